@@ -266,6 +266,30 @@ void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionVie
 
     path.moveTo(path.currentPosition().x(), -(y_base + ((*(listPairs[0].first) - channelMean)*dScaleY)));
 
+    //More than two samples per pixel column -> plot the min/max envelope of each column from the pyramids of the loaded windows
+    const RawModel* t_rawModel = static_cast<const RawModel*>(index.model());
+
+    if(m_dDx < 0.5) {
+        double dX0 = path.currentPosition().x();
+        qint32 iOffset = 0;
+
+        for(qint8 i=0; i < listPairs.size(); ++i) {
+            const DISPLIB::MinMaxPyramid* pPyramid = t_rawModel->minMaxPyramid(index.row(), i);
+
+            if(pPyramid && pPyramid->cols() == listPairs[i].second && index.row() < pPyramid->rows()) {
+                pPyramid->appendToPath(path, listPairs[i].first, index.row(), 0, listPairs[i].second, dX0 + iOffset*m_dDx, m_dDx, -y_base, dScaleY, channelMean);
+            } else {
+                for(qint32 j=0; j < listPairs[i].second; ++j) {
+                    path.lineTo(dX0 + (iOffset+j+1)*m_dDx, -(y_base + (*(listPairs[i].first+j) - channelMean)*dScaleY));
+                }
+            }
+
+            iOffset += listPairs[i].second;
+        }
+
+        return;
+    }
+
     //plot all rows from list of pairs
     for(qint8 i=0; i < listPairs.size(); ++i) {
         //create lines from one to the next sample
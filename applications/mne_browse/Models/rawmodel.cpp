@@ -205,7 +205,7 @@ QVariant RawModel::data(const QModelIndex &index, int role) const
 
                 for(qint16 i=0; i < m_data.size(); ++i) {
                     //if channel is not filtered or background Processing pending...
-                    if(!m_assignedOperators.contains(index.row()) || (m_bProcessing && m_bReloadBefore && i==0) || (m_bProcessing && !m_bReloadBefore && i==m_data.size()-1)) {
+                    if(!showsProcessedData(index.row(), i)) {
                         rowVectorPair.first = m_data[i]->dataRaw().data() + index.row()*m_data[i]->dataRaw().cols();
                         rowVectorPair.second  = m_data[i]->dataRaw().cols();
                     }
@@ -637,6 +637,29 @@ QPair<MatrixXd,MatrixXd> RawModel::readSegment(fiff_int_t from, fiff_int_t to)
 }
 
 
+//*************************************************************************************************************
+
+bool RawModel::showsProcessedData(int row, int window) const
+{
+    //raw data is shown if the channel is not filtered or background Processing of the window is pending
+    return !(!m_assignedOperators.contains(row) || (m_bProcessing && m_bReloadBefore && window==0) || (m_bProcessing && !m_bReloadBefore && window==m_data.size()-1));
+}
+
+
+//*************************************************************************************************************
+
+const DISPLIB::MinMaxPyramid* RawModel::minMaxPyramid(int row, int window) const
+{
+    if(window < 0 || window >= m_data.size())
+        return Q_NULLPTR;
+
+    if(showsProcessedData(row, window))
+        return &m_data[window]->pyramidProc();
+
+    return &m_data[window]->pyramidRaw();
+}
+
+
 //*************************************************************************************************************
 //public SLOTS
 void RawModel::updateScrollPos(int value)
@@ -232,6 +232,16 @@ private:
     */
     QPair<MatrixXd,MatrixXd> readSegment(fiff_int_t from, fiff_int_t to);
 
+    //=========================================================================================================
+    /**
+    * showsProcessedData returns whether the processed or the raw data of a window is displayed for a channel
+    *
+    * @param row the channel index
+    * @param window the index of the loaded window
+    * @return true if the processed data is displayed
+    */
+    bool showsProcessedData(int row, int window) const;
+
     //VARIABLES
     //Reload control
     bool                                    m_bStartReached;            /**< signals, whether the start of the fiff data file is reached. */
@@ -511,6 +521,17 @@ public:
     * @return the absolute cursor in the fiff file
     */
     inline qint32 absFiffCursor() const;
+
+    //=========================================================================================================
+    /**
+    * minMaxPyramid returns the min/max pyramid of the data which is displayed for a channel in one of the loaded
+    * windows, i.e. of the data the corresponding RowVectorPair of the DisplayRole points to.
+    *
+    * @param row the channel index
+    * @param window the index of the loaded window
+    * @return the min/max pyramid, NULL if the window does not exist
+    */
+    const DISPLIB::MinMaxPyramid* minMaxPyramid(int row, int window) const;
 };
 
 //*************************************************************************************************************
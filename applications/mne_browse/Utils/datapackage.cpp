@@ -74,6 +74,7 @@ DataPackage::DataPackage(const MatrixXdR &originalRawData, const MatrixXdR &orig
 
     m_dataProcOriginal = MatrixXdR::Zero(m_dataRawOriginal.rows(), length);
     m_dataProcMapped = MatrixXdR::Zero(m_dataRawMapped.rows(), m_dataRawMapped.cols());
+    m_pyramidProcMapped.build(m_dataProcMapped);
 
     //Init mean data
     m_dataRawMean = calculateMatMean(m_dataRawMapped);
@@ -90,6 +91,7 @@ void DataPackage::setOrigRawData(const MatrixXdR &originalRawData, int cutFront,
 
     //Cut data
     m_dataRawMapped = cutData(m_dataRawOriginal, cutFront, cutBack);
+    m_pyramidRawMapped.build(m_dataRawMapped);
 
     if(cutFront != m_iCutFrontRaw)
         m_iCutFrontRaw = cutFront;
@@ -116,6 +118,7 @@ void DataPackage::setOrigRawData(const RowVectorXd &originalRawData, int row, in
 
     //Cut data
     m_dataRawMapped.row(row) = cutData(m_dataRawOriginal, cutFront, cutBack);
+    m_pyramidRawMapped.updateRow(m_dataRawMapped.data() + row*m_dataRawMapped.cols(), row, 0, m_dataRawMapped.cols());
 
     if(cutFront != m_iCutFrontRaw)
         m_iCutFrontRaw = cutFront;
@@ -137,6 +140,7 @@ void DataPackage::setOrigProcData(const MatrixXdR &originalProcData, int cutFron
 
     //Cut data
     m_dataProcMapped = cutData(m_dataProcOriginal, cutFront, cutBack);
+    m_pyramidProcMapped.build(m_dataProcMapped);
 
     if(cutFront != m_iCutFrontProc)
         m_iCutFrontProc = cutFront;
@@ -155,6 +159,7 @@ void DataPackage::setMappedProcData(const MatrixXdR &originalProcData, int cutFr
 {
     //Cut data
     m_dataProcMapped = cutData(originalProcData, cutFront, cutBack);
+    m_pyramidProcMapped.build(m_dataProcMapped);
 
     if(cutFront != m_iCutFrontProc)
         m_iCutFrontProc = cutFront;
@@ -181,6 +186,7 @@ void DataPackage::setOrigProcData(const RowVectorXd &originalProcData, int row,
 
     //Cut data
     m_dataProcMapped.row(row) = cutData(originalProcData, cutFront, cutBack);
+    m_pyramidProcMapped.updateRow(m_dataProcMapped.data() + row*m_dataProcMapped.cols(), row, 0, m_dataProcMapped.cols());
 
     if(cutFront != m_iCutFrontProc)
         m_iCutFrontProc = cutFront;
@@ -204,6 +210,7 @@ void DataPackage::setMappedProcData(const RowVectorXd &originalProcData, int row
 
     //Cut data
     m_dataProcMapped.row(row) = cutData(originalProcData, cutFront, cutBack);
+    m_pyramidProcMapped.updateRow(m_dataProcMapped.data() + row*m_dataProcMapped.cols(), row, 0, m_dataProcMapped.cols());
 
     if(cutFront != m_iCutFrontProc)
         m_iCutFrontProc = cutFront;
@@ -247,6 +254,22 @@ const MatrixXdR & DataPackage::dataProc()
 }
 
 
+//*************************************************************************************************************
+
+const DISPLIB::MinMaxPyramid & DataPackage::pyramidRaw()
+{
+    return m_pyramidRawMapped;
+}
+
+
+//*************************************************************************************************************
+
+const DISPLIB::MinMaxPyramid & DataPackage::pyramidProc()
+{
+    return m_pyramidProcMapped;
+}
+
+
 //*************************************************************************************************************
 
 double DataPackage::dataProcMean(int row)
@@ -285,6 +308,10 @@ void DataPackage::applyFFTFilter(int channelNumber, QSharedPointer<FilterOperato
 
     //Cut filtered m_dataProcOriginal
     m_dataProcMapped = cutData(m_dataProcOriginal, m_iCutFrontProc, m_iCutBackProc);
+    if(m_pyramidProcMapped.rows() == m_dataProcMapped.rows() && m_pyramidProcMapped.cols() == m_dataProcMapped.cols())
+        m_pyramidProcMapped.updateRow(m_dataProcMapped.data() + channelNumber*m_dataProcMapped.cols(), channelNumber, 0, m_dataProcMapped.cols());
+    else
+        m_pyramidProcMapped.build(m_dataProcMapped);
 
     //Calculate mean
     m_dataProcMean(channelNumber) = calculateRowMean(m_dataProcMapped);
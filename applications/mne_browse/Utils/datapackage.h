@@ -45,6 +45,8 @@
 #include "filteroperator.h"
 #include "types.h"
 
+#include <disp/viewers/helpers/minmaxpyramid.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -195,6 +197,22 @@ public:
     */
     const MatrixXdR & dataProc();
 
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the mapped raw data.
+    *
+    * @return the min/max pyramid
+    */
+    const DISPLIB::MinMaxPyramid & pyramidRaw();
+
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the mapped processed data.
+    *
+    * @return the min/max pyramid
+    */
+    const DISPLIB::MinMaxPyramid & pyramidProc();
+
     //=========================================================================================================
     /**
     * Returns the mean of the processed mapped data.
@@ -271,11 +289,13 @@ private:
     MatrixXdR   m_dataRawMapped;        /**< The mapped/cut raw data */
     MatrixXdR   m_dataRawOriginal;      /**< The original raw data */
     VectorXd    m_dataRawMean;          /**< The mean of the mapped/cut raw data */
+    DISPLIB::MinMaxPyramid m_pyramidRawMapped;  /**< The min/max pyramid of the mapped/cut raw data */
 
     //Processed data
     MatrixXdR   m_dataProcOriginal;     /**< The mapped/cut processed/filtered data */
     MatrixXdR   m_dataProcMapped;       /**< The original processed/filtered data */
     VectorXd    m_dataProcMean;         /**< The mean of the mapped/cut processed/filtered data */
+    DISPLIB::MinMaxPyramid m_pyramidProcMapped; /**< The min/max pyramid of the mapped/cut processed/filtered data */
 
     //Cutting parameters
     int m_iCutFrontRaw;                 /**< The last used cut front value of the raw data */
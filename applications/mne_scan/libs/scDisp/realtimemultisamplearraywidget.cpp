@@ -163,13 +163,13 @@ void RealTimeMultiSampleArrayWidget::update(SCMEASLIB::Measurement::SPtr)
         if(m_pRTMSA->isChInit()) {
             m_pFiffInfo = m_pRTMSA->info();
 
-            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArray().at(m_pRTMSA->getMultiSampleArray().size()-1).cols();
+            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleBlocks().last()->cols();
 
             init();
         }
     } else {
         //Add data to table view
-        m_pChannelDataView->addData(m_pRTMSA->getMultiSampleArray());
+        m_pChannelDataView->addData(m_pRTMSA->getMultiSampleBlocks());
     }
 }
 
@@ -0,0 +1,187 @@
+//=============================================================================================================
+/**
+* @file     matrixblockpool.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the MatrixBlockPool class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "matrixblockpool.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMap>
+#include <QPair>
+#include <QMutexLocker>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MatrixBlockPool::MatrixBlockPool(int iRows, int iCols)
+: m_iRows(iRows)
+, m_iCols(iCols)
+, m_iMaxFree(64)
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlockPool::~MatrixBlockPool()
+{
+    qDeleteAll(m_qVecFree);
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlockPool::SPtr MatrixBlockPool::instance(int iRows, int iCols)
+{
+    static QMutex s_qMutex;
+    static QMap<QPair<int,int>, MatrixBlockPool::SPtr> s_qMapPools;
+
+    QMutexLocker locker(&s_qMutex);
+
+    MatrixBlockPool::SPtr& pPool = s_qMapPools[qMakePair(iRows, iCols)];
+
+    if(!pPool) {
+        pPool = MatrixBlockPool::SPtr(new MatrixBlockPool(iRows, iCols));
+    }
+
+    return pPool;
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlockPool::Block MatrixBlockPool::acquire()
+{
+    MatrixXd* pMat = Q_NULLPTR;
+
+    m_qMutex.lock();
+    if(!m_qVecFree.isEmpty()) {
+        pMat = m_qVecFree.takeLast();
+    }
+    m_qMutex.unlock();
+
+    if(!pMat) {
+        pMat = new MatrixXd(m_iRows, m_iCols);
+    }
+
+    //The deleter holds a reference to the pool, so blocks which outlive the registry still find their way back
+    MatrixBlockPool::SPtr pPool = sharedFromThis();
+
+    return Block(pMat, [pPool](MatrixXd* p) {
+        pPool->recycle(p);
+    });
+}
+
+
+//*************************************************************************************************************
+
+MatrixBlockPool::ConstBlock MatrixBlockPool::copyOf(const MatrixXd& mat)
+{
+    Block pBlock = acquire();
+
+    if(mat.rows() == m_iRows && mat.cols() == m_iCols) {
+        *pBlock = mat;
+    } else {
+        qWarning() << "MatrixBlockPool::copyOf - Matrix size" << mat.rows() << "x" << mat.cols() << "does not match the pool size" << m_iRows << "x" << m_iCols;
+        pBlock->resize(m_iRows, m_iCols);
+        pBlock->setZero();
+        pBlock->topLeftCorner(qMin(m_iRows, int(mat.rows())), qMin(m_iCols, int(mat.cols()))) = mat.topLeftCorner(qMin(m_iRows, int(mat.rows())), qMin(m_iCols, int(mat.cols())));
+    }
+
+    return pBlock;
+}
+
+
+//*************************************************************************************************************
+
+int MatrixBlockPool::numFree() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qVecFree.size();
+}
+
+
+//*************************************************************************************************************
+
+void MatrixBlockPool::setMaxFree(int iMaxFree)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iMaxFree = qMax(0, iMaxFree);
+
+    while(m_qVecFree.size() > m_iMaxFree) {
+        delete m_qVecFree.takeLast();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MatrixBlockPool::recycle(MatrixXd* pMat)
+{
+    //The producer might have resized its block, do not hand out blocks of the wrong size
+    if(pMat->rows() != m_iRows || pMat->cols() != m_iCols) {
+        delete pMat;
+        return;
+    }
+
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_qVecFree.size() < m_iMaxFree) {
+        m_qVecFree.append(pMat);
+    } else {
+        delete pMat;
+    }
+}
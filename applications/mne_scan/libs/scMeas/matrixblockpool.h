@@ -0,0 +1,208 @@
+//=============================================================================================================
+/**
+* @file     matrixblockpool.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the MatrixBlockPool class.
+*
+*/
+
+#ifndef MATRIXBLOCKPOOL_H
+#define MATRIXBLOCKPOOL_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QEnableSharedFromThis>
+#include <QVector>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+
+//=========================================================================================================
+/**
+* Slab allocator for equally sized data blocks. There is one pool per block size (channels x samples). Blocks are
+* handed out as shared pointers whose deleter returns the matrix to the pool once the last owner releases it, so
+* measurements can pass the same block to all observers without copying and the memory is reused for the next
+* block instead of being freed. A producer fills a Block once and publishes it as a read-only ConstBlock.
+*
+* @brief Pool of reference counted, recycled data blocks.
+*/
+class SCMEASSHARED_EXPORT MatrixBlockPool : public QEnableSharedFromThis<MatrixBlockPool>
+{
+public:
+    typedef QSharedPointer<MatrixBlockPool> SPtr;                   /**< Shared pointer type for MatrixBlockPool. */
+    typedef QSharedPointer<const MatrixBlockPool> ConstSPtr;        /**< Const shared pointer type for MatrixBlockPool. */
+    typedef QSharedPointer<Eigen::MatrixXd> Block;                  /**< Writable pooled block, owned by the producer. */
+    typedef QSharedPointer<const Eigen::MatrixXd> ConstBlock;       /**< Read-only pooled block, shared by all consumers. */
+
+    //=========================================================================================================
+    /**
+    * Destroys the pool and frees all blocks which are currently not in use.
+    */
+    ~MatrixBlockPool();
+
+    //=========================================================================================================
+    /**
+    * Returns the process wide pool for blocks of the given size. The pool is created on first use.
+    *
+    * @param [in] iRows     number of rows (channels) of the blocks.
+    * @param [in] iCols     number of columns (samples) of the blocks.
+    *
+    * @return the pool for the given block size.
+    */
+    static SPtr instance(int iRows, int iCols);
+
+    //=========================================================================================================
+    /**
+    * Returns a block of the pool size. The block is taken from the free list if possible, otherwise a new one is
+    * allocated. The content of a recycled block is undefined, the caller has to overwrite all values.
+    *
+    * @return the block, which goes back to the pool when its last reference is released.
+    */
+    Block acquire();
+
+    //=========================================================================================================
+    /**
+    * Returns a pooled read-only copy of the given matrix. This is the only copy made on the way from the producer
+    * to the consumers.
+    *
+    * @param [in] mat   the matrix to copy. Its size has to match the pool size.
+    *
+    * @return the pooled block.
+    */
+    ConstBlock copyOf(const Eigen::MatrixXd& mat);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of rows of the blocks.
+    *
+    * @return the number of rows.
+    */
+    inline int rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of columns of the blocks.
+    *
+    * @return the number of columns.
+    */
+    inline int cols() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks which are currently waiting in the free list.
+    *
+    * @return the number of free blocks.
+    */
+    int numFree() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the maximum number of blocks kept in the free list. Blocks returned to a full free list are deleted.
+    *
+    * @param [in] iMaxFree  the maximum number of free blocks.
+    */
+    void setMaxFree(int iMaxFree);
+
+private:
+    //=========================================================================================================
+    /**
+    * Constructs a pool for blocks of the given size. Use instance() to obtain a pool.
+    *
+    * @param [in] iRows     number of rows (channels) of the blocks.
+    * @param [in] iCols     number of columns (samples) of the blocks.
+    */
+    MatrixBlockPool(int iRows, int iCols);
+
+    //=========================================================================================================
+    /**
+    * Returns a block to the free list. Called by the deleter of the blocks handed out by acquire().
+    *
+    * @param [in] pMat  the block to recycle.
+    */
+    void recycle(Eigen::MatrixXd* pMat);
+
+    mutable QMutex              m_qMutex;       /**< Guards the free list. */
+    int                         m_iRows;        /**< Number of rows of the blocks. */
+    int                         m_iCols;        /**< Number of columns of the blocks. */
+    int                         m_iMaxFree;     /**< Maximum number of blocks kept in the free list. */
+    QVector<Eigen::MatrixXd*>   m_qVecFree;     /**< Blocks which are ready to be handed out again. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int MatrixBlockPool::rows() const
+{
+    return m_iRows;
+}
+
+
+//*************************************************************************************************************
+
+inline int MatrixBlockPool::cols() const
+{
+    return m_iCols;
+}
+
+} // NAMESPACE
+
+#endif // MATRIXBLOCKPOOL_H
@@ -236,6 +236,21 @@ void RealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr &p_pFiffInfo)
 }
 
 
+//*************************************************************************************************************
+
+const QList< MatrixXd >& RealTimeMultiSampleArray::getMultiSampleArray()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    //Blocks are only appended or cleared together with the copies, so only the new ones have to be copied
+    for(int i = m_matSamples.size(); i < m_listBlocks.size(); ++i) {
+        m_matSamples.append(*m_listBlocks.at(i));
+    }
+
+    return m_matSamples;
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
@@ -243,9 +258,28 @@ void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
     if(!m_bChInfoIsInit)
         return;
 
+    m_qMutex.lock();
+    if(!m_pBlockPool || m_pBlockPool->rows() != mat.rows() || m_pBlockPool->cols() != mat.cols()) {
+        m_pBlockPool = MatrixBlockPool::instance(mat.rows(), mat.cols());
+    }
+    MatrixBlockPool::SPtr pBlockPool = m_pBlockPool;
+    m_qMutex.unlock();
+
+    //This is the only copy, all observers share the pooled block
+    setValue(pBlockPool->copyOf(mat));
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArray::setValue(const MatrixBlockPool::ConstBlock& pBlock)
+{
+    if(!m_bChInfoIsInit || !pBlock)
+        return;
+
     m_qMutex.lock();
     //check vector size
-    if(mat.rows() != m_qListChInfo.size())
+    if(pBlock->rows() != m_qListChInfo.size())
         qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setVector: Vector size does not match the number of channels! ";
 
     //ToDo
@@ -257,15 +291,14 @@ void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
 //    }
 
     //Store
-    m_matSamples.push_back(mat);
+    m_listBlocks.append(pBlock);
+    bool bNotify = m_listBlocks.size() >= m_iMultiArraySize;
 
     m_qMutex.unlock();
-    if(m_matSamples.size() >= m_iMultiArraySize)
+    if(bNotify)
     {
         emit notify();
-        m_qMutex.lock();
-        m_matSamples.clear();
-        m_qMutex.unlock();
+        //Releasing the blocks returns them to their pool unless an observer still holds a reference
+        clear();
     }
 }
-
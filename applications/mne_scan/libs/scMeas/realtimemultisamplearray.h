@@ -45,6 +45,7 @@
 #include "scmeas_global.h"
 #include "measurement.h"
 #include "realtimesamplearraychinfo.h"
+#include "matrixblockpool.h"
 
 #include <fiff/fiff_info.h>
 
@@ -223,20 +224,38 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the gathered multi sample array.
+    * Returns the gathered multi sample array. The blocks are copied into the returned list on first access after
+    * new data arrived. Use getMultiSampleBlocks() to access the data without copying.
     *
     * @return the current multi sample array.
     */
-    inline const QList< MatrixXd >& getMultiSampleArray();
+    const QList< MatrixXd >& getMultiSampleArray();
 
     //=========================================================================================================
     /**
-    * Attaches a value to the sample array list.
+    * Returns the gathered blocks. The blocks are shared with all other observers and must not be modified. Keeping
+    * a reference to a block keeps it alive, it is returned to its pool when the last reference is released.
+    *
+    * @return the current blocks.
+    */
+    inline QList<MatrixBlockPool::ConstBlock> getMultiSampleBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Attaches a value to the sample array list. The value is copied once into a pooled block.
     *
     * @param [in] mat   the value which is attached to the sample array list.
     */
     virtual void setValue(const MatrixXd& mat);
 
+    //=========================================================================================================
+    /**
+    * Attaches a block to the sample array list without copying. The producer must not modify the block afterwards.
+    *
+    * @param [in] pBlock    the block which is attached to the sample array list.
+    */
+    void setValue(const MatrixBlockPool::ConstBlock& pBlock);
+
 private:
     mutable QMutex              m_qMutex;           /**< Mutex to ensure thread safety */
 
@@ -246,7 +265,9 @@ private:
     QString                     m_sXMLLayoutFile;   /**< Layout file name. */
     double                      m_dSamplingRate;    /**< Sampling rate of the RealTimeSampleArray.*/
     qint32                      m_iMultiArraySize;  /**< Sample size of the multi sample array.*/
-    QList<MatrixXd>             m_matSamples;       /**< The multi sample array.*/
+    QList<MatrixBlockPool::ConstBlock> m_listBlocks; /**< The gathered blocks, shared with the observers.*/
+    QList<MatrixXd>             m_matSamples;       /**< Copies of the gathered blocks, only filled if getMultiSampleArray() is called.*/
+    MatrixBlockPool::SPtr       m_pBlockPool;       /**< Pool of the last block size passed to setValue(const MatrixXd&).*/
     bool                        m_bChInfoIsInit;    /**< If channel info is initialized.*/
 
     QList<RealTimeSampleArrayChInfo> m_qListChInfo; /**< Channel info list.*/
@@ -261,6 +282,7 @@ private:
 inline void RealTimeMultiSampleArray::clear()
 {
     QMutexLocker locker(&m_qMutex);
+    m_listBlocks.clear();
     m_matSamples.clear();
 }
 
@@ -379,9 +401,10 @@ qint32 RealTimeMultiSampleArray::getMultiArraySize() const
 
 //*************************************************************************************************************
 
-inline const QList< MatrixXd >& RealTimeMultiSampleArray::getMultiSampleArray()
+inline QList<MatrixBlockPool::ConstBlock> RealTimeMultiSampleArray::getMultiSampleBlocks() const
 {
-    return m_matSamples;
+    QMutexLocker locker(&m_qMutex);
+    return m_listBlocks;
 }
 
 } // NAMESPACE
@@ -82,7 +82,8 @@ SOURCES += \
     measurementtypes.cpp \
     realtimeevokedset.cpp \
     realtimecov.cpp \
-    realtimespectrum.cpp
+    realtimespectrum.cpp \
+    matrixblockpool.cpp
 
 HEADERS += \
     scmeas_global.h \
@@ -96,7 +97,8 @@ HEADERS += \
     measurementtypes.h \
     realtimeevokedset.h \
     realtimecov.h \
-    realtimespectrum.h
+    realtimespectrum.h \
+    matrixblockpool.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
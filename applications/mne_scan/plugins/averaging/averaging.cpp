@@ -181,7 +181,7 @@ void Averaging::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pAveragingBuffer) {
-            m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
          //Fiff information
@@ -206,9 +206,11 @@ void Averaging::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         // Append new data
         if(m_bProcessData) {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i) {
+            QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
+
+            for(qint32 i = 0; i < lBlocks.size(); ++i) {
                 if(m_pRtAve) {
-                    m_pAveragingBuffer->push(&pRTMSA->getMultiSampleArray()[i]);
+                    m_pAveragingBuffer->push(lBlocks.at(i).data());
                 }
             }
         }
@@ -185,7 +185,7 @@ void DummyToolbox::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pDummyBuffer) {
-            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
         //Fiff information
@@ -198,11 +198,10 @@ void DummyToolbox::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pDummyOutput->data()->setVisibility(true);
         }
 
-        MatrixXd t_mat;
+        QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
 
-        for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pDummyBuffer->push(&t_mat);
+        for(int i = 0; i < lBlocks.size(); ++i) {
+            m_pDummyBuffer->push(lBlocks.at(i).data());
         }
     }
 }
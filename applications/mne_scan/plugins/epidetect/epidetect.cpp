@@ -200,7 +200,7 @@ void Epidetect::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pEpidetectBuffer) {
-            m_pEpidetectBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pEpidetectBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
         //Fiff information
@@ -213,11 +213,10 @@ void Epidetect::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pEpidetectOutput->data()->setVisibility(true);
         }
 
-        MatrixXd t_mat;
+        QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
 
-        for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pEpidetectBuffer->push(&t_mat);
+        for(int i = 0; i < lBlocks.size(); ++i) {
+            m_pEpidetectBuffer->push(lBlocks.at(i).data());
         }
     }
 }
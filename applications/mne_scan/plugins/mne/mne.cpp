@@ -405,7 +405,7 @@ void MNE::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         //Check if buffer initialized
         if(!m_pMatrixDataBuffer) {
-            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
         //Fiff Information of the RTMSA
@@ -415,17 +415,19 @@ void MNE::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement)
         }
 
         if(m_bProcessData) {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i) {
+            QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
+
+            for(qint32 i = 0; i < lBlocks.size(); ++i) {
                 // Check for artifacts
                 QMap<QString,double> mapReject;
                 mapReject.insert("eog", 150e-06);
 
-                bool bArtifactDetected = MNEEpochDataList::checkForArtifact(pRTMSA->getMultiSampleArray()[i],
+                bool bArtifactDetected = MNEEpochDataList::checkForArtifact(*lBlocks.at(i),
                                                                             *m_pFiffInfoInput,
                                                                             mapReject);
 
                 if(!bArtifactDetected) {
-                    m_pMatrixDataBuffer->push(&pRTMSA->getMultiSampleArray()[i]);
+                    m_pMatrixDataBuffer->push(lBlocks.at(i).data());
                 } else {
                     qDebug() << "MNE::updateRTMSA - Reject data block";
                 }
@@ -649,6 +651,8 @@ void MNE::run()
     qint32 t_evokedSize;
     MatrixXd rawSegment;
     MatrixXd data;
+    MatrixXd matSourceData;
+    VectorXi vecVertices;
     qint32 j;
     float tmin, tstep;
     MNESourceEstimate sourceEstimate;
@@ -674,10 +678,16 @@ void MNE::run()
                 tstep = 1.0f / m_pFiffInfoInput->sfreq;
 
                 //TODO: Add picking here. See evoked part as input.
-                sourceEstimate = m_pMinimumNorm->calculateInverse(data,
-                                                                  tmin,
-                                                                  tstep,
-                                                                  true);
+                //Apply the cached float kernel into the reused source buffer
+                if(m_pMinimumNorm->applyInverse(data, matSourceData)) {
+                    const MNESourceSpace& sourceSpace = m_pMinimumNorm->getPreparedInverseOperator().src;
+                    vecVertices.resize(sourceSpace[0].vertno.size() + sourceSpace[1].vertno.size());
+                    vecVertices << sourceSpace[0].vertno, sourceSpace[1].vertno;
+
+                    sourceEstimate = MNESourceEstimate(matSourceData, vecVertices, tmin, tstep);
+                } else {
+                    sourceEstimate = MNESourceEstimate();
+                }
 
                 m_qMutex.unlock();
 
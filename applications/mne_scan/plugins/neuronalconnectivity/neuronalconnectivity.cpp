@@ -172,6 +172,7 @@ void NeuronalConnectivity::init()
 
     //Init rt connectivity worker
     m_pRtConnectivity = RtConnectivity::SPtr::create();
+    m_pRtConnectivity->setWindowSize(m_iNumberAverages);
     connect(m_pRtConnectivity.data(), &RtConnectivity::newConnectivityResultAvailable,
             this, &NeuronalConnectivity::onNewConnectivityResultAvailable);
 
@@ -290,14 +291,10 @@ void NeuronalConnectivity::updateSource(SCMEASLIB::Measurement::SPtr pMeasuremen
                                                                            pRTSE->getValue()[i]->data.cols() - iZeroIdx));
         }
 
-        //Pop data from buffer
-        if(m_connectivitySettings.size() >= m_iNumberAverages) {
-            m_pRtConnectivity->restart();
-            m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-        }
-
+        //Send the new trials to the sliding window of the worker
         m_timer.restart();
-        m_pRtConnectivity->append(m_connectivitySettings);
+        m_pRtConnectivity->appendTrials(m_connectivitySettings);
+        m_connectivitySettings.clearAllData();
     }
 }
 
@@ -337,9 +334,11 @@ void NeuronalConnectivity::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement
 
             MatrixXd data;
 
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i) {
-                const MatrixXd& t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_iBlockSize = pRTMSA->getMultiSampleArray()[i].cols();
+            QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
+
+            for(qint32 i = 0; i < lBlocks.size(); ++i) {
+                const MatrixXd& t_mat = *lBlocks.at(i);
+                m_iBlockSize = t_mat.cols();
 
                 // Check row and colum integrity and restart if necessary
                 if(m_connectivitySettings.size() != 0) {
@@ -358,14 +357,10 @@ void NeuronalConnectivity::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement
                 m_connectivitySettings.append(data);
             }
 
-            //Pop data from buffer
-            if(m_connectivitySettings.size() > m_iNumberAverages) {
-                m_pRtConnectivity->restart();
-                m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-            }
-
+            //Send the new trials to the sliding window of the worker
             m_timer.restart();
-            m_pRtConnectivity->append(m_connectivitySettings);
+            m_pRtConnectivity->appendTrials(m_connectivitySettings);
+            m_connectivitySettings.clearAllData();
         }
     }
 }
@@ -442,14 +437,10 @@ void NeuronalConnectivity::updateRTEV(SCMEASLIB::Measurement::SPtr pMeasurement)
 
                     m_connectivitySettings.append(data);
 
-                    //Pop data from buffer
-                    if(m_connectivitySettings.size() > m_iNumberAverages) {
-                        m_pRtConnectivity->restart();
-                        m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-                    }
-
+                    //Send the new trial to the sliding window of the worker
                     m_timer.restart();
-                    m_pRtConnectivity->append(m_connectivitySettings);
+                    m_pRtConnectivity->appendTrials(m_connectivitySettings);
+                    m_connectivitySettings.clearAllData();
 
                     break;
                 }
@@ -541,10 +532,9 @@ void NeuronalConnectivity::run()
 void NeuronalConnectivity::onNewConnectivityResultAvailable(const QList<Network>& connectivityResults,
                                                             const ConnectivitySettings& connectivitySettings)
 {
-    //QMutexLocker locker(&m_mutex);
-    m_connectivitySettings = connectivitySettings;
-    m_connectivitySettings.setConnectivityMethods(m_sConnectivityMethods);
+    Q_UNUSED(connectivitySettings);
 
+    //QMutexLocker locker(&m_mutex);
     for(int i = 0; i < connectivityResults.size(); ++i) {
         m_pCircularNetworkBuffer->push(connectivityResults.at(i));
     }
@@ -563,7 +553,6 @@ void NeuronalConnectivity::onMetricChanged(const QString& sMetric)
     m_connectivitySettings.setConnectivityMethods(m_sConnectivityMethods);
     if(m_pRtConnectivity && m_bIsRunning) {
         m_pRtConnectivity->restart();
-        m_pRtConnectivity->append(m_connectivitySettings);
     }
 }
 
@@ -573,6 +562,10 @@ void NeuronalConnectivity::onMetricChanged(const QString& sMetric)
 void NeuronalConnectivity::onNumberTrialsChanged(int iNumberTrials)
 {
     m_iNumberAverages = iNumberTrials;
+
+    if(m_pRtConnectivity) {
+        m_pRtConnectivity->setWindowSize(m_iNumberAverages);
+    }
 }
 
 
@@ -254,7 +254,7 @@ void NoiseEstimate::update(SCMEASLIB::Measurement::SPtr pMeasurement)
         m_qMutex.lock();
         if(!m_pBuffer)
         {
-            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
         //Fiff information
@@ -267,12 +267,11 @@ void NoiseEstimate::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
+            QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
 
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
+            for(int i = 0; i < lBlocks.size(); ++i)
             {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pBuffer->push(&t_mat);
+                m_pBuffer->push(lBlocks.at(i).data());
             }
         }
     }
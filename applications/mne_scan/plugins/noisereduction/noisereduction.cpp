@@ -273,7 +273,7 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(m_pRTMSA) {
         //Check if buffer initialized
         if(!m_pNoiseReductionBuffer) {
-            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
         //Fiff information
@@ -299,7 +299,7 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pNoiseReductionOutput->data()->setVisibility(true);            
 
             //Init the filter
-            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArray().first().cols();
+            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleBlocks().first()->cols();
 
             m_pFilterSettingsView->getFilterView()->init(m_pFiffInfo->sfreq);
             m_pFilterSettingsView->getFilterView()->setWindowSize(m_iMaxFilterTapSize);
@@ -311,11 +311,10 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pCompensatorView->setCompensators(m_pFiffInfo->comps);
         }
 
-        MatrixXd t_mat;
+        QList<MatrixBlockPool::ConstBlock> lBlocks = m_pRTMSA->getMultiSampleBlocks();
 
-        for(unsigned char i = 0; i < m_pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = m_pRTMSA->getMultiSampleArray()[i];
-            m_pNoiseReductionBuffer->push(&t_mat);
+        for(int i = 0; i < lBlocks.size(); ++i) {
+            m_pNoiseReductionBuffer->push(lBlocks.at(i).data());
         }
     }
 }
@@ -319,6 +319,9 @@ void RapMusicToolbox::run()
 
     m_pPwlRapMusic = RapMusic::SPtr(new RapMusic(*m_pClusteredFwd, false, numDipolePairs));
 
+    //Track the signal subspace across the incoming evoked windows
+    m_pPwlRapMusic->setStreamingMode(true);
+
     //
     // start processing data
     //
@@ -345,7 +348,8 @@ void RapMusicToolbox::run()
             {
                 m_qMutex.lock();
                 FiffEvoked t_fiffEvoked = m_qVecFiffEvoked[0].evoked.first();
-                m_pPwlRapMusic->setStcAttr(t_fiffEvoked.data.cols()/4.0,0.0);
+                //Overlapping windows let the streaming mode update the covariance with the new samples only
+                m_pPwlRapMusic->setStcAttr(t_fiffEvoked.data.cols()/4.0,0.5);
                 m_qVecFiffEvoked.pop_front();
                 m_qMutex.unlock();
 
@@ -187,7 +187,7 @@ void Reference::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pRefBuffer) {
-            m_pRefBuffer = CircularMatrixBuffer<double>::SPtr(new _double_CircularMatrixBuffer(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pRefBuffer = CircularMatrixBuffer<double>::SPtr(new _double_CircularMatrixBuffer(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
         }
 
         //Fiff information
@@ -202,11 +202,10 @@ void Reference::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pRefToolbarWidget->updateChannels(m_pFiffInfo);
         }
 
-        MatrixXd t_mat;
+        QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
 
-        for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pRefBuffer->push(&t_mat);
+        for(int i = 0; i < lBlocks.size(); ++i) {
+            m_pRefBuffer->push(lBlocks.at(i).data());
         }
     }
 }
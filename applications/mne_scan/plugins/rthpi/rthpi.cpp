@@ -225,7 +225,7 @@ void RtHpi::update(SCMEASLIB::Measurement::SPtr pMeasurement)
         m_qMutex.lock();
         //Check if buffer initialized
         if(!m_pRtHpiBuffer)
-            m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pRtHpiBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -237,12 +237,11 @@ void RtHpi::update(SCMEASLIB::Measurement::SPtr pMeasurement)
         m_qMutex.unlock();
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
+            QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
 
-            for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
+            for(int i = 0; i < lBlocks.size(); ++i)
             {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pRtHpiBuffer->push(&t_mat);
+                m_pRtHpiBuffer->push(lBlocks.at(i).data());
             }
         }
     }
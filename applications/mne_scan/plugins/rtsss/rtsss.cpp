@@ -274,7 +274,7 @@ void RtSss::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     {
         //Check if buffer initialized
         if(!m_pRtSssBuffer)
-            m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
 
         //Fiff information
         if(!m_pFiffInfo)
@@ -282,11 +282,11 @@ void RtSss::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd in_mat;
-            for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i)
+            QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
+
+            for(int i = 0; i < lBlocks.size(); ++i)
             {
-                in_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pRtSssBuffer->push(&in_mat);
+                m_pRtSssBuffer->push(lBlocks.at(i).data());
             }
         }
     }
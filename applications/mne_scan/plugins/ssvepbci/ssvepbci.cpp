@@ -289,7 +289,7 @@ void SsvepBci::updateSensor(SCMEASLIB::Measurement::SPtr pMeasurement)
         //Check if buffer initialized
         m_qMutex.lock();
         if(!m_pBCIBuffer_Sensor)
-            m_pBCIBuffer_Sensor = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pBCIBuffer_Sensor = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlocks().first()->cols()));
     }
 
     //Fiff information
@@ -306,8 +306,8 @@ void SsvepBci::updateSensor(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         // determine sliding time window parameters
         m_iReadSampleSize = 0.1*m_dSampleFrequency;    // about 0.1 second long time segment as basic read increment
-        m_iWriteSampleSize = pRTMSA->getMultiSampleArray()[0].cols();
-        m_iTimeWindowLength = int(5*m_dSampleFrequency) + int(pRTMSA->getMultiSampleArray()[0].cols()/m_iDownSampleIncrement) + 1 ;
+        m_iWriteSampleSize = pRTMSA->getMultiSampleBlocks().first()->cols();
+        m_iTimeWindowLength = int(5*m_dSampleFrequency) + int(pRTMSA->getMultiSampleBlocks().first()->cols()/m_iDownSampleIncrement) + 1 ;
         //m_iTimeWindowSegmentSize  = int(5*m_dSampleFrequency / m_iWriteSampleSize) + 1;   // 4 seconds long maximal sized window
         m_matSlidingTimeWindow.resize(m_lElectrodeNumbers.size(), m_iTimeWindowLength);//m_matSlidingTimeWindow.resize(rows, m_iTimeWindowSegmentSize*pRTMSA->getMultiSampleArray()[0].cols());
 
@@ -321,10 +321,10 @@ void SsvepBci::updateSensor(SCMEASLIB::Measurement::SPtr pMeasurement)
 
     // filling the matrix buffer
     if(m_bProcessData){
-        MatrixXd t_mat;
-        for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i){
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pBCIBuffer_Sensor->push(&t_mat);
+        QList<MatrixBlockPool::ConstBlock> lBlocks = pRTMSA->getMultiSampleBlocks();
+
+        for(int i = 0; i < lBlocks.size(); ++i){
+            m_pBCIBuffer_Sensor->push(lBlocks.at(i).data());
         }
     }
 }
@@ -127,6 +127,55 @@ void customMessageHandler(QtMsgType type, const QMessageLogContext &context, con
 }
 
 
+//=============================================================================================================
+/**
+* Measures how the connectivity estimation scales with the number of threads of the global thread pool.
+*
+* @param [in] connectivitySettings     The connectivity settings holding the trials.
+* @param [in] sConnectivityMethodList  The connectivity methods to measure.
+* @param [in] iNumberRepeats           The number of repetitions per thread count.
+*/
+void measureThreadScaling(ConnectivitySettings& connectivitySettings,
+                          const QStringList& sConnectivityMethodList,
+                          int iNumberRepeats)
+{
+    QList<int> lNumberThreads = QList<int>() << 1 << 2 << 4 << 8 << 16 << 32;
+    int iMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QElapsedTimer timer;
+
+    qWarning() << "Thread scaling for" << connectivitySettings.size() << "trials,"
+               << connectivitySettings.at(0).matData.rows() << "channels,"
+               << connectivitySettings.at(0).matData.cols() << "samples";
+
+    for(int i = 0; i < sConnectivityMethodList.size(); ++i) {
+        connectivitySettings.setConnectivityMethods(QStringList() << sConnectivityMethodList.at(i));
+        double dTimeSingle = 0.0;
+
+        for(int j = 0; j < lNumberThreads.size(); ++j) {
+            QThreadPool::globalInstance()->setMaxThreadCount(lNumberThreads.at(j));
+
+            timer.start();
+            for(int u = 0; u < iNumberRepeats; ++u) {
+                connectivitySettings.clearIntermediateData();
+                Connectivity::calculate(connectivitySettings);
+            }
+            double dTime = timer.nsecsElapsed() / 1000000.0 / iNumberRepeats;
+
+            if(j == 0) {
+                dTimeSingle = dTime;
+            }
+
+            qWarning() << "sConnectivityMethod" << sConnectivityMethodList.at(i)
+                       << "iNumberThreads" << lNumberThreads.at(j)
+                       << "time [ms]" << dTime
+                       << "speedup" << dTimeSingle / dTime;
+        }
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(iMaxThreadCount);
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // MAIN
@@ -215,6 +264,16 @@ int main(int argc, char *argv[])
     qWarning() << "matInputData[64][100000].rows()" << matInputData[64][100000].rows();
     qWarning() << "matInputData[64][100000].cols()" << matInputData[64][100000].cols();
 
+    //Measure the scaling with the number of threads for 100 trials of 64 channels and 500 samples
+    ConnectivitySettings scalingSettings = connectivitySettings;
+    scalingSettings.setNodePositions(raw.info, RowVectorXi::LinSpaced(64,1,65));
+
+    for(int i = 0; i < 100; ++i) {
+        scalingSettings.append(matInputData[64][500]);
+    }
+
+    measureThreadScaling(scalingSettings, sConnectivityMethodList, iNumberRepeats);
+
     for(int j = 0; j < lNumberSamples.size(); ++j) {
         for(int k = 0; k < lNumberChannels.size(); ++k) {
             connectivitySettings.clearAllData();
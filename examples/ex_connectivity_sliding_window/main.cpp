@@ -0,0 +1,182 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   Lorenz Esch <lorenz.esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Benchmark comparing update latency and throughput of sliding window and full connectivity estimation.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <connectivity/connectivity.h>
+#include <connectivity/connectivitysettings.h>
+#include <connectivity/network/network.h>
+#include <connectivity/metrics/abstractmetric.h>
+
+#include <rtprocessing/rtconnectivity.h>
+
+#include <stdio.h>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace CONNECTIVITYLIB;
+using namespace RTPROCESSINGLIB;
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sliding Window Connectivity Benchmark Example");
+    parser.addHelpOption();
+
+    QCommandLineOption methodOption("connectMethod", "Connectivity <method>, i.e., 'COH', 'IMAGCOH', 'PLI', 'WPLI'.", "method", "WPLI");
+    QCommandLineOption channelsOption("channels", "The number of channels <channels>.", "channels", "64");
+    QCommandLineOption samplesOption("samples", "The number of samples per trial <samples>.", "samples", "500");
+    QCommandLineOption sFreqOption("sfreq", "The sampling frequency in Hz <sfreq>.", "sfreq", "1000");
+    QCommandLineOption binsOption("bins", "The number of frequency bins to compute <bins>.", "bins", "40");
+    QCommandLineOption repeatOption("repeat", "The number of timed updates per window size <repeat>.", "repeat", "20");
+
+    parser.addOption(methodOption);
+    parser.addOption(channelsOption);
+    parser.addOption(samplesOption);
+    parser.addOption(sFreqOption);
+    parser.addOption(binsOption);
+    parser.addOption(repeatOption);
+
+    parser.process(a);
+
+    const QString sMethod = parser.value(methodOption);
+    const int iNumChannels = parser.value(channelsOption).toInt();
+    const int iNumSamples = parser.value(samplesOption).toInt();
+    const int iSFreq = parser.value(sFreqOption).toInt();
+    const int iNumRepeats = parser.value(repeatOption).toInt();
+
+    // The sliding window relies on the stored per-trial intermediate data
+    AbstractMetric::m_bStorageModeIsActive = true;
+    AbstractMetric::m_iNumberBinStart = 0;
+    AbstractMetric::m_iNumberBinAmount = parser.value(binsOption).toInt();
+
+    ConnectivitySettings settings;
+    settings.setConnectivityMethods(QStringList() << sMethod);
+    settings.setSamplingFrequency(iSFreq);
+    settings.setFFTSize(iNumSamples);
+    settings.setWindowType("hanning");
+    settings.setNodePositions(MatrixX3f::Random(iNumChannels, 3));
+
+    QList<int> lWindowSizes = QList<int>() << 10 << 20 << 50 << 100 << 200;
+
+    printf("%s, %d channels, %d samples per trial, %d frequency bins\n", sMethod.toLatin1().data(), iNumChannels, iNumSamples, AbstractMetric::m_iNumberBinAmount);
+    printf("%-8s %20s %20s %20s %20s\n", "Trials", "Sliding mean [ms]", "Sliding max [ms]", "Sliding [updates/s]", "Full mean [ms]");
+
+    QElapsedTimer timer;
+
+    for(int k = 0; k < lWindowSizes.size(); ++k) {
+        const int iWindowSize = lWindowSizes.at(k);
+
+        // Fill the window, this also computes the intermediate data of the first iWindowSize trials
+        RtConnectivityWorker worker;
+        ConnectivitySettings fullSettings = settings;
+
+        ConnectivitySettings newTrials = settings;
+        for(int i = 0; i < iWindowSize; ++i) {
+            newTrials.append(MatrixXd::Random(iNumChannels, iNumSamples));
+            fullSettings.append(newTrials.at(i).matData);
+        }
+        worker.doWorkSlidingWindow(newTrials, iWindowSize);
+
+        // Sliding window, one new trial per update
+        double dTimeSum = 0.0;
+        double dTimeMax = 0.0;
+
+        for(int u = 0; u < iNumRepeats; ++u) {
+            newTrials.clearAllData();
+            newTrials.append(MatrixXd::Random(iNumChannels, iNumSamples));
+
+            timer.start();
+            worker.doWorkSlidingWindow(newTrials, iWindowSize);
+            const double dTime = timer.nsecsElapsed() / 1000000.0;
+
+            dTimeSum += dTime;
+            dTimeMax = qMax(dTimeMax, dTime);
+        }
+
+        const double dTimeSliding = dTimeSum / iNumRepeats;
+
+        // Full recomputation of all trials in the window per update
+        dTimeSum = 0.0;
+
+        for(int u = 0; u < iNumRepeats; ++u) {
+            timer.start();
+            fullSettings.removeFirst();
+            fullSettings.append(MatrixXd::Random(iNumChannels, iNumSamples));
+            fullSettings.clearIntermediateData();
+            Connectivity::calculate(fullSettings);
+            dTimeSum += timer.nsecsElapsed() / 1000000.0;
+        }
+
+        const double dTimeFull = dTimeSum / iNumRepeats;
+
+        printf("%-8d %20.2f %20.2f %20.1f %20.2f\n", iWindowSize, dTimeSliding, dTimeMax, 1000.0 / dTimeSliding, dTimeFull);
+    }
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Benchmark comparing group delay and per-block latency of the real-time filter modes.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <iostream>
+#include <vector>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <utils/filterTools/filterdata.h>
+#include <rtprocessing/rtfilter.h>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace UTILSLIB;
+using namespace RTPROCESSINGLIB;
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* Estimates the group delay of a filter at the given frequency from the phase of its spectrum.
+*
+* @param [in] filter    The filter.
+* @param [in] dFreq     The frequency in Hz.
+*
+* @return the group delay in samples.
+*/
+double groupDelay(const FilterData& filter, double dFreq)
+{
+    const RowVectorXcd& vecSpectrum = filter.m_dFFTCoeffA;
+    const int iBin = qBound(1, int(dFreq / filter.m_sFreq * filter.m_iFFTlength + 0.5), int(vecSpectrum.cols()) - 2);
+
+    double dPhaseDiff = std::arg(vecSpectrum[iBin+1]) - std::arg(vecSpectrum[iBin-1]);
+
+    //Unwrap the phase difference
+    while(dPhaseDiff > M_PI) {
+        dPhaseDiff -= 2*M_PI;
+    }
+    while(dPhaseDiff < -M_PI) {
+        dPhaseDiff += 2*M_PI;
+    }
+
+    return -dPhaseDiff / (2 * 2*M_PI / filter.m_iFFTlength);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Filter Latency Benchmark Example");
+    parser.addHelpOption();
+
+    QCommandLineOption channelsOption("channels", "The number of channels <channels>.", "channels", "306");
+    QCommandLineOption sFreqOption("sfreq", "The sampling frequency in Hz <sfreq>.", "sfreq", "5000");
+    QCommandLineOption blockOption("block", "The number of samples per block <block>.", "block", "200");
+    QCommandLineOption repeatOption("repeat", "The number of filtered blocks <repeat>.", "repeat", "200");
+
+    parser.addOption(channelsOption);
+    parser.addOption(sFreqOption);
+    parser.addOption(blockOption);
+    parser.addOption(repeatOption);
+
+    parser.process(a);
+
+    const int iNumChannels = parser.value(channelsOption).toInt();
+    const double dSFreq = parser.value(sFreqOption).toDouble();
+    const int iBlockSize = parser.value(blockOption).toInt();
+    const int iNumRepeats = parser.value(repeatOption).toInt();
+
+    // Initialize filter settings, normed to nyquist
+    const double dCenterfreq = 20.0;
+    const double dBandwidth = 20.0;
+    const double dTransition = 5.0;
+    const int iFirOrder = 1024;
+    const int iIirOrder = 4;
+    const qint32 iFftLength = 4096;
+
+    if(iBlockSize + iFirOrder > iFftLength) {
+        printf("Block size plus FIR order must not exceed the fft length of %d.\n", iFftLength);
+        return -1;
+    }
+
+    QList<FilterData> lFilterLinear = RtFilter::getCachedFilterDesign(FilterData::BPF,
+                                                                      dCenterfreq/(dSFreq/2.0),
+                                                                      dBandwidth/(dSFreq/2.0),
+                                                                      dTransition/(dSFreq/2.0),
+                                                                      dSFreq,
+                                                                      iFirOrder,
+                                                                      iFftLength,
+                                                                      FilterData::Cosine);
+
+    QList<FilterData> lFilterMinPhase = RtFilter::getCachedFilterDesign(FilterData::BPF,
+                                                                        dCenterfreq/(dSFreq/2.0),
+                                                                        dBandwidth/(dSFreq/2.0),
+                                                                        dTransition/(dSFreq/2.0),
+                                                                        dSFreq,
+                                                                        iFirOrder,
+                                                                        iFftLength,
+                                                                        FilterData::Cosine,
+                                                                        true);
+
+    QList<FilterData> lFilterIIR = RtFilter::getCachedFilterDesign(FilterData::BPF,
+                                                                   dCenterfreq/(dSFreq/2.0),
+                                                                   dBandwidth/(dSFreq/2.0),
+                                                                   dTransition/(dSFreq/2.0),
+                                                                   dSFreq,
+                                                                   iIirOrder,
+                                                                   iFftLength,
+                                                                   FilterData::Butterworth);
+
+    // Filter all channels
+    RowVectorXi picks = RowVectorXi::LinSpaced(iNumChannels, 0, iNumChannels-1);
+    MatrixXd matBlock = MatrixXd::Random(iNumChannels, iBlockSize);
+
+    RtFilter rtFilterLinear;
+    RtFilter rtFilterMinPhase;
+    RtFilter rtFilterIIR;
+    QElapsedTimer timer;
+
+    // Warm up, so the fft plans and work buffers are set up before timing
+    rtFilterLinear.filterDataBlockInPlace(matBlock, iFirOrder, picks, lFilterLinear);
+    rtFilterMinPhase.filterDataBlockInPlace(matBlock, iFirOrder, picks, lFilterMinPhase);
+    rtFilterIIR.filterDataBlockIIR(matBlock, picks, lFilterIIR.first());
+
+    timer.start();
+    for(int i = 0; i < iNumRepeats; ++i) {
+        rtFilterLinear.filterDataBlockInPlace(matBlock, iFirOrder, picks, lFilterLinear);
+    }
+    const double dTimeLinear = timer.nsecsElapsed() / 1000.0 / iNumRepeats;
+
+    timer.restart();
+    for(int i = 0; i < iNumRepeats; ++i) {
+        rtFilterMinPhase.filterDataBlockInPlace(matBlock, iFirOrder, picks, lFilterMinPhase);
+    }
+    const double dTimeMinPhase = timer.nsecsElapsed() / 1000.0 / iNumRepeats;
+
+    timer.restart();
+    for(int i = 0; i < iNumRepeats; ++i) {
+        rtFilterIIR.filterDataBlockIIR(matBlock, picks, lFilterIIR.first());
+    }
+    const double dTimeIIR = timer.nsecsElapsed() / 1000.0 / iNumRepeats;
+
+    // Report the group delay at the center frequency and the processing time per block
+    const double dGroupDelayLinear = groupDelay(lFilterLinear.first(), dCenterfreq);
+    const double dGroupDelayMinPhase = groupDelay(lFilterMinPhase.first(), dCenterfreq);
+    const double dGroupDelayIIR = groupDelay(lFilterIIR.first(), dCenterfreq);
+
+    printf("%d channels, %.0f Hz, %d samples per block, bandpass %.1f - %.1f Hz\n", iNumChannels, dSFreq, iBlockSize, dCenterfreq - dBandwidth/2, dCenterfreq + dBandwidth/2);
+    printf("%-28s %16s %16s %18s\n", "Mode", "Delay [samples]", "Delay [ms]", "Time/block [us]");
+    printf("%-28s %16.1f %16.2f %18.1f\n", "FIR linear phase (FFT)", dGroupDelayLinear, 1000.0*dGroupDelayLinear/dSFreq, dTimeLinear);
+    printf("%-28s %16.1f %16.2f %18.1f\n", "FIR minimum phase (FFT)", dGroupDelayMinPhase, 1000.0*dGroupDelayMinPhase/dSFreq, dTimeMinPhase);
+    printf("%-28s %16.1f %16.2f %18.1f\n", "IIR Butterworth (biquads)", dGroupDelayIIR, 1000.0*dGroupDelayIIR/dSFreq, dTimeIIR);
+
+    return 0;
+}
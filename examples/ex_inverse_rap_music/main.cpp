@@ -70,6 +70,7 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QVector3D>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -85,6 +86,86 @@ using namespace UTILSLIB;
 using namespace DISP3DLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// SUBCORR BENCHMARK
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* Compares the SVD based subspace correlation scan against the Gram based scan of RapMusic for the first
+* RAP MUSIC iteration. Both scans run on one thread, so the speed-up is the one per scan and per core.
+*/
+class RapMusicSubcorrBenchmark : public RapMusic
+{
+public:
+    RapMusicSubcorrBenchmark(MNEForwardSolution& p_Fwd)
+    : RapMusic(p_Fwd, false, 1)
+    {
+    }
+
+    void run(const MatrixXd& p_matMeasurement)
+    {
+        //Signal subspace of the first iteration (orthogonal projector = identity)
+        MatrixXT* t_pMatPhi_s = NULL;
+        calcPhi_s(p_matMeasurement, t_pMatPhi_s);
+
+        Eigen::JacobiSVD<MatrixXT> t_svdPhi_S(*t_pMatPhi_s, Eigen::ComputeThinU);
+        MatrixXT t_matU_B;
+        useFullRank(t_svdPhi_S.matrixU(), t_svdPhi_S.singularValues().asDiagonal(), t_matU_B);
+        delete t_pMatPhi_s;
+
+        const MatrixXT& t_matLeadField = m_ForwardSolution.sol->data;
+
+        std::cout << "Subcorr scan of " << m_iNumGridPoints << " grid points, " << m_iNumLeadFieldCombinations
+                  << " pairs, " << m_iNumChannels << " channels" << std::endl;
+
+        int t_iMaxNumThreads = m_iMaxNumThreads;
+        m_iMaxNumThreads = 1;
+
+        QElapsedTimer timer;
+
+        //SVD based scan
+        VectorXT t_vecRohSVD(m_iNumLeadFieldCombinations);
+        MatrixX6T t_matProj_G(t_matLeadField.rows(), 6);
+
+        timer.start();
+        for(int i = 0; i < m_iNumLeadFieldCombinations; ++i) {
+            getGainMatrixPair(t_matLeadField, t_matProj_G, m_ppPairIdxCombinations[i]->x1, m_ppPairIdxCombinations[i]->x2);
+            t_vecRohSVD(i) = subcorr(t_matProj_G, t_matU_B);
+        }
+        qint64 t_iTimeSVD = timer.elapsed();
+
+        //Gram based scan
+        VectorXT t_vecRohGram(m_iNumLeadFieldCombinations);
+
+        timer.start();
+        SubcorrBasis t_subcorrBasis;
+        calcSubcorrBasis(t_matLeadField, t_matU_B, t_subcorrBasis);
+        calcSubcorrScan(t_matLeadField, t_subcorrBasis, t_vecRohGram);
+        qint64 t_iTimeGram = timer.elapsed();
+
+        //Gram based scan on all threads
+        m_iMaxNumThreads = t_iMaxNumThreads;
+
+        timer.start();
+        calcSubcorrBasis(t_matLeadField, t_matU_B, t_subcorrBasis);
+        calcSubcorrScan(t_matLeadField, t_subcorrBasis, t_vecRohGram);
+        qint64 t_iTimeGramThreads = timer.elapsed();
+
+        VectorXT::Index t_iMaxIdxSVD, t_iMaxIdxGram;
+        t_vecRohSVD.maxCoeff(&t_iMaxIdxSVD);
+        t_vecRohGram.maxCoeff(&t_iMaxIdxGram);
+
+        std::cout << "SVD scan:  " << t_iTimeSVD << " ms" << std::endl;
+        std::cout << "Gram scan: " << t_iTimeGram << " ms (x" << double(t_iTimeSVD)/double(qMax(t_iTimeGram, qint64(1)))
+                  << "), " << t_iTimeGramThreads << " ms on " << m_iMaxNumThreads << " threads" << std::endl;
+        std::cout << "Max correlation difference: " << (t_vecRohSVD - t_vecRohGram).cwiseAbs().maxCoeff()
+                  << "; same maximum: " << (t_iMaxIdxSVD == t_iMaxIdxGram ? "yes" : "no") << std::endl << std::endl;
+    }
+};
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // MAIN
@@ -120,15 +201,20 @@ int main(int argc, char *argv[])
     QCommandLineOption annotOption("annotType", "Annotation type <type>.", "type", "aparc.a2009s");
     QCommandLineOption numDipolePairsOption("numDip", "<number> of dipole pairs to localize.", "number", "1");
     QCommandLineOption surfOption("surfType", "Surface type <type>.", "type", "orig");
+    QCommandLineOption streamingOption("streaming", "Track the signal subspace across the overlapping movie windows.", "streaming", "false");
+    QCommandLineOption benchSubcorrOption("benchSubcorr", "Benchmark the SVD against the Gram based subspace correlation scan.", "benchSubcorr", "false");
 
     parser.addOption(fwdFileOption);
     parser.addOption(evokedFileOption);
     parser.addOption(subjectDirectoryOption);
     parser.addOption(subjectOption);
     parser.addOption(stcFileOption);
+    parser.addOption(doMovieOption);
     parser.addOption(annotOption);
     parser.addOption(numDipolePairsOption);
     parser.addOption(surfOption);
+    parser.addOption(benchSubcorrOption);
+    parser.addOption(streamingOption);
     parser.process(a);
 
     //Load data
@@ -177,6 +263,11 @@ int main(int argc, char *argv[])
 //    std::cout << "Size " << t_clusteredFwd.sol->data.rows() << " x " << t_clusteredFwd.sol->data.cols() << std::endl;
 //    std::cout << "Clustered Fwd:\n" << t_clusteredFwd.sol->data.row(0) << std::endl;
 
+    if(parser.value(benchSubcorrOption) == "true" || parser.value(benchSubcorrOption) == "1") {
+        RapMusicSubcorrBenchmark t_benchmark(t_clusteredFwd);
+        t_benchmark.run(pickedEvoked.data);
+    }
+
     RapMusic t_rapMusic(t_clusteredFwd, false, numDipolePairs);
 
     int iWinSize = 200;
@@ -184,6 +275,10 @@ int main(int argc, char *argv[])
         t_rapMusic.setStcAttr(iWinSize, 0.6f);
     }
 
+    if(parser.value(streamingOption) == "true" || parser.value(streamingOption) == "1") {
+        t_rapMusic.setStreamingMode(true);
+    }
+
     MNESourceEstimate sourceEstimate = t_rapMusic.calculateInverse(pickedEvoked);
 
     if(doMovie) {
@@ -0,0 +1,225 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Benchmark of the frame time of the real-time raw data view with and without the min/max pyramid.
+*
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_info.h>
+#include <disp/viewers/helpers/rtfiffrawviewmodel.h>
+#include <disp/viewers/helpers/rtfiffrawviewdelegate.h>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOptionViewItem>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace FIFFLIB;
+using namespace DISPLIB;
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* Paints all channels the way the delegate did before the min/max pyramid was introduced, i.e. with one
+* QPainterPath::lineTo per sample.
+*
+* @param [in] painter       The painter.
+* @param [in] model         The model holding the data.
+* @param [in] iWidth        The width of the plot in pixels.
+* @param [in] iRowHeight    The height of one channel in pixels.
+* @param [in] dMaxValue     The scaling of the channels.
+*/
+void paintPerSample(QPainter& painter, const RtFiffRawViewModel& model, int iWidth, int iRowHeight, double dMaxValue)
+{
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen(Qt::darkBlue, 1, Qt::SolidLine));
+
+    const double dDx = double(iWidth) / model.getMaxSamples();
+    const double dScaleY = iRowHeight / (2*dMaxValue);
+
+    for(int r = 0; r < model.rowCount(); ++r) {
+        RowVectorPair data = model.data(model.index(r,1), Qt::DisplayRole).value<RowVectorPair>();
+        double y_base = r*iRowHeight + iRowHeight/2;
+
+        QPainterPath path(QPointF(0, y_base));
+        for(qint32 j = 0; j < data.second; ++j) {
+            path.lineTo(path.currentPosition().x() + dDx, y_base - (*(data.first+j) - *(data.first))*dScaleY);
+        }
+
+        painter.drawPath(path);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Raw View Frame Time Benchmark Example");
+    parser.addHelpOption();
+
+    QCommandLineOption channelsOption("channels", "The number of channels <channels>.", "channels", "306");
+    QCommandLineOption sFreqOption("sfreq", "The sampling frequency in Hz <sfreq>.", "sfreq", "5000");
+    QCommandLineOption windowOption("window", "The displayed time window in seconds <window>.", "window", "10");
+    QCommandLineOption blockOption("block", "The number of samples per block <block>.", "block", "200");
+    QCommandLineOption widthOption("width", "The width of the plot in pixels <width>.", "width", "1600");
+    QCommandLineOption framesOption("frames", "The number of painted frames <frames>.", "frames", "10");
+
+    parser.addOption(channelsOption);
+    parser.addOption(sFreqOption);
+    parser.addOption(windowOption);
+    parser.addOption(blockOption);
+    parser.addOption(widthOption);
+    parser.addOption(framesOption);
+
+    parser.process(a);
+
+    const int iNumChannels = parser.value(channelsOption).toInt();
+    const double dSFreq = parser.value(sFreqOption).toDouble();
+    const int iWindow = parser.value(windowOption).toInt();
+    const int iBlockSize = parser.value(blockOption).toInt();
+    const int iWidth = parser.value(widthOption).toInt();
+    const int iNumFrames = parser.value(framesOption).toInt();
+    const int iRowHeight = 10;
+    const double dMaxValue = 1e-10;
+
+    // Set up a gradiometer only measurement info
+    FiffInfo::SPtr pFiffInfo = FiffInfo::SPtr::create();
+    pFiffInfo->sfreq = dSFreq;
+
+    for(int i = 0; i < iNumChannels; ++i) {
+        FiffChInfo chInfo;
+        chInfo.kind = FIFFV_MEG_CH;
+        chInfo.unit = FIFF_UNIT_T_M;
+        chInfo.ch_name = QString("MEG %1").arg(i);
+
+        pFiffInfo->chs.append(chInfo);
+        pFiffInfo->ch_names.append(chInfo.ch_name);
+    }
+    pFiffInfo->nchan = iNumChannels;
+
+    RtFiffRawViewModel model;
+    model.setFiffInfo(pFiffInfo);
+    model.setSamplingInfo(dSFreq, iWindow, true);
+
+    RtFiffRawViewDelegate delegate;
+    delegate.initPainterPaths(&model);
+
+    // Fill the whole time window with noise and sparse spikes, which must survive the envelope
+    QElapsedTimer timer;
+    qint64 iIngestTime = 0;
+    int iNumBlocks = model.getMaxSamples() / iBlockSize;
+
+    for(int b = 0; b < iNumBlocks; ++b) {
+        MatrixXd matBlock = MatrixXd::Random(iNumChannels, iBlockSize) * 0.1 * dMaxValue;
+        matBlock(b % iNumChannels, b % iBlockSize) = 0.9 * dMaxValue;
+
+        QList<MatrixXd> lData;
+        lData.append(matBlock);
+
+        timer.restart();
+        model.addData(lData);
+        iIngestTime += timer.nsecsElapsed();
+    }
+
+    QImage image(iWidth, iNumChannels*iRowHeight, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+
+    // Paint with the delegate, which reads the envelopes from the min/max pyramid
+    QStyleOptionViewItem option;
+    image.fill(Qt::white);
+
+    timer.restart();
+    for(int f = 0; f < iNumFrames; ++f) {
+        for(int r = 0; r < iNumChannels; ++r) {
+            option.rect = QRect(0, r*iRowHeight, iWidth, iRowHeight);
+            delegate.paint(&painter, option, model.index(r,1));
+        }
+    }
+    const double dFrameTimePyramid = timer.nsecsElapsed() / 1.0e6 / iNumFrames;
+
+    // Paint every sample
+    image.fill(Qt::white);
+
+    timer.restart();
+    for(int f = 0; f < iNumFrames; ++f) {
+        paintPerSample(painter, model, iWidth, iRowHeight, dMaxValue);
+    }
+    const double dFrameTimePerSample = timer.nsecsElapsed() / 1.0e6 / iNumFrames;
+
+    painter.end();
+
+    printf("%d channels, %.0f Hz, %d s window (%d samples), %d pixels wide\n", iNumChannels, dSFreq, iWindow, model.getMaxSamples(), iWidth);
+    printf("%-32s %14s\n", "Mode", "Time [ms]");
+    printf("%-32s %14.2f\n", "Frame, min/max pyramid", dFrameTimePyramid);
+    printf("%-32s %14.2f\n", "Frame, one point per sample", dFrameTimePerSample);
+    printf("%-32s %14.3f\n", "addData per block", iIngestTime / 1.0e6 / qMax(iNumBlocks, 1));
+
+    return 0;
+}
@@ -131,6 +131,9 @@ int main(int argc, char *argv[])
     fiff_int_t quantum = ceil(quantum_sec*raw.info.sfreq);
 
     // To read the whole file at once set quantum = to - from + 1;
+    // The chunks are decoded ahead on a background thread while the previous one is written
+    FiffRawChunkIterator chunkIterator(raw, quantum, defaultRowVectorXi/*, picks*/, from, to);
+
     // Read and write the data
     bool first_buffer = true;
 
@@ -138,17 +141,7 @@ int main(int argc, char *argv[])
     MatrixXd data;
     MatrixXd times;
 
-    for(first = from; first < to; first+=quantum) {
-        last = first+quantum-1;
-        if (last > to) {
-            last = to;
-        }
-
-        if(!raw.read_raw_segment(data,times,first,last/*,picks*/)) {
-            printf("error during read_raw_segment\n");
-            return -1;
-        }
-
+    while(chunkIterator.next(data, times, first, last)) {
         // You can add your own miracle here
         printf("Writing...");
         if(first_buffer) {
@@ -66,14 +66,17 @@ SUBDIRS += \
             ex_connectivity \
             ex_connectivity_comparison \
             ex_connectivity_performance \
+            ex_connectivity_sliding_window \
             ex_disp \
             ex_disp_3D \
             ex_fs_surface \
             ex_filtering \
+            ex_filtering_latency \
             ex_histogram \
             ex_inverse_mne_raw \
             ex_inverse_pwl_rap_music \
             ex_inverse_rap_music \
+            ex_raw_view_frametime \
             ex_read_fwd_disp_3D \
             ex_roi_clustered_inverse_pwl_rap_music \
             ex_st_clustered_inverse_pwl_rap_music \
@@ -52,6 +52,11 @@
 #include "metrics/weightedphaselagindex.h"
 #include "metrics/unbiasedsquaredphaselagindex.h"
 #include "metrics/debiasedsquaredweightedphaselagindex.h"
+#include "metrics/coherency.h"
+#include "metrics/abstractmetric.h"
+#include "network/networknode.h"
+
+#include <utils/spectral.h>
 
 
 //*************************************************************************************************************
@@ -69,6 +74,8 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <unsupported/Eigen/FFT>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -76,6 +83,8 @@
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -103,40 +112,74 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
     QElapsedTimer timer;
     timer.start();
 
-    if(lMethods.contains("WPLI")) {
-        results.append(WeightedPhaseLagIndex::calculate(connectivitySettings));
-    }
+    // The spectral metrics are all derived from the same tapered spectra and CSD. If more than one of them is
+    // requested, compute the spectra once and reduce the shared sums to the single networks.
+    QStringList lSpectralMethods;
+    lSpectralMethods << "WPLI" << "USPLI" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
 
-    if(lMethods.contains("USPLI")) {
-        results.append(UnbiasedSquaredPhaseLagIndex::calculate(connectivitySettings));
+    QStringList lSharedMethods;
+    for(int i = 0; i < lSpectralMethods.size(); ++i) {
+        if(lMethods.contains(lSpectralMethods.at(i))) {
+            lSharedMethods << lSpectralMethods.at(i);
+        }
     }
 
+    QMap<QString,Network> mapNetworks;
+
     if(lMethods.contains("COR")) {
-        results.append(Correlation::calculate(connectivitySettings));
+        mapNetworks.insert("COR", Correlation::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("XCOR")) {
-        results.append(CrossCorrelation::calculate(connectivitySettings));
+        mapNetworks.insert("XCOR", CrossCorrelation::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("PLI")) {
-        results.append(PhaseLagIndex::calculate(connectivitySettings));
-    }
+    if(lSharedMethods.size() > 1 && !connectivitySettings.isEmpty()) {
+        calculateSharedIntermediateData(connectivitySettings,
+                                        lSharedMethods);
 
-    if(lMethods.contains("COH")) {
-        results.append(Coherence::calculate(connectivitySettings));
-    }
+        for(int i = 0; i < lSharedMethods.size(); ++i) {
+            mapNetworks.insert(lSharedMethods.at(i), reduceSharedIntermediateData(lSharedMethods.at(i),
+                                                                                  connectivitySettings));
+        }
+    } else {
+        if(lMethods.contains("WPLI")) {
+            mapNetworks.insert("WPLI", WeightedPhaseLagIndex::calculate(connectivitySettings));
+        }
 
-    if(lMethods.contains("IMAGCOH")) {
-        results.append(ImagCoherence::calculate(connectivitySettings));
-    }
+        if(lMethods.contains("USPLI")) {
+            mapNetworks.insert("USPLI", UnbiasedSquaredPhaseLagIndex::calculate(connectivitySettings));
+        }
 
-    if(lMethods.contains("PLV")) {
-        results.append(PhaseLockingValue::calculate(connectivitySettings));
+        if(lMethods.contains("PLI")) {
+            mapNetworks.insert("PLI", PhaseLagIndex::calculate(connectivitySettings));
+        }
+
+        if(lMethods.contains("COH")) {
+            mapNetworks.insert("COH", Coherence::calculate(connectivitySettings));
+        }
+
+        if(lMethods.contains("IMAGCOH")) {
+            mapNetworks.insert("IMAGCOH", ImagCoherence::calculate(connectivitySettings));
+        }
+
+        if(lMethods.contains("PLV")) {
+            mapNetworks.insert("PLV", PhaseLockingValue::calculate(connectivitySettings));
+        }
+
+        if(lMethods.contains("DSWPLI")) {
+            mapNetworks.insert("DSWPLI", DebiasedSquaredWeightedPhaseLagIndex::calculate(connectivitySettings));
+        }
     }
 
-    if(lMethods.contains("DSWPLI")) {
-        results.append(DebiasedSquaredWeightedPhaseLagIndex::calculate(connectivitySettings));
+    // Keep the order in which the networks were returned before
+    QStringList lOrder;
+    lOrder << "WPLI" << "USPLI" << "COR" << "XCOR" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
+
+    for(int i = 0; i < lOrder.size(); ++i) {
+        if(mapNetworks.contains(lOrder.at(i))) {
+            results.append(mapNetworks.value(lOrder.at(i)));
+        }
     }
 
     qWarning() << "Total" << timer.elapsed();
@@ -144,3 +187,332 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
 
     return results;
 }
+
+
+//*************************************************************************************************************
+
+void Connectivity::calculateSharedIntermediateData(ConnectivitySettings& connectivitySettings,
+                                                   const QStringList& lMethods)
+{
+    if(AbstractMetric::m_bStorageModeIsActive == false) {
+        connectivitySettings.clearIntermediateData();
+    }
+
+    #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+    #endif
+
+    int iNRows = connectivitySettings.at(0).matData.rows();
+    int iSignalLength = connectivitySettings.at(0).matData.cols();
+    int iNfft = connectivitySettings.getFFTSize();
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    // Generate tapers
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
+
+    // Check if start and bin amount need to be reset to full spectrum
+    if(AbstractMetric::m_iNumberBinStart == -1 ||
+       AbstractMetric::m_iNumberBinAmount == -1 ||
+       AbstractMetric::m_iNumberBinStart > iNFreqs ||
+       AbstractMetric::m_iNumberBinAmount > iNFreqs ||
+       AbstractMetric::m_iNumberBinAmount + AbstractMetric::m_iNumberBinStart > iNFreqs) {
+        qDebug() << "Connectivity::calculateSharedIntermediateData - Resetting to full spectrum";
+        AbstractMetric::m_iNumberBinStart = 0;
+        AbstractMetric::m_iNumberBinAmount = iNFreqs;
+    }
+
+    SpectralPlan plan;
+    plan.bPsd = lMethods.contains("COH") || lMethods.contains("IMAGCOH");
+    plan.bImagSign = lMethods.contains("PLI") || lMethods.contains("USPLI");
+    plan.bImagAbs = lMethods.contains("WPLI") || lMethods.contains("DSWPLI");
+    plan.bImagSqrd = lMethods.contains("DSWPLI");
+    plan.bNormalized = lMethods.contains("PLV");
+
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
+        computeSharedTrial(inputData,
+                           sumData,
+                           plan,
+                           iNRows,
+                           iNFreqs,
+                           iNfft,
+                           tapers);
+    };
+
+    AbstractMetric::computeTrials(connectivitySettings,
+                                  computeLambda);
+}
+
+
+//*************************************************************************************************************
+
+void Connectivity::computeSharedTrial(ConnectivitySettings::IntermediateTrialData& inputData,
+                                      ConnectivitySettings::IntermediateSumData& sumData,
+                                      const SpectralPlan& plan,
+                                      int iNRows,
+                                      int iNFreqs,
+                                      int iNfft,
+                                      const QPair<MatrixXd, VectorXd>& tapers)
+{
+    // Only accumulate what was not already added to the sums for this trial (storage mode)
+    bool bCsdStored = inputData.vecPairCsd.size() == iNRows;
+    bool bPsd = plan.bPsd && inputData.matPsd.rows() != iNRows;
+    bool bImagSign = plan.bImagSign && inputData.vecPairCsdImagSign.size() != iNRows;
+    bool bImagAbs = plan.bImagAbs && inputData.vecPairCsdImagAbs.size() != iNRows;
+    bool bImagSqrd = plan.bImagSqrd && inputData.vecPairCsdImagSqrd.size() != iNRows;
+    bool bNormalized = plan.bNormalized && inputData.vecPairCsdNormalized.size() != iNRows;
+
+    if(bCsdStored && !bPsd && !bImagSign && !bImagAbs && !bImagSqrd && !bNormalized) {
+        return;
+    }
+
+    bool bStorage = AbstractMetric::m_bStorageModeIsActive;
+    int iBinStart = AbstractMetric::m_iNumberBinStart;
+    int iNBins = AbstractMetric::m_iNumberBinAmount;
+    bool bNfftEven = iNfft % 2 == 0;
+    bool bHalveFirst = iBinStart == 0;
+    bool bHalveLast = bNfftEven && iBinStart + iNBins >= iNFreqs;
+    int i,j;
+
+    // Allocate the partial sums of this task on first use, so the trials can be accumulated row by row
+    if(!bCsdStored && sumData.vecPairCsdSum.isEmpty()) {
+        for(i = 0; i < iNRows; ++i) {
+            sumData.vecPairCsdSum.append(QPair<int,MatrixXcd>(i, MatrixXcd::Zero(iNRows, iNBins)));
+        }
+    }
+
+    if(bPsd && sumData.matPsdSum.size() == 0) {
+        sumData.matPsdSum = MatrixXd::Zero(iNRows, iNBins);
+    }
+
+    if(bImagSign && sumData.vecPairCsdImagSignSum.isEmpty()) {
+        for(i = 0; i < iNRows; ++i) {
+            sumData.vecPairCsdImagSignSum.append(QPair<int,MatrixXd>(i, MatrixXd::Zero(iNRows, iNBins)));
+        }
+    }
+
+    if(bImagAbs && sumData.vecPairCsdImagAbsSum.isEmpty()) {
+        for(i = 0; i < iNRows; ++i) {
+            sumData.vecPairCsdImagAbsSum.append(QPair<int,MatrixXd>(i, MatrixXd::Zero(iNRows, iNBins)));
+        }
+    }
+
+    if(bImagSqrd && sumData.vecPairCsdImagSqrdSum.isEmpty()) {
+        for(i = 0; i < iNRows; ++i) {
+            sumData.vecPairCsdImagSqrdSum.append(QPair<int,MatrixXd>(i, MatrixXd::Zero(iNRows, iNBins)));
+        }
+    }
+
+    if(bNormalized && sumData.vecPairCsdNormalizedSum.isEmpty()) {
+        for(i = 0; i < iNRows; ++i) {
+            sumData.vecPairCsdNormalizedSum.append(QPair<int,MatrixXcd>(i, MatrixXcd::Zero(iNRows, iNBins)));
+        }
+    }
+
+    // Calculate the tapered spectra once for all metrics. Only keep them in the trial data in storage mode.
+    QVector<MatrixXcd> vecTapSpectra = inputData.vecTapSpectra;
+
+    if(vecTapSpectra.size() != iNRows && (bPsd || !bCsdStored)) {
+        vecTapSpectra.clear();
+        vecTapSpectra.reserve(iNRows);
+
+        RowVectorXd vecInputFFT, rowData;
+        RowVectorXcd vecTmpFreq;
+
+        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
+
+        FFT<double> fft;
+        fft.SetFlag(fft.HalfSpectrum);
+
+        for (i = 0; i < iNRows; ++i) {
+            // Substract mean
+            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
+
+            // Calculate tapered spectra
+            for(j = 0; j < tapers.first.rows(); j++) {
+                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
+                if (rowData.cols() < iNfft) {
+                    vecInputFFT.setZero(iNfft);
+                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));
+                } else {
+                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
+                }
+
+                // FFT for freq domain returning the half spectrum and multiply taper weights
+                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
+                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
+            }
+
+            vecTapSpectra.append(matTapSpectrum);
+        }
+
+        if(bStorage) {
+            inputData.vecTapSpectra = vecTapSpectra;
+        }
+    }
+
+    // Compute PSD
+    if(bPsd) {
+        double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
+
+        MatrixXd matPsd(iNRows, iNBins);
+
+        for (i = 0; i < iNRows; ++i) {
+            matPsd.row(i) = vecTapSpectra.at(i).block(0,iBinStart,vecTapSpectra.at(i).rows(),iNBins).cwiseAbs2().colwise().sum() / denomPSD;
+
+            // Divide first and last element by 2 due to half spectrum
+            if(bHalveFirst) {
+                matPsd.row(i)(0) /= 2.0;
+            }
+
+            if(bHalveLast) {
+                matPsd.row(i).tail(1) /= 2.0;
+            }
+        }
+
+        sumData.matPsdSum += matPsd;
+
+        if(bStorage) {
+            inputData.matPsd = matPsd;
+        }
+    }
+
+    // Compute the CSD in blocks of rows and derive the quantities row by row. Each row is added to the sums right
+    // away, so only one block of CSD rows needs to be held in memory if the storage mode is not active.
+    const int iBlockRows = 32;
+
+    QVector<QPair<int,MatrixXcd> > vecPairCsdBlock;
+    MatrixXd matImag, matImagSign, matImagAbs, matImagSqrd;
+    MatrixXcd matNormalized;
+
+    for (i = 0; i < iNRows; ++i) {
+        if(!bCsdStored && i % iBlockRows == 0) {
+            vecPairCsdBlock = AbstractMetric::computeCsd(vecTapSpectra,
+                                                         tapers.second,
+                                                         iNFreqs,
+                                                         iNfft,
+                                                         i,
+                                                         qMin(iBlockRows, iNRows - i));
+        }
+
+        const MatrixXcd& matCsd = bCsdStored ? inputData.vecPairCsd.at(i).second : vecPairCsdBlock.at(i % iBlockRows).second;
+
+        if(bImagSign || bImagAbs || bImagSqrd) {
+            matImag = matCsd.imag();
+        }
+
+        if(bImagSign) {
+            matImagSign = matImag.cwiseSign();
+        }
+
+        if(bImagAbs) {
+            matImagAbs = matImag.cwiseAbs();
+        }
+
+        if(bImagSqrd) {
+            matImagSqrd = matImag.array().square();
+        }
+
+        if(bNormalized) {
+            matNormalized = matCsd.cwiseQuotient(matCsd.cwiseAbs());
+        }
+
+        if(!bCsdStored) {
+            sumData.vecPairCsdSum[i].second += matCsd;
+        }
+
+        if(bImagSign) {
+            sumData.vecPairCsdImagSignSum[i].second += matImagSign;
+        }
+
+        if(bImagAbs) {
+            sumData.vecPairCsdImagAbsSum[i].second += matImagAbs;
+        }
+
+        if(bImagSqrd) {
+            sumData.vecPairCsdImagSqrdSum[i].second += matImagSqrd;
+        }
+
+        if(bNormalized) {
+            sumData.vecPairCsdNormalizedSum[i].second += matNormalized;
+        }
+
+        if(bStorage) {
+            if(!bCsdStored) {
+                inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
+            }
+
+            if(bImagSign) {
+                inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,matImagSign));
+            }
+
+            if(bImagAbs) {
+                inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,matImagAbs));
+            }
+
+            if(bImagSqrd) {
+                inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,matImagSqrd));
+            }
+
+            if(bNormalized) {
+                inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,matNormalized));
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+Network Connectivity::reduceSharedIntermediateData(const QString& sMethod,
+                                                   ConnectivitySettings& connectivitySettings)
+{
+    Network finalNetwork(sMethod);
+
+    finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+
+    // Pass information about the FFT length. Use iNFreqs because we only use the half spectrum
+    int iNFreqs = int(floor(connectivitySettings.getFFTSize() / 2.0)) + 1;
+    finalNetwork.setFFTSize(iNFreqs);
+    finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
+
+    //Create nodes
+    int iNRows = connectivitySettings.at(0).matData.rows();
+    RowVectorXf rowVert = RowVectorXf::Zero(3);
+
+    for(int i = 0; i < iNRows; ++i) {
+        rowVert = RowVectorXf::Zero(3);
+
+        if(connectivitySettings.getNodePositions().rows() != 0 && i < connectivitySettings.getNodePositions().rows()) {
+            rowVert(0) = connectivitySettings.getNodePositions().row(i)(0);
+            rowVert(1) = connectivitySettings.getNodePositions().row(i)(1);
+            rowVert(2) = connectivitySettings.getNodePositions().row(i)(2);
+        }
+
+        finalNetwork.append(NetworkNode::SPtr(new NetworkNode(i, rowVert)));
+    }
+
+    if(sMethod == "WPLI") {
+        WeightedPhaseLagIndex::computeWPLI(connectivitySettings,
+                                           finalNetwork);
+    } else if(sMethod == "USPLI") {
+        UnbiasedSquaredPhaseLagIndex::computeUSPLI(connectivitySettings,
+                                                   finalNetwork);
+    } else if(sMethod == "PLI") {
+        PhaseLagIndex::computePLI(connectivitySettings,
+                                  finalNetwork);
+    } else if(sMethod == "COH") {
+        Coherency::computeAbs(finalNetwork,
+                              connectivitySettings);
+    } else if(sMethod == "IMAGCOH") {
+        Coherency::computeImag(finalNetwork,
+                               connectivitySettings);
+    } else if(sMethod == "PLV") {
+        PhaseLockingValue::computePLV(connectivitySettings,
+                                      finalNetwork);
+    } else if(sMethod == "DSWPLI") {
+        DebiasedSquaredWeightedPhaseLagIndex::computeDSWPLI(connectivitySettings,
+                                                            finalNetwork);
+    }
+
+    return finalNetwork;
+}
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "connectivity_global.h"
+#include "connectivitysettings.h"
 
 
 //*************************************************************************************************************
@@ -51,6 +52,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QStringList>
+#include <QPair>
 
 
 //*************************************************************************************************************
@@ -80,7 +83,6 @@ namespace CONNECTIVITYLIB {
 // CONNECTIVITYLIB FORWARD DECLARATIONS
 //=============================================================================================================
 
-class ConnectivitySettings;
 class Network;
 
 
@@ -112,6 +114,62 @@ public:
     static QList<Network> calculate(ConnectivitySettings& connectivitySettings);
 
 protected:
+    //=========================================================================================================
+    /**
+    * The sums which are needed by the requested spectral metrics besides the CSD sum.
+    */
+    struct SpectralPlan {
+        bool bPsd;          /**< PSD sum, needed by COH and IMAGCOH. */
+        bool bImagSign;     /**< Sum of the sign of the imaginary CSD, needed by PLI and USPLI. */
+        bool bImagAbs;      /**< Sum of the absolute imaginary CSD, needed by WPLI and DSWPLI. */
+        bool bImagSqrd;     /**< Sum of the squared imaginary CSD, needed by DSWPLI. */
+        bool bNormalized;   /**< Sum of the normalized CSD, needed by PLV. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Computes the intermediate sum data of all requested spectral metrics in one pass over the trials. The
+    * tapered spectra and the CSD are computed once per trial and all sums are derived from them. The trials
+    * are streamed, only one block of CSD rows per thread is held in memory unless the storage mode is active.
+    *
+    * @param[in] connectivitySettings   The input data and parameters.
+    * @param[in] lMethods               The requested connectivity methods.
+    */
+    static void calculateSharedIntermediateData(ConnectivitySettings& connectivitySettings,
+                                                const QStringList& lMethods);
+
+    //=========================================================================================================
+    /**
+    * Computes the tapered spectra, the CSD and the sums of the plan for one trial. This function gets called
+    * in parallel.
+    *
+    * @param[in] inputData      The input data.
+    * @param[out] sumData       The partial intermediate sums of the calling task.
+    * @param[in] plan           The sums to compute.
+    * @param[in] iNRows         The number of rows.
+    * @param[in] iNFreqs        The number of frequency bins.
+    * @param[in] iNfft          The FFT length.
+    * @param[in] tapers         The taper information.
+    */
+    static void computeSharedTrial(ConnectivitySettings::IntermediateTrialData& inputData,
+                                   ConnectivitySettings::IntermediateSumData& sumData,
+                                   const SpectralPlan& plan,
+                                   int iNRows,
+                                   int iNFreqs,
+                                   int iNfft,
+                                   const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+
+    //=========================================================================================================
+    /**
+    * Reduces the intermediate sum data to the network of a spectral metric.
+    *
+    * @param[in] sMethod                The connectivity method.
+    * @param[in] connectivitySettings   The settings holding the intermediate sum data.
+    *
+    * @return The connectivity information in form of a network structure.
+    */
+    static Network reduceSharedIntermediateData(const QString& sMethod,
+                                                ConnectivitySettings& connectivitySettings);
 };
 
 
@@ -78,6 +78,30 @@ using namespace FIFFLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+template<typename T>
+void recomputeSum(QVector<QPair<int,T> >& vecPairSum,
+                  const QList<ConnectivitySettings::IntermediateTrialData>& trialData,
+                  QVector<QPair<int,T> > ConnectivitySettings::IntermediateTrialData::* pTrialMember)
+{
+    if(vecPairSum.isEmpty()) {
+        return;
+    }
+
+    for(int i = 0; i < trialData.size(); ++i) {
+        if((trialData.at(i).*pTrialMember).size() != vecPairSum.size()) {
+            return;
+        }
+    }
+
+    for(int j = 0; j < vecPairSum.size(); ++j) {
+        vecPairSum[j].second = (trialData.first().*pTrialMember).at(j).second;
+
+        for(int i = 1; i < trialData.size(); ++i) {
+            vecPairSum[j].second += (trialData.at(i).*pTrialMember).at(j).second;
+        }
+    }
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -285,6 +309,39 @@ void ConnectivitySettings::removeLast(int iAmount)
 }
 
 
+//*******************************************************************************************************
+
+void ConnectivitySettings::recomputeIntermediateSumData()
+{
+    if(m_trialData.isEmpty()) {
+        return;
+    }
+
+    recomputeSum(m_intermediateSumData.vecPairCsdSum, m_trialData, &IntermediateTrialData::vecPairCsd);
+    recomputeSum(m_intermediateSumData.vecPairCsdNormalizedSum, m_trialData, &IntermediateTrialData::vecPairCsdNormalized);
+    recomputeSum(m_intermediateSumData.vecPairCsdImagSignSum, m_trialData, &IntermediateTrialData::vecPairCsdImagSign);
+    recomputeSum(m_intermediateSumData.vecPairCsdImagAbsSum, m_trialData, &IntermediateTrialData::vecPairCsdImagAbs);
+    recomputeSum(m_intermediateSumData.vecPairCsdImagSqrdSum, m_trialData, &IntermediateTrialData::vecPairCsdImagSqrd);
+
+    if(m_intermediateSumData.matPsdSum.size() == 0) {
+        return;
+    }
+
+    for(int i = 0; i < m_trialData.size(); ++i) {
+        if(m_trialData.at(i).matPsd.rows() != m_intermediateSumData.matPsdSum.rows() ||
+           m_trialData.at(i).matPsd.cols() != m_intermediateSumData.matPsdSum.cols()) {
+            return;
+        }
+    }
+
+    m_intermediateSumData.matPsdSum = m_trialData.first().matPsd;
+
+    for(int i = 1; i < m_trialData.size(); ++i) {
+        m_intermediateSumData.matPsdSum += m_trialData.at(i).matPsd;
+    }
+}
+
+
 //*******************************************************************************************************
 
 void ConnectivitySettings::setConnectivityMethods(const QStringList& sConnectivityMethods)
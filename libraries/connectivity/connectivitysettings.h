@@ -154,6 +154,14 @@ public:
 
     void removeLast(int iAmount = 1);
 
+    //=========================================================================================================
+    /**
+    * Recomputes the intermediate sums from the intermediate data stored for each trial. Sums are only recomputed
+    * if every trial holds the corresponding data. Used to remove the rounding error which accumulates when trials
+    * are repeatedly added to and subtracted from the sums, e.g. for sliding window estimation.
+    */
+    void recomputeIntermediateSumData();
+
     void setConnectivityMethods(const QStringList& sConnectivityMethods);
 
     const QStringList& getConnectivityMethods() const;
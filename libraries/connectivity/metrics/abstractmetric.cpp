@@ -47,6 +47,8 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -60,6 +62,7 @@
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -71,6 +74,24 @@ bool AbstractMetric::m_bStorageModeIsActive = false;
 int AbstractMetric::m_iNumberBinStart = -1;
 int AbstractMetric::m_iNumberBinAmount = -1;
 
+template<typename T>
+void addPairSum(QVector<QPair<int,T> >& vecPairSum,
+                const QVector<QPair<int,T> >& vecPairPartialSum)
+{
+    if(vecPairPartialSum.isEmpty()) {
+        return;
+    }
+
+    if(vecPairSum.isEmpty()) {
+        vecPairSum = vecPairPartialSum;
+        return;
+    }
+
+    for(int i = 0; i < vecPairSum.size() && i < vecPairPartialSum.size(); ++i) {
+        vecPairSum[i].second += vecPairPartialSum.at(i).second;
+    }
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -81,3 +102,171 @@ AbstractMetric::AbstractMetric()
 {
 }
 
+
+//*************************************************************************************************************
+
+QVector<QPair<int,MatrixXcd> > AbstractMetric::computeCsd(const QVector<MatrixXcd>& vecTapSpectra,
+                                                          const VectorXd& vecTapWeights,
+                                                          int iNFreqs,
+                                                          int iNfft,
+                                                          int iRowStart,
+                                                          int iNumberRows)
+{
+    QVector<QPair<int,MatrixXcd> > vecPairCsd;
+
+    int iNRows = vecTapSpectra.size();
+
+    if(iNumberRows < 0) {
+        iNumberRows = iNRows - iRowStart;
+    }
+
+    if(iNRows == 0 || iRowStart < 0 || iNumberRows == 0 || iRowStart + iNumberRows > iNRows) {
+        return vecPairCsd;
+    }
+
+    int iNTapers = vecTapSpectra.first().rows();
+    int iBinStart = m_iNumberBinStart;
+    int iNBins = m_iNumberBinAmount;
+
+    double denomCSD = sqrt(vecTapWeights.cwiseAbs2().sum()) * sqrt(vecTapWeights.cwiseAbs2().sum()) / 2.0;
+
+    // Divide first and last element by 2 due to half spectrum
+    bool bHalveFirst = iBinStart == 0;
+    bool bHalveLast = iNfft % 2 == 0 && iBinStart + iNBins >= iNFreqs;
+
+    for(int i = iRowStart; i < iRowStart + iNumberRows; ++i) {
+        vecPairCsd.append(QPair<int,MatrixXcd>(i, MatrixXcd::Zero(iNRows, iNBins)));
+    }
+
+    QVector<int> vecBins(iNBins);
+    for(int i = 0; i < iNBins; ++i) {
+        vecBins[i] = i;
+    }
+
+    // Every bin writes to its own column of the preallocated CSD matrices
+    QPair<int,MatrixXcd>* pPairCsd = vecPairCsd.data();
+
+    std::function<void(int&)> computeLambda = [&](int& iBin) {
+        int i, j;
+        int iNRest = iNRows - iRowStart;
+
+        // Gather the spectra of this bin, only the rows from iRowStart on are needed for the rows j >= i
+        MatrixXcd matSpectra(iNRest, iNTapers);
+        for(i = 0; i < iNRest; ++i) {
+            matSpectra.row(i) = vecTapSpectra.at(iRowStart + i).col(iBinStart + iBin).transpose();
+        }
+
+        // matCsdBin(j,i) = sum over tapers of S_j * conj(S_i)
+        MatrixXcd matCsdBin;
+        if(iRowStart == 0 && iNumberRows == iNRows) {
+            matCsdBin.setZero(iNRows, iNRows);
+            matCsdBin.selfadjointView<Lower>().rankUpdate(matSpectra);
+        } else {
+            matCsdBin.noalias() = matSpectra * matSpectra.topRows(iNumberRows).adjoint();
+        }
+
+        double dScale = 1.0 / denomCSD;
+        if(bHalveFirst && iBin == 0) {
+            dScale /= 2.0;
+        }
+        if(bHalveLast && iBin == iNBins - 1) {
+            dScale /= 2.0;
+        }
+
+        for(i = 0; i < iNumberRows; ++i) {
+            j = iRowStart + i;
+            pPairCsd[i].second.col(iBin).segment(j, iNRows - j) = matCsdBin.col(i).segment(i, iNRows - j).conjugate() * dScale;
+        }
+    };
+
+    QFuture<void> result = QtConcurrent::map(vecBins,
+                                             computeLambda);
+    result.waitForFinished();
+
+    return vecPairCsd;
+}
+
+
+//*************************************************************************************************************
+
+void AbstractMetric::computeTrials(ConnectivitySettings& connectivitySettings,
+                                   const std::function<void(ConnectivitySettings::IntermediateTrialData&,
+                                                            ConnectivitySettings::IntermediateSumData&)>& computeTrial)
+{
+    // Collect the trials up front, so the list is detached once and not from within the tasks
+    QVector<ConnectivitySettings::IntermediateTrialData*> vecTrials;
+    vecTrials.reserve(connectivitySettings.size());
+
+    for(ConnectivitySettings::IntermediateTrialData& trialData : connectivitySettings.getTrialData()) {
+        vecTrials.append(&trialData);
+    }
+
+    if(vecTrials.isEmpty()) {
+        return;
+    }
+
+    int iNumberTasks = qBound(1, QThreadPool::globalInstance()->maxThreadCount(), vecTrials.size());
+
+    QVector<ConnectivitySettings::IntermediateSumData> vecPartialSums(iNumberTasks);
+    ConnectivitySettings::IntermediateSumData* pPartialSums = vecPartialSums.data();
+
+    QVector<int> vecTasks(iNumberTasks);
+    for(int i = 0; i < iNumberTasks; ++i) {
+        vecTasks[i] = i;
+    }
+
+    QAtomicInt iNextTrial(0);
+
+    std::function<void(int&)> computeLambda = [&](int& iTask) {
+        int iTrial;
+
+        while((iTrial = iNextTrial.fetchAndAddRelaxed(1)) < vecTrials.size()) {
+            computeTrial(*vecTrials.at(iTrial), pPartialSums[iTask]);
+        }
+    };
+
+    QFuture<void> result = QtConcurrent::map(vecTasks,
+                                             computeLambda);
+    result.waitForFinished();
+
+    // Tree reduction, every level adds the partial sums iStride apart in parallel
+    for(int iStride = 1; iStride < iNumberTasks; iStride *= 2) {
+        QVector<int> vecTargets;
+
+        for(int i = 0; i + iStride < iNumberTasks; i += 2 * iStride) {
+            vecTargets.append(i);
+        }
+
+        std::function<void(int&)> reduceLambda = [&](int& iTarget) {
+            addIntermediateSumData(pPartialSums[iTarget], pPartialSums[iTarget + iStride]);
+        };
+
+        result = QtConcurrent::map(vecTargets,
+                                   reduceLambda);
+        result.waitForFinished();
+    }
+
+    addIntermediateSumData(connectivitySettings.getIntermediateSumData(), vecPartialSums.first());
+}
+
+
+//*************************************************************************************************************
+
+void AbstractMetric::addIntermediateSumData(ConnectivitySettings::IntermediateSumData& sumData,
+                                            const ConnectivitySettings::IntermediateSumData& partialSumData)
+{
+    if(partialSumData.matPsdSum.size() != 0) {
+        if(sumData.matPsdSum.rows() == partialSumData.matPsdSum.rows() &&
+           sumData.matPsdSum.cols() == partialSumData.matPsdSum.cols()) {
+            sumData.matPsdSum += partialSumData.matPsdSum;
+        } else if(sumData.matPsdSum.size() == 0) {
+            sumData.matPsdSum = partialSumData.matPsdSum;
+        }
+    }
+
+    addPairSum(sumData.vecPairCsdSum, partialSumData.vecPairCsdSum);
+    addPairSum(sumData.vecPairCsdNormalizedSum, partialSumData.vecPairCsdNormalizedSum);
+    addPairSum(sumData.vecPairCsdImagSignSum, partialSumData.vecPairCsdImagSignSum);
+    addPairSum(sumData.vecPairCsdImagAbsSum, partialSumData.vecPairCsdImagAbsSum);
+    addPairSum(sumData.vecPairCsdImagSqrdSum, partialSumData.vecPairCsdImagSqrdSum);
+}
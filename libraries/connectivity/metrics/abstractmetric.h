@@ -43,6 +43,9 @@
 //=============================================================================================================
 
 #include "../connectivity_global.h"
+#include "../connectivitysettings.h"
+
+#include <functional>
 
 
 //*************************************************************************************************************
@@ -52,6 +55,7 @@
 
 #include <QSharedPointer>
 #include <QVector>
+#include <QPair>
 
 
 //*************************************************************************************************************
@@ -101,6 +105,55 @@ public:
     */
     explicit AbstractMetric();
 
+    //=========================================================================================================
+    /**
+    * Computes the cross-spectral densities of the tapered spectra for the frequency bins set by m_iNumberBinStart
+    * and m_iNumberBinAmount. For every bin the spectra of all channels are gathered into one (channels x tapers)
+    * matrix, so the CSD of all channel pairs becomes one Hermitian rank-k update instead of a loop over the
+    * pairs. The bins are computed in parallel.
+    *
+    * @param[in] vecTapSpectra      The tapered spectra (tapers x frequencies) of all channels.
+    * @param[in] vecTapWeights      The taper weights.
+    * @param[in] iNFreqs            The number of frequency bins of the half spectrum.
+    * @param[in] iNfft              The FFT length.
+    * @param[in] iRowStart          The first row i for which the CSD is computed. Default is 0.
+    * @param[in] iNumberRows        The number of rows for which the CSD is computed. Default is -1 (all rows from iRowStart on).
+    *
+    * @return The CSD per row i in form of (channels x bins) matrices. Only the rows j >= i are set.
+    */
+    static QVector<QPair<int,Eigen::MatrixXcd> > computeCsd(const QVector<Eigen::MatrixXcd>& vecTapSpectra,
+                                                            const Eigen::VectorXd& vecTapWeights,
+                                                            int iNFreqs,
+                                                            int iNfft,
+                                                            int iRowStart = 0,
+                                                            int iNumberRows = -1);
+
+    //=========================================================================================================
+    /**
+    * Computes the intermediate data of all trials in parallel. Every task accumulates the trials it processes
+    * into its own partial sums, so no lock is needed while the trials are added up. Tasks pull the next trial
+    * from a shared counter, trials whose data is stored already do not stall a task. The partial sums are
+    * combined pairwise in a parallel tree reduction and finally added to the intermediate sum data of
+    * connectivitySettings. The number of tasks follows the maximum thread count of the global thread pool.
+    *
+    * @param[in,out] connectivitySettings   The trials and the intermediate sum data.
+    * @param[in] computeTrial               Computes one trial and adds its contribution to the given partial sums.
+    */
+    static void computeTrials(ConnectivitySettings& connectivitySettings,
+                              const std::function<void(ConnectivitySettings::IntermediateTrialData&,
+                                                       ConnectivitySettings::IntermediateSumData&)>& computeTrial);
+
+    //=========================================================================================================
+    /**
+    * Adds the intermediate sums of partialSumData to sumData. Sums which are empty in sumData are set to the
+    * ones of partialSumData, sums which are empty in partialSumData are skipped.
+    *
+    * @param[in,out] sumData        The intermediate sum data to add to.
+    * @param[in] partialSumData     The intermediate sum data to be added.
+    */
+    static void addIntermediateSumData(ConnectivitySettings::IntermediateSumData& sumData,
+                                       const ConnectivitySettings::IntermediateSumData& partialSumData);
+
     static bool     m_bStorageModeIsActive;
     static int      m_iNumberBinStart;
     static int      m_iNumberBinAmount;
@@ -123,13 +123,10 @@ void Coherency::calculateAbs(Network& finalNetwork,
     int iNFreqs = int(floor(iNfft / 2.0)) + 1;
 
     // Compute PSD/CSD for each trial
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                mutex,
+                sumData.matPsdSum,
+                sumData.vecPairCsdSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
@@ -140,25 +137,16 @@ void Coherency::calculateAbs(Network& finalNetwork,
 //    qWarning() << "Preparation" << iTime;
 //    timer.restart();
 
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
 //    timer.restart();
 
     // Compute CSD/sqrt(PSD_X * PSD_Y)
-    std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
-        computePSDCSDAbs(mutex,
-                         finalNetwork,
-                         pairInput,
-                         connectivitySettings.getIntermediateSumData().matPsdSum);
-    };
-
-    QFuture<void> resultCSDPSD = QtConcurrent::map(connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                                                   computePSDCSDLambda);
-    resultCSDPSD.waitForFinished();
+    computeAbs(finalNetwork,
+               connectivitySettings);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
@@ -195,13 +183,10 @@ void Coherency::calculateImag(Network& finalNetwork,
     int iNFreqs = int(floor(iNfft / 2.0)) + 1;
 
     // Compute PSD/CSD for each trial
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                mutex,
+                sumData.matPsdSum,
+                sumData.vecPairCsdSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
@@ -212,18 +197,55 @@ void Coherency::calculateImag(Network& finalNetwork,
 //    qWarning() << "Preparation" << iTime;
 //    timer.restart();
 
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
 //    timer.restart();
 
+    // Compute CSD/sqrt(PSD_X * PSD_Y)
+    computeImag(finalNetwork,
+                connectivitySettings);
+
+//    iTime = timer.elapsed();
+//    qWarning() << "Compute" << iTime;
+//    timer.restart();
+}
+
+
+//*************************************************************************************************************
+
+void Coherency::computeAbs(Network& finalNetwork,
+                           ConnectivitySettings &connectivitySettings)
+{
+    finalNetwork.initEdgeWeights(connectivitySettings.getIntermediateSumData().matPsdSum.cols());
+
     // Compute CSD/sqrt(PSD_X * PSD_Y)
     std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
-        computePSDCSDImag(mutex,
-                          finalNetwork,
+        computePSDCSDAbs(finalNetwork,
+                         pairInput,
+                         connectivitySettings.getIntermediateSumData().matPsdSum);
+    };
+
+    QFuture<void> resultCSDPSD = QtConcurrent::map(connectivitySettings.getIntermediateSumData().vecPairCsdSum,
+                                                   computePSDCSDLambda);
+    resultCSDPSD.waitForFinished();
+
+    finalNetwork.updateEdgeWeights();
+}
+
+
+//*************************************************************************************************************
+
+void Coherency::computeImag(Network& finalNetwork,
+                            ConnectivitySettings &connectivitySettings)
+{
+    finalNetwork.initEdgeWeights(connectivitySettings.getIntermediateSumData().matPsdSum.cols());
+
+    // Compute CSD/sqrt(PSD_X * PSD_Y)
+    std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
+        computePSDCSDImag(finalNetwork,
                           pairInput,
                           connectivitySettings.getIntermediateSumData().matPsdSum);
     };
@@ -232,9 +254,7 @@ void Coherency::calculateImag(Network& finalNetwork,
                                                    computePSDCSDLambda);
     resultCSDPSD.waitForFinished();
 
-//    iTime = timer.elapsed();
-//    qWarning() << "Compute" << iTime;
-//    timer.restart();
+    finalNetwork.updateEdgeWeights();
 }
 
 
@@ -243,7 +263,6 @@ void Coherency::calculateImag(Network& finalNetwork,
 void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         MatrixXd& matPsdSum,
                         QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
-                        QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
@@ -317,16 +336,12 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
         }
     }
 
-    mutex.lock();
-
     if(matPsdSum.rows() == 0 || matPsdSum.cols() == 0) {
         matPsdSum = inputData.matPsd;
     } else {
         matPsdSum += inputData.matPsd;
     }
 
-    mutex.unlock();
-
 //    iTime = timer.elapsed();
 //    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - Tapered spectra and PSD (summing):" << iTime;
 //    timer.restart();
@@ -335,30 +350,10 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
     if(inputData.vecPairCsd.size() != iNRows) {
         inputData.vecPairCsd.clear();
 
-        //MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-        }
-
-        mutex.lock();
+        inputData.vecPairCsd = computeCsd(inputData.vecTapSpectra,
+                                          tapers.second,
+                                          iNFreqs,
+                                          iNfft);
 
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
@@ -367,8 +362,6 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                 vecPairCsdSum[j].second += inputData.vecPairCsd.at(j).second;
             }
         }
-
-        mutex.unlock();
     }
 
 //    iTime = timer.elapsed();
@@ -389,8 +382,7 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
 
 //*************************************************************************************************************
 
-void Coherency::computePSDCSDAbs(QMutex& mutex,
-                                 Network& finalNetwork,
+void Coherency::computePSDCSDAbs(Network& finalNetwork,
                                  const QPair<int,MatrixXcd>& pairInput,
                                  const MatrixXd& matPsdSum)
 {
@@ -404,28 +396,14 @@ void Coherency::computePSDCSDAbs(QMutex& mutex,
     // Average. Note that the number of trials cancel each other out.
     MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
 
-    QSharedPointer<NetworkEdge> pEdge;
-    MatrixXd matWeight;
-    int j;
-    int i = pairInput.first;
-
-    for(j = i; j < matCohy.rows(); ++j) {
-        matWeight = matCohy.row(j).cwiseAbs().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-        mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
-        mutex.unlock();
-    }
+    // The edges of different start nodes can be set in parallel
+    finalNetwork.setEdgeWeights(pairInput.first, matCohy.cwiseAbs());
 }
 
 
 //*************************************************************************************************************
 
-void Coherency::computePSDCSDImag(QMutex& mutex,
-                                  Network& finalNetwork,
+void Coherency::computePSDCSDImag(Network& finalNetwork,
                                   const QPair<int,MatrixXcd>& pairInput,
                                   const MatrixXd& matPsdSum)
 {
@@ -438,19 +416,5 @@ void Coherency::computePSDCSDImag(QMutex& mutex,
 
     MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
 
-    QSharedPointer<NetworkEdge> pEdge;
-    MatrixXd matWeight;
-    int j;
-    int i = pairInput.first;
-
-    for(j = i; j < matCohy.rows(); ++j) {
-        matWeight = matCohy.row(j).imag().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-        mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
-        mutex.unlock();
-    }
+    finalNetwork.setEdgeWeights(pairInput.first, matCohy.imag());
 }
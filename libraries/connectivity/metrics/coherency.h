@@ -58,7 +58,6 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -130,6 +129,26 @@ public:
     static void calculateImag(Network& finalNetwork,
                               ConnectivitySettings &connectivitySettings);
 
+    //=========================================================================================================
+    /**
+    * Reduces the summed PSD and CSD of the connectivity settings to the absolute value of coherency.
+    *
+    * @param[out]   finalNetwork          The resulting network.
+    * @param[in]    connectivitySettings  The settings holding the intermediate sum data.
+    */
+    static void computeAbs(Network& finalNetwork,
+                           ConnectivitySettings &connectivitySettings);
+
+    //=========================================================================================================
+    /**
+    * Reduces the summed PSD and CSD of the connectivity settings to the imaginary part of coherency.
+    *
+    * @param[out]   finalNetwork          The resulting network.
+    * @param[in]    connectivitySettings  The settings holding the intermediate sum data.
+    */
+    static void computeImag(Network& finalNetwork,
+                            ConnectivitySettings &connectivitySettings);
+
 private:
     //=========================================================================================================
     /**
@@ -138,7 +157,6 @@ private:
     * @param[in]    inputData           The input data.
     * @param[out]   matPsdSum           The sum of all PSD matrices for each trial.
     * @param[out]   vecPairCsdSum       The sum of all CSD matrices for each trial.
-    * @param[in]    mutex               The mutex used to safely access matPsdSum and vecPairCsdSum.
     * @param[in]    iNRows              The number of rows.
     * @param[in]    iNFreqs             The number of frequenciy bins.
     * @param[in]    iNfft               The FFT length.
@@ -147,7 +165,6 @@ private:
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         Eigen::MatrixXd& matPsdSum,
                         QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
-                        QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
@@ -157,12 +174,10 @@ private:
     /**
     * Computes the PSD and CSD. This function gets called in parallel.
     */
-    static void computePSDCSDAbs(QMutex& mutex,
-                                 Network& finalNetwork,
+    static void computePSDCSDAbs(Network& finalNetwork,
                                  const QPair<int,Eigen::MatrixXcd>& pairInput,
                                  const Eigen::MatrixXd& matPsdSum);
-    static void computePSDCSDImag(QMutex& mutex,
-                                  Network& finalNetwork,
+    static void computePSDCSDImag(Network& finalNetwork,
                                   const QPair<int,Eigen::MatrixXcd>& pairInput,
                                   const Eigen::MatrixXd& matPsdSum);
 };
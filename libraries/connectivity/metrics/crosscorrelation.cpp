@@ -165,22 +165,14 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     //Add edges to network
-    MatrixXd matWeight(1,1);
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
+    finalNetwork.initEdgeWeights(1);
 
     for(int i = 0; i < matDist.rows(); ++i) {
-        for(j = i; j < matDist.cols(); ++j) {
-            matWeight << matDist(i,j);
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
+        finalNetwork.setEdgeWeights(i, matDist.row(i).transpose());
     }
 
+    finalNetwork.updateEdgeWeights();
+
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
 //    timer.restart();
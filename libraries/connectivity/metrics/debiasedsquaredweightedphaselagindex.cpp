@@ -161,14 +161,11 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         return compute(inputData,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdImagAbsSum,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdImagSqrdSum,
-                       mutex,
+                       sumData.vecPairCsdSum,
+                       sumData.vecPairCsdImagAbsSum,
+                       sumData.vecPairCsdImagSqrdSum,
                        iNRows,
                        iNFreqs,
                        iNfft,
@@ -180,9 +177,8 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
 //    timer.restart();
 
     // Compute DSWPLI in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -206,7 +202,6 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                                                    QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
                                                    QVector<QPair<int,MatrixXd> >& vecPairCsdImagAbsSum,
                                                    QVector<QPair<int,MatrixXd> >& vecPairCsdImagSqrdSum,
-                                                   QMutex& mutex,
                                                    int iNRows,
                                                    int iNFreqs,
                                                    int iNfft,
@@ -257,37 +252,16 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd(iNRows, m_iNumberBinAmount);
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,matCsd.imag().array().square()));
-            inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseAbs()));
+        inputData.vecPairCsd = computeCsd(inputData.vecTapSpectra,
+                                          tapers.second,
+                                          iNFreqs,
+                                          iNfft);
+
+        for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
+            inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().array().square()));
+            inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseAbs()));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdImagSqrdSum = inputData.vecPairCsdImagSqrd;
@@ -299,25 +273,19 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                 vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdImagSqrd.isEmpty()) {
             for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
                 inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().array().square()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagSqrdSum.isEmpty()) {
                 vecPairCsdImagSqrdSum = inputData.vecPairCsdImagSqrd;
             } else {
-                for (int j = 0; j < vecPairCsdSum.size(); ++j) {
+                for (int j = 0; j < vecPairCsdImagSqrdSum.size(); ++j) {
                     vecPairCsdImagSqrdSum[j].second += inputData.vecPairCsdImagSqrd.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
 
         if(inputData.vecPairCsdImagAbs.isEmpty()) {
@@ -325,17 +293,13 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                 inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseAbs()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagAbsSum.isEmpty()) {
                 vecPairCsdImagAbsSum = inputData.vecPairCsdImagAbs;
             } else {
-                for (int j = 0; j < vecPairCsdSum.size(); ++j) {
+                for (int j = 0; j < vecPairCsdImagAbsSum.size(); ++j) {
                     vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
@@ -355,9 +319,8 @@ void DebiasedSquaredWeightedPhaseLagIndex::computeDSWPLI(ConnectivitySettings &c
 {
     // Compute final DSWPLI and create Network
     MatrixXd matNom, matDenom;
-    MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
+
+    finalNetwork.initEdgeWeights(m_iNumberBinAmount);
 
     for (int i = 0; i < connectivitySettings.at(0).matData.rows(); ++i) {
 
@@ -370,17 +333,10 @@ void DebiasedSquaredWeightedPhaseLagIndex::computeDSWPLI(ConnectivitySettings &c
         matDenom = (matDenom.array() == 0.).select(INFINITY, matDenom);
         matDenom = matNom.cwiseQuotient(matDenom);
 
-        for(j = i; j < connectivitySettings.at(0).matData.rows(); ++j) {
-            matWeight = matDenom.row(j).transpose();
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
-
+        finalNetwork.setEdgeWeights(i, matDenom);
     }
+
+    finalNetwork.updateEdgeWeights();
 }
 
 
@@ -58,7 +58,6 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -129,7 +128,6 @@ protected:
     * @param[out]vecPairCsdSum          The sum of all CSD matrices for each trial.
     * @param[out]vecPairCsdImagAbsSum   The sum of all imag abs CSD matrices for each trial.
     * @param[out]vecPairCsdImagSqrdSum  The sum of all imag aqrd CSD matrices for each trial.
-    * @param[in] mutex                  The mutex used to safely access vecPairCsdSum.
     * @param[in] iNRows                 The number of rows.
     * @param[in] iNFreqs                The number of frequenciy bins.
     * @param[in] iNfft                  The FFT length.
@@ -139,12 +137,12 @@ protected:
                         QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
                         QVector<QPair<int,Eigen::MatrixXd> >& vecPairCsdImagAbsSum,
                         QVector<QPair<int,Eigen::MatrixXd> >& vecPairCsdImagSqrdSum,
-                        QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
                         const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
 
+public:
     //=========================================================================================================
     /**
     * Reduces the DSWPLI computation to a final result.
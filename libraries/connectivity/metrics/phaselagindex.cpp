@@ -159,13 +159,10 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum,
-                mutex,
+                sumData.vecPairCsdSum,
+                sumData.vecPairCsdImagSignSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
@@ -177,9 +174,8 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     // Compute DSWPLV in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -202,7 +198,6 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
 void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                             QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
                             QVector<QPair<int,MatrixXd> >& vecPairCsdImagSignSum,
-                            QMutex& mutex,
                             int iNRows,
                             int iNFreqs,
                             int iNfft,
@@ -251,36 +246,15 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
+        inputData.vecPairCsd = computeCsd(inputData.vecTapSpectra,
+                                          tapers.second,
+                                          iNFreqs,
+                                          iNfft);
 
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseSign()));
+        for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
+            inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseSign()));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdImagSignSum = inputData.vecPairCsdImagSign;
@@ -290,16 +264,12 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
                 vecPairCsdImagSignSum[j].second += inputData.vecPairCsdImagSign.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdImagSign.isEmpty()) {
             for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
                 inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseSign()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagSignSum.isEmpty()) {
                 vecPairCsdImagSignSum = inputData.vecPairCsdImagSign;
             } else {
@@ -307,8 +277,6 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
                     vecPairCsdImagSignSum[j].second += inputData.vecPairCsdImagSign.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
@@ -327,22 +295,15 @@ void PhaseLagIndex::computePLI(ConnectivitySettings &connectivitySettings,
 {
     // Compute final PLI and create Network
     MatrixXd matNom;
-    MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
+
+    finalNetwork.initEdgeWeights(m_iNumberBinAmount);
 
     for (int i = 0; i < connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum.size(); ++i) {
         matNom = connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum.at(i).second.cwiseAbs() / connectivitySettings.size();
 
-        for(j = i; j < matNom.rows(); ++j) {
-            matWeight = matNom.row(j).transpose();
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
+        finalNetwork.setEdgeWeights(i, matNom);
     }
+
+    finalNetwork.updateEdgeWeights();
 }
 
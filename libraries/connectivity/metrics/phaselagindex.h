@@ -58,7 +58,6 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -128,7 +127,6 @@ protected:
     * @param[in] inputData              The input data.
     * @param[out]vecPairCsdSum          The sum of all CSD matrices for each trial.
     * @param[out]vecPairCsdImagSignSum  The sum of all imag sign CSD matrices for each trial.
-    * @param[in] mutex                  The mutex used to safely access vecPairCsdSum.
     * @param[in] iNRows                 The number of rows.
     * @param[in] iNFreqs                The number of frequenciy bins.
     * @param[in] iNfft                  The FFT length.
@@ -137,12 +135,12 @@ protected:
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
                         QVector<QPair<int,Eigen::MatrixXd> >& vecPairCsdImagSignSum,
-                        QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
                         const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
 
+public:
     //=========================================================================================================
     /**
     * Reduces the PLI computation to a final result.
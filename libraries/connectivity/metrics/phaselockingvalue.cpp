@@ -160,13 +160,10 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdNormalizedSum,
-                mutex,
+                sumData.vecPairCsdSum,
+                sumData.vecPairCsdNormalizedSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
@@ -178,9 +175,8 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     // Compute PLV in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -203,7 +199,6 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
 void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                                 QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
                                 QVector<QPair<int,MatrixXcd> >& vecPairCsdNormalizedSum,
-                                QMutex& mutex,
                                 int iNRows,
                                 int iNFreqs,
                                 int iNfft,
@@ -252,36 +247,15 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
+        inputData.vecPairCsd = computeCsd(inputData.vecTapSpectra,
+                                          tapers.second,
+                                          iNFreqs,
+                                          iNfft);
 
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,matCsd.cwiseQuotient(matCsd.cwiseAbs())));
+        for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
+            inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,inputData.vecPairCsd.at(i).second.cwiseQuotient(inputData.vecPairCsd.at(i).second.cwiseAbs())));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdNormalizedSum = inputData.vecPairCsdNormalized;
@@ -291,16 +265,12 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
                 vecPairCsdNormalizedSum[j].second += inputData.vecPairCsdNormalized.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdNormalized.isEmpty()) {
             for (i = 0; i < iNRows; ++i) {
                 inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,inputData.vecPairCsd.at(i).second.cwiseQuotient(inputData.vecPairCsd.at(i).second.cwiseAbs())));
             }
 
-            mutex.lock();
-
             if(vecPairCsdNormalizedSum.isEmpty()) {
                 vecPairCsdNormalizedSum = inputData.vecPairCsdNormalized;
             } else {
@@ -308,8 +278,6 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
                     vecPairCsdNormalizedSum[j].second += inputData.vecPairCsdNormalized.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
@@ -328,21 +296,14 @@ void PhaseLockingValue::computePLV(ConnectivitySettings &connectivitySettings,
 {
     // Compute final PLV and create Network
     MatrixXd matNom;
-    MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
+
+    finalNetwork.initEdgeWeights(m_iNumberBinAmount);
 
     for (int i = 0; i < connectivitySettings.at(0).matData.rows(); ++i) {
         matNom = connectivitySettings.getIntermediateSumData().vecPairCsdNormalizedSum.at(i).second.cwiseAbs() / connectivitySettings.size();
 
-        for(j = i; j < connectivitySettings.at(0).matData.rows(); ++j) {
-            matWeight = matNom.row(j).transpose();
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
+        finalNetwork.setEdgeWeights(i, matNom);
     }
+
+    finalNetwork.updateEdgeWeights();
 }
@@ -161,13 +161,10 @@ Network UnbiasedSquaredPhaseLagIndex::calculate(ConnectivitySettings& connectivi
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum,
-                mutex,
+                sumData.vecPairCsdSum,
+                sumData.vecPairCsdImagSignSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
@@ -179,9 +176,8 @@ Network UnbiasedSquaredPhaseLagIndex::calculate(ConnectivitySettings& connectivi
 //    timer.restart();
 
     // Compute DSWPLV in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -204,7 +200,6 @@ Network UnbiasedSquaredPhaseLagIndex::calculate(ConnectivitySettings& connectivi
 void UnbiasedSquaredPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                                            QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
                                            QVector<QPair<int,MatrixXd> >& vecPairCsdImagSignSum,
-                                           QMutex& mutex,
                                            int iNRows,
                                            int iNFreqs,
                                            int iNfft,
@@ -255,36 +250,15 @@ void UnbiasedSquaredPhaseLagIndex::compute(ConnectivitySettings::IntermediateTri
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
+        inputData.vecPairCsd = computeCsd(inputData.vecTapSpectra,
+                                          tapers.second,
+                                          iNFreqs,
+                                          iNfft);
 
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseSign()));
+        for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
+            inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseSign()));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdImagSignSum = inputData.vecPairCsdImagSign;
@@ -294,16 +268,12 @@ void UnbiasedSquaredPhaseLagIndex::compute(ConnectivitySettings::IntermediateTri
                 vecPairCsdImagSignSum[j].second += inputData.vecPairCsdImagSign.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdImagSign.isEmpty()) {
             for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
                 inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseSign()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagSignSum.isEmpty()) {
                 vecPairCsdImagSignSum = inputData.vecPairCsdImagSign;
             } else {
@@ -311,8 +281,6 @@ void UnbiasedSquaredPhaseLagIndex::compute(ConnectivitySettings::IntermediateTri
                     vecPairCsdImagSignSum[j].second += inputData.vecPairCsdImagSign.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
@@ -331,24 +299,17 @@ void UnbiasedSquaredPhaseLagIndex::computeUSPLI(ConnectivitySettings &connectivi
 {
     // Compute final DSWPLV and create Network
     MatrixXd matNom;
-    MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
     double dNTrials = double(connectivitySettings.size() - 1.0);
 
+    finalNetwork.initEdgeWeights(m_iNumberBinAmount);
+
     for (int i = 0; i < connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum.size(); ++i) {
         matNom = connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum.at(i).second.cwiseAbs() / connectivitySettings.size();
         matNom = (connectivitySettings.size() * matNom.array().square() - 1.0) / dNTrials;
 
-        for(j = i; j < matNom.rows(); ++j) {
-            matWeight = matNom.row(j).transpose();
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
+        finalNetwork.setEdgeWeights(i, matNom);
     }
+
+    finalNetwork.updateEdgeWeights();
 }
 
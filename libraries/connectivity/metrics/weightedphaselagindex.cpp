@@ -162,13 +162,10 @@ Network WeightedPhaseLagIndex::calculate(ConnectivitySettings& connectivitySetti
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData, ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdImagAbsSum,
-                mutex,
+                sumData.vecPairCsdSum,
+                sumData.vecPairCsdImagAbsSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
@@ -180,9 +177,8 @@ Network WeightedPhaseLagIndex::calculate(ConnectivitySettings& connectivitySetti
 //    timer.restart();
 
     // Compute WPLI in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    computeTrials(connectivitySettings,
+                  computeLambda);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -205,7 +201,6 @@ Network WeightedPhaseLagIndex::calculate(ConnectivitySettings& connectivitySetti
 void WeightedPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                                     QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
                                     QVector<QPair<int,MatrixXd> >& vecPairCsdImagAbsSum,
-                                    QMutex& mutex,
                                     int iNRows,
                                     int iNFreqs,
                                     int iNfft,
@@ -265,39 +260,19 @@ void WeightedPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData&
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
+        inputData.vecPairCsd = computeCsd(inputData.vecTapSpectra,
+                                          tapers.second,
+                                          iNFreqs,
+                                          iNfft);
 
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseAbs()));
+        for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
+            inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseAbs()));
         }
 
 //        iTime = timer.elapsed();
 //        qWarning() << "WeightedPhaseLagIndex::compute timer - Compute CSD and Imag CSD:" << iTime;
 //        timer.restart();
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdImagAbsSum = inputData.vecPairCsdImagAbs;
@@ -308,8 +283,6 @@ void WeightedPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData&
             }
         }
 
-        mutex.unlock();
-
 //        iTime = timer.elapsed();
 //        qWarning() << "WeightedPhaseLagIndex::compute timer - Add CSD to sum:" << iTime;
 //        timer.restart();
@@ -320,8 +293,6 @@ void WeightedPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData&
                 inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseAbs()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagAbsSum.isEmpty()) {
                 vecPairCsdImagAbsSum = inputData.vecPairCsdImagAbs;
             } else {
@@ -329,8 +300,6 @@ void WeightedPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData&
                     vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
@@ -350,9 +319,8 @@ void WeightedPhaseLagIndex::computeWPLI(ConnectivitySettings &connectivitySettin
 {
     // Compute final WPLI and create Network
     MatrixXd matDenom, matNom;
-    MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
+
+    finalNetwork.initEdgeWeights(m_iNumberBinAmount);
 
     for (int i = 0; i < connectivitySettings.getIntermediateSumData().vecPairCsdSum.size(); ++i) {
         matDenom = connectivitySettings.getIntermediateSumData().vecPairCsdImagAbsSum.at(i).second;
@@ -360,15 +328,9 @@ void WeightedPhaseLagIndex::computeWPLI(ConnectivitySettings &connectivitySettin
 
         matNom = connectivitySettings.getIntermediateSumData().vecPairCsdSum.at(i).second.imag().cwiseAbs().cwiseQuotient(matDenom);
 
-        for(j = i; j < matNom.rows(); ++j) {
-            matWeight = matNom.row(j).transpose();
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
+        finalNetwork.setEdgeWeights(i, matNom);
     }
+
+    finalNetwork.updateEdgeWeights();
 }
 
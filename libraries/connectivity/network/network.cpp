@@ -55,6 +55,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QMutexLocker>
 
 
 //*************************************************************************************************************
@@ -86,7 +87,11 @@ using namespace UTILSLIB;
 
 Network::Network(const QString& sConnectivityMethod,
                  double dThreshold)
-: m_sConnectivityMethod(sConnectivityMethod)
+: m_bEdgesOutdated(false)
+, m_pEdgesMutex(new QMutex)
+, m_iNumberEdgeNodes(0)
+, m_minMaxFreqBins(QPair<int,int>(-1,-1))
+, m_sConnectivityMethod(sConnectivityMethod)
 , m_minMaxFullWeights(QPair<double,double>(std::numeric_limits<double>::max(),0.0))
 , m_minMaxThresholdedWeights(QPair<double,double>(std::numeric_limits<double>::max(),0.0))
 , m_dThreshold(dThreshold)
@@ -105,20 +110,21 @@ Network::Network(const QString& sConnectivityMethod,
 
 MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
 {
-    MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
-    matDist.setZero();
+    MatrixXd matDist = MatrixXd::Zero(m_lNodes.size(), m_lNodes.size());
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        int row = m_lFullEdges.at(i)->getStartNodeID();
-        int col = m_lFullEdges.at(i)->getEndNodeID();
+    int iNumberNodes = std::min(m_iNumberEdgeNodes, int(m_lNodes.size()));
+    int iNumberEdges;
 
-        if(row < matDist.rows() && col < matDist.cols()) {
-            matDist(row,col) = m_lFullEdges.at(i)->getWeight();
+    for(int i = 0; i < iNumberNodes - 1; ++i) {
+        iNumberEdges = m_iNumberEdgeNodes - i - 1;
+        matDist.row(i).segment(i + 1, iNumberNodes - i - 1) = m_vecEdgeExists.segment(getEdgeIndex(i, i + 1), iNumberEdges)
+                                                              .select(m_vecAveragedWeights.segment(getEdgeIndex(i, i + 1), iNumberEdges), 0.0)
+                                                              .head(iNumberNodes - i - 1).transpose();
+    }
 
-            if(bGetMirroredVersion) {
-                matDist(col,row) = m_lFullEdges.at(i)->getWeight();
-            }
-        }
+    if(bGetMirroredVersion) {
+        MatrixXd matUpper = matDist.transpose();
+        matDist.triangularView<StrictlyLower>() = matUpper;
     }
 
     //IOUtils::write_eigen_matrix(matDist,"eigen.txt");
@@ -130,20 +136,21 @@ MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
 
 MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) const
 {
-    MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
-    matDist.setZero();
+    MatrixXd matDist = MatrixXd::Zero(m_lNodes.size(), m_lNodes.size());
 
-    for(int i = 0; i < m_lThresholdedEdges.size(); ++i) {
-        int row = m_lThresholdedEdges.at(i)->getStartNodeID();
-        int col = m_lThresholdedEdges.at(i)->getEndNodeID();
+    int iNumberNodes = std::min(m_iNumberEdgeNodes, int(m_lNodes.size()));
+    int iNumberEdges;
 
-        if(row < matDist.rows() && col < matDist.cols()) {
-            matDist(row,col) = m_lThresholdedEdges.at(i)->getWeight();
+    for(int i = 0; i < iNumberNodes - 1; ++i) {
+        iNumberEdges = m_iNumberEdgeNodes - i - 1;
+        matDist.row(i).segment(i + 1, iNumberNodes - i - 1) = m_vecEdgeActive.segment(getEdgeIndex(i, i + 1), iNumberEdges)
+                                                              .select(m_vecAveragedWeights.segment(getEdgeIndex(i, i + 1), iNumberEdges), 0.0)
+                                                              .head(iNumberNodes - i - 1).transpose();
+    }
 
-            if(bGetMirroredVersion) {
-                matDist(col,row) = m_lThresholdedEdges.at(i)->getWeight();
-            }
-        }
+    if(bGetMirroredVersion) {
+        MatrixXd matUpper = matDist.transpose();
+        matDist.triangularView<StrictlyLower>() = matUpper;
     }
 
     //IOUtils::write_eigen_matrix(matDist,"eigen.txt");
@@ -154,6 +161,8 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
 
 const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 {
+    createEdges();
+
     return m_lFullEdges;
 }
 
@@ -162,6 +171,8 @@ const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 
 const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 {
+    createEdges();
+
     return m_lThresholdedEdges;
 }
 
@@ -170,7 +181,9 @@ const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 
 const QList<NetworkNode::SPtr>& Network::getNodes() const
 {
-    return m_lNodes;
+    createEdges();
+
+    return m_lEdgeNodes;
 }
 
 
@@ -178,35 +191,126 @@ const QList<NetworkNode::SPtr>& Network::getNodes() const
 
 NetworkNode::SPtr Network::getNodeAt(int i)
 {
-    return m_lNodes.at(i);
+    createEdges();
+
+    return m_lEdgeNodes.at(i);
 }
 
 
 //*************************************************************************************************************
 
-qint16 Network::getFullDistribution() const
+void Network::initEdgeWeights(int iNumberBins)
 {
-    qint16 distribution = 0;
+    m_iNumberEdgeNodes = m_lNodes.size();
+    int iNumberPairs = m_iNumberEdgeNodes * (m_iNumberEdgeNodes - 1) / 2;
 
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        distribution += m_lNodes.at(i)->getFullDegree();
+    m_matEdgeWeights = MatrixXf::Zero(iNumberPairs, std::max(iNumberBins, 1));
+    m_vecAveragedWeights = VectorXd::Zero(iNumberPairs);
+    m_vecEdgeExists = Array<bool,Dynamic,1>::Constant(iNumberPairs, false);
+    m_vecEdgeActive = Array<bool,Dynamic,1>::Constant(iNumberPairs, false);
+
+    m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
+    m_bEdgesOutdated = true;
+}
+
+
+//*************************************************************************************************************
+
+void Network::setEdgeWeights(int iStartNodeID,
+                             const MatrixXd& matWeights)
+{
+    int iNumberEdges = std::min(int(matWeights.rows()), m_iNumberEdgeNodes) - iStartNodeID - 1;
+
+    if(iStartNodeID < 0 || iNumberEdges <= 0) {
+        return;
     }
 
-    return distribution;
+    int iNumberBins = std::min(matWeights.cols(), m_matEdgeWeights.cols());
+    int iEdge = getEdgeIndex(iStartNodeID, iStartNodeID + 1);
+
+    // The edges of one start node are stored contiguously
+    m_matEdgeWeights.block(iEdge, 0, iNumberEdges, iNumberBins) = matWeights.block(iStartNodeID + 1, 0, iNumberEdges, iNumberBins).cast<float>();
+    m_vecEdgeExists.segment(iEdge, iNumberEdges).setConstant(true);
+
+    // Average in double precision from the input weights
+    int iStartBin = m_minMaxFreqBins.first;
+    int iEndBin = m_minMaxFreqBins.second;
+
+    if(iStartBin == -1 && iEndBin == -1) {
+        m_vecAveragedWeights.segment(iEdge, iNumberEdges) = matWeights.block(iStartNodeID + 1, 0, iNumberEdges, iNumberBins).rowwise().mean();
+    } else if(iStartBin >= 0 && iEndBin >= iStartBin && iStartBin < iNumberBins) {
+        iEndBin = std::min(iEndBin, iNumberBins - 1);
+        m_vecAveragedWeights.segment(iEdge, iNumberEdges) = matWeights.block(iStartNodeID + 1, iStartBin, iNumberEdges, iEndBin - iStartBin + 1).rowwise().mean();
+    }
 }
 
 
 //*************************************************************************************************************
 
-qint16 Network::getThresholdedDistribution() const
+void Network::updateEdgeWeights()
 {
-    qint16 distribution = 0;
+    m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
 
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        distribution += m_lNodes.at(i)->getThresholdedDegree();
+    if(m_vecEdgeExists.any()) {
+        m_minMaxFullWeights.first = m_vecEdgeExists.select(m_vecAveragedWeights.array(), std::numeric_limits<double>::max()).minCoeff();
+        m_minMaxFullWeights.second = std::max(0.0, m_vecEdgeExists.select(m_vecAveragedWeights.array(), 0.0).maxCoeff());
+    }
+
+    m_vecEdgeActive = m_vecEdgeExists && (m_vecAveragedWeights.array().abs() >= m_dThreshold);
+    m_bEdgesOutdated = true;
+}
+
+
+//*************************************************************************************************************
+
+double Network::getEdgeWeight(int iStartNodeID,
+                              int iEndNodeID) const
+{
+    int iEdge = getEdgeIndex(iStartNodeID, iEndNodeID);
+
+    if(iEdge < 0 || !m_vecEdgeExists(iEdge)) {
+        return 0.0;
     }
 
-    return distribution;
+    return m_vecAveragedWeights(iEdge);
+}
+
+
+//*************************************************************************************************************
+
+VectorXi Network::getFullDegrees() const
+{
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeExists, vecIndegrees, vecOutdegrees);
+
+    return vecIndegrees + vecOutdegrees;
+}
+
+
+//*************************************************************************************************************
+
+VectorXi Network::getThresholdedDegrees() const
+{
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeActive, vecIndegrees, vecOutdegrees);
+
+    return vecIndegrees + vecOutdegrees;
+}
+
+
+//*************************************************************************************************************
+
+qint16 Network::getFullDistribution() const
+{
+    return 2 * m_vecEdgeExists.count();
+}
+
+
+//*************************************************************************************************************
+
+qint16 Network::getThresholdedDistribution() const
+{
+    return 2 * m_vecEdgeActive.count();
 }
 
 
@@ -246,18 +350,16 @@ QPair<double, double> Network::getMinMaxThresholdedWeights() const
 
 QPair<int,int> Network::getMinMaxFullDegrees() const
 {
-    int maxDegree = 0;
-    int minDegree = 1000000;
-
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        if(m_lNodes.at(i)->getFullDegree() > maxDegree){
-            maxDegree = m_lNodes.at(i)->getFullDegree();
-        } else if (m_lNodes.at(i)->getFullDegree() < minDegree){
-            minDegree = m_lNodes.at(i)->getFullDegree();
-        }
+    if(m_lNodes.isEmpty()) {
+        return QPair<int,int>(1000000,0);
     }
 
-    return QPair<int,int>(minDegree,maxDegree);
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeExists, vecIndegrees, vecOutdegrees);
+
+    VectorXi vecDegrees = vecIndegrees + vecOutdegrees;
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
 }
 
 
@@ -265,18 +367,16 @@ QPair<int,int> Network::getMinMaxFullDegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 {
-    int maxDegree = 0;
-    int minDegree = 1000000;
-
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        if(m_lNodes.at(i)->getThresholdedDegree() > maxDegree){
-            maxDegree = m_lNodes.at(i)->getThresholdedDegree();
-        } else if (m_lNodes.at(i)->getThresholdedDegree() < minDegree){
-            minDegree = m_lNodes.at(i)->getThresholdedDegree();
-        }
+    if(m_lNodes.isEmpty()) {
+        return QPair<int,int>(1000000,0);
     }
 
-    return QPair<int,int>(minDegree,maxDegree);
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeActive, vecIndegrees, vecOutdegrees);
+
+    VectorXi vecDegrees = vecIndegrees + vecOutdegrees;
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
 }
 
 
@@ -284,18 +384,16 @@ QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 
 QPair<int,int> Network::getMinMaxFullIndegrees() const
 {
-    int maxDegree = 0;
-    int minDegree = 1000000;
-
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        if(m_lNodes.at(i)->getFullIndegree() > maxDegree){
-            maxDegree = m_lNodes.at(i)->getFullIndegree();
-        } else if (m_lNodes.at(i)->getFullIndegree() < minDegree){
-            minDegree = m_lNodes.at(i)->getFullIndegree();
-        }
+    if(m_lNodes.isEmpty()) {
+        return QPair<int,int>(1000000,0);
     }
 
-    return QPair<int,int>(minDegree,maxDegree);
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeExists, vecIndegrees, vecOutdegrees);
+
+    VectorXi vecDegrees = vecIndegrees;
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
 }
 
 
@@ -303,18 +401,16 @@ QPair<int,int> Network::getMinMaxFullIndegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 {
-    int maxDegree = 0;
-    int minDegree = 1000000;
-
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        if(m_lNodes.at(i)->getThresholdedIndegree() > maxDegree){
-            maxDegree = m_lNodes.at(i)->getThresholdedIndegree();
-        } else if (m_lNodes.at(i)->getThresholdedIndegree() < minDegree){
-            minDegree = m_lNodes.at(i)->getThresholdedIndegree();
-        }
+    if(m_lNodes.isEmpty()) {
+        return QPair<int,int>(1000000,0);
     }
 
-    return QPair<int,int>(minDegree,maxDegree);
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeActive, vecIndegrees, vecOutdegrees);
+
+    VectorXi vecDegrees = vecIndegrees;
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
 }
 
 
@@ -322,18 +418,16 @@ QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 
 QPair<int,int> Network::getMinMaxFullOutdegrees() const
 {
-    int maxDegree = 0;
-    int minDegree = 1000000;
-
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        if(m_lNodes.at(i)->getFullOutdegree() > maxDegree){
-            maxDegree = m_lNodes.at(i)->getFullOutdegree();
-        } else if (m_lNodes.at(i)->getFullOutdegree() < minDegree){
-            minDegree = m_lNodes.at(i)->getFullOutdegree();
-        }
+    if(m_lNodes.isEmpty()) {
+        return QPair<int,int>(1000000,0);
     }
 
-    return QPair<int,int>(minDegree,maxDegree);
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeExists, vecIndegrees, vecOutdegrees);
+
+    VectorXi vecDegrees = vecOutdegrees;
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
 }
 
 
@@ -341,18 +435,16 @@ QPair<int,int> Network::getMinMaxFullOutdegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 {
-    int maxDegree = 0;
-    int minDegree = 1000000;
-
-    for(int i = 0; i < m_lNodes.size(); ++i) {
-        if(m_lNodes.at(i)->getThresholdedOutdegree() > maxDegree){
-            maxDegree = m_lNodes.at(i)->getThresholdedOutdegree();
-        } else if (m_lNodes.at(i)->getThresholdedOutdegree() < minDegree){
-            minDegree = m_lNodes.at(i)->getThresholdedOutdegree();
-        }
+    if(m_lNodes.isEmpty()) {
+        return QPair<int,int>(1000000,0);
     }
 
-    return QPair<int,int>(minDegree,maxDegree);
+    VectorXi vecIndegrees, vecOutdegrees;
+    calculateDegrees(m_vecEdgeActive, vecIndegrees, vecOutdegrees);
+
+    VectorXi vecDegrees = vecOutdegrees;
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
 }
 
 
@@ -361,16 +453,9 @@ QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 void Network::setThreshold(double dThreshold)
 {
     m_dThreshold = dThreshold;
-    m_lThresholdedEdges.clear();
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
-            m_lFullEdges.at(i)->setActive(true);
-            m_lThresholdedEdges.append(m_lFullEdges.at(i));
-        } else {
-            m_lFullEdges.at(i)->setActive(false);
-        }
-    }
+    m_vecEdgeActive = m_vecEdgeExists && (m_vecAveragedWeights.array().abs() >= m_dThreshold);
+    m_bEdgesOutdated = true;
 
     m_minMaxThresholdedWeights.first = m_dThreshold;
     m_minMaxThresholdedWeights.second = m_minMaxFullWeights.second;
@@ -417,18 +502,19 @@ void Network::setFrequencyRange(float fLowerFreq, float fUpperFreq)
     int iLowerBin = fLowerFreq * dScaleFactor;
     int iUpperBin = fUpperFreq * dScaleFactor;
 
+    m_minMaxFreqBins = QPair<int,int>(iLowerBin,iUpperBin);
+
+    calculateAveragedWeights();
+
     // Update the min max values
     m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        m_lFullEdges.at(i)->setFrequencyBins(QPair<int,int>(iLowerBin,iUpperBin));
-
-        if(fabs(m_lFullEdges.at(i)->getWeight()) < m_minMaxFullWeights.first) {
-            m_minMaxFullWeights.first = fabs(m_lFullEdges.at(i)->getWeight());
-        } else if(fabs(m_lFullEdges.at(i)->getWeight()) > m_minMaxFullWeights.second) {
-            m_minMaxFullWeights.second = fabs(m_lFullEdges.at(i)->getWeight());
-        }
+    if(m_vecEdgeExists.any()) {
+        m_minMaxFullWeights.first = m_vecEdgeExists.select(m_vecAveragedWeights.array().abs(), std::numeric_limits<double>::max()).minCoeff();
+        m_minMaxFullWeights.second = m_vecEdgeExists.select(m_vecAveragedWeights.array().abs(), 0.0).maxCoeff();
     }
+
+    m_bEdgesOutdated = true;
 }
 
 
@@ -444,7 +530,25 @@ const QPair<float,float>& Network::getFrequencyRange() const
 
 void Network::append(NetworkEdge::SPtr newEdge)
 {
-    if(newEdge->getEndNodeID() != newEdge->getStartNodeID()) {
+    int iStartNodeID = newEdge->getStartNodeID();
+    int iEndNodeID = newEdge->getEndNodeID();
+
+    if(iEndNodeID != iStartNodeID) {
+        MatrixXd matWeight = newEdge->getMatrixWeight();
+
+        if(std::max(iStartNodeID, iEndNodeID) >= m_iNumberEdgeNodes || matWeight.rows() > m_matEdgeWeights.cols()) {
+            resizeEdgeWeights(std::max(std::max(iStartNodeID, iEndNodeID) + 1, int(m_lNodes.size())),
+                              std::max(int(matWeight.rows()), int(m_matEdgeWeights.cols())));
+        }
+
+        int iEdge = getEdgeIndex(iStartNodeID, iEndNodeID);
+
+        if(iEdge < 0) {
+            return;
+        }
+
+        m_matEdgeWeights.row(iEdge).head(matWeight.rows()) = matWeight.col(0).transpose().cast<float>();
+
         double dEdgeWeight = newEdge->getWeight();
         if(dEdgeWeight < m_minMaxFullWeights.first) {
             m_minMaxFullWeights.first = dEdgeWeight;
@@ -452,11 +556,10 @@ void Network::append(NetworkEdge::SPtr newEdge)
             m_minMaxFullWeights.second = dEdgeWeight;
         }
 
-        m_lFullEdges << newEdge;
-
-        if(fabs(newEdge->getWeight()) >= m_dThreshold) {
-            m_lThresholdedEdges << newEdge;
-        }
+        m_vecAveragedWeights(iEdge) = dEdgeWeight;
+        m_vecEdgeExists(iEdge) = true;
+        m_vecEdgeActive(iEdge) = fabs(dEdgeWeight) >= m_dThreshold;
+        m_bEdgesOutdated = true;
     }
 }
 
@@ -466,6 +569,7 @@ void Network::append(NetworkEdge::SPtr newEdge)
 void Network::append(NetworkNode::SPtr newNode)
 {
     m_lNodes << newNode;
+    m_bEdgesOutdated = true;
 }
 
 
@@ -473,7 +577,7 @@ void Network::append(NetworkNode::SPtr newNode)
 
 bool Network::isEmpty() const
 {
-    if(m_lFullEdges.isEmpty() || m_lNodes.isEmpty()) {
+    if(!m_vecEdgeExists.any() || m_lNodes.isEmpty()) {
         return true;
     }
 
@@ -491,9 +595,8 @@ void Network::normalize()
         return;
     }
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        m_lFullEdges.at(i)->setWeight(m_lFullEdges.at(i)->getWeight()/m_minMaxFullWeights.second);
-    }
+    m_vecAveragedWeights /= m_minMaxFullWeights.second;
+    m_bEdgesOutdated = true;
 
     m_minMaxFullWeights.first = m_minMaxFullWeights.first/m_minMaxFullWeights.second;
     m_minMaxFullWeights.second = 1.0;
@@ -566,3 +669,138 @@ int Network::getFFTSize()
     return m_iFFTSize;
 }
 
+
+//*************************************************************************************************************
+
+void Network::resizeEdgeWeights(int iNumberNodes,
+                                int iNumberBins)
+{
+    MatrixXf matEdgeWeights = m_matEdgeWeights;
+    VectorXd vecAveragedWeights = m_vecAveragedWeights;
+    Array<bool,Dynamic,1> vecEdgeExists = m_vecEdgeExists;
+    Array<bool,Dynamic,1> vecEdgeActive = m_vecEdgeActive;
+    int iOldNumberNodes = m_iNumberEdgeNodes;
+    QPair<double,double> minMaxFullWeights = m_minMaxFullWeights;
+
+    m_iNumberEdgeNodes = iNumberNodes;
+    int iNumberPairs = m_iNumberEdgeNodes * (m_iNumberEdgeNodes - 1) / 2;
+
+    m_matEdgeWeights = MatrixXf::Zero(iNumberPairs, std::max(iNumberBins, 1));
+    m_vecAveragedWeights = VectorXd::Zero(iNumberPairs);
+    m_vecEdgeExists = Array<bool,Dynamic,1>::Constant(iNumberPairs, false);
+    m_vecEdgeActive = Array<bool,Dynamic,1>::Constant(iNumberPairs, false);
+    m_minMaxFullWeights = minMaxFullWeights;
+
+    // Copy the edges of every start node, they are stored contiguously in the old and the new storage
+    int iOldEdge = 0;
+    int iNumberEdges;
+
+    for(int i = 0; i < std::min(iOldNumberNodes, m_iNumberEdgeNodes) - 1; ++i) {
+        iNumberEdges = std::min(iOldNumberNodes, m_iNumberEdgeNodes) - i - 1;
+        int iEdge = getEdgeIndex(i, i + 1);
+
+        m_matEdgeWeights.block(iEdge, 0, iNumberEdges, matEdgeWeights.cols()) = matEdgeWeights.middleRows(iOldEdge, iNumberEdges);
+        m_vecAveragedWeights.segment(iEdge, iNumberEdges) = vecAveragedWeights.segment(iOldEdge, iNumberEdges);
+        m_vecEdgeExists.segment(iEdge, iNumberEdges) = vecEdgeExists.segment(iOldEdge, iNumberEdges);
+        m_vecEdgeActive.segment(iEdge, iNumberEdges) = vecEdgeActive.segment(iOldEdge, iNumberEdges);
+
+        iOldEdge += iOldNumberNodes - i - 1;
+    }
+
+    m_bEdgesOutdated = true;
+}
+
+
+//*************************************************************************************************************
+
+void Network::calculateAveragedWeights()
+{
+    int iStartBin = m_minMaxFreqBins.first;
+    int iEndBin = m_minMaxFreqBins.second;
+    int iNumberBins = m_matEdgeWeights.cols();
+
+    if(iEndBin < iStartBin || iStartBin < -1 || iEndBin < -1 ) {
+        return;
+    }
+
+    if(iStartBin == -1 && iEndBin == -1) {
+        m_vecAveragedWeights = m_matEdgeWeights.cast<double>().rowwise().mean();
+    } else if(iStartBin < iNumberBins) {
+        iEndBin = std::min(iEndBin, iNumberBins - 1);
+        m_vecAveragedWeights = m_matEdgeWeights.middleCols(iStartBin, iEndBin - iStartBin + 1).cast<double>().rowwise().mean();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void Network::calculateDegrees(const Array<bool,Dynamic,1>& vecMask,
+                               VectorXi& vecIndegrees,
+                               VectorXi& vecOutdegrees) const
+{
+    vecIndegrees = VectorXi::Zero(m_lNodes.size());
+    vecOutdegrees = VectorXi::Zero(m_lNodes.size());
+
+    int iNumberNodes = std::min(m_iNumberEdgeNodes, int(m_lNodes.size()));
+    int iNumberEdges;
+
+    // Edges are stored from the lower to the higher node id, i.e. the start node has the lower id
+    for(int i = 0; i < iNumberNodes - 1; ++i) {
+        iNumberEdges = iNumberNodes - i - 1;
+        const auto mask = vecMask.segment(getEdgeIndex(i, i + 1), iNumberEdges);
+
+        vecOutdegrees(i) = mask.count();
+        vecIndegrees.segment(i + 1, iNumberEdges) += mask.cast<int>().matrix();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void Network::createEdges() const
+{
+    QMutexLocker locker(m_pEdgesMutex.data());
+
+    if(!m_bEdgesOutdated) {
+        return;
+    }
+
+    m_lFullEdges.clear();
+    m_lThresholdedEdges.clear();
+    m_lEdgeNodes.clear();
+
+    // Create new node objects, so copies of this network which share the old nodes are not affected
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        NetworkNode::SPtr pNode = NetworkNode::SPtr(new NetworkNode(m_lNodes.at(i)->getId(), m_lNodes.at(i)->getVert()));
+        pNode->setHubStatus(m_lNodes.at(i)->getHubStatus());
+        m_lEdgeNodes << pNode;
+    }
+
+    int iNumberNodes = std::min(m_iNumberEdgeNodes, int(m_lNodes.size()));
+    int iEdge;
+    NetworkEdge::SPtr pEdge;
+
+    for(int i = 0; i < iNumberNodes; ++i) {
+        for(int j = i + 1; j < iNumberNodes; ++j) {
+            iEdge = getEdgeIndex(i, j);
+
+            if(!m_vecEdgeExists(iEdge)) {
+                continue;
+            }
+
+            pEdge = NetworkEdge::SPtr(new NetworkEdge(i, j, m_matEdgeWeights.row(iEdge).transpose().cast<double>(), m_vecEdgeActive(iEdge)));
+            pEdge->setFrequencyBins(m_minMaxFreqBins);
+            pEdge->setWeight(m_vecAveragedWeights(iEdge));
+
+            m_lEdgeNodes.at(i)->append(pEdge);
+            m_lEdgeNodes.at(j)->append(pEdge);
+            m_lFullEdges << pEdge;
+
+            if(m_vecEdgeActive(iEdge)) {
+                m_lThresholdedEdges << pEdge;
+            }
+        }
+    }
+
+    m_bEdgesOutdated = false;
+}
@@ -51,6 +51,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QPair>
+#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -93,6 +95,12 @@ struct VisualizationInfo {
 //=============================================================================================================
 /**
 * This class holds information (nodes and connecting edges) about a network, can compute a distance table and provide network metrics.
+* The edge weights of all node pairs (i < j) are stored densely in one (pairs x bins) float matrix, packed row by row
+* along the upper triangle. Thresholding, weight averaging and degree statistics operate directly on this storage.
+* The NetworkEdge objects and the edge lists of the nodes are only created on demand by getFullEdges,
+* getThresholdedEdges, getNodes and getNodeAt. Their creation is guarded by a mutex, so these getters can be called
+* from several threads at once. Edges from a node to itself are discarded, the diagonal of the connectivity matrices
+* is zero.
 *
 * @brief This class holds information about a network, can compute a distance table and provide network metrics.
 */
@@ -162,6 +170,73 @@ public:
     */
     const QList<QSharedPointer<NetworkNode> >& getNodes() const;
 
+    //=========================================================================================================
+    /**
+    * Allocates the dense edge weight storage for the currently appended nodes. All edges are set to zero and are
+    * marked as not existing until their weights are set.
+    *
+    * @param[in] iNumberBins    The number of weights (e.g. frequency bins) per edge.
+    */
+    void initEdgeWeights(int iNumberBins);
+
+    //=========================================================================================================
+    /**
+    * Sets the weights of all edges starting at a node, i.e. the edges to all nodes j > iStartNodeID. The storage
+    * must have been allocated with initEdgeWeights. Different start nodes can be set from different threads in
+    * parallel. Call updateEdgeWeights once all weights are set.
+    *
+    * @param[in] iStartNodeID   The start node of the edges.
+    * @param[in] matWeights     The weights (nodes x bins). Row j holds the weights of the edge to node j. Rows j <= iStartNodeID are ignored.
+    */
+    void setEdgeWeights(int iStartNodeID,
+                        const Eigen::MatrixXd& matWeights);
+
+    //=========================================================================================================
+    /**
+    * Updates the minimum and maximum weights and the thresholded edges after the weights were set via setEdgeWeights.
+    */
+    void updateEdgeWeights();
+
+    //=========================================================================================================
+    /**
+    * Returns the position of the edge between two nodes in the dense edge weight storage.
+    *
+    * @param[in] iStartNodeID   The start node of the edge.
+    * @param[in] iEndNodeID     The end node of the edge.
+    *
+    * @return The row of the edge in the dense edge weight storage, -1 if there is no such row.
+    */
+    inline int getEdgeIndex(int iStartNodeID,
+                            int iEndNodeID) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the averaged weight of the edge between two nodes without creating a NetworkEdge object.
+    *
+    * @param[in] iStartNodeID   The start node of the edge.
+    * @param[in] iEndNodeID     The end node of the edge.
+    *
+    * @return The averaged edge weight, 0 if the edge does not exist.
+    */
+    double getEdgeWeight(int iStartNodeID,
+                         int iEndNodeID) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the dense edge weight storage. Row getEdgeIndex(i,j) holds the weights of the edge between node i and j.
+    *
+    * @return The edge weights (pairs x bins).
+    */
+    inline const Eigen::MatrixXf& getEdgeWeightTensor() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the averaged weights of all edges, in the same order as the rows of getEdgeWeightTensor.
+    *
+    * @return The averaged edge weights.
+    */
+    inline const Eigen::VectorXd& getAveragedEdgeWeights() const;
+
     //=========================================================================================================
     /**
     * Returns the edge at a specific position.
@@ -182,6 +257,22 @@ public:
     */
     QSharedPointer<NetworkNode> getNodeAt(int i);
 
+    //=========================================================================================================
+    /**
+    * Returns the degree of every node corresponding to the full network.
+    *
+    * @return   The degrees (in and out) of all nodes.
+    */
+    Eigen::VectorXi getFullDegrees() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the degree of every node corresponding to the thresholded network.
+    *
+    * @return   The degrees (in and out) of all nodes.
+    */
+    Eigen::VectorXi getThresholdedDegrees() const;
+
     //=========================================================================================================
     /**
     * Returns network distribution, also known as network degree, corresponding to the full network.
@@ -406,10 +497,54 @@ public:
     int getFFTSize();
 
 protected:
-    QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network.*/
-    QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network.*/
+    //=========================================================================================================
+    /**
+    * Resizes the dense edge weight storage while keeping the weights of the already existing edges.
+    *
+    * @param[in] iNumberNodes   The new number of nodes.
+    * @param[in] iNumberBins    The new number of weights per edge.
+    */
+    void resizeEdgeWeights(int iNumberNodes,
+                           int iNumberBins);
 
-    QList<QSharedPointer<NetworkNode> >     m_lNodes;                   /**< List with all nodes of the network.*/
+    //=========================================================================================================
+    /**
+    * Recalculates the averaged edge weights from the dense storage for the currently set frequency bins.
+    */
+    void calculateAveragedWeights();
+
+    //=========================================================================================================
+    /**
+    * Counts the in and outdegree of every node for the given edge mask.
+    *
+    * @param[in] vecMask            The edge mask in the order of the dense edge weight storage.
+    * @param[out] vecIndegrees      The indegree of every node.
+    * @param[out] vecOutdegrees     The outdegree of every node.
+    */
+    void calculateDegrees(const Eigen::Array<bool,Eigen::Dynamic,1>& vecMask,
+                          Eigen::VectorXi& vecIndegrees,
+                          Eigen::VectorXi& vecOutdegrees) const;
+
+    //=========================================================================================================
+    /**
+    * Creates the NetworkEdge objects and the edge lists of the nodes from the dense edge weight storage.
+    */
+    void createEdges() const;
+
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;           /**< List with all edges of the network. Created on demand.*/
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;    /**< List with all the active (thresholded) edges of the network. Created on demand.*/
+
+    QList<QSharedPointer<NetworkNode> >             m_lNodes;               /**< List with all nodes of the network, as appended.*/
+    mutable QList<QSharedPointer<NetworkNode> >     m_lEdgeNodes;           /**< Copies of the nodes holding their edge lists. Created on demand.*/
+    mutable bool                                    m_bEdgesOutdated;       /**< Whether the edge objects need to be recreated from the dense edge weight storage.*/
+    mutable QSharedPointer<QMutex>                  m_pEdgesMutex;          /**< Guards the on demand creation of the edge objects.*/
+
+    Eigen::MatrixXf                         m_matEdgeWeights;           /**< The weights of all edges (pairs x bins), packed row by row along the upper triangle.*/
+    Eigen::VectorXd                         m_vecAveragedWeights;       /**< The averaged weight of all edges.*/
+    Eigen::Array<bool,Eigen::Dynamic,1>     m_vecEdgeExists;            /**< Whether the edge was set.*/
+    Eigen::Array<bool,Eigen::Dynamic,1>     m_vecEdgeActive;            /**< Whether the edge is part of the thresholded network.*/
+    int                                     m_iNumberEdgeNodes;         /**< The number of nodes the dense edge weight storage was allocated for.*/
+    QPair<int,int>                          m_minMaxFreqBins;           /**< The lower/upper bin indeces to average from/to. Default is -1 which means an average over all weights.*/
 
     Eigen::MatrixXd                         m_matDistMatrix;            /**< The distance matrix.*/
 
@@ -433,6 +568,36 @@ protected:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline int Network::getEdgeIndex(int iStartNodeID,
+                                 int iEndNodeID) const
+{
+    if(iStartNodeID > iEndNodeID) {
+        qSwap(iStartNodeID, iEndNodeID);
+    }
+
+    if(iStartNodeID < 0 || iStartNodeID == iEndNodeID || iEndNodeID >= m_iNumberEdgeNodes) {
+        return -1;
+    }
+
+    return iStartNodeID * (2 * m_iNumberEdgeNodes - iStartNodeID - 1) / 2 + iEndNodeID - iStartNodeID - 1;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXf& Network::getEdgeWeightTensor() const
+{
+    return m_matEdgeWeights;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::VectorXd& Network::getAveragedEdgeWeights() const
+{
+    return m_vecAveragedWeights;
+}
+
 
 } // namespace CONNECTIVITYLIB
 
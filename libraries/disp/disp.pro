@@ -137,6 +137,7 @@ SOURCES += \
     viewers/helpers/draggableframelesswidget.cpp \
     viewers/helpers/frequencyspectrumdelegate.cpp \
     viewers/helpers/frequencyspectrummodel.cpp \
+    viewers/helpers/minmaxpyramid.cpp \
 
 HEADERS += \
     disp_global.h \
@@ -183,6 +184,7 @@ HEADERS += \
     viewers/helpers/draggableframelesswidget.h \
     viewers/helpers/frequencyspectrumdelegate.h \
     viewers/helpers/frequencyspectrummodel.h \
+    viewers/helpers/minmaxpyramid.h \
 
 qtHaveModule(charts) {
     SOURCES += \
@@ -0,0 +1,224 @@
+//=============================================================================================================
+/**
+* @file     minmaxpyramid.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     November, 2019
+*
+* @section  LICENSE
+*
+* Copyright (C) 2019, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MinMaxPyramid Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "minmaxpyramid.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QPainterPath>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISPLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MinMaxPyramid::MinMaxPyramid()
+: m_iRows(0)
+, m_iCols(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::build(const MatrixXdR &matData)
+{
+    m_iRows = matData.rows();
+    m_iCols = matData.cols();
+
+    m_qVecMin.clear();
+    m_qVecMax.clear();
+
+    for(qint32 k = s_iBaseLevel; (m_iCols >> k) > 0; ++k) {
+        m_qVecMin.append(MatrixXdR(m_iRows, m_iCols >> k));
+        m_qVecMax.append(MatrixXdR(m_iRows, m_iCols >> k));
+    }
+
+    update(matData, 0, m_iCols);
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::update(const MatrixXdR &matData, qint32 iFrom, qint32 iNumCols)
+{
+    if(matData.rows() != m_iRows || matData.cols() != m_iCols) {
+        build(matData);
+        return;
+    }
+
+    for(qint32 r = 0; r < m_iRows; ++r) {
+        updateRow(matData.data() + r*m_iCols, r, iFrom, iNumCols);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::updateRow(const double* pRowData, qint32 iRow, qint32 iFrom, qint32 iNumCols)
+{
+    iFrom = qMax(iFrom, 0);
+    qint32 iTo = qMin(iFrom + iNumCols, m_iCols);
+
+    if(iTo <= iFrom || iRow < 0 || iRow >= m_iRows) {
+        return;
+    }
+
+    for(qint32 l = 0; l < m_qVecMin.size(); ++l) {
+        qint32 k = s_iBaseLevel + l;
+        qint32 iLastBin = qMin((iTo - 1) >> k, (qint32)m_qVecMin[l].cols() - 1);
+
+        double* pMin = m_qVecMin[l].data() + iRow*m_qVecMin[l].cols();
+        double* pMax = m_qVecMax[l].data() + iRow*m_qVecMax[l].cols();
+
+        if(l == 0) {
+            //Finest level from the samples
+            for(qint32 b = iFrom >> k; b <= iLastBin; ++b) {
+                Eigen::Map<const Eigen::RowVectorXd> samples(pRowData + (b << k), 1 << k);
+                pMin[b] = samples.minCoeff();
+                pMax[b] = samples.maxCoeff();
+            }
+        } else {
+            //Coarser levels from the two child bins
+            const double* pChildMin = m_qVecMin[l-1].data() + iRow*m_qVecMin[l-1].cols();
+            const double* pChildMax = m_qVecMax[l-1].data() + iRow*m_qVecMax[l-1].cols();
+
+            for(qint32 b = iFrom >> k; b <= iLastBin; ++b) {
+                pMin[b] = qMin(pChildMin[2*b], pChildMin[2*b+1]);
+                pMax[b] = qMax(pChildMax[2*b], pChildMax[2*b+1]);
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::minMax(const double* pRowData, qint32 iRow, qint32 iFrom, qint32 iTo, double &dMin, double &dMax) const
+{
+    dMin = pRowData[iFrom];
+    dMax = pRowData[iFrom];
+
+    qint32 j = iFrom;
+
+    while(j < iTo) {
+        //Use the coarsest bin which starts at j and ends before iTo, read the samples where no bin fits
+        qint32 l = -1;
+        while(l+1 < m_qVecMin.size()) {
+            qint32 k = s_iBaseLevel + l + 1;
+            if((j & ((1 << k) - 1)) != 0 || j + (1 << k) > iTo) {
+                break;
+            }
+            ++l;
+        }
+
+        if(l < 0) {
+            dMin = qMin(dMin, pRowData[j]);
+            dMax = qMax(dMax, pRowData[j]);
+            ++j;
+        } else {
+            qint32 b = j >> (s_iBaseLevel + l);
+            dMin = qMin(dMin, m_qVecMin[l](iRow, b));
+            dMax = qMax(dMax, m_qVecMax[l](iRow, b));
+            j += 1 << (s_iBaseLevel + l);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::appendToPath(QPainterPath &path,
+                                 const double* pRowData,
+                                 qint32 iRow,
+                                 qint32 iFrom,
+                                 qint32 iTo,
+                                 double dX0,
+                                 double dDx,
+                                 double dYBase,
+                                 double dScaleY,
+                                 double dOffset) const
+{
+    if(dDx <= 0.0) {
+        return;
+    }
+
+    double dMin, dMax, dYMin, dYMax, dX;
+    qint32 jNext;
+
+    for(qint32 j = iFrom; j < iTo; j = jNext) {
+        //First sample which lies in the next pixel column
+        double dColumn = qFloor(dX0 + (j+1)*dDx);
+        jNext = qBound(j + 1, (qint32)qCeil((dColumn + 1.0 - dX0) / dDx) - 1, iTo);
+
+        minMax(pRowData, iRow, j, jNext, dMin, dMax);
+
+        dX = dX0 + jNext*dDx;
+        dYMin = dYBase - (dMin - dOffset)*dScaleY;
+        dYMax = dYBase - (dMax - dOffset)*dScaleY;
+
+        //Continue with the extremum closer to the current position, so the columns stay connected
+        if(qAbs(path.currentPosition().y() - dYMin) < qAbs(path.currentPosition().y() - dYMax)) {
+            path.lineTo(dX, dYMin);
+            if(jNext - j > 1) {
+                path.lineTo(dX, dYMax);
+            }
+        } else {
+            path.lineTo(dX, dYMax);
+            if(jNext - j > 1) {
+                path.lineTo(dX, dYMin);
+            }
+        }
+    }
+}
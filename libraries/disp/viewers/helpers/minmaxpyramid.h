@@ -0,0 +1,219 @@
+//=============================================================================================================
+/**
+* @file     minmaxpyramid.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     November, 2019
+*
+* @section  LICENSE
+*
+* Copyright (C) 2019, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MinMaxPyramid class declaration.
+*
+*/
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../disp_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QPainterPath;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISPLIB
+//=============================================================================================================
+
+namespace DISPLIB
+{
+
+
+//=============================================================================================================
+/**
+* Per channel min/max envelope pyramid of a row major data matrix (channels x samples). Level k holds the minimum
+* and maximum of consecutive bins of 2^k samples, starting at 2^3 samples. The pyramid does not keep a copy of the
+* data, the finest samples are read from the data row that is passed to the queries. Min/max of an arbitrary sample
+* range is assembled from O(log n) bins, so plotting a channel at any zoom level costs at most two path points per
+* pixel column without dropping spikes.
+*
+* @brief Min/max level of detail pyramid for plotting raw data
+*/
+class DISPSHARED_EXPORT MinMaxPyramid
+{
+public:
+    typedef Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> MatrixXdR;
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty MinMaxPyramid.
+    */
+    MinMaxPyramid();
+
+    //=========================================================================================================
+    /**
+    * Allocates the pyramid for the given data size and builds it from the data.
+    *
+    * @param[in] matData    The data (channels x samples).
+    */
+    void build(const MatrixXdR &matData);
+
+    //=========================================================================================================
+    /**
+    * Refreshes all bins which overlap the given sample range of all channels. The data must have the size the
+    * pyramid was built for.
+    *
+    * @param[in] matData    The data (channels x samples).
+    * @param[in] iFrom      The first changed sample.
+    * @param[in] iNumCols   The number of changed samples.
+    */
+    void update(const MatrixXdR &matData, qint32 iFrom, qint32 iNumCols);
+
+    //=========================================================================================================
+    /**
+    * Refreshes all bins of one channel which overlap the given sample range.
+    *
+    * @param[in] pRowData   The samples of the channel.
+    * @param[in] iRow       The channel.
+    * @param[in] iFrom      The first changed sample.
+    * @param[in] iNumCols   The number of changed samples.
+    */
+    void updateRow(const double* pRowData, qint32 iRow, qint32 iFrom, qint32 iNumCols);
+
+    //=========================================================================================================
+    /**
+    * Returns the minimum and maximum of the samples [iFrom, iTo) of one channel.
+    *
+    * @param[in] pRowData   The samples of the channel the pyramid was built from.
+    * @param[in] iRow       The channel.
+    * @param[in] iFrom      The first sample.
+    * @param[in] iTo        One past the last sample.
+    * @param[out] dMin      The minimum.
+    * @param[out] dMax      The maximum.
+    */
+    void minMax(const double* pRowData, qint32 iRow, qint32 iFrom, qint32 iTo, double &dMin, double &dMax) const;
+
+    //=========================================================================================================
+    /**
+    * Appends the samples [iFrom, iTo) of one channel to a plot path. Sample j is placed at
+    * dX0 + (j+1) * dDx and y = dYBase - (value - dOffset) * dScaleY. Each pixel column which covers more than one
+    * sample is reduced to its minimum and maximum, so at most two points per column are added.
+    *
+    * @param[in, out] path  The path, its current position is the start of the line.
+    * @param[in] pRowData   The samples of the channel the pyramid was built from.
+    * @param[in] iRow       The channel.
+    * @param[in] iFrom      The first sample.
+    * @param[in] iTo        One past the last sample.
+    * @param[in] dX0        The x position before the first sample of the row.
+    * @param[in] dDx        The distance of two samples in pixels.
+    * @param[in] dYBase     The y position of the offset value.
+    * @param[in] dScaleY    The scaling of the values in pixels.
+    * @param[in] dOffset    The value which is drawn at dYBase.
+    */
+    void appendToPath(QPainterPath &path,
+                      const double* pRowData,
+                      qint32 iRow,
+                      qint32 iFrom,
+                      qint32 iTo,
+                      double dX0,
+                      double dDx,
+                      double dYBase,
+                      double dScaleY,
+                      double dOffset) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels the pyramid was built for.
+    *
+    * @return the number of channels.
+    */
+    inline qint32 rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples the pyramid was built for.
+    *
+    * @return the number of samples.
+    */
+    inline qint32 cols() const;
+
+private:
+    static const qint32 s_iBaseLevel = 3;   /**< Level of the finest stored bins, bins of 2^s_iBaseLevel samples */
+
+    QVector<MatrixXdR>  m_qVecMin;          /**< Bin minima (channels x bins), one matrix per level starting at s_iBaseLevel */
+    QVector<MatrixXdR>  m_qVecMax;          /**< Bin maxima (channels x bins), one matrix per level starting at s_iBaseLevel */
+    qint32              m_iRows;            /**< Number of channels */
+    qint32              m_iCols;            /**< Number of samples */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 MinMaxPyramid::rows() const
+{
+    return m_iRows;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 MinMaxPyramid::cols() const
+{
+    return m_iCols;
+}
+
+} // NAMESPACE DISPLIB
+
+#endif // MINMAXPYRAMID_H
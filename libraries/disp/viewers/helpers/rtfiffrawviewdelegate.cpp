@@ -597,6 +597,31 @@ void RtFiffRawViewDelegate::createPlotPath(const QModelIndex &index,
 
     double val;
 
+    //More than two samples per pixel column -> draw the min/max envelope of each column from the pyramid of the model
+    const MinMaxPyramid& pyramid = t_pModel->getMinMaxPyramid();
+    qint32 iChRow = t_pModel->getIdxSelMap().value(index.row(),0);
+
+    if(dDx < 0.5 && pyramid.cols() == data.second && iChRow < pyramid.rows() && data.second > 0) {
+        double dX0 = path.currentPosition().x();
+        qint32 iSplit = qBound(0, currentSampleIndex, (qint32)data.second);
+
+        pyramid.appendToPath(path, data.first, iChRow, 0, iSplit, dX0, dDx, y_base, dScaleY, *(data.first));
+        pyramid.appendToPath(path, data.first, iChRow, iSplit, data.second, dX0, dDx, y_base, dScaleY, lastFirstValue);
+
+        //Create ellipse position
+        qint32 j = (qint32)(m_markerPosition.x()/dDx);
+        if(j >= 0 && j < data.second) {
+            val = j < currentSampleIndex ? *(data.first+j) - *(data.first) : *(data.first+j) - lastFirstValue;
+
+            ellipsePos.setX(dX0+(j+2)*dDx);
+            ellipsePos.setY(y_base-val*dScaleY);
+
+            amplitude = QString::number(*(data.first+j));
+        }
+
+        return;
+    }
+
     for(qint32 j=0; j < data.second; ++j)
     {
         if(j<currentSampleIndex)
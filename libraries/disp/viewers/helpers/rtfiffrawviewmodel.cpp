@@ -321,6 +321,9 @@ void RtFiffRawViewModel::setFiffInfo(QSharedPointer<FIFFLIB::FiffInfo> &p_pFiffI
         m_matDataFiltered.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxSamples);
         m_matDataFiltered.setZero();
 
+        m_pyramidDataRaw.build(m_matDataRaw);
+        m_pyramidDataFiltered.build(m_matDataFiltered);
+
         m_vecLastBlockFirstValuesFiltered.conservativeResize(m_pFiffInfo->chs.size());
         m_vecLastBlockFirstValuesFiltered.setZero();
 
@@ -397,6 +400,9 @@ void RtFiffRawViewModel::setSamplingInfo(float sps, int T, bool bSetZero)
         m_vecLastBlockFirstValuesFiltered.setZero();
     }
 
+    m_pyramidDataRaw.build(m_matDataRaw);
+    m_pyramidDataFiltered.build(m_matDataFiltered);
+
     if(m_iCurrentSample>m_iMaxSamples) {
         m_iCurrentSample = 0;
     }
@@ -420,6 +426,45 @@ MatrixXd RtFiffRawViewModel::getLastBlock()
 //*************************************************************************************************************
 
 void RtFiffRawViewModel::addData(const QList<MatrixXd> &data)
+{
+    for(qint32 b = 0; b < data.size(); ++b) {
+        if(!addDataBlock(data.at(b))) {
+            return;
+        }
+    }
+
+    //Update data content
+    QModelIndex topLeft = this->index(0,1);
+    QModelIndex bottomRight = this->index(m_pFiffInfo->ch_names.size()-1,1);
+    QVector<int> roles; roles << Qt::DisplayRole;
+
+    emit dataChanged(topLeft, bottomRight, roles);
+}
+
+
+//*************************************************************************************************************
+
+void RtFiffRawViewModel::addData(const QList<QSharedPointer<const MatrixXd> > &data)
+{
+    //Read the shared blocks in place, they are copied into the display matrices only
+    for(qint32 b = 0; b < data.size(); ++b) {
+        if(!addDataBlock(*data.at(b))) {
+            return;
+        }
+    }
+
+    //Update data content
+    QModelIndex topLeft = this->index(0,1);
+    QModelIndex bottomRight = this->index(m_pFiffInfo->ch_names.size()-1,1);
+    QVector<int> roles; roles << Qt::DisplayRole;
+
+    emit dataChanged(topLeft, bottomRight, roles);
+}
+
+
+//*************************************************************************************************************
+
+bool RtFiffRawViewModel::addDataBlock(const MatrixXd &matData)
 {
     //SSP
     bool doProj = m_bProjActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matProj.cols() ? true : false;
@@ -431,144 +476,182 @@ void RtFiffRawViewModel::addData(const QList<MatrixXd> &data)
     bool doSphara = m_bSpharaActivated && m_matSparseSpharaMult.cols() > 0 && m_matDataRaw.rows() == m_matSparseSpharaMult.cols() ? true : false;
 
     //Copy new data into the global data matrix
-    for(qint32 b = 0; b < data.size(); ++b) {
-        int nCol = data.at(b).cols();
-        int nRow = data.at(b).rows();
+    int nCol = matData.cols();
+    int nRow = matData.rows();
 
-        if(nRow != m_matDataRaw.rows()) {
-            qDebug()<<"incoming data does not match internal data row size. Returning...";
-            return;
-        }
+    if(nRow != m_matDataRaw.rows()) {
+        qDebug()<<"incoming data does not match internal data row size. Returning...";
+        return false;
+    }
 
-        //Reset m_iCurrentSample and start filling the data matrix from the beginning again. Also add residual amount of data to the end of the matrix.
-        if(m_iCurrentSample+nCol > m_matDataRaw.cols()) {
-            m_iResidual = nCol - ((m_iCurrentSample+nCol) % m_matDataRaw.cols());
+    //Position at which the residual was written to the end of the matrix, -1 if the data matrix was not wrapped
+    int iWrappedSample = -1;
 
-            if(m_iResidual == nCol) {
-                m_iResidual = 0;
-            }
+    //Reset m_iCurrentSample and start filling the data matrix from the beginning again. Also add residual amount of data to the end of the matrix.
+    if(m_iCurrentSample+nCol > m_matDataRaw.cols()) {
+        m_iResidual = nCol - ((m_iCurrentSample+nCol) % m_matDataRaw.cols());
+
+        if(m_iResidual == nCol) {
+            m_iResidual = 0;
+        }
 
 //            std::cout<<"incoming data exceeds internal data cols by: "<<(m_iCurrentSample+nCol) % m_matDataRaw.cols()<<std::endl;
 //            std::cout<<"m_iCurrentSample+nCol: "<<m_iCurrentSample+nCol<<std::endl;
 //            std::cout<<"m_matDataRaw.cols(): "<<m_matDataRaw.cols()<<std::endl;
 //            std::cout<<"nCol-m_iResidual: "<<nCol-m_iResidual<<std::endl<<std::endl;
 
-            if(doComp) {
-                if(doProj) {
-                    //Comp + Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * data.at(b).block(0,0,nRow,m_iResidual);
-                } else {
-                    //Comp
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * data.at(b).block(0,0,nRow,m_iResidual);
-                }
-            } else {
-                if(doProj)
-                {
-                    //Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * data.at(b).block(0,0,nRow,m_iResidual);
-                } else {
-                    //None - Raw
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = data.at(b).block(0,0,nRow,m_iResidual);
-                }
-            }
-
-            m_iCurrentSample = 0;
-
-            if(!m_bIsFreezed) {
-                m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
-                m_vecLastBlockFirstValuesRaw = m_matDataRaw.col(0);
-            }
-
-            //Store old detected triggers
-            m_qMapDetectedTriggerOld = m_qMapDetectedTrigger;
-
-            //Clear detected triggers
-            if(m_bTriggerDetectionActive) {
-                QMutableMapIterator<int,QList<QPair<int,double> > > i(m_qMapDetectedTrigger);
-                while (i.hasNext()) {
-                    i.next();
-                    i.value().clear();
-                }
-            }
-        } else {
-            m_iResidual = 0;
-        }
-
-        //std::cout<<"incoming data is ok"<<std::endl;
-
         if(doComp) {
             if(doProj) {
                 //Comp + Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * matData.block(0,0,nRow,m_iResidual);
             } else {
                 //Comp
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * matData.block(0,0,nRow,m_iResidual);
             }
         } else {
-            if(doProj) {
+            if(doProj)
+            {
                 //Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * matData.block(0,0,nRow,m_iResidual);
             } else {
                 //None - Raw
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = matData.block(0,0,nRow,m_iResidual);
             }
         }
 
-        //Filter if neccessary else set filtered data matrix to zero
-        if(!m_filterData.isEmpty() && m_bPerformFiltering) {
-            filterDataBlock(m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol), m_iCurrentSample);
+        iWrappedSample = m_iCurrentSample;
+        m_iCurrentSample = 0;
 
-            //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
-            if(doSphara) {
-                if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
-                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
-                }
-                else {
-                    if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
-                        m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
-                        int iResidual = m_iResidual+m_iMaxFilterLength/2;
-                        m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
-                    }
-                }
+        if(!m_bIsFreezed) {
+            m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
+            m_vecLastBlockFirstValuesRaw = m_matDataRaw.col(0);
+        }
+
+        //Store old detected triggers
+        m_qMapDetectedTriggerOld = m_qMapDetectedTrigger;
+
+        //Clear detected triggers
+        if(m_bTriggerDetectionActive) {
+            QMutableMapIterator<int,QList<QPair<int,double> > > i(m_qMapDetectedTrigger);
+            while (i.hasNext()) {
+                i.next();
+                i.value().clear();
             }
+        }
+    } else {
+        m_iResidual = 0;
+    }
+
+    //std::cout<<"incoming data is ok"<<std::endl;
+
+    if(doComp) {
+        if(doProj) {
+            //Comp + Proj
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * matData;
+        } else {
+            //Comp
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * matData;
+        }
+    } else {
+        if(doProj) {
+            //Proj
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * matData;
         } else {
-            m_matDataFiltered.block(0, m_iCurrentSample, nRow, nCol).setZero();// = m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
+            //None - Raw
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = matData;
+        }
+    }
+
+    //Filter if neccessary else set filtered data matrix to zero
+    if(!m_filterData.isEmpty() && m_bPerformFiltering) {
+        filterDataBlock(m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol), m_iCurrentSample);
 
-            //Perform SPHARA on raw data data
-            if(doSphara) {
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseSpharaMult * m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
+        //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
+        if(doSphara) {
+            if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
+                m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
+            }
+            else {
+                if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
+                    m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
+                    int iResidual = m_iResidual+m_iMaxFilterLength/2;
+                    m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
+                }
             }
         }
+    } else {
+        m_matDataFiltered.block(0, m_iCurrentSample, nRow, nCol).setZero();// = m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
+
+        //Perform SPHARA on raw data data
+        if(doSphara) {
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseSpharaMult * m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
+        }
+    }
 
-        m_iCurrentSample += nCol;
-        m_iCurrentBlockSize = nCol;
+    //Refresh the envelopes of the written samples, the filtering of the first block also writes to the end of the matrix
+    updateMinMaxPyramids(m_iCurrentSample, nCol);
 
-        //detect the trigger flanks in the trigger channels
-        if(m_bTriggerDetectionActive) {
-            int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
+    if(iWrappedSample >= 0) {
+        updateMinMaxPyramids(iWrappedSample, m_matDataRaw.cols() - iWrappedSample);
+    }
 
-            QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, true, 500);
-            //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
+    m_iCurrentSample += nCol;
+    m_iCurrentBlockSize = nCol;
 
-            //Append results to already found triggers
-            m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].append(qMapDetectedTrigger);
+    //detect the trigger flanks in the trigger channels
+    if(m_bTriggerDetectionActive) {
+        int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
 
-            //Compute newly counted triggers
-            int newTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size() - iOldDetectedTriggers;
+        QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(matData, m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, true, 500);
+        //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(matData, m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
 
-            if(newTriggers!=0) {
-                m_iDetectedTriggers += newTriggers;
-                emit triggerDetected(m_iDetectedTriggers, m_qMapDetectedTrigger);
-            }
+        //Append results to already found triggers
+        m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].append(qMapDetectedTrigger);
+
+        //Compute newly counted triggers
+        int newTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size() - iOldDetectedTriggers;
+
+        if(newTriggers!=0) {
+            m_iDetectedTriggers += newTriggers;
+            emit triggerDetected(m_iDetectedTriggers, m_qMapDetectedTrigger);
         }
     }
 
-    //Update data content
-    QModelIndex topLeft = this->index(0,1);
-    QModelIndex bottomRight = this->index(m_pFiffInfo->ch_names.size()-1,1);
-    QVector<int> roles; roles << Qt::DisplayRole;
+    return true;
+}
 
-    emit dataChanged(topLeft, bottomRight, roles);
+
+//*************************************************************************************************************
+
+void RtFiffRawViewModel::updateMinMaxPyramids(int iFrom, int iNumCols)
+{
+    m_pyramidDataRaw.update(m_matDataRaw, iFrom, iNumCols);
+
+    if(!m_filterData.isEmpty() && m_bPerformFiltering) {
+        m_pyramidDataFiltered.update(m_matDataFiltered, iFrom - m_iMaxFilterLength, iNumCols + 2*m_iMaxFilterLength);
+    } else {
+        m_pyramidDataFiltered.update(m_matDataFiltered, iFrom, iNumCols);
+    }
+}
+
+
+//*************************************************************************************************************
+
+const MinMaxPyramid& RtFiffRawViewModel::getMinMaxPyramid() const
+{
+    if(m_bIsFreezed) {
+        if(!m_filterData.isEmpty() && m_bPerformFiltering) {
+            return m_pyramidDataFilteredFreeze;
+        }
+
+        return m_pyramidDataRawFreeze;
+    }
+
+    if(!m_filterData.isEmpty() && m_bPerformFiltering) {
+        return m_pyramidDataFiltered;
+    }
+
+    return m_pyramidDataRaw;
 }
 
 
@@ -676,6 +759,8 @@ void RtFiffRawViewModel::toggleFreeze(const QModelIndex &)
     if(m_bIsFreezed) {
         m_matDataRawFreeze = m_matDataRaw;
         m_matDataFilteredFreeze = m_matDataFiltered;
+        m_pyramidDataRawFreeze = m_pyramidDataRaw;
+        m_pyramidDataFilteredFreeze = m_pyramidDataFiltered;
         m_qMapDetectedTriggerFreeze = m_qMapDetectedTrigger;
         m_qMapDetectedTriggerOldFreeze = m_qMapDetectedTriggerOld;
 
@@ -1203,6 +1288,8 @@ void RtFiffRawViewModel::filterDataBlock()
         m_matDataFiltered.row(notFilterChannelIndex.at(i)) = m_matDataRaw.row(notFilterChannelIndex.at(i));
     }
 
+    m_pyramidDataFiltered.build(m_matDataFiltered);
+
     if(!m_bIsFreezed) {
         m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
     }
@@ -1342,5 +1429,10 @@ void RtFiffRawViewModel::clearModel()
     m_vecLastBlockFirstValuesRaw.setZero();
     m_matOverlap.setZero();
 
+    m_pyramidDataRaw.build(m_matDataRaw);
+    m_pyramidDataFiltered.build(m_matDataFiltered);
+    m_pyramidDataRawFreeze.build(m_matDataRawFreeze);
+    m_pyramidDataFilteredFreeze.build(m_matDataFilteredFreeze);
+
     endResetModel();
 }
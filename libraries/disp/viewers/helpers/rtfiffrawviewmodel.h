@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "../../disp_global.h"
+#include "minmaxpyramid.h"
 
 #include <fiff/fiff_types.h>
 #include <fiff/fiff_proj.h>
@@ -204,6 +205,14 @@ public:
     */
     void addData(const QList<Eigen::MatrixXd> &data);
 
+    //=========================================================================================================
+    /**
+    * Adds multiple time points for a channel set. The blocks are shared with other consumers and only read.
+    *
+    * @param[in] data       data blocks to add (Time points of channel samples)
+    */
+    void addData(const QList<QSharedPointer<const Eigen::MatrixXd> > &data);
+
     //=========================================================================================================
     /**
     * Returns the kind of a given channel number
@@ -268,6 +277,15 @@ public:
     */
     inline const QMap<qint32,qint32>& getIdxSelMap() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the data which is currently returned for the data plot column (raw or
+    * filtered, streamed or freezed). Rows are channel indices, see getIdxSelMap.
+    *
+    * @return the min/max pyramid of the currently displayed data
+    */
+    const MinMaxPyramid& getMinMaxPyramid() const;
+
     //=========================================================================================================
     /**
     * Selects the given list of channel indeces and unselect all other channels
@@ -526,6 +544,16 @@ private:
     */
     void initSphara();
 
+    //=========================================================================================================
+    /**
+    * Copies one data block into the raw data matrix, applies the activated operators and filters the new data.
+    *
+    * @param[in] matData    data block to add (Time points of channel samples)
+    *
+    * @return false if the number of rows does not match the number of channels, true otherwise.
+    */
+    bool addDataBlock(const Eigen::MatrixXd &matData);
+
     static void doFilterPerChannelRTMSA(QPair<QList<UTILSLIB::FilterData>,QPair<int,Eigen::RowVectorXd> > &channelDataTime);
 
     //=========================================================================================================
@@ -543,6 +571,16 @@ private:
     */
     void filterDataBlock(const Eigen::MatrixXd &data, int iDataIndex);
 
+    //=========================================================================================================
+    /**
+    * Refreshes the min/max pyramids of the raw and filtered data for the given sample range. The filtered range
+    * is extended by the filter length, since the overlap add and SPHARA also rewrite samples around the block.
+    *
+    * @param [in] iFrom         first changed sample
+    * @param [in] iNumCols      number of changed samples
+    */
+    void updateMinMaxPyramids(int iFrom, int iNumCols);
+
     //=========================================================================================================
     /**
     * Clears the model
@@ -583,6 +621,10 @@ private:
     MatrixXdR                           m_matDataFiltered;                          /**< The filtered data */
     MatrixXdR                           m_matDataRawFreeze;                         /**< The raw data in freeze mode */
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode */
+    MinMaxPyramid                       m_pyramidDataRaw;                           /**< The min/max pyramid of the raw data */
+    MinMaxPyramid                       m_pyramidDataFiltered;                      /**< The min/max pyramid of the filtered data */
+    MinMaxPyramid                       m_pyramidDataRawFreeze;                     /**< The min/max pyramid of the raw data in freeze mode */
+    MinMaxPyramid                       m_pyramidDataFilteredFreeze;                /**< The min/max pyramid of the filtered data in freeze mode */
     Eigen::MatrixXd                     m_matOverlap;                               /**< Last overlap block for the back */
 
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA operator in case of a VectorView system.*/
@@ -186,6 +186,14 @@ void RtFiffRawView::addData(const QList<Eigen::MatrixXd> &data)
 }
 
 
+//*************************************************************************************************************
+
+void RtFiffRawView::addData(const QList<QSharedPointer<const Eigen::MatrixXd> > &data)
+{
+    m_pModel->addData(data);
+}
+
+
 //*************************************************************************************************************
 
 MatrixXd RtFiffRawView::getLastBlock()
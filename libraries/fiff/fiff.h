@@ -56,6 +56,9 @@
 #include "fiff_ctf_comp.h"
 #include "fiff_info.h"
 #include "fiff_raw_data.h"
+#include "fiff_raw_chunk_iterator.h"
+#include "fiff_raw_mapped_reader.h"
+#include "fiff_raw_read_operator.h"
 #include "fiff_raw_dir.h"
 #include "fiff_stream.h"
 #include "fiff_evoked_set.h"
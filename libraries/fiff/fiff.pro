@@ -72,6 +72,9 @@ SOURCES += fiff.cpp \
     fiff_proj.cpp \
     fiff_named_matrix.cpp \
     fiff_raw_data.cpp \
+    fiff_raw_chunk_iterator.cpp \
+    fiff_raw_mapped_reader.cpp \
+    fiff_raw_read_operator.cpp \
     fiff_ctf_comp.cpp \
     fiff_id.cpp \
     fiff_info.cpp \
@@ -107,6 +110,9 @@ HEADERS += fiff.h \
     fiff_ctf_comp.h \
     fiff_info.h \
     fiff_raw_data.h \
+    fiff_raw_chunk_iterator.h \
+    fiff_raw_mapped_reader.h \
+    fiff_raw_read_operator.h \
     fiff_dir_entry.h \
     fiff_raw_dir.h \
     fiff_dig_point.h \
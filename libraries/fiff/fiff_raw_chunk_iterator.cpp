@@ -0,0 +1,201 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_chunk_iterator.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawChunkIterator Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_chunk_iterator.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawChunkIterator::FiffRawChunkIterator(const FiffRawData &p_FiffRawData,
+                                           fiff_int_t iChunkSize,
+                                           const RowVectorXi &sel,
+                                           fiff_int_t from,
+                                           fiff_int_t to,
+                                           qint64 iMaxBytes)
+: m_reader(p_FiffRawData)
+, m_vecSel(sel)
+, m_iFrom(from == -1 ? p_FiffRawData.first_samp : qMax(from, p_FiffRawData.first_samp))
+, m_iTo(to == -1 ? p_FiffRawData.last_samp : qMin(to, p_FiffRawData.last_samp))
+, m_iChunkSize(iChunkSize)
+, m_iHead(0)
+, m_iCount(0)
+, m_bStop(false)
+, m_bFinished(false)
+, m_thread(this)
+{
+    if(m_iChunkSize <= 0) {
+        m_iChunkSize = p_FiffRawData.rawdir.isEmpty() ? 1 : p_FiffRawData.rawdir.first().nsamp;
+    }
+
+    //
+    //  Derive the number of ring slots from the memory cap
+    //
+    const qint64 iNumRows = sel.size() > 0 ? sel.size() : p_FiffRawData.info.nchan;
+    const qint64 iBytesPerChunk = qMax(qint64(1), iNumRows * m_iChunkSize * qint64(sizeof(double)));
+    const qint32 iNumSlots = static_cast<qint32>(qMax(qint64(2), iMaxBytes / iBytesPerChunk));
+
+    m_qVecRing.resize(iNumSlots);
+
+    m_thread.start();
+}
+
+
+//*************************************************************************************************************
+
+FiffRawChunkIterator::~FiffRawChunkIterator()
+{
+    stop();
+    m_thread.wait();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawChunkIterator::next(MatrixXd& data,
+                                MatrixXd& times,
+                                fiff_int_t& first,
+                                fiff_int_t& last)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while(m_iCount == 0 && !m_bFinished) {
+        m_condNotEmpty.wait(&m_mutex);
+    }
+
+    if(m_iCount == 0) {
+        return false;
+    }
+
+    //
+    //  Hand out the chunk by exchanging storage, the caller's matrices become the new ring slot
+    //
+    Chunk& chunk = m_qVecRing[m_iHead];
+    data.swap(chunk.data);
+    times.swap(chunk.times);
+    first = chunk.first;
+    last = chunk.last;
+
+    m_iHead = (m_iHead + 1) % m_qVecRing.size();
+    --m_iCount;
+
+    m_condNotFull.wakeOne();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawChunkIterator::stop()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_bStop = true;
+    m_condNotFull.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawChunkIterator::readAhead()
+{
+    for(fiff_int_t first = m_iFrom; first <= m_iTo; first += m_iChunkSize) {
+        const fiff_int_t last = qMin(first + m_iChunkSize - 1, m_iTo);
+        qint32 iSlot;
+
+        //
+        //  Wait for a free slot
+        //
+        {
+            QMutexLocker locker(&m_mutex);
+
+            while(m_iCount == m_qVecRing.size() && !m_bStop) {
+                m_condNotFull.wait(&m_mutex);
+            }
+
+            if(m_bStop) {
+                break;
+            }
+
+            iSlot = (m_iHead + m_iCount) % m_qVecRing.size();
+        }
+
+        //
+        //  Decode outside the lock, the slot is not touched by next() until it is published
+        //
+        Chunk& chunk = m_qVecRing[iSlot];
+
+        if(!m_reader.read_raw_segment(chunk.data, chunk.times, first, last, m_vecSel)) {
+            qWarning() << "FiffRawChunkIterator::readAhead - Error when reading samples" << first << "to" << last;
+            break;
+        }
+
+        chunk.first = first;
+        chunk.last = last;
+
+        QMutexLocker locker(&m_mutex);
+        ++m_iCount;
+        m_condNotEmpty.wakeOne();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_bFinished = true;
+    m_condNotEmpty.wakeAll();
+}
@@ -0,0 +1,241 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_chunk_iterator.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawChunkIterator class declaration.
+*
+*/
+
+#ifndef FIFF_RAW_CHUNK_ITERATOR_H
+#define FIFF_RAW_CHUNK_ITERATOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_raw_data.h"
+#include "fiff_raw_mapped_reader.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Walks the samples from..to of a raw file in consecutive chunks of a fixed number of samples, the final chunk holds
+* the remaining samples and can be shorter. A read-ahead thread decodes the upcoming chunks through a
+* FiffRawMappedReader into a ring of matrices while the consumer processes the current one. The number of ring
+* slots is derived from a configurable memory cap. next() hands out a chunk by swapping matrix storage with the
+* caller, so the decoded chunk is not copied again and the caller's previous matrices are refilled as a ring slot.
+*
+* @brief Streaming fiff raw data iterator with read-ahead thread
+*/
+class FIFFSHARED_EXPORT FiffRawChunkIterator
+{
+public:
+    typedef QSharedPointer<FiffRawChunkIterator> SPtr;               /**< Shared pointer type for FiffRawChunkIterator. */
+    typedef QSharedPointer<const FiffRawChunkIterator> ConstSPtr;    /**< Const shared pointer type for FiffRawChunkIterator. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the iterator and starts reading ahead.
+    *
+    * @param[in] p_FiffRawData  The raw data set up by FiffStream::setup_read_raw.
+    * @param[in] iChunkSize     Number of samples per chunk. Defaults to the number of samples of the first raw
+    *                           buffer. Chunks start at from, they are not aligned with the raw buffers (optional).
+    * @param[in] sel            Channel selection vector (optional).
+    * @param[in] from           First sample to include. Defaults to the first sample in data (optional).
+    * @param[in] to             Last sample to include. Defaults to the last sample in data (optional).
+    * @param[in] iMaxBytes      Memory cap for the data matrices in the ring. The times and the chunk held by the
+    *                           caller are not counted. At least two slots are used, even if they exceed the cap (optional).
+    */
+    explicit FiffRawChunkIterator(const FiffRawData &p_FiffRawData,
+                                  fiff_int_t iChunkSize = -1,
+                                  const RowVectorXi &sel = defaultRowVectorXi,
+                                  fiff_int_t from = -1,
+                                  fiff_int_t to = -1,
+                                  qint64 iMaxBytes = 64*1024*1024);
+
+    //=========================================================================================================
+    /**
+    * Stops the read-ahead thread and destroys the iterator.
+    */
+    ~FiffRawChunkIterator();
+
+    //=========================================================================================================
+    /**
+    * Returns the next chunk. Blocks until the read-ahead thread has decoded it. The storage of data and times
+    * is exchanged with the ring. Passing the matrices of the previous call lets the read-ahead thread refill them
+    * without reallocation, as long as the chunk size does not change and the file is mapped.
+    *
+    * @param[out] data      returns the data matrix (channels x samples)
+    * @param[out] times     returns the time values corresponding to the samples
+    * @param[out] first     returns the first sample of the chunk
+    * @param[out] last      returns the last sample of the chunk
+    *
+    * @return true if a chunk was returned, false once all decoded chunks were handed out and the end of the data
+    *         was reached, reading failed or stop() was called.
+    */
+    bool next(MatrixXd& data,
+              MatrixXd& times,
+              fiff_int_t& first,
+              fiff_int_t& last);
+
+    //=========================================================================================================
+    /**
+    * Stops reading ahead. Chunks already decoded can still be fetched with next().
+    */
+    void stop();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of chunks which are decoded ahead at most.
+    *
+    * @return the number of ring slots.
+    */
+    inline qint32 numSlots() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples per chunk.
+    *
+    * @return the chunk size.
+    */
+    inline fiff_int_t chunkSize() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * The producer loop, which runs in the read-ahead thread.
+    */
+    void readAhead();
+
+    //=========================================================================================================
+    /**
+    * Thread running FiffRawChunkIterator::readAhead.
+    */
+    class ReadAheadThread : public QThread
+    {
+    public:
+        explicit ReadAheadThread(FiffRawChunkIterator* pIterator) : m_pIterator(pIterator) {}
+    protected:
+        void run() { m_pIterator->readAhead(); }
+    private:
+        FiffRawChunkIterator* m_pIterator;
+    };
+
+    //=========================================================================================================
+    /**
+    * One decoded chunk.
+    */
+    struct Chunk {
+        MatrixXd    data;       /**< The data matrix (channels x samples) */
+        MatrixXd    times;      /**< The time values */
+        fiff_int_t  first;      /**< First sample */
+        fiff_int_t  last;       /**< Last sample */
+    };
+
+    FiffRawMappedReader     m_reader;           /**< Reader decoding the chunks */
+    RowVectorXi             m_vecSel;           /**< Channel selection */
+    fiff_int_t              m_iFrom;            /**< First sample to read */
+    fiff_int_t              m_iTo;              /**< Last sample to read */
+    fiff_int_t              m_iChunkSize;       /**< Samples per chunk */
+
+    QVector<Chunk>          m_qVecRing;         /**< Ring of decoded chunks */
+    qint32                  m_iHead;            /**< Ring slot of the next chunk handed out by next() */
+    qint32                  m_iCount;           /**< Number of decoded chunks in the ring */
+    bool                    m_bStop;            /**< Whether the read-ahead thread is requested to stop */
+    bool                    m_bFinished;        /**< Whether the read-ahead thread is done */
+
+    QMutex                  m_mutex;            /**< Guards the ring state */
+    QWaitCondition          m_condNotFull;      /**< Signaled when a ring slot becomes free */
+    QWaitCondition          m_condNotEmpty;     /**< Signaled when a chunk was decoded or reading finished */
+
+    ReadAheadThread         m_thread;           /**< The read-ahead thread */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 FiffRawChunkIterator::numSlots() const
+{
+    return m_qVecRing.size();
+}
+
+
+//*************************************************************************************************************
+
+inline fiff_int_t FiffRawChunkIterator::chunkSize() const
+{
+    return m_iChunkSize;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_CHUNK_ITERATOR_H
@@ -43,6 +43,8 @@
 #include "fiff_stream.h"
 #include "cstdlib"
 
+#include <QMutexLocker>
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -59,6 +61,7 @@ using namespace FIFFLIB;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, m_pReadOperatorMutex(new QMutex)
 {
 
 }
@@ -69,6 +72,7 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, m_pReadOperatorMutex(new QMutex)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -91,6 +95,8 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , rawdir(p_FiffRawData.rawdir)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, m_pReadOperatorMutex(new QMutex)
+, m_pReadOperator(p_FiffRawData.m_pReadOperator)
 {
 
 }
@@ -115,6 +121,23 @@ void FiffRawData::clear()
     rawdir.clear();
     proj = MatrixXd();
     comp.clear();
+
+    QMutexLocker locker(m_pReadOperatorMutex.data());
+    m_pReadOperator.clear();
+}
+
+
+//*************************************************************************************************************
+
+FiffRawReadOperator::ConstSPtr FiffRawData::read_operator(const RowVectorXi& sel) const
+{
+    QMutexLocker locker(m_pReadOperatorMutex.data());
+
+    if(!m_pReadOperator || !m_pReadOperator->matches(*this, sel)) {
+        m_pReadOperator = FiffRawReadOperator::ConstSPtr(new FiffRawReadOperator(*this, sel));
+    }
+
+    return m_pReadOperator;
 }
 
 
@@ -127,11 +150,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    const RowVectorXi& sel,
                                    bool do_debug) const
 {
-    bool projAvailable = true;
-
     if (this->proj.size() == 0) {
         qDebug() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
     }
 
     if(from == -1)
@@ -159,91 +179,17 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     qint32 dest  = 0;//1;
     qint32 i, k, r;
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
-
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
-
-    MatrixXd mult_full;
     //
+    //  Calibration, compensation and projection are only rebuilt if sel, proj, comp or cals changed
+    //
+    FiffRawReadOperator::ConstSPtr pReadOperator = this->read_operator(sel);
+    const SparseMatrix<double>& cal = pReadOperator->cal();
+    const SparseMatrix<double>& mult = pReadOperator->mult();
+
     if (sel.size() == 0)
-    {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
-    }
+        data.resize(nchan, to-from+1);
     else
-    {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
-
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
-    }
-
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
+        data.resize(sel.size(), to-from+1);
 
     //
 
@@ -461,11 +407,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    const RowVectorXi& sel,
                                    bool do_debug) const
 {
-    bool projAvailable = true;
-
     if (this->proj.size() == 0) {
         qDebug() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
     }
 
     if(from == -1)
@@ -493,91 +436,17 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     qint32 dest  = 0;//1;
     qint32 i, k, r;
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
-
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
-
-    MatrixXd mult_full;
     //
+    //  Calibration, compensation and projection are only rebuilt if sel, proj, comp or cals changed
+    //
+    FiffRawReadOperator::ConstSPtr pReadOperator = this->read_operator(sel);
+    const SparseMatrix<double>& cal = pReadOperator->cal();
+    const SparseMatrix<double>& mult = pReadOperator->mult();
+
     if (sel.size() == 0)
-    {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
-    }
+        data.resize(nchan, to-from+1);
     else
-    {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
-
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
-    }
-
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
+        data.resize(sel.size(), to-from+1);
 
     //
 
@@ -44,6 +44,7 @@
 #include "fiff_global.h"
 #include "fiff_info.h"
 #include "fiff_raw_dir.h"
+#include "fiff_raw_read_operator.h"
 #include "fiff_stream.h"
 
 
@@ -62,6 +63,7 @@
 //=============================================================================================================
 
 #include <QList>
+#include <QMutex>
 #include <QSharedPointer>
 
 
@@ -205,6 +207,18 @@ public:
                                 float to,
                                 const RowVectorXi& sel = defaultRowVectorXi) const;
 
+    //=========================================================================================================
+    /**
+    * Returns the calibration, compensation and projection operator used by read_raw_segment for the given
+    * selection. The operator is cached and only rebuilt if sel, proj, comp or cals changed since the last call.
+    * The returned operator is immutable and may be kept by the caller.
+    *
+    * @param[in] sel        channel selection vector (optional)
+    *
+    * @return the read operator.
+    */
+    FiffRawReadOperator::ConstSPtr read_operator(const RowVectorXi& sel = defaultRowVectorXi) const;
+
 public:
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
@@ -214,6 +228,10 @@ public:
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
     MatrixXd proj;              /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
+
+private:
+    mutable QSharedPointer<QMutex>          m_pReadOperatorMutex;   /**< Guards m_pReadOperator. */
+    mutable FiffRawReadOperator::ConstSPtr  m_pReadOperator;        /**< Operator of the last read_raw_segment call. */
 };
 
 } // NAMESPACE
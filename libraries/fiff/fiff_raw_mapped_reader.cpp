@@ -0,0 +1,391 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_mapped_reader.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawMappedReader Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_mapped_reader.h"
+#include "fiff_file.h"
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC FUNCTIONS
+//=============================================================================================================
+
+namespace {
+
+//Size of the tag header (kind, type, size, next) preceding the tag data
+const qint64 TAG_HEADER_SIZE = 4*sizeof(fiff_int_t);
+
+template<typename T> inline double decodeSample(const uchar* p);
+
+template<> inline double decodeSample<qint16>(const uchar* p)
+{
+    return qFromBigEndian<qint16>(p);
+}
+
+template<> inline double decodeSample<qint32>(const uchar* p)
+{
+    return qFromBigEndian<qint32>(p);
+}
+
+template<> inline double decodeSample<float>(const uchar* p)
+{
+    quint32 word = qFromBigEndian<quint32>(p);
+    float value;
+    std::memcpy(&value, &word, sizeof(float));
+    return value;
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Converts the picked samples of one big endian buffer into a column major destination.
+*
+* @param[in] pBuffer    start of the buffer samples in the mapped file (nchan x nsamp, channels running fastest)
+* @param[in] nchan      number of channels stored in the buffer
+* @param[in] firstPick  first sample of the buffer to convert
+* @param[in] picksamp   number of samples to convert
+* @param[in] pSel       channel selection with nrows entries, NULL to convert all channels
+* @param[in] pCals      calibration with nrows entries, NULL to leave the samples uncalibrated
+* @param[in] nrows      number of rows of the destination
+* @param[out] pDest     first destination column
+*/
+template<typename T>
+void decodeBuffer(const uchar* pBuffer,
+                  qint32 nchan,
+                  qint32 firstPick,
+                  qint32 picksamp,
+                  const int* pSel,
+                  const double* pCals,
+                  qint32 nrows,
+                  double* pDest)
+{
+    for(qint32 c = 0; c < picksamp; ++c) {
+        const uchar* pCol = pBuffer + static_cast<size_t>(firstPick + c) * nchan * sizeof(T);
+        double* pDestCol = pDest + static_cast<size_t>(c) * nrows;
+
+        if(pSel) {
+            if(pCals) {
+                for(qint32 r = 0; r < nrows; ++r) {
+                    pDestCol[r] = pCals[r] * decodeSample<T>(pCol + pSel[r] * sizeof(T));
+                }
+            } else {
+                for(qint32 r = 0; r < nrows; ++r) {
+                    pDestCol[r] = decodeSample<T>(pCol + pSel[r] * sizeof(T));
+                }
+            }
+        } else {
+            if(pCals) {
+                for(qint32 r = 0; r < nrows; ++r) {
+                    pDestCol[r] = pCals[r] * decodeSample<T>(pCol + r * sizeof(T));
+                }
+            } else {
+                for(qint32 r = 0; r < nrows; ++r) {
+                    pDestCol[r] = decodeSample<T>(pCol + r * sizeof(T));
+                }
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool decodeBuffer(fiff_int_t type,
+                  const uchar* pBuffer,
+                  qint32 nchan,
+                  qint32 firstPick,
+                  qint32 picksamp,
+                  const int* pSel,
+                  const double* pCals,
+                  qint32 nrows,
+                  double* pDest)
+{
+    switch(type) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            decodeBuffer<qint16>(pBuffer, nchan, firstPick, picksamp, pSel, pCals, nrows, pDest);
+            return true;
+        case FIFFT_INT:
+            decodeBuffer<qint32>(pBuffer, nchan, firstPick, picksamp, pSel, pCals, nrows, pDest);
+            return true;
+        case FIFFT_FLOAT:
+            decodeBuffer<float>(pBuffer, nchan, firstPick, picksamp, pSel, pCals, nrows, pDest);
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+qint32 sampleSize(fiff_int_t type)
+{
+    switch(type) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            return 2;
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawMappedReader::FiffRawMappedReader(const FiffRawData &p_FiffRawData)
+: m_FiffRawData(p_FiffRawData)
+, m_pMapped(Q_NULLPTR)
+{
+    if(!init()) {
+        qWarning() << "FiffRawMappedReader::FiffRawMappedReader - Could not map" << m_FiffRawData.info.filename << "- Falling back to FiffRawData::read_raw_segment.";
+    }
+}
+
+
+//*************************************************************************************************************
+
+FiffRawMappedReader::~FiffRawMappedReader()
+{
+    if(m_pMapped) {
+        m_file.unmap(m_pMapped);
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawMappedReader::init()
+{
+    if(m_FiffRawData.isEmpty() || !m_FiffRawData.file) {
+        return false;
+    }
+
+    //
+    //   Open a separate handle on the file the stream reads from
+    //
+    QFile* t_pFile = qobject_cast<QFile*>(m_FiffRawData.file->device());
+    m_file.setFileName(t_pFile ? t_pFile->fileName() : m_FiffRawData.info.filename);
+
+    if(!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = m_file.size();
+    uchar* pMapped = m_file.map(0, fileSize);
+    if(!pMapped) {
+        m_file.close();
+        return false;
+    }
+
+    //
+    //   Index the raw directory once
+    //
+    const qint32 nchan = m_FiffRawData.info.nchan;
+    qint32 maxNSamp = 0;
+
+    m_qVecBuffers.reserve(m_FiffRawData.rawdir.size());
+
+    for(qint32 k = 0; k < m_FiffRawData.rawdir.size(); ++k) {
+        const FiffRawDir& thisRawDir = m_FiffRawData.rawdir[k];
+
+        BufferEntry entry;
+        entry.first = thisRawDir.first;
+        entry.last = thisRawDir.last;
+        entry.nsamp = thisRawDir.nsamp;
+        entry.type = -1;
+        entry.pData = Q_NULLPTR;
+
+        if(thisRawDir.ent && thisRawDir.ent->kind != -1) {
+            const qint64 dataPos = static_cast<qint64>(thisRawDir.ent->pos) + TAG_HEADER_SIZE;
+            const qint64 dataSize = static_cast<qint64>(sampleSize(thisRawDir.ent->type)) * nchan * thisRawDir.nsamp;
+
+            if(dataSize == 0 || dataSize > thisRawDir.ent->size || dataPos + dataSize > fileSize) {
+                qWarning() << "FiffRawMappedReader::init - Raw buffer" << k << "of type" << thisRawDir.ent->type << "cannot be mapped.";
+                m_qVecBuffers.clear();
+                m_file.unmap(pMapped);
+                m_file.close();
+                return false;
+            }
+
+            entry.type = thisRawDir.ent->type;
+            entry.pData = pMapped + dataPos;
+        }
+
+        maxNSamp = qMax(maxNSamp, thisRawDir.nsamp);
+        m_qVecBuffers.append(entry);
+    }
+
+    //The mapping stays valid after closing the handle
+    m_file.close();
+    m_pMapped = pMapped;
+
+    m_matScratch.resize(nchan, maxNSamp);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawMappedReader::read_raw_segment(MatrixXd& data,
+                                           MatrixXd& times,
+                                           fiff_int_t from,
+                                           fiff_int_t to,
+                                           const RowVectorXi& sel)
+{
+    if(!isMapped()) {
+        return m_FiffRawData.read_raw_segment(data, times, from, to, sel);
+    }
+
+    if(from == -1)
+        from = m_FiffRawData.first_samp;
+    if(to == -1)
+        to = m_FiffRawData.last_samp;
+    //
+    //  Initial checks
+    //
+    if(from < m_FiffRawData.first_samp)
+        from = m_FiffRawData.first_samp;
+    if(to > m_FiffRawData.last_samp)
+        to = m_FiffRawData.last_samp;
+    //
+    if(from > to) {
+        printf("No data in this range %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/m_FiffRawData.info.sfreq, ((float)to)/m_FiffRawData.info.sfreq);
+        return false;
+    }
+
+    FiffRawReadOperator::ConstSPtr pReadOperator = m_FiffRawData.read_operator(sel);
+
+    const qint32 nchan = m_FiffRawData.info.nchan;
+    const qint32 nrows = sel.size() == 0 ? nchan : sel.size();
+    const qint32 ncols = to - from + 1;
+
+    //
+    //  Only reallocate if the caller did not provide matching matrices
+    //
+    if(data.rows() != nrows || data.cols() != ncols) {
+        data.resize(nrows, ncols);
+    }
+    if(times.rows() != 1 || times.cols() != ncols) {
+        times.resize(1, ncols);
+    }
+
+    const int* pSel = sel.size() == 0 ? Q_NULLPTR : sel.data();
+    const bool bApplyMult = pReadOperator->hasMult();
+
+    //
+    //  Find the first buffer we need
+    //
+    qint32 k = 0;
+    qint32 lo = 0, hi = m_qVecBuffers.size();
+    while(lo < hi) {
+        qint32 mid = (lo + hi) / 2;
+        if(m_qVecBuffers[mid].last < from) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    k = lo;
+
+    qint32 dest = 0;
+    for(; k < m_qVecBuffers.size() && dest < ncols; ++k) {
+        const BufferEntry& entry = m_qVecBuffers[k];
+
+        const qint32 first_pick = qMax(from - entry.first, 0);
+        const qint32 last_pick = qMin(to, entry.last) - entry.first;
+        const qint32 picksamp = last_pick - first_pick + 1;
+
+        if(picksamp <= 0) {
+            continue;
+        }
+
+        if(!entry.pData) {
+            //
+            //  Skip is translated to zeros
+            //
+            data.middleCols(dest, picksamp).setZero();
+        } else if(bApplyMult) {
+            decodeBuffer(entry.type, entry.pData, nchan, first_pick, picksamp,
+                         Q_NULLPTR, Q_NULLPTR, nchan, m_matScratch.data());
+            data.middleCols(dest, picksamp).noalias() = pReadOperator->mult() * m_matScratch.leftCols(picksamp);
+        } else {
+            decodeBuffer(entry.type, entry.pData, nchan, first_pick, picksamp,
+                         pSel, pReadOperator->cals().data(), nrows, data.col(dest).data());
+        }
+
+        dest += picksamp;
+    }
+
+    for(qint32 i = 0; i < ncols; ++i) {
+        times(0, i) = ((float)(from+i)) / m_FiffRawData.info.sfreq;
+    }
+
+    return true;
+}
@@ -0,0 +1,201 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_mapped_reader.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawMappedReader class declaration.
+*
+*/
+
+#ifndef FIFF_RAW_MAPPED_READER_H
+#define FIFF_RAW_MAPPED_READER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_raw_data.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QVector>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Memory-mapped reader for fiff raw data. The raw directory is indexed once on construction and all subsequent
+* segment reads decode the buffers directly from the mapped file into the caller's output matrix. No FiffTag is
+* created, no per-buffer heap allocation takes place and the big endian samples are converted on the fly while
+* they are written to the destination. Calibration, compensation and projection are taken from the cached
+* FiffRawData::read_operator of the reader's copy of the raw data, use raw() to change proj or comp. If the file
+* cannot be mapped, read_raw_segment falls back to FiffRawData::read_raw_segment.
+*
+* @brief Zero-copy memory-mapped fiff raw data reader
+*/
+class FIFFSHARED_EXPORT FiffRawMappedReader
+{
+public:
+    typedef QSharedPointer<FiffRawMappedReader> SPtr;               /**< Shared pointer type for FiffRawMappedReader. */
+    typedef QSharedPointer<const FiffRawMappedReader> ConstSPtr;    /**< Const shared pointer type for FiffRawMappedReader. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the reader, maps the file the raw data was read from and indexes its raw directory.
+    *
+    * @param[in] p_FiffRawData  The raw data set up by FiffStream::setup_read_raw.
+    */
+    explicit FiffRawMappedReader(const FiffRawData &p_FiffRawData);
+
+    //=========================================================================================================
+    /**
+    * Unmaps the file and destroys the reader.
+    */
+    ~FiffRawMappedReader();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the raw file is mapped and all buffers of the raw directory could be indexed.
+    *
+    * @return true if the mapped read path is used, false if reads fall back to FiffRawData::read_raw_segment.
+    */
+    inline bool isMapped() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the raw data this reader was set up for. Projector and compensator set here are picked up by the
+    * next read.
+    *
+    * @return the raw data.
+    */
+    inline FiffRawData& raw();
+
+    //=========================================================================================================
+    /**
+    * Read a specific raw data segment directly from the mapped file. The output matrices are only reallocated
+    * if their size does not match the requested segment, so repeated reads of equally sized segments do not
+    * allocate.
+    *
+    * @param[out] data      returns the data matrix (channels x samples)
+    * @param[out] times     returns the time values corresponding to the samples
+    * @param[in] from       first sample to include. If omitted, defaults to the first sample in data (optional)
+    * @param[in] to         last sample to include. If omitted, defaults to the last sample in data (optional)
+    * @param[in] sel        channel selection vector (optional)
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_raw_segment(MatrixXd& data,
+                          MatrixXd& times,
+                          fiff_int_t from = -1,
+                          fiff_int_t to = -1,
+                          const RowVectorXi& sel = defaultRowVectorXi);
+
+private:
+    //=========================================================================================================
+    /**
+    * Maps the file and builds the buffer index.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool init();
+
+    //=========================================================================================================
+    /**
+    * Index entry of one raw buffer inside the mapped file.
+    */
+    struct BufferEntry {
+        fiff_int_t      first;      /**< First sample of the buffer */
+        fiff_int_t      last;       /**< Last sample of the buffer */
+        fiff_int_t      nsamp;      /**< Number of samples */
+        fiff_int_t      type;       /**< Fiff data type of the samples, -1 for skips */
+        const uchar*    pData;      /**< Start of the big endian samples in the mapped file, NULL for skips */
+    };
+
+    FiffRawData             m_FiffRawData;      /**< The raw data this reader was set up for */
+    QFile                   m_file;             /**< Separate file handle, so the mapping does not interfere with the stream position */
+    uchar*                  m_pMapped;          /**< Start of the mapped file, NULL if not mapped */
+    QVector<BufferEntry>    m_qVecBuffers;      /**< Buffer index built from the raw directory */
+    MatrixXd                m_matScratch;       /**< Preallocated decode buffer (nchan x max nsamp) used when compensation or projection is applied */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffRawMappedReader::isMapped() const
+{
+    return m_pMapped != Q_NULLPTR;
+}
+
+
+//*************************************************************************************************************
+
+inline FiffRawData& FiffRawMappedReader::raw()
+{
+    return m_FiffRawData;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_MAPPED_READER_H
@@ -0,0 +1,182 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_read_operator.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawReadOperator Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_read_operator.h"
+#include "fiff_raw_data.h"
+
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC FUNCTIONS
+//=============================================================================================================
+
+namespace {
+
+template<typename Derived, typename OtherDerived>
+inline bool isEqual(const MatrixBase<Derived>& a, const MatrixBase<OtherDerived>& b)
+{
+    return a.rows() == b.rows() && a.cols() == b.cols() && a == b;
+}
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawReadOperator::FiffRawReadOperator(const FiffRawData &p_FiffRawData,
+                                         const RowVectorXi &sel)
+: m_vecSel(sel)
+, m_vecAllCals(p_FiffRawData.cals)
+, m_matProj(p_FiffRawData.proj)
+, m_iCompKind(p_FiffRawData.comp.kind)
+{
+    const bool projAvailable = m_matProj.size() > 0;
+    const bool compAvailable = m_iCompKind != -1;
+    const qint32 nchan = p_FiffRawData.info.nchan;
+    qint32 i, k;
+
+    if(compAvailable) {
+        m_matComp = p_FiffRawData.comp.data->data;
+    }
+
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
+
+    //
+    //  Calibration of the selected channels
+    //
+    if(sel.size() == 0) {
+        m_vecCals = m_vecAllCals.transpose();
+    } else {
+        m_vecCals.resize(sel.size());
+        for(i = 0; i < sel.size(); ++i) {
+            m_vecCals[i] = m_vecAllCals[sel[i]];
+        }
+    }
+
+    //
+    //  The selection is only applied to the calibration matrix if it is used on its own
+    //
+    const VectorXd& vecCal = (sel.size() > 0 && !projAvailable && !compAvailable) ? m_vecCals : VectorXd(m_vecAllCals.transpose());
+
+    tripletList.reserve(vecCal.size());
+    for(i = 0; i < vecCal.size(); ++i) {
+        tripletList.push_back(T(i, i, vecCal[i]));
+    }
+    m_matCal.resize(vecCal.size(), vecCal.size());
+    m_matCal.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    if(!projAvailable && !compAvailable) {
+        return;
+    }
+
+    //
+    //  Combine compensator, projector and calibration
+    //
+    MatrixXd matOp;
+    if(!projAvailable) {
+        matOp = m_matComp;
+    } else if(!compAvailable) {
+        matOp = m_matProj;
+    } else {
+        matOp = m_matProj * m_matComp;
+    }
+
+    MatrixXd mult_full;
+    if(sel.size() == 0) {
+        mult_full = matOp * m_vecAllCals.asDiagonal();
+    } else {
+        mult_full.resize(sel.size(), nchan);
+        for(i = 0; i < sel.size(); ++i) {
+            mult_full.row(i) = matOp.row(sel[i]).cwiseProduct(m_vecAllCals);
+        }
+    }
+
+    //
+    // Make mult sparse
+    //
+    tripletList.clear();
+    for(i = 0; i < mult_full.rows(); ++i) {
+        for(k = 0; k < mult_full.cols(); ++k) {
+            if(mult_full(i,k) != 0) {
+                tripletList.push_back(T(i, k, mult_full(i,k)));
+            }
+        }
+    }
+
+    m_matMult.resize(mult_full.rows(), mult_full.cols());
+    if(tripletList.size() > 0) {
+        m_matMult.setFromTriplets(tripletList.begin(), tripletList.end());
+    }
+    m_matMult.makeCompressed();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawReadOperator::matches(const FiffRawData &p_FiffRawData,
+                                  const RowVectorXi &sel) const
+{
+    if(!isEqual(m_vecSel, sel)
+       || m_iCompKind != p_FiffRawData.comp.kind
+       || !isEqual(m_vecAllCals, p_FiffRawData.cals)
+       || !isEqual(m_matProj, p_FiffRawData.proj)) {
+        return false;
+    }
+
+    if(m_iCompKind != -1 && !isEqual(m_matComp, p_FiffRawData.comp.data->data)) {
+        return false;
+    }
+
+    return true;
+}
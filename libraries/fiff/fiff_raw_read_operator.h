@@ -0,0 +1,218 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_read_operator.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawReadOperator class declaration.
+*
+*/
+
+#ifndef FIFF_RAW_READ_OPERATOR_H
+#define FIFF_RAW_READ_OPERATOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+class FiffRawData;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Immutable operator which is applied to every raw buffer read by FiffRawData::read_raw_segment. It combines
+* calibration, compensation and projection for one channel selection. The operator remembers the state it was
+* built from, so FiffRawData can keep it across reads and only rebuild it when sel, proj, comp or cals change.
+*
+* @brief Cached calibration, compensation and projection operator for raw segment reads
+*/
+class FIFFSHARED_EXPORT FiffRawReadOperator
+{
+public:
+    typedef QSharedPointer<FiffRawReadOperator> SPtr;               /**< Shared pointer type for FiffRawReadOperator. */
+    typedef QSharedPointer<const FiffRawReadOperator> ConstSPtr;    /**< Const shared pointer type for FiffRawReadOperator. */
+
+    //=========================================================================================================
+    /**
+    * Builds the read operator for the current projector, compensator and calibration of the raw data.
+    *
+    * @param[in] p_FiffRawData  The raw data.
+    * @param[in] sel            Channel selection vector, empty for all channels.
+    */
+    FiffRawReadOperator(const FiffRawData &p_FiffRawData,
+                        const RowVectorXi &sel = defaultRowVectorXi);
+
+    //=========================================================================================================
+    /**
+    * Checks whether this operator was built for the given selection and the current state of the raw data.
+    *
+    * @param[in] p_FiffRawData  The raw data.
+    * @param[in] sel            Channel selection vector, empty for all channels.
+    *
+    * @return true if the operator can be reused, false if it has to be rebuilt.
+    */
+    bool matches(const FiffRawData &p_FiffRawData,
+                 const RowVectorXi &sel = defaultRowVectorXi) const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether compensation or projection have to be applied, i.e. whether mult() is not empty.
+    *
+    * @return true if mult() has to be applied, false if the calibration is sufficient.
+    */
+    inline bool hasMult() const;
+
+    //=========================================================================================================
+    /**
+    * The full multiplication matrix (selected channels x all channels) including the calibration. Empty if
+    * neither a projector nor a compensator is set.
+    *
+    * @return the multiplication matrix.
+    */
+    inline const SparseMatrix<double>& mult() const;
+
+    //=========================================================================================================
+    /**
+    * The diagonal calibration matrix of the selected channels (all channels if mult() is not empty).
+    *
+    * @return the calibration matrix.
+    */
+    inline const SparseMatrix<double>& cal() const;
+
+    //=========================================================================================================
+    /**
+    * The calibration factors of the selected channels.
+    *
+    * @return the calibration vector.
+    */
+    inline const VectorXd& cals() const;
+
+    //=========================================================================================================
+    /**
+    * The channel selection this operator was built for.
+    *
+    * @return the selection, empty for all channels.
+    */
+    inline const RowVectorXi& sel() const;
+
+private:
+    RowVectorXi             m_vecSel;           /**< Channel selection the operator was built for */
+    RowVectorXd             m_vecAllCals;       /**< Calibration of all channels at build time */
+    MatrixXd                m_matProj;          /**< Projector at build time */
+    fiff_int_t              m_iCompKind;        /**< Compensator kind at build time */
+    MatrixXd                m_matComp;          /**< Compensator data at build time */
+
+    VectorXd                m_vecCals;          /**< Calibration of the selected channels */
+    SparseMatrix<double>    m_matCal;           /**< Diagonal calibration matrix */
+    SparseMatrix<double>    m_matMult;          /**< Compensator, projection and calibration */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffRawReadOperator::hasMult() const
+{
+    return m_matMult.cols() > 0;
+}
+
+
+//*************************************************************************************************************
+
+inline const SparseMatrix<double>& FiffRawReadOperator::mult() const
+{
+    return m_matMult;
+}
+
+
+//*************************************************************************************************************
+
+inline const SparseMatrix<double>& FiffRawReadOperator::cal() const
+{
+    return m_matCal;
+}
+
+
+//*************************************************************************************************************
+
+inline const VectorXd& FiffRawReadOperator::cals() const
+{
+    return m_vecCals;
+}
+
+
+//*************************************************************************************************************
+
+inline const RowVectorXi& FiffRawReadOperator::sel() const
+{
+    return m_vecSel;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_READ_OPERATOR_H
@@ -43,6 +43,7 @@
 #include "fwd_eeg_sphere_model.h"
 #include <mne/c/mne_surface_old.h>
 #include <mne/c/mne_triangle.h>
+#include <mne/c/mne_surface_bvh.h>
 #include <mne/c/mne_source_space_old.h>
 
 #include "fwd_comp_data.h"
@@ -52,9 +53,17 @@
 
 #include <fiff/fiff_stream.h>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QList>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QThread>
+#include <QThreadStorage>
 #include <QtConcurrent>
 
 #define _USE_MATH_DEFINES
@@ -67,6 +76,16 @@ static float Qx[] = {1.0,0.0,0.0};
 static float Qy[] = {0.0,1.0,0.0};
 static float Qz[] = {0.0,0.0,1.0};
 
+#define FWD_BEM_BLOCK_SIZE 64   /* Number of dipoles evaluated together in the block computations */
+
+#define FWD_BEM_ASSEMBLY_BLOCK 128  /* Tile size used when filling the coefficient matrices */
+
+#define FWD_BEM_CACHE_MAGIC   0x4d42534c    /* Identifies a cached BEM solution file */
+#define FWD_BEM_CACHE_VERSION 1             /* Increment whenever the solution computation or the file layout changes */
+#define FWD_BEM_CACHE_SUFFIX  "-bem-sol.cache"
+#define FWD_BEM_CACHE_SIZE_MB 2048          /* Default size limit of each cache directory */
+#define FWD_BEM_CACHE_SIZE_ENV "MNE_CPP_CACHE_SIZE"  /* Overrides the size limit (in MB), 0 disables the caches */
+
 
 #ifndef TRUE
 #define TRUE 1
@@ -214,14 +233,21 @@ void fromFloatEigenMatrix_40(const Eigen::MatrixXf& from_mat, float **& to_mat)
 
 float **mne_lu_invert_40(float **mat,int dim)
 /*
-      * Invert a matrix using the LU decomposition from
-      * LAPACK
+      * Invert a matrix using the LU decomposition.
+      * The decomposition is done in place in the contiguous storage of mat,
+      * the inverse is solved directly into a new matrix and mat is freed.
+      * The blocked LU and the triangular solves run multithreaded if OpenMP is available.
       */
 {
-    Eigen::MatrixXf eigen_mat = toFloatEigenMatrix_40(mat, dim, dim);
-    Eigen::MatrixXf eigen_mat_inv = eigen_mat.inverse();
-    fromFloatEigenMatrix_40(eigen_mat_inv, mat);
-    return mat;
+    typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> MatrixXfRowMajor;
+
+    Eigen::Map<MatrixXfRowMajor> eigen_mat(mat[0],dim,dim);
+    Eigen::PartialPivLU<Eigen::Ref<MatrixXfRowMajor> > lu(eigen_mat);
+
+    float **inv = ALLOC_CMATRIX_40(dim,dim);
+    Eigen::Map<MatrixXfRowMajor>(inv[0],dim,dim) = lu.inverse();
+    FREE_CMATRIX_40(mat);
+    return inv;
 }
 
 
@@ -455,6 +481,46 @@ using namespace MNELIB;
 using namespace FWDLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixXfRowMajor;
+
+struct FwdBemBlockWork {
+    VectorXf            v0;     /* Infinite-medium potentials of a single dipole */
+    MatrixXf            V0;     /* Infinite-medium potentials of the dipole block */
+    MatrixXfRowMajor    res;    /* Solution of the dipole block, one row per dipole orientation */
+};
+
+static FwdBemBlockWork& fwd_bem_block_work()
+/*
+ * The BEM computations use a workspace of the calling thread, the model itself stays read only
+ */
+{
+    static QThreadStorage<FwdBemBlockWork*> s_workStorage;
+
+    if (!s_workStorage.hasLocalData())
+        s_workStorage.setLocalData(new FwdBemBlockWork());
+    return *s_workStorage.localData();
+}
+
+
+static float *fwd_bem_thread_v0(int nsol)
+/*
+ * Space for the infinite-medium potentials of one dipole, private to the calling thread.
+ * This keeps the single dipole computations reentrant, several threads may share one model.
+ */
+{
+    FwdBemBlockWork& work = fwd_bem_block_work();
+
+    if (work.v0.size() < nsol)
+        work.v0.resize(nsol);
+    return work.v0.data();
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -1117,10 +1183,7 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
     float **sub_mat = NULL;
     int   np1,np2,ntri,np_tot,np_max;
     float **nodes;
-    MneTriangle*   tri;
-    double omega[3];
-    double *row = NULL;
-    int    j,k,p,q,c;
+    int    j,k,p,q;
     int    joff,koff;
     MneSurfaceOld* surf1;
     MneSurfaceOld* surf2;
@@ -1135,7 +1198,6 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
     for (j = 0; j < np_tot; j++)
         for (k = 0; k < np_tot; k++)
             mat[j][k] = 0.0;
-    row        = MALLOC_40(np_max,double);
     sub_mat = MALLOC_40(np_max,float *);
     for (p = 0, joff = 0; p < surfs.size(); p++, joff = joff + np1) {
         surf1 = surfs[p];
@@ -1150,25 +1212,42 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
                     fwd_bem_explain_surface(surf1->id).toUtf8().constData(),np1,
                     fwd_bem_explain_surface(surf2->id).toUtf8().constData(),np2);
 
-            for (j = 0; j < np1; j++) {
-                for (k = 0; k < np2; k++)
-                    row[k] = 0.0;
-                for (k = 0, tri = surf2->tris; k < ntri; k++,tri++) {
-                    /*
-               * No contribution from a triangle that
-               * this vertex belongs to
-               */
-                    if (p == q && (tri->vert[0] == j || tri->vert[1] == j || tri->vert[2] == j))
-                        continue;
-                    /*
-               * Otherwise do the hard job
-               */
-                    lin_pot_coeff (nodes[j],tri,omega);
-                    for (c = 0; c < 3; c++)
-                        row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
+            /*
+             * The rows are independent, each thread accumulates into its own row buffer
+             */
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                double      *row = MALLOC_40(np2,double);
+                double      omega[3];
+                MneTriangle *tri;
+                int         jj,kk,c;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,16)
+#endif
+                for (jj = 0; jj < np1; jj++) {
+                    for (kk = 0; kk < np2; kk++)
+                        row[kk] = 0.0;
+                    for (kk = 0, tri = surf2->tris; kk < ntri; kk++,tri++) {
+                        /*
+                 * No contribution from a triangle that
+                 * this vertex belongs to
+                 */
+                        if (p == q && (tri->vert[0] == jj || tri->vert[1] == jj || tri->vert[2] == jj))
+                            continue;
+                        /*
+                 * Otherwise do the hard job
+                 */
+                        lin_pot_coeff (nodes[jj],tri,omega);
+                        for (c = 0; c < 3; c++)
+                            row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
+                    }
+                    for (kk = 0; kk < np2; kk++)
+                        mat[jj+joff][kk+koff] = row[kk];
                 }
-                for (k = 0; k < np2; k++)
-                    mat[j+joff][k+koff] = row[k];
+                FREE_40(row);
             }
             if (p == q) {
                 for (j = 0; j < np1; j++)
@@ -1178,7 +1257,6 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
             fprintf(stderr,"[done]\n");
         }
     }
-    FREE_40(row);
     FREE_40(sub_mat);
     return(mat);
 }
@@ -1207,7 +1285,9 @@ int FwdBemModel::fwd_bem_linear_collocation_solution(FwdBemModel *m)
         m->nsol += m->surfs[k]->np;
 
     fprintf (stderr,"\tInverting the coefficient matrix...\n");
-    if ((m->solution = fwd_bem_multi_solution (coeff,m->gamma,m->nsurf,m->np)) == NULL)
+    m->solution = fwd_bem_multi_solution (coeff,m->gamma,m->nsurf,m->np);
+    coeff = NULL;
+    if (m->solution == NULL)
         goto bad;
 
     /*
@@ -1226,7 +1306,9 @@ int FwdBemModel::fwd_bem_linear_collocation_solution(FwdBemModel *m)
             goto bad;
 
         fprintf (stderr,"\tInverting the coefficient matrix (homog)...\n");
-        if ((ip_solution = fwd_bem_homog_solution (coeff,m->surfs[m->nsurf-1]->np)) == NULL)
+        ip_solution = fwd_bem_homog_solution (coeff,m->surfs[m->nsurf-1]->np);
+        coeff = NULL;
+        if (ip_solution == NULL)
             goto bad;
 
         fprintf (stderr,"\tModify the original solution to incorporate IP approach...\n");
@@ -1254,7 +1336,7 @@ float **FwdBemModel::fwd_bem_multi_solution(float **solids, float **gamma, int n
 /*
           * Invert I - solids/(2*M_PI)
           * Take deflation into account
-          * The matrix is destroyed after inversion
+          * The matrix is freed after inversion, the inverse is returned in a new matrix
           * This is the general multilayer case
           */
 {
@@ -1295,7 +1377,7 @@ float **FwdBemModel::fwd_bem_homog_solution(float **solids, int ntri)
 /*
           * Invert I - solids/(2*M_PI)
           * Take deflation into account
-          * The matrix is destroyed after inversion
+          * The matrix is freed after inversion, the inverse is returned in a new matrix
           * This is the homogeneous model case
           */
 {
@@ -1425,12 +1507,11 @@ float **FwdBemModel::fwd_bem_solid_angles(const QList<MneSurfaceOld*>& surfs)
 {
     MneSurfaceOld* surf1;
     MneSurfaceOld* surf2;
-    MneTriangle* tri;
     int ntri1,ntri2,ntri_tot;
-    int j,k,p,q;
+    int nblk1,nblk2,b;
+    int j,p,q;
     int joff,koff;
     float **solids;
-    float result;
     float **sub_solids = NULL;
     float desired;
 
@@ -1446,14 +1527,33 @@ float **FwdBemModel::fwd_bem_solid_angles(const QList<MneSurfaceOld*>& surfs)
             surf2 = surfs[q];
             ntri2 = surf2->ntri;
             fprintf(stderr,"\t\t%s (%d) -> %s (%d) ... ",fwd_bem_explain_surface(surf1->id).toUtf8().constData(),ntri1,fwd_bem_explain_surface(surf2->id).toUtf8().constData(),ntri2);
-            for (j = 0; j < ntri1; j++)
-                for (k = 0, tri = surf2->tris; k < ntri2; k++, tri++) {
-                    if (p == q && j == k)
-                        result = 0.0;
-                    else
-                        result = MneSurfaceOrVolume::solid_angle (surf1->tris[j].cent,tri);
-                    solids[j+joff][k+koff] = result;
+            /*
+             * Fill the matrix in tiles, the triangles of one tile stay in the cache
+             * while the rows of the tile are computed
+             */
+            nblk1 = (ntri1 + FWD_BEM_ASSEMBLY_BLOCK - 1)/FWD_BEM_ASSEMBLY_BLOCK;
+            nblk2 = (ntri2 + FWD_BEM_ASSEMBLY_BLOCK - 1)/FWD_BEM_ASSEMBLY_BLOCK;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (b = 0; b < nblk1*nblk2; b++) {
+                int   jstart = (b/nblk2)*FWD_BEM_ASSEMBLY_BLOCK;
+                int   kstart = (b%nblk2)*FWD_BEM_ASSEMBLY_BLOCK;
+                int   jend   = qMin(jstart + FWD_BEM_ASSEMBLY_BLOCK,ntri1);
+                int   kend   = qMin(kstart + FWD_BEM_ASSEMBLY_BLOCK,ntri2);
+                int   jj,kk;
+                float *row;
+
+                for (jj = jstart; jj < jend; jj++) {
+                    row = solids[jj+joff]+koff;
+                    for (kk = kstart; kk < kend; kk++) {
+                        if (p == q && jj == kk)
+                            row[kk] = 0.0;
+                        else
+                            row[kk] = MneSurfaceOrVolume::solid_angle (surf1->tris[jj].cent,surf2->tris+kk);
+                    }
                 }
+            }
             for (j = 0; j < ntri1; j++)
                 sub_solids[j] = solids[j+joff]+koff;
             fprintf(stderr,"[done]\n");
@@ -1498,7 +1598,9 @@ int FwdBemModel::fwd_bem_constant_collocation_solution(FwdBemModel *m)
         m->nsol += m->surfs[k]->ntri;
 
     fprintf (stderr,"\tInverting the coefficient matrix...\n");
-    if ((m->solution = fwd_bem_multi_solution (solids,m->gamma,m->nsurf,m->ntri)) == NULL)
+    m->solution = fwd_bem_multi_solution (solids,m->gamma,m->nsurf,m->ntri);
+    solids = NULL;
+    if (m->solution == NULL)
         goto bad;
     /*
        * IP approach?
@@ -1516,7 +1618,9 @@ int FwdBemModel::fwd_bem_constant_collocation_solution(FwdBemModel *m)
             goto bad;
 
         fprintf (stderr,"\tInverting the coefficient matrix (homog)...\n");
-        if ((ip_solution = fwd_bem_homog_solution (solids,m->surfs[m->nsurf-1]->ntri)) == NULL)
+        ip_solution = fwd_bem_homog_solution (solids,m->surfs[m->nsurf-1]->ntri);
+        solids = NULL;
+        if (ip_solution == NULL)
             goto bad;
 
         fprintf (stderr,"\tModify the original solution to incorporate IP approach...\n");
@@ -1590,7 +1694,216 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
     }
     if (bem_method == FWD_BEM_UNKNOWN)
         bem_method = FWD_BEM_LINEAR_COLL;
-    return fwd_bem_compute_solution(m,bem_method);
+    /*
+     * An unchanged model does not need to be recomputed
+     */
+    if (!force_recompute) {
+        if (fwd_bem_load_cached_solution(m,bem_method) == TRUE) {
+            fprintf(stderr,"\nLoaded cached %s BEM solution from %s\n",fwd_bem_explain_method(m->bem_method).toUtf8().constData(),m->sol_name.toUtf8().constData());
+            return OK;
+        }
+    }
+    if (fwd_bem_compute_solution(m,bem_method) == FAIL)
+        return FAIL;
+    /*
+     * Failing to store the solution is not an error
+     */
+    fwd_bem_save_cached_solution(m);
+    return OK;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FwdBemModel::fwd_bem_cache_limit()
+/*
+* Size limit of a cache directory in bytes. It applies to the BEM solution cache as well as to the
+* guess field cache of the dipole fit. The default can be changed with the MNE_CPP_CACHE_SIZE
+* environment variable (in MB), 0 disables the caches.
+*/
+{
+    QByteArray value = qgetenv(FWD_BEM_CACHE_SIZE_ENV);
+    qint64     limit = FWD_BEM_CACHE_SIZE_MB;
+    bool       ok;
+
+    if (!value.isEmpty()) {
+        limit = value.trimmed().toLongLong(&ok);
+        if (!ok || limit < 0) {
+            fprintf(stderr,"Invalid %s value %s, using %d MB\n",FWD_BEM_CACHE_SIZE_ENV,value.constData(),FWD_BEM_CACHE_SIZE_MB);
+            limit = FWD_BEM_CACHE_SIZE_MB;
+        }
+    }
+    return limit*1024*1024;
+}
+
+
+//*************************************************************************************************************
+
+QString FwdBemModel::fwd_bem_solution_cache_name(FwdBemModel *m, int bem_method)
+/*
+* Name of the cached solution file. It is derived from a hash of everything the solution depends on:
+* the surface geometry, the conductivities, the approximation method and the IP approach limit.
+*
+* The files live in <GenericCacheLocation>/mne-cpp/bem, e.g., ~/.cache/mne-cpp/bem on Linux. The directory
+* is kept below fwd_bem_cache_limit by dropping the least recently used solutions. It can be
+* cleared at any time by deleting the directory.
+*
+* An empty name is returned if there is no cache location available or the cache is disabled.
+*/
+{
+    QString cache_dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    MneSurfaceOld* surf;
+    qint32 val;
+    int    s,k;
+
+    if (cache_dir.isEmpty() || fwd_bem_cache_limit() == 0)
+        return QString();
+
+    val = FWD_BEM_CACHE_VERSION;
+    hash.addData((const char *)&val,sizeof(val));
+    hash.addData((const char *)&bem_method,sizeof(bem_method));
+    hash.addData((const char *)&m->ip_approach_limit,sizeof(m->ip_approach_limit));
+    hash.addData((const char *)m->sigma,m->nsurf*sizeof(float));
+    for (s = 0; s < m->nsurf; s++) {
+        surf = m->surfs[s];
+        hash.addData((const char *)&surf->np,sizeof(surf->np));
+        hash.addData((const char *)&surf->ntri,sizeof(surf->ntri));
+        for (k = 0; k < surf->np; k++)
+            hash.addData((const char *)surf->rr[k],3*sizeof(float));
+        for (k = 0; k < surf->ntri; k++)
+            hash.addData((const char *)surf->tris[k].vert,3*sizeof(int));
+    }
+    return QDir(cache_dir + "/mne-cpp/bem").filePath(QString(hash.result().toHex()) + FWD_BEM_CACHE_SUFFIX);
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_load_cached_solution(FwdBemModel *m, int bem_method)
+/*
+* Load a previously cached solution of this model:
+*
+* return values:
+*
+*       TRUE   found a matching solution
+*       FALSE  no matching solution in the cache
+*/
+{
+    QString     name = fwd_bem_solution_cache_name(m,bem_method);
+    float       **sol = NULL;
+    quint32     magic;
+    qint32      version,method,nsol;
+    int         k,dim;
+
+    if (name.isEmpty())
+        return FALSE;
+
+    QFile file(name);
+    if (!file.open(QIODevice::ReadOnly))
+        return FALSE;
+    QDataStream in(&file);
+
+    in >> magic >> version >> method >> nsol;
+    for (k = 0, dim = 0; k < m->nsurf; k++)
+        dim = dim + ((bem_method == FWD_BEM_LINEAR_COLL) ? m->surfs[k]->np : m->surfs[k]->ntri);
+    if (in.status() != QDataStream::Ok || magic != FWD_BEM_CACHE_MAGIC || version != FWD_BEM_CACHE_VERSION ||
+            method != bem_method || nsol != dim)
+        return FALSE;
+    /*
+     * Read row by row to stay clear of the int limit of readRawData
+     */
+    sol = ALLOC_CMATRIX_40(nsol,nsol);
+    for (k = 0; k < nsol; k++)
+        if (in.readRawData((char *)sol[k],nsol*sizeof(float)) != (int)(nsol*sizeof(float))) {
+            FREE_CMATRIX_40(sol);
+            return FALSE;
+        }
+    m->fwd_bem_free_solution();
+    m->sol_name   = name;
+    m->solution   = sol;
+    m->nsol       = nsol;
+    m->bem_method = method;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    /*
+     * Mark as recently used, the cache is pruned by modification time
+     */
+    file.setFileTime(QDateTime::currentDateTime(),QFileDevice::FileModificationTime);
+#endif
+    return TRUE;
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_save_cached_solution(FwdBemModel *m)
+/*
+* Store the solution of this model in the cache
+*/
+{
+    QString name;
+    int     k;
+
+    if (!m || !m->solution)
+        return FAIL;
+    name = fwd_bem_solution_cache_name(m,m->bem_method);
+    if (name.isEmpty() || !QDir().mkpath(QFileInfo(name).absolutePath()))
+        return FAIL;
+    /*
+     * A solution which alone exceeds the size limit is not cached
+     */
+    if ((qint64)m->nsol*m->nsol*(qint64)sizeof(float) > fwd_bem_cache_limit())
+        return FAIL;
+    /*
+     * Write to a temporary file first, a concurrent reader never sees a partial solution
+     */
+    QSaveFile file(name);
+    if (!file.open(QIODevice::WriteOnly))
+        return FAIL;
+    QDataStream out(&file);
+
+    out << (quint32)FWD_BEM_CACHE_MAGIC << (qint32)FWD_BEM_CACHE_VERSION << (qint32)m->bem_method << (qint32)m->nsol;
+    for (k = 0; k < m->nsol; k++)
+        if (out.writeRawData((const char *)m->solution[k],m->nsol*sizeof(float)) != (int)(m->nsol*sizeof(float))) {
+            file.cancelWriting();
+            return FAIL;
+        }
+    if (!file.commit())
+        return FAIL;
+    fprintf(stderr,"Cached the BEM solution in %s\n",name.toUtf8().constData());
+    fwd_bem_prune_cache(name,FWD_BEM_CACHE_SUFFIX);
+    return OK;
+}
+
+
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_bem_prune_cache(const QString& keep, const QString& suffix)
+/*
+* Remove the least recently used files ending with suffix from the directory of keep until they fit
+* into fwd_bem_cache_limit. The file just stored (keep) is never removed.
+*/
+{
+    QFileInfo     keep_info(keep);
+    qint64        limit = fwd_bem_cache_limit();
+    qint64        total = 0;
+    int           k;
+    /*
+     * Most recently used first
+     */
+    QFileInfoList files = keep_info.absoluteDir().entryInfoList(QStringList() << QString("*") + suffix,
+                                                                QDir::Files,
+                                                                QDir::Time);
+
+    for (k = 0; k < files.size(); k++) {
+        if (total + files[k].size() > limit && files[k].absoluteFilePath() != keep_info.absoluteFilePath()) {
+            if (QFile::remove(files[k].absoluteFilePath())) {
+                fprintf(stderr,"Removed the least recently used %s from the cache\n",files[k].absoluteFilePath().toUtf8().constData());
+                continue;
+            }
+        }
+        total += files[k].size();
+    }
 }
 
 
@@ -1643,6 +1956,7 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
     MneTriangle* tri;
     float       x,y,z;
     FwdBemSolution* sol;
+    MneSurfaceBvh*  bvh = NULL;
 
     if (!m) {
         printf("Model missing in fwd_bem_specify_els");
@@ -1664,6 +1978,8 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
     sol->ncoil = els->ncoil;
     sol->np    = m->nsol;
     sol->solution  = ALLOC_CMATRIX_40(sol->ncoil,sol->np);
+    scalp = m->surfs[0];
+    bvh   = new MneSurfaceBvh(scalp);
     /*
        * Go through all coils
        */
@@ -1672,7 +1988,6 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
         one_sol = sol->solution[k];
         for (q = 0; q < m->nsol; q++)
             one_sol[q] = 0.0;
-        scalp = m->surfs[0];
         /*
          * Go through all 'integration points'
          */
@@ -1680,7 +1995,7 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
             VEC_COPY_40(r,el->rmag[p]);
             if (m->head_mri_t != NULL)
                 FiffCoordTransOld::fiff_coord_trans(r,m->head_mri_t,FIFFV_MOVE);
-            best = MneSurfaceOrVolume::mne_project_to_surface(scalp,NULL,r,FALSE,&dist);
+            best = bvh->project_to_surface(NULL,r,FALSE,&dist);
             if (best < 0) {
                 printf("One of the electrodes could not be projected onto the scalp surface. How come?");
                 goto bad;
@@ -1715,9 +2030,11 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
             }
         }
     }
+    delete bvh;
     return OK;
 
 bad : {
+        delete bvh;
         els->fwd_free_coil_set_user_data();
         return FAIL;
     }
@@ -1746,9 +2063,7 @@ void FwdBemModel::fwd_bem_pot_grad_calc(float *rd, float *Q, FwdBemModel* m, Fwd
     grads[1] = ygrad;
     grads[2] = zgrad;
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -1803,9 +2118,7 @@ void FwdBemModel::fwd_bem_lin_pot_calc(float *rd, float *Q, FwdBemModel *m, FwdC
     float *v0;
     float **solution;
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -1858,9 +2171,7 @@ void FwdBemModel::fwd_bem_lin_pot_grad_calc(float *rd, float *Q, FwdBemModel *m,
     grads[1] = ygrad;
     grads[2] = zgrad;
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -1914,9 +2225,7 @@ void FwdBemModel::fwd_bem_pot_calc(float *rd, float *Q, FwdBemModel *m, FwdCoilS
     float       **solution;
     float       mri_rd[3],mri_Q[3];
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -2020,6 +2329,93 @@ int FwdBemModel::fwd_bem_pot_grad_els(float *rd, float *Q, FwdCoilSet *els, floa
 }
 
 
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_bem_inf_pot_block(float **rd, float **Q, int ndip, FwdBemModel *m, MatrixXf &V0)
+/*
+     * Infinite-medium potentials of a block of dipoles at the vertices (linear collocation)
+     * or at the triangle centers (constant collocation), one column per dipole orientation
+     */
+{
+    float *Qxyz[3] = { Qx, Qy, Qz };
+    int   nori = Q ? 1 : 3;
+    int   s,j,q,k,c,np;
+    float mult,mri_rd[3],mri_Q[3];
+    float *v0;
+    MneSurfaceOld* surf;
+
+    V0.resize(m->nsol,nori*ndip);
+    for (j = 0, c = 0; j < ndip; j++) {
+        VEC_COPY_40(mri_rd,rd[j]);
+        if (m->head_mri_t)
+            FiffCoordTransOld::fiff_coord_trans(mri_rd,m->head_mri_t,FIFFV_MOVE);
+        for (q = 0; q < nori; q++, c++) {
+            VEC_COPY_40(mri_Q,Q ? Q[j] : Qxyz[q]);
+            if (m->head_mri_t)
+                FiffCoordTransOld::fiff_coord_trans(mri_Q,m->head_mri_t,FIFFV_NO_MOVE);
+            v0 = V0.col(c).data();
+            for (s = 0; s < m->nsurf; s++) {
+                surf = m->surfs[s];
+                mult = m->source_mult[s];
+                if (m->bem_method == FWD_BEM_CONSTANT_COLL) {
+                    np = surf->ntri;
+                    for (k = 0; k < np; k++)
+                        *v0++ = mult*fwd_bem_inf_pot(mri_rd,mri_Q,surf->tris[k].cent);
+                }
+                else {
+                    np = surf->np;
+                    for (k = 0; k < np; k++)
+                        *v0++ = mult*fwd_bem_inf_pot(mri_rd,mri_Q,surf->rr[k]);
+                }
+            }
+        }
+    }
+    return;
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_pot_els_block(float **rd, float **Q, int ndip, FwdCoilSet *els, float **pot, void *client)
+/*
+     * Potentials of a block of dipoles at the electrodes. The infinite-medium potentials of all
+     * dipoles are mapped to the electrodes with a single matrix product
+     */
+{
+    FwdBemModel*    m = (FwdBemModel*)client;
+    FwdBemSolution* sol = (FwdBemSolution*)els->user_data;
+    int             nres = Q ? ndip : 3*ndip;
+    int             k;
+
+    if (!m) {
+        printf("No BEM model specified to fwd_bem_pot_els_block");
+        return FAIL;
+    }
+    if (!m->solution) {
+        printf("No solution available for fwd_bem_pot_els_block");
+        return FAIL;
+    }
+    if (!sol || sol->ncoil != els->ncoil) {
+        printf("No appropriate electrode-specific data available in fwd_bem_pot_els_block");
+        return FAIL;
+    }
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
+        printf("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    FwdBemBlockWork& work = fwd_bem_block_work();
+
+    fwd_bem_inf_pot_block(rd,Q,ndip,m,work.V0);
+
+    Map<const MatrixXfRowMajor> matSol(sol->solution[0],sol->ncoil,m->nsol);
+    work.res.noalias() = work.V0.transpose()*matSol.transpose();
+
+    for (k = 0; k < nres; k++)
+        Map<RowVectorXf>(pot[k],sol->ncoil) = work.res.row(k);
+    return OK;
+}
+
+
 //*************************************************************************************************************
 
 #define ARSINH(x) log((x) + sqrt(1.0+(x)*(x)))
@@ -2612,9 +3008,7 @@ void FwdBemModel::fwd_bem_lin_field_calc(float *rd, float *Q, FwdCoilSet *coils,
     /*
        * Infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2675,9 +3069,7 @@ void FwdBemModel::fwd_bem_field_calc(float *rd, float *Q, FwdCoilSet *coils, Fwd
     /*
        * Infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2743,9 +3135,7 @@ void FwdBemModel::fwd_bem_field_grad_calc(float *rd, float *Q, FwdCoilSet* coils
     /*
        * Infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2868,9 +3258,7 @@ void FwdBemModel::fwd_bem_lin_field_grad_calc(float *rd, float *Q, FwdCoilSet *c
     /*
        * Space for infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    v0 = fwd_bem_thread_v0(m->nsol);
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2992,6 +3380,67 @@ int FwdBemModel::fwd_bem_field_grad(float *rd, float Q[], FwdCoilSet *coils, flo
 }
 
 
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_field_block(float **rd, float **Q, int ndip, FwdCoilSet *coils, float **B, void *client)
+/*
+     * Calculate the magnetic field of a block of dipoles in a set of coils. The volume current
+     * contributions of all dipoles are computed with a single matrix product
+     */
+{
+    FwdBemModel*    m = (FwdBemModel*)client;
+    FwdBemSolution* sol = (FwdBemSolution*)coils->user_data;
+    float           *Qxyz[3] = { Qx, Qy, Qz };
+    int             nori = Q ? 1 : 3;
+    int             j,q,k,p,c;
+    float           *my_Q,prim;
+    FwdCoil*        coil;
+
+    if (!m) {
+        printf("No BEM model specified to fwd_bem_field_block");
+        return FAIL;
+    }
+    if (!sol || !sol->solution || sol->ncoil != coils->ncoil) {
+        printf("No appropriate coil-specific data available in fwd_bem_field_block");
+        return FAIL;
+    }
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
+        printf("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    FwdBemBlockWork& work = fwd_bem_block_work();
+    /*
+       * Infinite-medium potentials
+       */
+    fwd_bem_inf_pot_block(rd,Q,ndip,m,work.V0);
+    /*
+       * Volume current contribution
+       */
+    Map<const MatrixXfRowMajor> matSol(sol->solution[0],sol->ncoil,m->nsol);
+    work.res.noalias() = work.V0.transpose()*matSol.transpose();
+    /*
+       * Primary current contribution
+       * (can be calculated in the coil/dipole coordinates)
+       */
+    for (j = 0, c = 0; j < ndip; j++) {
+        for (q = 0; q < nori; q++, c++) {
+            my_Q = Q ? Q[j] : Qxyz[q];
+            for (k = 0; k < coils->ncoil; k++) {
+                coil = coils->coils[k];
+                prim = 0.0;
+                for (p = 0; p < coil->np; p++)
+                    prim = prim + coil->w[p]*fwd_bem_inf_field(rd[j],my_Q,coil->rmag[p],coil->cosmag[p]);
+                /*
+                 * Scale correctly
+                 */
+                B[c][k] = MAG_FACTOR*(prim + work.res(c,k));
+            }
+        }
+    }
+    return OK;
+}
+
+
 //*************************************************************************************************************
 
 void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
@@ -3005,6 +3454,12 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
     int            j,p,q;
     float          *xyz[3];
 
+    if (a->block_field_pot && !(a->field_pot_grad && a->res_grad)) {
+        if (meg_eeg_fwd_one_source_space_block(a) != OK)
+            goto bad;
+        a->stat = OK;
+        return NULL;
+    }
     p = a->off;
     q = 3*a->off;
     if (a->fixed_ori) {					  /* The normal source component only */
@@ -3127,6 +3582,51 @@ bad : {
 }
 
 
+//*************************************************************************************************************
+
+int FwdBemModel::meg_eeg_fwd_one_source_space_block(FwdThreadArg *a)
+/*
+* Compute the MEG or EEG forward solution for one source space
+* in blocks of FWD_BEM_BLOCK_SIZE dipoles
+*/
+{
+    MneSourceSpaceOld* s = a->s;
+    float          *rd[FWD_BEM_BLOCK_SIZE];
+    float          *Q[FWD_BEM_BLOCK_SIZE];
+    float          *res[3*FWD_BEM_BLOCK_SIZE];
+    float          *Qxyz[3] = { Qx, Qy, Qz };
+    bool           one_ori = a->fixed_ori || a->comp >= 0;
+    int            j,k,p,ndip;
+
+    p = a->off;
+    for (j = 0, ndip = 0; j < s->np; j++) {
+        if (s->inuse[j]) {
+            rd[ndip] = s->rr[j];
+            if (a->fixed_ori) {                           /* The normal source component only */
+                Q[ndip]   = s->nn[j];
+                res[ndip] = a->res[p++];
+            }
+            else if (a->comp >= 0) {                      /* One of the source components */
+                Q[ndip]   = Qxyz[a->comp];
+                res[ndip] = a->res[p+a->comp];
+                p = p + 3;
+            }
+            else {                                        /* All source components */
+                for (k = 0; k < 3; k++)
+                    res[3*ndip+k] = a->res[p++];
+            }
+            ndip++;
+        }
+        if (ndip == FWD_BEM_BLOCK_SIZE || (ndip > 0 && j == s->np-1)) {
+            if (a->block_field_pot(rd,one_ori ? Q : NULL,ndip,a->coils_els,res,a->client) != OK)
+                return FAIL;
+            ndip = 0;
+        }
+    }
+    return OK;
+}
+
+
 //*************************************************************************************************************
 
 int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
@@ -3152,6 +3652,7 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
     fwdVecFieldFunc     vec_field;          /* Computes the field for all dipole orientations */
     fwdFieldGradFunc    field_grad;         /* Computes the field and gradient with respect to dipole position
                                              * for one dipole orientation */
+    fwdBlockFieldFunc   block_field = NULL; /* Computes the field for a block of dipoles */
     int                 nmeg = coils->ncoil;/* Number of channels */
     int                 nsource;            /* Total number of sources */
     int                 k,p,q,off;
@@ -3191,10 +3692,12 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
                 goto bad;
             fprintf(stderr,"[done]\n");
         }
-        field      = FwdCompData::fwd_comp_field;
-        vec_field  = NULL;
-        field_grad = FwdCompData::fwd_comp_field_grad;
-        client     = comp;
+        comp->block_field = fwd_bem_field_block;
+        field       = FwdCompData::fwd_comp_field;
+        vec_field   = NULL;
+        field_grad  = FwdCompData::fwd_comp_field_grad;
+        block_field = FwdCompData::fwd_comp_field_block;
+        client      = comp;
     }
     else {
         /*
@@ -3254,6 +3757,7 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
     one_arg->field_pot      = field;
     one_arg->vec_field_pot  = vec_field;
     one_arg->field_pot_grad = field_grad;
+    one_arg->block_field_pot = block_field;
 
     if (nproc < 2)
         use_threads = false;
@@ -3373,6 +3877,7 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
     fwdVecFieldFunc  vec_pot;               /* Computes the potentials for all dipole orientations */
     fwdFieldGradFunc pot_grad;              /* Computes the potential and gradient with respect to dipole position
                                              * for one dipole orientation */
+    fwdBlockFieldFunc block_pot = NULL;     /* Computes the potentials for a block of dipoles */
     int             nsource;                /* Total number of sources */
     int             neeg = els->ncoil;      /* Number of channels */
     int             k,p,q,off;
@@ -3391,8 +3896,9 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
         if (fwd_bem_specify_els(bem_model,els) == FAIL)
             goto bad;
         client   = bem_model;
-        pot      = fwd_bem_pot_els;
-        vec_pot  = NULL;
+        pot       = fwd_bem_pot_els;
+        vec_pot   = NULL;
+        block_pot = fwd_bem_pot_els_block;
 #ifdef TEST
         fprintf(stderr,"Using differences.\n");
         pot_grad = my_bem_pot_grad;
@@ -3446,6 +3952,7 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
     one_arg->field_pot      = pot;
     one_arg->vec_field_pot  = vec_pot;
     one_arg->field_pot_grad = pot_grad;
+    one_arg->block_field_pot = block_pot;
 
     if (nproc < 2)
         use_threads = false;
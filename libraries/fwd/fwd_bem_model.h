@@ -106,6 +106,7 @@ namespace FWDLIB
 //=============================================================================================================
 
 class FwdEegSphereModel;
+class FwdThreadArg;
 
 
 //=============================================================================================================
@@ -261,6 +262,19 @@ public:
                                         int         force_recompute,
                                         FwdBemModel* m);
 
+    static qint64 fwd_bem_cache_limit();
+
+    static QString fwd_bem_solution_cache_name(FwdBemModel* m,
+                                               int         bem_method);
+
+    static int fwd_bem_load_cached_solution(FwdBemModel* m,
+                                            int         bem_method);
+
+    static int fwd_bem_save_cached_solution(FwdBemModel* m);
+
+    static void fwd_bem_prune_cache(const QString& keep,
+                                    const QString& suffix);
+
     //============================= fwd_bem_pot.c =============================
 
     static float fwd_bem_inf_field(float *rd,      /* Dipole position */
@@ -322,6 +336,19 @@ public:
                   float       *zgrad,
                   void        *client);
 
+    static void fwd_bem_inf_pot_block(float           **rd,   /* Dipole positions */
+                                      float           **Q,    /* Dipole orientations (NULL = x, y, and z for each dipole) */
+                                      int             ndip,   /* Number of dipoles */
+                                      FwdBemModel*    m,      /* The model */
+                                      Eigen::MatrixXf &V0);   /* Infinite-medium potentials, one column per dipole orientation */
+
+    static int fwd_bem_pot_els_block(float       **rd,    /* Dipole positions */
+                                     float       **Q,     /* Dipole orientations (NULL = x, y, and z for each dipole) */
+                                     int         ndip,    /* Number of dipoles */
+                                     FwdCoilSet* els,     /* Electrode descriptors */
+                                     float       **pot,   /* Result, one row per dipole orientation */
+                                     void        *client);
+
     //============================= fwd_bem_field.c =============================
 
     /*
@@ -451,10 +478,19 @@ public:
                    float        zgrad[],
                    void         *client);
 
+    static int fwd_bem_field_block(float       **rd,    /* Dipole positions */
+                                   float       **Q,     /* Dipole orientations (NULL = x, y, and z for each dipole) */
+                                   int         ndip,    /* Number of dipoles */
+                                   FwdCoilSet* coils,   /* Coil descriptors */
+                                   float       **B,     /* Result, one row per dipole orientation */
+                                   void        *client);
+
     //============================= compute_forward.c =============================
 
     static void *meg_eeg_fwd_one_source_space(void *arg);
 
+    static int meg_eeg_fwd_one_source_space_block(FwdThreadArg* a);
+
     // TODO check if this is the correct class or move
     static int compute_forward_meg( MNELIB::MneSourceSpaceOld*    *spaces,     /* Source spaces */
                                     int                 nspace,      /* How many? */
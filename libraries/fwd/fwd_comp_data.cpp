@@ -144,6 +144,7 @@ FwdCompData::FwdCompData()
 ,field      (NULL)
 ,vec_field  (NULL)
 ,field_grad (NULL)
+,block_field(NULL)
 ,client     (NULL)
 ,client_free(NULL)
 ,set        (NULL)
@@ -370,6 +371,47 @@ int FwdCompData::fwd_comp_field_vec(float *rd, FwdCoilSet *coils, float **res, v
 }
 
 
+//*************************************************************************************************************
+
+int FwdCompData::fwd_comp_field_block(float **rd, float **Q, int ndip, FwdCoilSet *coils, float **res, void *client)
+/*
+          * Calculate the compensated field of a block of dipoles
+          */
+{
+    FwdCompData* comp = (FwdCompData*)client;
+    float **comp_res;
+    int   nres = Q ? ndip : 3*ndip;
+    int   k,stat;
+
+    if (!comp->block_field) {
+        printf("Field computation function is missing in fwd_comp_field_block");
+        return FAIL;
+    }
+    /*
+       * First compute the field in the primary set of coils
+       */
+    if (comp->block_field(rd,Q,ndip,coils,res,comp->client) == FAIL)
+        return FAIL;
+    /*
+       * Compensation needed?
+       */
+    if (!comp->comp_coils || comp->comp_coils->ncoil <= 0 || !comp->set || !comp->set->current)
+        return OK;
+    /*
+       * Compute the field at the compensation sensors
+       */
+    comp_res = ALLOC_CMATRIX_60(nres,comp->comp_coils->ncoil);
+    stat = comp->block_field(rd,Q,ndip,comp->comp_coils,comp_res,comp->client);
+    /*
+       * Compute the compensated field of all dipoles in the block
+       */
+    for (k = 0; k < nres && stat == OK; k++)
+        stat = MneCTFCompDataSet::mne_apply_ctf_comp(comp->set,TRUE,res[k],coils->ncoil,comp_res[k],comp->comp_coils->ncoil);
+    FREE_CMATRIX_60(comp_res);
+    return stat;
+}
+
+
 //*************************************************************************************************************
 
 int FwdCompData::fwd_comp_field_grad(float *rd, float *Q, FwdCoilSet* coils, float *res, float *xgrad, float *ygrad, float *zgrad, void *client)
@@ -143,6 +143,8 @@ public:
 
     static int fwd_comp_field_vec(float *rd, FwdCoilSet* coils, float **res, void *client);
 
+    static int fwd_comp_field_block(float **rd, float **Q, int ndip, FwdCoilSet* coils, float **res, void *client);
+
     static int fwd_comp_field_grad(float *rd,float *Q, FwdCoilSet* coils,
                 float *res, float *xgrad, float *ygrad, float *zgrad,
                 void *client);
@@ -156,6 +158,7 @@ public:
     fwdFieldFunc        field;      /* Computes the field of given direction dipole */
     fwdVecFieldFunc     vec_field;  /* Computes the fields of all three dipole components  */
     fwdFieldGradFunc    field_grad; /* Computes the field and gradient of one dipole direction */
+    fwdBlockFieldFunc   block_field; /* Computes the fields of a block of dipoles */
     void                *client;    /* Client data to pass to the above functions */
     fwdUserFreeFunc     client_free;
     float               *work;      /* The work areas */
@@ -46,6 +46,8 @@
 
 
 #include <QtAlgorithms>
+#include <QMutex>
+#include <QMutexLocker>
 
 
 #include <qmath.h>
@@ -585,12 +587,18 @@ int FwdEegSphereModel::fwd_eeg_multi_spherepot(float *rd, float *Q, float **el,
     float  sigmaM_inv;
     /*
        * Precompute the coefficients
+       * fwd_eeg_get_multi_sphere_model_coeff keeps its work space in statics, guard it against concurrent fits
        */
     if (m->fn.size() == 0 || m->nterms != MAXTERMS) {
-        m->fn.resize(MAXTERMS);
-        m->nterms = MAXTERMS;
-        for (k = 0; k < MAXTERMS; k++)
-            m->fn[k] = (2*k+3)*m->fwd_eeg_get_multi_sphere_model_coeff(k+1);
+        static QMutex s_coeffMutex;
+        QMutexLocker locker(&s_coeffMutex);
+        if (m->fn.size() == 0 || m->nterms != MAXTERMS) {
+            VectorXd fn(MAXTERMS);
+            for (k = 0; k < MAXTERMS; k++)
+                fn[k] = (2*k+3)*m->fwd_eeg_get_multi_sphere_model_coeff(k+1);
+            m->fn = fn;
+            m->nterms = MAXTERMS;
+        }
     }
     /*
        * Move to the sphere coordinates
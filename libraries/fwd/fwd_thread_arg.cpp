@@ -100,6 +100,7 @@ FwdThreadArg::FwdThreadArg()
 ,field_pot     (NULL)
 ,vec_field_pot (NULL)
 ,field_pot_grad(NULL)
+,block_field_pot(NULL)
 ,coils_els     (NULL)
 ,client        (NULL)
 ,s             (NULL)
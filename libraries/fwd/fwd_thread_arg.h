@@ -133,6 +133,7 @@ public:
     fwdFieldFunc        field_pot;         /* Computes the field or potential for one dipole orientation */
     fwdVecFieldFunc     vec_field_pot;     /* Computes the field or potential for all dipole orientations */
     fwdFieldGradFunc    field_pot_grad;    /* Computes the gradient of field or potential for one dipole orientation */
+    fwdBlockFieldFunc   block_field_pot;   /* Computes the field or potential for a block of dipoles */
     FwdCoilSet          *coils_els;        /* The coil definitions */
     void                *client;           /* Client data for the field computation function */
     MNELIB::MneSourceSpaceOld   *s;                 /* The source space to process */
@@ -22,6 +22,11 @@ typedef int (*fwdFieldFunc)(float *rd,float *Q,FWDLIB::FwdCoilSet* coils,float *
 typedef int (*fwdVecFieldFunc)(float *rd,FWDLIB::FwdCoilSet* coils,float **res,void *client);
 typedef int (*fwdFieldGradFunc)(float *rd,float *Q,FWDLIB::FwdCoilSet* coils, float *res,
                                 float *xgrad, float *ygrad, float *zgrad, void *client);
+/*
+ * Computes the field / potential of a block of dipoles at once. If Q is NULL the three orthogonal
+ * components of each dipole are computed (3*ndip result rows), otherwise one row per dipole.
+ */
+typedef int (*fwdBlockFieldFunc)(float **rd,float **Q,int ndip,FWDLIB::FwdCoilSet* coils,float **res,void *client);
 
 
 
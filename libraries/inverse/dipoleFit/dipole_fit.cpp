@@ -6,6 +6,10 @@
 
 #include <string.h>
 #include <QScopedPointer>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
 
 
 using namespace INVERSELIB;
@@ -57,6 +61,9 @@ using namespace FWDLIB;
 
 #define EPS_VALUES 0.05
 
+#define FIT_BATCH 512             /* How many time points are collected before they are fitted in parallel */
+#define FIT_CHUNKS_PER_THREAD 4   /* Contiguous chunks per thread, keeps the threads busy although the fits take unequal time */
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -597,6 +604,170 @@ int mne_get_values_from_data_ch (float time,      /* Interesting time point */
 
 
 
+//*************************************************************************************************************
+/*
+ * Parallel fitting of the time points: the data vectors are collected into a batch and the guesses are scored for
+ * the whole batch at once. The batch is then split into contiguous chunks. Each chunk is fitted by one thread with
+ * a fitting context of its own, so that the fits within a chunk can be warm-started from the result of the
+ * preceding time point. The chunks run on a thread pool of the batch limited to the requested number of threads.
+ */
+
+typedef struct {
+    DipoleFitData*   fit;
+    dipoleFitContext ctx;           /* Forward functions of this chunk */
+    GuessData*       guess;
+    float            **B;           /* The data vectors */
+    float            *times;
+    int              *best;         /* The best guesses */
+    float            *good;         /* Their goodness of fit */
+    int              ntime;
+    const ECD*       prev;          /* Result to warm start the first fit from (optional) */
+    bool             warm_start;
+    ECD              *res;          /* The fitted dipoles */
+    bool             *ok;           /* Which fits succeeded */
+} fitChunkRec;
+
+
+struct FitBatch {
+    DipoleFitData*              fit;
+    GuessData*                  guess;
+    bool                        warm_start;
+    int                         nchan;
+    QVector<dipoleFitContext>   ctx;        /* One per chunk */
+    float                       **B;        /* Data vectors collected so far */
+    QVector<float>              times;
+    QVector<ECD>                res;
+    int                         best[FIT_BATCH];
+    float                       good[FIT_BATCH];
+    bool                        ok[FIT_BATCH];
+    ECD                         last;       /* Last result of the previous batch */
+    bool                        last_ok;
+    QThreadPool                 pool;       /* Runs the chunks with at most the requested number of threads */
+};
+
+
+static void fit_chunk(fitChunkRec* chunk)
+
+{
+    const ECD* prev = chunk->warm_start ? chunk->prev : NULL;
+
+    for (int k = 0; k < chunk->ntime; k++) {
+        chunk->ok[k] = DipoleFitData::fit_one_from_guess(chunk->fit,chunk->ctx,chunk->guess,chunk->best[k],chunk->good[k],
+                                                         chunk->times[k],chunk->B[k],FALSE,prev,chunk->res[k]);
+        if (chunk->warm_start)
+            prev = chunk->ok[k] ? &chunk->res[k] : NULL;
+    }
+    return;
+}
+
+
+static FitBatch* new_fit_batch(DipoleFitData* fit, GuessData* guess, int nchan, int nthreads, bool warm_start)
+
+{
+    FitBatch* b = new FitBatch;
+
+    b->fit        = fit;
+    b->guess      = guess;
+    b->warm_start = warm_start;
+    b->nchan      = nchan;
+    b->B          = ALLOC_CMATRIX(FIT_BATCH,nchan);
+    b->last_ok    = false;
+    b->times.reserve(FIT_BATCH);
+    b->res.resize(FIT_BATCH);
+    b->pool.setMaxThreadCount(nthreads);
+    for (int k = 0; k < FIT_CHUNKS_PER_THREAD*nthreads; k++)
+        b->ctx.append(DipoleFitData::new_fit_context(fit));
+    return b;
+}
+
+
+static void free_fit_batch(FitBatch* b)
+
+{
+    if (!b)
+        return;
+    for (int k = 0; k < b->ctx.size(); k++)
+        DipoleFitData::free_fit_context(b->ctx[k]);
+    FREE_CMATRIX(b->B);
+    delete b;
+    return;
+}
+
+
+static void flush_fit_batch(FitBatch* b, ECDSet& set, int report_interval)
+/*
+ * Fit the collected time points and add the results to the set in temporal order
+ */
+{
+    int ntime  = b->times.size();
+    int nchunk = qMin(b->ctx.size(),ntime);
+    QVector<fitChunkRec> chunks(nchunk);
+    QVector<QFuture<void> > running;
+    int c,k;
+
+    if (ntime == 0)
+        return;
+
+    if (DipoleFitData::prepare_fit_data(b->fit,b->guess,b->B,ntime,b->best,b->good) == FAIL)
+        for (k = 0; k < ntime; k++)
+            b->best[k] = -1;
+
+    for (c = 0; c < nchunk; c++) {
+        int first = c*ntime/nchunk;
+        int last  = (c+1)*ntime/nchunk;
+
+        chunks[c].fit        = b->fit;
+        chunks[c].ctx        = b->ctx[c];
+        chunks[c].guess      = b->guess;
+        chunks[c].B          = b->B + first;
+        chunks[c].times      = b->times.data() + first;
+        chunks[c].best       = b->best + first;
+        chunks[c].good       = b->good + first;
+        chunks[c].ntime      = last - first;
+        chunks[c].prev       = (c == 0 && b->last_ok) ? &b->last : NULL;
+        chunks[c].warm_start = b->warm_start;
+        chunks[c].res        = b->res.data() + first;
+        chunks[c].ok         = b->ok + first;
+    }
+    for (c = 0; c < nchunk; c++)
+        running.append(QtConcurrent::run(&b->pool,fit_chunk,chunks.data()+c));
+    for (c = 0; c < nchunk; c++)
+        running[c].waitForFinished();
+
+    for (k = 0; k < ntime; k++) {
+        if (!b->ok[k])
+            printf("t = %7.1f ms : %s\n",1000*b->times[k],"error (tbd: catch)");
+        else {
+            set.addEcd(b->res[k]);
+            if (set.size() % report_interval == 0)
+                fprintf(stderr,"%d..",set.size());
+        }
+    }
+    b->last    = b->res[ntime-1];
+    b->last_ok = b->ok[ntime-1];
+    b->times.clear();
+    return;
+}
+
+
+static float *fit_batch_next(FitBatch* b, float time)
+/*
+ * Space for the next data vector
+ */
+{
+    float *one = b->B[b->times.size()];
+
+    b->times.append(time);
+    return one;
+}
+
+
+static bool fit_batch_full(FitBatch* b)
+
+{
+    return b->times.size() == FIT_BATCH;
+}
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -711,11 +882,11 @@ ECDSet DipoleFit::calculateFit() const
 
 
     if (raw) {
-        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose) == FAIL)
+        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,settings->nthreads,settings->warm_start) == FAIL)
             goto out;
     }
     else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set,settings->nthreads,settings->warm_start) == FAIL)
             goto out;
     }
     printf("%d dipoles fitted\n",set.size());
@@ -729,29 +900,48 @@ out : {
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads, bool warm_start)
 {
     float *one = MALLOC(data->nchan,float);
     float time;
     ECDSet set;
     ECD   dip;
+    bool  dip_ok = false;
     int   s;
     int   report_interval = 10;
+    FitBatch* batch = NULL;
 
     set.dataname = dataname;
 
+    if (nthreads <= 0)
+        nthreads = QThread::idealThreadCount();
+    /*
+     * The intermediate results of a verbose fit would be interleaved, fit those serially
+     */
+    if (!verbose && nthreads > 1)
+        batch = new_fit_batch(fit,guess,data->nchan,nthreads,warm_start);
+
     fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
     for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
+        float *B = batch ? fit_batch_next(batch,time) : one;
         /*
      * Pick the data point
      */
         if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
+                                     1.0/data->current->tstep,FALSE,B) == FAIL) {
             fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
+            if (batch)
+                batch->times.removeLast();
+            continue;
+        }
+        if (batch) {
+            if (fit_batch_full(batch))
+                flush_fit_batch(batch,set,report_interval);
             continue;
         }
 
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
+        dip_ok = DipoleFitData::fit_one(fit,NULL,guess,time,one,verbose,(warm_start && dip_ok) ? &dip : NULL,dip);
+        if (!dip_ok)
             printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
         else {
             set.addEcd(dip);
@@ -763,6 +953,10 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
             }
         }
     }
+    if (batch) {
+        flush_fit_batch(batch,set,report_interval);
+        free_fit_batch(batch);
+    }
     if (!verbose)
         fprintf(stderr,"[done]\n");
     FREE(one);
@@ -773,7 +967,7 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads, bool warm_start)
 {
     float *one    = MALLOC(sel->nchan,float);
     float sfreq   = raw->info->sfreq;
@@ -787,11 +981,22 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     float time,stime;
     float **data  = ALLOC_CMATRIX(sel->nchan,length);
     ECD    dip;
+    bool   dip_ok = false;
     ECDSet set;
     int    report_interval = 10;
+    FitBatch* batch = NULL;
+    float  *B;
 
     set.dataname = dataname;
 
+    if (nthreads <= 0)
+        nthreads = QThread::idealThreadCount();
+    /*
+     * The intermediate results of a verbose fit would be interleaved, fit those serially
+     */
+    if (!verbose && nthreads > 1)
+        batch = new_fit_batch(fit,guess,sel->nchan,nthreads,warm_start);
+
     /*
    * Load the initial data segment
    */
@@ -811,14 +1016,23 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
         /*
      * Get the values
      */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+        B = batch ? fit_batch_next(batch,time) : one;
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,B) == FAIL) {
             fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
+            if (batch)
+                batch->times.removeLast();
+            continue;
+        }
+        if (batch) {
+            if (fit_batch_full(batch))
+                flush_fit_batch(batch,set,report_interval);
             continue;
         }
         /*
      * Fit
      */
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
+        dip_ok = DipoleFitData::fit_one(fit,NULL,guess,time,one,verbose,(warm_start && dip_ok) ? &dip : NULL,dip);
+        if (!dip_ok)
             qWarning() << "Error";
         else {
             set.addEcd(dip);
@@ -830,6 +1044,10 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
             }
         }
     }
+    if (batch) {
+        flush_fit_batch(batch,set,report_interval);
+        free_fit_batch(batch);
+    }
     if (!verbose)
         fprintf(stderr,"[done]\n");
     FREE_CMATRIX(data);
@@ -838,6 +1056,7 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     return OK;
 
 bad : {
+        free_fit_batch(batch);
         FREE_CMATRIX(data);
         FREE(one);
         return FAIL;
@@ -847,8 +1066,8 @@ bad : {
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, int nthreads, bool warm_start)
 {
     ECDSet set;
-    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set);
+    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set, nthreads, warm_start);
 }
@@ -117,12 +117,14 @@ public:
     * @param[in] tmax
     * @param[in] tstep      Time step to use
     * @param[in] integ      Integration time
-    * @param[in] verbose    Verbose output?
+    * @param[in] verbose    Verbose output? Verbose fits are always computed serially
     * @param[out] p_set     the fitted ECD Set
+    * @param[in] nthreads   Number of fitting threads, 0 = one per core (default = 1)
+    * @param[in] warm_start Start the fits from the result of the preceding time point if it explains the data better than the best guess (default = false)
     *
     * @return true when successful
     */
-    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads = 1, bool warm_start = false);
 
     //=========================================================================================================
     /**
@@ -139,12 +141,14 @@ public:
     * @param[in] tmax
     * @param[in] tstep      Time step to use
     * @param[in] integ      Integration time
-    * @param[in] verbose    Verbose output?
+    * @param[in] verbose    Verbose output? Verbose fits are always computed serially
     * @param[out] p_set     Return all results here. Warning: for large data files this may take a lot of memory
+    * @param[in] nthreads   Number of fitting threads, 0 = one per core (default = 1)
+    * @param[in] warm_start Start the fits from the result of the preceding time point if it explains the data better than the best guess (default = false)
     *
     * @return true when successful
     */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads = 1, bool warm_start = false);
 
     //=========================================================================================================
     /**
@@ -161,11 +165,13 @@ public:
     * @param[in] tmax
     * @param[in] tstep      Time step to use
     * @param[in] integ      Integration time
-    * @param[in] verbose    Verbose output?
+    * @param[in] verbose    Verbose output? Verbose fits are always computed serially
+    * @param[in] nthreads   Number of fitting threads, 0 = one per core (default = 1)
+    * @param[in] warm_start Start the fits from the result of the preceding time point if it explains the data better than the best guess (default = false)
     *
     * @return true when successful
     */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, int nthreads = 1, bool warm_start = false);
 
 private:
     DipoleFitSettings* settings;
@@ -14,6 +14,7 @@
 #include <mne/c/mne_surface_old.h>
 
 #include <fwd/fwd_comp_data.h>
+#include <mne/c/mne_ctf_comp_data_set.h>
 
 #include <Eigen/Dense>
 
@@ -212,6 +213,8 @@ void mne_free_dcmatrix_3 (double **m)
 
 #define MIN_3(a,b) ((a) < (b) ? (a) : (b))
 
+#define PSEUDO_RADIAL_LIMIT 0.2     /* (pseudo) radial component omission limit used in the fits */
+
 
 
 
@@ -561,6 +564,8 @@ FiffSparseMatrix* mne_convert_to_sparse_3(float **dense,        /* The dense mat
 
 
 typedef struct {
+    DipoleFitData*  fit;        /* The fitting data */
+    dipoleFitFuncs  funcs;      /* The forward functions to use */
     float          limit;
     int            report_dim;
     float          *B;
@@ -3997,6 +4002,100 @@ out :
 }
 
 
+//*************************************************************************************************************
+
+static void free_context_comp_data(void *d)
+/*
+ * Free a compensation data duplicate made by dup_context_funcs
+ * The coils and the client data belong to the original
+ */
+{
+    FwdCompData* comp = (FwdCompData*)d;
+
+    if (!comp)
+        return;
+
+    comp->comp_coils  = NULL;
+    comp->client      = NULL;
+    comp->client_free = NULL;
+    delete comp;
+    return;
+}
+
+
+//*************************************************************************************************************
+
+static void free_context_sphere_model(void *d)
+
+{
+    delete (FwdEegSphereModel*)d;
+    return;
+}
+
+
+//*************************************************************************************************************
+
+static dipoleFitFuncs dup_context_funcs(DipoleFitData* d, dipoleFitFuncs orig)
+/*
+ * Duplicate the parts of the forward functions which keep work space of their own
+ */
+{
+    dipoleFitFuncs f;
+
+    if (!orig)
+        return NULL;
+
+    f  = new_dipole_fit_funcs();
+    *f = *orig;
+    f->meg_client_free = NULL;
+    f->eeg_client_free = NULL;
+    if (orig->meg_client && orig->meg_field == FwdCompData::fwd_comp_field) {
+        FwdCompData* comp_orig = (FwdCompData*)orig->meg_client;
+        FwdCompData* comp      = new FwdCompData;
+
+        *comp = *comp_orig;
+        comp->work     = NULL;
+        comp->vec_work = NULL;
+        comp->set      = comp_orig->set ? new MneCTFCompDataSet(*(comp_orig->set)) : NULL;
+
+        f->meg_client      = comp;
+        f->meg_client_free = free_context_comp_data;
+    }
+    if (orig->eeg_client && orig->eeg_client == d->eeg_model) {
+        f->eeg_client      = new FwdEegSphereModel(*d->eeg_model);
+        f->eeg_client_free = free_context_sphere_model;
+    }
+    return f;
+}
+
+
+//*************************************************************************************************************
+
+dipoleFitContext DipoleFitData::new_fit_context(DipoleFitData* d)
+{
+    dipoleFitContext ctx = MALLOC_3(1,dipoleFitContextRec);
+
+    ctx->sphere_funcs = dup_context_funcs(d,d->sphere_funcs);
+    ctx->bem_funcs    = dup_context_funcs(d,d->bem_funcs);
+
+    return ctx;
+}
+
+
+//*************************************************************************************************************
+
+void DipoleFitData::free_fit_context(dipoleFitContext ctx)
+{
+    if (!ctx)
+        return;
+
+    free_dipole_fit_funcs(ctx->sphere_funcs);
+    free_dipole_fit_funcs(ctx->bem_funcs);
+    FREE_3(ctx);
+    return;
+}
+
+
 //*************************************************************************************************************
 
 MneCovMatrix* DipoleFitData::ad_hoc_noise(FwdCoilSet *meg, FwdCoilSet *eeg, float grad_std, float mag_std, float eeg_std)
@@ -4639,6 +4738,7 @@ out : {
 //*************************************************************************************************************
 
 DipoleForward* dipole_forward(DipoleFitData* d,
+                              dipoleFitFuncs funcs,
                               float         **rd,
                               int           ndip,
                               DipoleForward* old)
@@ -4675,7 +4775,7 @@ DipoleForward* dipole_forward(DipoleFitData* d,
         /*
      * Calculate the field of three orthogonal dipoles
      */
-        if ((DipoleFitData::compute_dipole_field(d,rd[k],TRUE,this_fwd)) == FAIL)
+        if ((DipoleFitData::compute_dipole_field(d,funcs,rd[k],TRUE,this_fwd)) == FAIL)
             goto bad;
         /*
      * Choice of column normalization
@@ -4737,7 +4837,7 @@ DipoleForward* DipoleFitData::dipole_forward_one(DipoleFitData* d,
 {
     float *rds[1];
     rds[0] = rd;
-    return dipole_forward(d,rds,1,old);
+    return dipole_forward(d,d->funcs,rds,1,old);
 }
 
 
@@ -4748,13 +4848,14 @@ static float fit_eval(float *rd,int npar,void *user)
  * Calculate the residual sum of squares
  */
 {
-    DipoleFitData* fit   = (DipoleFitData*)user;
+    fitDipUser       fuser = (fitDipUser)user;
     DipoleForward* fwd;
-    fitDipUser       fuser = (fitDipUser)fit->user;
+    float         *rds[1];
     double        Bm2,one;
     int           ncomp,c;
 
-    fwd = fuser->fwd = DipoleFitData::dipole_forward_one(fit,rd,fuser->fwd);
+    rds[0] = rd;
+    fwd = fuser->fwd = dipole_forward(fuser->fit,fuser->funcs,rds,1,fuser->fwd);
     ncomp = fwd->sing[2]/fwd->sing[0] > fuser->limit ? 3 : 2;
     if (fuser->report_dim)
         fprintf(stderr,"ncomp = %d\n",ncomp);
@@ -4773,47 +4874,6 @@ static float fit_eval(float *rd,int npar,void *user)
 
 
 
-static int find_best_guess(float     *B,         /* The whitened data */
-                           int       nch,
-                           GuessData* guess,	 /* Guesses */
-                           float     limit,	 /* Pseudoradial component omission limit */
-                           int       *bestp,	 /* Which is the best */
-                           float     *goodp)	 /* Best goodness of fit */
-/*
- * Thanks to the precomputed SVD everything is really simple
- */
-{
-    int    k,c;
-    double B2,Bm2,this_good,one;
-    int    best = -1;
-    float  good = 0.0;
-    DipoleForward* fwd;
-    int    ncomp;
-
-    B2 = mne_dot_vectors_3(B,B,nch);
-    for (k = 0; k < guess->nguess; k++) {
-        fwd = guess->guess_fwd[k];
-        if (fwd->nch == nch) {
-            ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
-            for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
-                one = mne_dot_vectors_3(fwd->uu[c],B,nch);
-                Bm2 = Bm2 + one*one;
-            }
-            this_good = 1.0 - (B2 - Bm2)/B2;
-            if (this_good > good) {
-                best = k;
-                good = this_good;
-            }
-        }
-    }
-    if (best < 0) {
-        printf("No reasonable initial guess found.");
-        return FAIL;
-    }
-    *bestp = best;
-    *goodp = good;
-    return OK;
-}
 
 
 
@@ -4889,6 +4949,7 @@ static int report_func(int     loop,
 
 
 static int fit_Q(DipoleFitData* fit,	     /* The fit data */
+                 dipoleFitFuncs funcs,	     /* The forward functions to use */
                  float *B,		     /* Measurement */
                  float *rd,		     /* Dipole position */
                  float limit,		     /* Radial component omission limit */
@@ -4900,7 +4961,8 @@ static int fit_Q(DipoleFitData* fit,	     /* The fit data */
  */
 {
     int c;
-    DipoleForward* fwd = DipoleFitData::dipole_forward_one(fit,rd,NULL);
+    float *rds[1] = { rd };
+    DipoleForward* fwd = dipole_forward(fit,funcs,rds,1,NULL);
     float Bm2,one;
 
     if (!fwd)
@@ -5119,10 +5181,86 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
                     int           verbose,
                     ECD&          res               /* The fitted dipole */
                     )
+{
+    return fit_one(fit,NULL,guess,time,B,verbose,NULL,res);
+}
+
+
+//*************************************************************************************************************
+
+bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitting data */
+                    dipoleFitContext ctx,             /* Forward functions of this thread (NULL = those of fit) */
+                    GuessData*     guess,	            /* The initial guesses */
+                    float         time,              /* Which time is it? */
+                    float         *B,	            /* The field to fit */
+                    int           verbose,
+                    const ECD*    prev,              /* Neighbouring result to start from (optional) */
+                    ECD&          res               /* The fitted dipole */
+                    )
+{
+    int   best;
+    float good;
+
+    if (prepare_fit_data(fit,guess,&B,1,&best,&good) == FAIL)
+        return false;
+    return fit_one_from_guess(fit,ctx,guess,best,good,time,B,verbose,prev,res);
+}
+
+
+//*************************************************************************************************************
+
+int DipoleFitData::prepare_fit_data(DipoleFitData* fit,     /* Precomputed fitting data */
+                                    GuessData*     guess,   /* The initial guesses */
+                                    float          **B,     /* The fields of the time points */
+                                    int            ntime,   /* How many time points */
+                                    int            *best,   /* The best guesses */
+                                    float          *good)   /* Their goodness of fit */
+/*
+ * Project and whiten the data and score the guesses for all time points at once
+ */
+{
+    int      nchan = fit->nmeg+fit->neeg;
+    MatrixXf data(nchan,ntime);
+    VectorXi guess_best;
+    VectorXf guess_good;
+    int      k;
+
+    for (k = 0; k < ntime; k++)
+        if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B[k],nchan,TRUE) == FAIL)
+            return FAIL;
+
+    if (mne_whiten_data(B,B,ntime,nchan,fit->noise) == FAIL)
+        return FAIL;
+
+    for (k = 0; k < ntime; k++)
+        data.col(k) = Map<VectorXf>(B[k],nchan);
+    if (!guess->find_best_guesses(data,PSEUDO_RADIAL_LIMIT,guess_best,guess_good))
+        return FAIL;
+    for (k = 0; k < ntime; k++) {
+        best[k] = guess_best[k];
+        good[k] = guess_good[k];
+    }
+    return OK;
+}
+
+
+//*************************************************************************************************************
+
+bool DipoleFitData::fit_one_from_guess(DipoleFitData* fit,	    /* Precomputed fitting data */
+                    dipoleFitContext ctx,             /* Forward functions of this thread (NULL = those of fit) */
+                    GuessData*     guess,	            /* The initial guesses */
+                    int           best,              /* The best guess from prepare_fit_data */
+                    float         good,              /* Its goodness of fit */
+                    float         time,              /* Which time is it? */
+                    float         *B,	            /* The projected and whitened field to fit */
+                    int           verbose,
+                    const ECD*    prev,              /* Neighbouring result to start from (optional) */
+                    ECD&          res               /* The fitted dipole */
+                    )
 {
     float  **simplex       = NULL;	       /* The simplex */
     float  vals[4];			       /* Values at the vertices */
-    float  limit           = 0.2;	               /* (pseudo) radial component omission limit */
+    float  limit           = PSEUDO_RADIAL_LIMIT; /* (pseudo) radial component omission limit */
     float  size            = 1e-2;	       /* Size of the initial simplex */
     float  ftol[]          = { 1e-2, 1e-2 };     /* Tolerances on the the two passes */
     float  atol[]          = { 0.2e-3, 0.2e-3 }; /* If dipole movement between two iterations is less than this,
@@ -5131,36 +5269,41 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     int    max_eval        = 1000;	       /* Limit for fit function evaluations */
     int    report_interval = verbose ? 1 : -1;   /* How often to report the intermediate result */
 
-    int        best;
-    float      good,rd_guess[3],rd_final[3],Q[3],final_val;
+    float      rd_guess[3],rd_final[3],Q[3],final_val;
     fitDipUserRec user;
     int        k,p,neval,neval_tot,nchan,ncomp;
     int        fit_fail;
+    dipoleFitFuncs sphere_funcs = ctx ? ctx->sphere_funcs : fit->sphere_funcs;
+    dipoleFitFuncs bem_funcs    = ctx ? ctx->bem_funcs : fit->bem_funcs;
 
     nchan = fit->nmeg+fit->neeg;
     user.fwd = NULL;
 
-    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
-        goto bad;
-
-    if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
-        goto bad;
-    /*
-   * Get the initial guess
-   */
-    if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
+    if (best < 0) {
+        printf("No reasonable initial guess found.");
         goto bad;
+    }
 
-
+    user.fit   = fit;
+    user.funcs = sphere_funcs;
     user.limit = limit;
     user.B     = B;
     user.B2    = mne_dot_vectors_3(B,B,nchan);
     user.fwd   = NULL;
     user.report_dim = FALSE;
-    fit->user  = &user;
 
     VEC_COPY_3(rd_guess,guess->rr[best]);
-    VEC_COPY_3(rd_final,guess->rr[best]);
+    /*
+     * Start from the neighbouring result instead if it explains the data better
+     */
+    if (prev && prev->valid) {
+        float rd_prev[3];
+        for (k = 0; k < 3; k++)
+            rd_prev[k] = prev->rd[k];
+        if (fit_eval(rd_prev,3,&user) < (1.0 - good)*user.B2)
+            VEC_COPY_3(rd_guess,rd_prev);
+    }
+    VEC_COPY_3(rd_final,rd_guess);
 
     neval_tot = 0;
     fit_fail = FALSE;
@@ -5169,20 +5312,20 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
      * Do first pass with the sphere model
      */
         if (k == 0)
-            fit->funcs = fit->sphere_funcs;
+            user.funcs = sphere_funcs;
         else
-            fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
+            user.funcs = !fit->bemname.isEmpty() ? bem_funcs : sphere_funcs;
 
         simplex = make_initial_dipole_simplex(rd_guess,size);
         for (p = 0; p < 4; p++)
-            vals[p] = fit_eval(simplex[p],3,fit);
+            vals[p] = fit_eval(simplex[p],3,&user);
         if (simplex_minimize(simplex,           /* The initial simplex */
                              vals,              /* Function values at the vertices */
                              3,                 /* Number of variables */
                              ftol[k],           /* Relative convergence tolerance for the target function */
                              atol[k],           /* Absolute tolerance for the change in the parameters */
                              fit_eval,          /* The function to be evaluated */
-                             fit,               /* Data to be passed to the above function in each evaluation */
+                             &user,             /* Data to be passed to the above function in each evaluation */
                              max_eval,          /* Maximum number of function evaluations */
                              &neval,            /* Number of function evaluations */
                              report_interval,   /* How often to report (-1 = no_reporting) */
@@ -5208,7 +5351,7 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     /*
    * Compute the dipole moment at the final point
    */
-    if (fit_Q(fit,user.B,rd_final,user.limit,Q,&ncomp,&final_val) == OK) {
+    if (fit_Q(fit,user.funcs,user.B,rd_final,user.limit,Q,&ncomp,&final_val) == OK) {
         res.time  = time;
         res.valid = true;
         for(int i = 0; i < 3; ++i)
@@ -5253,6 +5396,17 @@ bad : {
 //*************************************************************************************************************
 
 int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd)
+/*
+ * Compute the field with the current forward functions of the fitting data
+ */
+{
+    return compute_dipole_field(d,d->funcs,rd,whiten,fwd);
+}
+
+
+//*************************************************************************************************************
+
+int DipoleFitData::compute_dipole_field(DipoleFitData* d, dipoleFitFuncs funcs, float *rd, int whiten, float **fwd)
 /*
  * Compute the field and take whitening and projection into account
  */
@@ -5266,34 +5420,34 @@ int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten,
    * Compute the fields
    */
     if (d->nmeg > 0) {
-        if (d->funcs->meg_vec_field) {
-            if (d->funcs->meg_vec_field(rd,d->meg_coils,fwd,d->funcs->meg_client) != OK)
+        if (funcs->meg_vec_field) {
+            if (funcs->meg_vec_field(rd,d->meg_coils,fwd,funcs->meg_client) != OK)
                 goto bad;
         }
         else {
-            if (d->funcs->meg_field(rd,Qx,d->meg_coils,fwd[0],d->funcs->meg_client) != OK)
+            if (funcs->meg_field(rd,Qx,d->meg_coils,fwd[0],funcs->meg_client) != OK)
                 goto bad;
-            if (d->funcs->meg_field(rd,Qy,d->meg_coils,fwd[1],d->funcs->meg_client) != OK)
+            if (funcs->meg_field(rd,Qy,d->meg_coils,fwd[1],funcs->meg_client) != OK)
                 goto bad;
-            if (d->funcs->meg_field(rd,Qz,d->meg_coils,fwd[2],d->funcs->meg_client) != OK)
+            if (funcs->meg_field(rd,Qz,d->meg_coils,fwd[2],funcs->meg_client) != OK)
                 goto bad;
         }
     }
 
     if (d->neeg > 0) {
-        if (d->funcs->eeg_vec_pot) {
+        if (funcs->eeg_vec_pot) {
             eeg_fwd[0] = fwd[0]+d->nmeg;
             eeg_fwd[1] = fwd[1]+d->nmeg;
             eeg_fwd[2] = fwd[2]+d->nmeg;
-            if (d->funcs->eeg_vec_pot(rd,d->eeg_els,eeg_fwd,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_vec_pot(rd,d->eeg_els,eeg_fwd,funcs->eeg_client) != OK)
                 goto bad;
         }
         else {
-            if (d->funcs->eeg_pot(rd,Qx,d->eeg_els,fwd[0]+d->nmeg,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_pot(rd,Qx,d->eeg_els,fwd[0]+d->nmeg,funcs->eeg_client) != OK)
                 goto bad;
-            if (d->funcs->eeg_pot(rd,Qy,d->eeg_els,fwd[1]+d->nmeg,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_pot(rd,Qy,d->eeg_els,fwd[1]+d->nmeg,funcs->eeg_client) != OK)
                 goto bad;
-            if (d->funcs->eeg_pot(rd,Qz,d->eeg_els,fwd[2]+d->nmeg,d->funcs->eeg_client) != OK)
+            if (funcs->eeg_pot(rd,Qz,d->eeg_els,fwd[2]+d->nmeg,funcs->eeg_client) != OK)
                 goto bad;
         }
     }
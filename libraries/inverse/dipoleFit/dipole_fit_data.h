@@ -91,6 +91,14 @@ typedef struct {
   mneUserFreeFunc eeg_client_free;
 } *dipoleFitFuncs,dipoleFitFuncsRec;
 
+/*
+ * Forward calculation state private to one fitting thread (see DipoleFitData::new_fit_context)
+ */
+typedef struct {
+  dipoleFitFuncs  sphere_funcs;	    /* Sphere model functions with their own client data */
+  dipoleFitFuncs  bem_funcs;	    /* BEM functions with their own client data, NULL if no BEM is used */
+} *dipoleFitContext,dipoleFitContextRec;
+
 
 
 
@@ -214,12 +222,83 @@ public:
     */
     static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
 
+    //=========================================================================================================
+    /**
+    * Fit a single dipole to the given data using the forward functions of a fitting context. Neither the fitting
+    * data nor the guesses are modified, several fits may run concurrently if each uses its own context.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] ctx        The fitting context, NULL to use the forward functions of fit (not reentrant)
+    * @param[in] guess      The initial guesses
+    * @param[in] time       Which time is it?
+    * @param[in] B          The field to fit
+    * @param[in] verbose
+    * @param[in] prev       Result of a neighbouring time point to start from if it explains the data better than the best guess (optional)
+    * @param[in] res        The fitted dipole
+    */
+    static bool fit_one(DipoleFitData* fit, dipoleFitContext ctx, GuessData* guess, float time, float *B, int verbose, const ECD* prev, ECD& res);
+
+    //=========================================================================================================
+    /**
+    * Project and whiten the data of several time points in place and find the best initial guess for each of
+    * them. The guesses are scored for all time points at once.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in,out] B      The fields to fit, one row per time point
+    * @param[in] ntime      Number of time points
+    * @param[out] best      The best guess of each time point, -1 if none explains any of the data
+    * @param[out] good      The goodness of fit of the best guesses
+    *
+    * @return OK when successful, FAIL otherwise
+    */
+    static int prepare_fit_data(DipoleFitData* fit, GuessData* guess, float **B, int ntime, int *best, float *good);
+
+    //=========================================================================================================
+    /**
+    * Fit a single dipole to data prepared with prepare_fit_data, see fit_one.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] ctx        The fitting context, NULL to use the forward functions of fit (not reentrant)
+    * @param[in] guess      The initial guesses
+    * @param[in] best       The best guess found by prepare_fit_data
+    * @param[in] good       The goodness of fit of the best guess
+    * @param[in] time       Which time is it?
+    * @param[in] B          The projected and whitened field to fit
+    * @param[in] verbose
+    * @param[in] prev       Result of a neighbouring time point to start from if it explains the data better than the best guess (optional)
+    * @param[in] res        The fitted dipole
+    */
+    static bool fit_one_from_guess(DipoleFitData* fit, dipoleFitContext ctx, GuessData* guess, int best, float good, float time, float *B, int verbose, const ECD* prev, ECD& res);
+
+    //=========================================================================================================
+    /**
+    * Create a fitting context for one fitting thread. The compensation and sphere model data, which keep work
+    * space of their own, are duplicated. The coils, the BEM solution and the other read-only parts are shared
+    * with the fitting data, which has to outlive the context.
+    *
+    * @param[in] d          The fitting data set up by setup_dipole_fit_data
+    *
+    * @return the new context
+    */
+    static dipoleFitContext new_fit_context(DipoleFitData* d);
+
+    //=========================================================================================================
+    /**
+    * Free a fitting context created with new_fit_context.
+    *
+    * @param[in] ctx        The context to free
+    */
+    static void free_fit_context(dipoleFitContext ctx);
+
 
 
 //============================= dipole_forward.c
 
     static int compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd);
 
+    static int compute_dipole_field(DipoleFitData* d, dipoleFitFuncs funcs, float *rd, int whiten, float **fwd);
+
     //============================= dipole_forward.c
 
     static DipoleForward* dipole_forward_one(DipoleFitData* d,
@@ -115,6 +115,8 @@ void DipoleFitSettings::initMembers()
     do_baseline  = false;         
     setno        = 1;             
     verbose      = false;
+    nthreads     = 0;
+    warm_start   = false;
     omit_data_proj = false;
          
     eeg_sphere_rad = 0.09f;      
@@ -277,6 +279,8 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--threads n       Number of threads used to fit the time points in parallel (default = one per core).\n");
+    printf("\t--warmstart       Start each fit from the previous time point if it explains the data better than the best guess.\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
@@ -823,6 +827,26 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             fit_mag_dipoles = true;
         }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&ival) != 1) {
+                qCritical() << "Illegal number:" << argv[k+1];
+                return false;
+            }
+            if (ival < 0) {
+                qCritical ("Number of threads should be non-negative.");
+                return false;
+            }
+            nthreads = ival;
+        }
+        else if (strcmp(argv[k],"--warmstart") == 0) {
+            found = 1;
+            warm_start = true;
+        }
         else if (strcmp(argv[k],"--dip") == 0) {
             found = 2;
             if (k == *argc - 1) {
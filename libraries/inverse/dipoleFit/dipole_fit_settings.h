@@ -169,6 +169,8 @@ float guess_rad;       			/**< Radius of spherical guess surface */
     bool  do_baseline;         		/**< Are both baseline limits set? */
     int   setno;             		/**< Which data set */
     bool  verbose;
+    int   nthreads;          		/**< Number of fitting threads (0 = one per core) */
+    bool  warm_start;        		/**< Start each fit from the result of the previous time point if it fits better than the best guess */
     mneFilterDefRec filter;
     QStringList projnames;              /**< Projection file names */
     bool omit_data_proj;
@@ -43,11 +43,22 @@
 #include "dipole_forward.h"
 #include <mne/c/mne_surface_old.h>
 #include <mne/c/mne_source_space_old.h>
+#include <mne/c/mne_cov_matrix.h>
+#include <mne/c/mne_proj_op.h>
+
+#include <fwd/fwd_coil_set.h>
 
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_tag.h>
 
 #include <QFile>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 
 //*************************************************************************************************************
@@ -104,6 +115,15 @@ using namespace INVERSELIB;
 #define ALLOC_CMATRIX_16(x,y) mne_cmatrix_16((x),(y))
 
 
+#define GUESS_BLOCK 1024                /* How many guesses are scored with one matrix product */
+
+#define GUESS_CACHE_MAGIC   0x4d475346  /* Identifies a guess field cache file */
+#define GUESS_CACHE_VERSION 1
+#define GUESS_CACHE_SUFFIX  "-guess-fields.cache"
+#define GUESS_CACHE_NPROBE  3           /* How many guess fields are recomputed to validate the cache */
+#define GUESS_CACHE_TOL     1e-4        /* Relative tolerance for the above */
+
+
 
 static void matrix_error_16(int kind, int nr, int nc)
 
@@ -195,7 +215,6 @@ void fromIntEigenMatrix_16(const Eigen::MatrixXi& from_mat, int **&to_mat)
 
 GuessData::GuessData()
 : rr(NULL)
-, guess_fwd(NULL)
 , nguess(0)
 {
 
@@ -212,6 +231,8 @@ GuessData::GuessData()
 //*************************************************************************************************************
 
 GuessData::GuessData(const QString &guessname, const QString &guess_surfname, float mindist, float exclude, float grid, DipoleFitData *f)
+: rr(NULL)
+, nguess(0)
 {
     MneSourceSpaceOld* *sp = NULL;
     int            nsp = 0;
@@ -219,7 +240,6 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
     int            k,p;
     float          guessrad = 0.080;
     MneSourceSpaceOld* guesses = NULL;
-    dipoleFitFuncs orig;
 
     if (!guessname.isEmpty()) {
         /*
@@ -271,31 +291,11 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
             p++;
         }
     delete guesses; guesses = NULL;
-
-    fprintf(stderr,"Go through all guess source locations...");
-    this->guess_fwd = MALLOC_16(this->nguess,DipoleForward*);
-    for (k = 0; k < this->nguess; k++)
-        this->guess_fwd[k] = NULL;
     /*
         * Compute the guesses using the sphere model for speed
         */
-    orig = f->funcs;
-    if (f->fit_mag_dipoles)
-        f->funcs = f->mag_dipole_funcs;
-    else
-        f->funcs = f->sphere_funcs;
-
-    for (k = 0; k < this->nguess; k++) {
-        if ((this->guess_fwd[k] = DipoleFitData::dipole_forward_one(f,this->rr[k],NULL)) == NULL)
-            goto bad;
-#ifdef DEBUG
-        sing = this->guess_fwd[k]->sing;
-        printf("%f %f %f\n",sing[0],sing[1],sing[2]);
-#endif
-    }
-    f->funcs = orig;
-
-    fprintf(stderr,"[done %d sources]\n",p);
+    if (!this->compute_guess_fields(f))
+        goto bad;
 
     return;
 //    return res;
@@ -313,6 +313,8 @@ bad : {
 //*************************************************************************************************************
 
 GuessData::GuessData(const QString &guessname, const QString &guess_surfname, float mindist, float exclude, float grid, DipoleFitData *f, char *guess_save_name)
+: rr(NULL)
+, nguess(0)
 {
     MneSourceSpaceOld* *sp = NULL;
     int             nsp = 0;
@@ -391,10 +393,6 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
     if(guesses)
         delete guesses;
     guesses = NULL;
-
-    this->guess_fwd = MALLOC_16(this->nguess,DipoleForward*);
-    for (k = 0; k < this->nguess; k++)
-        this->guess_fwd[k] = NULL;
     /*
         * Compute the guesses using the sphere model for speed
         */
@@ -419,11 +417,6 @@ bad : {
 GuessData::~GuessData()
 {
     FREE_CMATRIX_16(rr);
-    if (guess_fwd) {
-        for (int k = 0; k < nguess; k++)
-            delete guess_fwd[k];
-        FREE_16(guess_fwd);
-    }
     return;
 }
 
@@ -433,6 +426,9 @@ GuessData::~GuessData()
 bool GuessData::compute_guess_fields(DipoleFitData* f)
 {
     dipoleFitFuncs orig = NULL;
+    DipoleForward* fwd  = NULL;
+    DipoleForward* one;
+    int            nch;
 
     if (!f) {
         qCritical("Data missing in compute_guess_fields");
@@ -442,25 +438,267 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
         qCritical("Noise covariance missing in compute_guess_fields");
         return false;
     }
-    printf("Go through all guess source locations...");
+    nch = f->nmeg+f->neeg;
     orig = f->funcs;
     if (f->fit_mag_dipoles)
         f->funcs = f->mag_dipole_funcs;
     else
         f->funcs = f->sphere_funcs;
+    if (this->load_cached_guess_fields(f)) {
+        f->funcs = orig;
+        printf("Guess fields taken from the cache [%d sources]\n",this->nguess);
+        return true;
+    }
+    printf("Go through all guess source locations...");
+    /*
+     * Keep only what the guess search needs, in one contiguous matrix
+     */
+    this->guess_uu.resize(nch,3*this->nguess);
+    this->guess_ratio.resize(this->nguess);
     for (int k = 0; k < this->nguess; k++) {
-        if ((this->guess_fwd[k] = DipoleFitData::dipole_forward_one(f,this->rr[k],this->guess_fwd[k])) == NULL){
-            if (orig)
-                f->funcs = orig;
+        if ((one = DipoleFitData::dipole_forward_one(f,this->rr[k],fwd)) == NULL) {
+            delete fwd;
+            f->funcs = orig;
             return false;
         }
-#ifdef DEBUG
-        sing = this->guess_fwd[k]->sing;
-        printf("%f %f %f\n",sing[0],sing[1],sing[2]);
-#endif
+        fwd = one;
+        for (int c = 0; c < 3; c++)
+            this->guess_uu.col(3*k+c) = Map<VectorXf>(fwd->uu[c],nch);
+        this->guess_ratio[k] = fwd->sing[2]/fwd->sing[0];
     }
+    delete fwd;
     f->funcs = orig;
     printf("[done %d sources]\n",this->nguess);
 
+    this->save_cached_guess_fields(f);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool GuessData::find_best_guesses(const MatrixXf& B, float limit, VectorXi& best, VectorXf& good) const
+{
+    int      ntime = B.cols();
+    MatrixXf proj;
+    RowVectorXf B2;
+    float    Bm2,this_good;
+    int      g0,ng,g,t;
+
+    if (this->guess_uu.rows() != B.rows()) {
+        qCritical("Guess fields do not match the data in find_best_guesses");
+        return false;
+    }
+    B2   = B.colwise().squaredNorm();
+    best = VectorXi::Constant(ntime,-1);
+    good = VectorXf::Zero(ntime);
+    for (g0 = 0; g0 < this->nguess; g0 += GUESS_BLOCK) {
+        ng = qMin(GUESS_BLOCK,this->nguess-g0);
+        /*
+         * Projections of all data vectors on the field components of this block
+         */
+        proj.noalias() = this->guess_uu.middleCols(3*g0,3*ng).transpose()*B;
+        proj = proj.array().square();
+        for (t = 0; t < ntime; t++) {
+            const float *p = proj.data() + t*proj.rows();
+            for (g = 0; g < ng; g++, p += 3) {
+                Bm2 = p[0] + p[1];
+                if (this->guess_ratio[g0+g] > limit)
+                    Bm2 = Bm2 + p[2];
+                this_good = Bm2/B2[t];
+                if (this_good > good[t]) {
+                    best[t] = g0+g;
+                    good[t] = this_good;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString GuessData::guess_cache_name(DipoleFitData* f) const
+{
+    QString cache_dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    FwdCoilSet* sets[2] = { f->meg_coils, f->eeg_els };
+    FwdCoil*    coil;
+    qint32      val;
+    int         k,s,p;
+
+    if (cache_dir.isEmpty() || FwdBemModel::fwd_bem_cache_limit() == 0)
+        return QString();
+
+    val = GUESS_CACHE_VERSION;
+    hash.addData((const char *)&val,sizeof(val));
+    /*
+     * Guess locations
+     */
+    hash.addData((const char *)&this->nguess,sizeof(this->nguess));
+    for (k = 0; k < this->nguess; k++)
+        hash.addData((const char *)this->rr[k],3*sizeof(float));
+    /*
+     * Sensors
+     */
+    hash.addData((const char *)&f->nmeg,sizeof(f->nmeg));
+    hash.addData((const char *)&f->neeg,sizeof(f->neeg));
+    hash.addData(f->ch_names.join(":").toUtf8());
+    for (s = 0; s < 2; s++) {
+        if (!sets[s])
+            continue;
+        for (k = 0; k < sets[s]->ncoil; k++) {
+            coil = sets[s]->coils[k];
+            hash.addData((const char *)&coil->type,sizeof(coil->type));
+            hash.addData((const char *)&coil->np,sizeof(coil->np));
+            for (p = 0; p < coil->np; p++) {
+                hash.addData((const char *)coil->rmag[p],3*sizeof(float));
+                hash.addData((const char *)coil->cosmag[p],3*sizeof(float));
+            }
+            hash.addData((const char *)coil->w,coil->np*sizeof(float));
+        }
+    }
+    /*
+     * Forward model
+     */
+    hash.addData((const char *)&f->fit_mag_dipoles,sizeof(f->fit_mag_dipoles));
+    hash.addData((const char *)&f->column_norm,sizeof(f->column_norm));
+    hash.addData((const char *)f->r0,3*sizeof(float));
+    if (f->eeg_model && f->neeg > 0) {
+        for (k = 0; k < f->eeg_model->nlayer(); k++) {
+            hash.addData((const char *)&f->eeg_model->layers[k].rad,sizeof(float));
+            hash.addData((const char *)&f->eeg_model->layers[k].sigma,sizeof(float));
+        }
+        hash.addData((const char *)f->eeg_model->mu.data(),f->eeg_model->mu.size()*sizeof(float));
+        hash.addData((const char *)f->eeg_model->lambda.data(),f->eeg_model->lambda.size()*sizeof(float));
+    }
+    /*
+     * Whitening and projection
+     */
+    hash.addData((const char *)&f->noise->ncov,sizeof(f->noise->ncov));
+    hash.addData((const char *)&f->noise->nzero,sizeof(f->noise->nzero));
+    if (f->noise->inv_lambda)
+        hash.addData((const char *)f->noise->inv_lambda,f->noise->ncov*sizeof(double));
+    if (f->noise->eigen && !f->noise->cov_diag)
+        for (k = 0; k < f->noise->ncov; k++)
+            hash.addData((const char *)f->noise->eigen[k],f->noise->ncov*sizeof(float));
+    if (f->proj && f->proj->nvec > 0)
+        for (k = 0; k < f->proj->nvec; k++)
+            hash.addData((const char *)f->proj->proj_data[k],f->proj->nch*sizeof(float));
+
+    return QDir(cache_dir + "/mne-cpp/guess").filePath(QString(hash.result().toHex()) + GUESS_CACHE_SUFFIX);
+}
+
+
+//*************************************************************************************************************
+
+bool GuessData::load_cached_guess_fields(DipoleFitData* f)
+{
+    QString     name = guess_cache_name(f);
+    MatrixXf    uu;
+    VectorXf    ratio;
+    DipoleForward* fwd = NULL;
+    DipoleForward* one;
+    quint32     magic;
+    qint32      version,nguess,nch;
+    int         k,c,probe;
+
+    if (name.isEmpty() || this->nguess <= 0)
+        return false;
+
+    QFile file(name);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+
+    in >> magic >> version >> nguess >> nch;
+    if (in.status() != QDataStream::Ok || magic != GUESS_CACHE_MAGIC || version != GUESS_CACHE_VERSION ||
+            nguess != this->nguess || nch != f->nmeg+f->neeg)
+        return false;
+    ratio.resize(nguess);
+    if (in.readRawData((char *)ratio.data(),nguess*sizeof(float)) != (int)(nguess*sizeof(float)))
+        return false;
+    /*
+     * Read guess by guess to stay clear of the int limit of readRawData
+     */
+    uu.resize(nch,3*nguess);
+    for (k = 0; k < nguess; k++)
+        if (in.readRawData((char *)uu.col(3*k).data(),3*nch*sizeof(float)) != (int)(3*nch*sizeof(float)))
+            return false;
+    /*
+     * Check a few fields against the current setup
+     */
+    for (c = 0; c < GUESS_CACHE_NPROBE; c++) {
+        probe = (GUESS_CACHE_NPROBE > 1) ? c*(nguess-1)/(GUESS_CACHE_NPROBE-1) : 0;
+        if ((one = DipoleFitData::dipole_forward_one(f,this->rr[probe],fwd)) == NULL) {
+            delete fwd;
+            return false;
+        }
+        fwd = one;
+        for (k = 0; k < 3; k++) {
+            /*
+             * The sign of a singular vector is arbitrary
+             */
+            Map<VectorXf> fresh(fwd->uu[k],nch);
+            float diff = qMin((uu.col(3*probe+k) - fresh).norm(),(uu.col(3*probe+k) + fresh).norm());
+            if (diff > GUESS_CACHE_TOL*fresh.norm()) {
+                delete fwd;
+                return false;
+            }
+        }
+    }
+    delete fwd;
+
+    this->guess_uu    = uu;
+    this->guess_ratio = ratio;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    /*
+     * Mark as recently used, the cache is pruned by modification time
+     */
+    file.setFileTime(QDateTime::currentDateTime(),QFileDevice::FileModificationTime);
+#endif
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool GuessData::save_cached_guess_fields(DipoleFitData* f) const
+{
+    QString name = guess_cache_name(f);
+    int     nch  = this->guess_uu.rows();
+    int     k;
+
+    if (name.isEmpty() || this->nguess <= 0 || !QDir().mkpath(QFileInfo(name).absolutePath()))
+        return false;
+    /*
+     * Fields which alone exceed the size limit are not cached
+     */
+    if ((qint64)nch*3*this->nguess*(qint64)sizeof(float) > FwdBemModel::fwd_bem_cache_limit())
+        return false;
+    /*
+     * Write to a temporary file first, a concurrent reader never sees partial fields
+     */
+    QSaveFile file(name);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream out(&file);
+
+    out << (quint32)GUESS_CACHE_MAGIC << (qint32)GUESS_CACHE_VERSION << (qint32)this->nguess << (qint32)nch;
+    if (out.writeRawData((const char *)this->guess_ratio.data(),this->nguess*sizeof(float)) != (int)(this->nguess*sizeof(float))) {
+        file.cancelWriting();
+        return false;
+    }
+    for (k = 0; k < this->nguess; k++)
+        if (out.writeRawData((const char *)this->guess_uu.col(3*k).data(),3*nch*sizeof(float)) != (int)(3*nch*sizeof(float))) {
+            file.cancelWriting();
+            return false;
+        }
+    if (!file.commit())
+        return false;
+    printf("Cached the guess fields in %s\n",name.toUtf8().constData());
+    FwdBemModel::fwd_bem_prune_cache(name,GUESS_CACHE_SUFFIX);
     return true;
 }
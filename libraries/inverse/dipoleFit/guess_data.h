@@ -59,6 +59,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QString>
 
 
 //*************************************************************************************************************
@@ -135,7 +136,9 @@ public:
 
     //=========================================================================================================
     /**
-    * Once the guess locations have been set up we can compute the fields
+    * Once the guess locations have been set up we can compute the fields. The fields are taken from the guess
+    * field cache if it holds the fields of the same guess locations, sensors, model, noise covariance and
+    * projection, otherwise they are computed and stored in the cache.
     * Refactored: compute_guess_fields (dipole_fit_setup.c)
     *
     * @param[in] f      Dipole Fit Data to the Compute Guess Fields
@@ -144,9 +147,64 @@ public:
     */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+    * Find the best initial guess for each of a set of whitened data vectors. The guesses are scored in blocks,
+    * each block with a single matrix product for all data vectors, so scoring many time points together is
+    * considerably cheaper than scoring them one by one.
+    *
+    * @param[in] B      The projected and whitened data, one column per time point
+    * @param[in] limit  Pseudoradial component omission limit
+    * @param[out] best  Index of the best guess for each time point, -1 if no guess explains any of the data
+    * @param[out] good  Goodness of fit of the best guesses
+    *
+    * @return true when successful
+    */
+    bool find_best_guesses(const Eigen::MatrixXf& B, float limit, Eigen::VectorXi& best, Eigen::VectorXf& good) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Name of the guess field cache file, derived from a hash of the guess locations, the sensors, the forward
+    * model, the noise covariance and the projection.
+    *
+    * The files live in <GenericCacheLocation>/mne-cpp/guess, e.g., ~/.cache/mne-cpp/guess on Linux. Like the
+    * BEM solution cache the directory is kept below FwdBemModel::fwd_bem_cache_limit (MNE_CPP_CACHE_SIZE
+    * environment variable, in MB) by dropping the least recently used fields, and it can be cleared at any
+    * time by deleting it. An empty name is returned if there is no cache location or the cache is disabled.
+    *
+    * @param[in] f      Dipole Fit Data the fields are computed for
+    *
+    * @return the cache file name
+    */
+    QString guess_cache_name(DipoleFitData* f) const;
+
+    //=========================================================================================================
+    /**
+    * Load the guess fields from the cache. A few guess fields are recomputed and compared to the cached ones,
+    * this catches changes the cache name does not cover, e.g., in the compensation.
+    *
+    * @param[in] f      Dipole Fit Data the fields are computed for
+    *
+    * @return true if matching fields were found
+    */
+    bool load_cached_guess_fields(DipoleFitData* f);
+
+    //=========================================================================================================
+    /**
+    * Store the guess fields in the cache and drop the least recently used fields if the cache grows beyond
+    * its size limit.
+    *
+    * @param[in] f      Dipole Fit Data the fields were computed for
+    *
+    * @return true when successful
+    */
+    bool save_cached_guess_fields(DipoleFitData* f) const;
+
 public:
     float          **rr;            /**< These are the guess dipole locations */
-    DipoleForward** guess_fwd;      /**< Forward solutions for the guesses */
+    Eigen::MatrixXf guess_uu;       /**< Left singular vectors of the whitened guess fields, three adjacent columns per guess (nchan x 3*nguess) */
+    Eigen::VectorXf guess_ratio;    /**< Ratio of the smallest to the largest singular value of each guess field */
     int            nguess;          /**< How many sources */
 
 // ### OLD STRUCT ###
@@ -78,6 +78,8 @@ using namespace INVERSELIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bCombineXyz(false)
+, m_qCacheKernels(512)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -88,6 +90,8 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bCombineXyz(false)
+, m_qCacheKernels(512)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -212,14 +216,9 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
     {
         printf("combining the current components...\n");
 
+        //The xyz triplets of a source are contiguous in the column major solution -> pool them column wise
         MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
-        {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.col(i));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
-        }
-        sol.resize(sol1.rows(),sol1.cols());
+        Map<RowVectorXd>(sol1.data(), sol1.size()) = Map<const Matrix<double,3,Dynamic> >(sol.data(), 3, sol1.size()).colwise().norm();
         sol = sol1;
     }
 
@@ -248,10 +247,65 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
 }
 
 
+//*************************************************************************************************************
+
+bool MinimumNorm::applyInverse(const MatrixXd &data, MatrixXd &sol)
+{
+    if(!inverseSetup)
+    {
+        qWarning("MinimumNorm::applyInverse - Inverse not setup -> call doInverseSetup first!");
+        return false;
+    }
+
+    if(m_matKernelFused.cols() != data.rows()) {
+        qWarning() << "MinimumNorm::applyInverse - Dimension mismatch between kernel cols and data.rows() -" << m_matKernelFused.cols() << "and" << data.rows();
+        return false;
+    }
+
+    m_matDataFloat = data.cast<float>();
+    m_matSolFloat.noalias() = m_matKernelFused * m_matDataFloat; //apply imaging kernel
+
+    if(m_bCombineXyz)
+    {
+        //The xyz triplets of a source are contiguous in the column major solution -> pool them column wise
+        if(sol.rows() != m_matSolFloat.rows()/3 || sol.cols() != m_matSolFloat.cols())
+            sol.resize(m_matSolFloat.rows()/3, m_matSolFloat.cols());
+
+        Map<RowVectorXd>(sol.data(), sol.size()) = Map<const Matrix<float,3,Dynamic> >(m_matSolFloat.data(), 3, sol.size()).colwise().norm().cast<double>();
+    }
+    else
+    {
+        sol = m_matSolFloat.cast<double>();
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 {
+    QString t_sKey = QString("%1_%2_%3_%4_%5_%6_%7").arg(nave)
+                                                    .arg(m_fLambda, 0, 'g', 9)
+                                                    .arg(m_sMethod)
+                                                    .arg(label.name)
+                                                    .arg(label.hemi)
+                                                    .arg(label.label_id)
+                                                    .arg(pick_normal);
+
+    if(KernelCacheEntry* t_pEntry = m_qCacheKernels.object(t_sKey)) {
+        inv = t_pEntry->inv;
+        noise_norm = t_pEntry->noise_norm;
+        vertno = t_pEntry->vertno;
+        K = t_pEntry->K;
+        m_matKernelFused = t_pEntry->matKernelFused;
+        m_bCombineXyz = t_pEntry->bCombineXyz;
+
+        inverseSetup = true;
+        return;
+    }
+
     //
     //   Set up the inverse according to the parameters
     //
@@ -262,6 +316,25 @@ void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 
     std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
 
+    //
+    //   Fuse the noise normalization into a float32 kernel. The normalization is positive and the same for all
+    //   orientations of a source, so scaling the kernel rows commutes with pooling the orientations.
+    //
+    m_bCombineXyz = inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false;
+    m_matKernelFused = K.cast<float>();
+
+    if((m_bdSPM || m_bsLORETA) && inv.noisenorm.rows() > 0)
+    {
+        VectorXd t_vecNoiseNorm = inv.noisenorm.diagonal();
+        qint32 t_iRowsPerSource = K.rows() / t_vecNoiseNorm.size();
+
+        for(qint32 i = 0; i < K.rows(); ++i)
+            m_matKernelFused.row(i) *= static_cast<float>(t_vecNoiseNorm[i / t_iRowsPerSource]);
+    }
+
+    int t_iCost = static_cast<int>((K.size()*sizeof(double) + m_matKernelFused.size()*sizeof(float)) / (1024*1024)) + 1;
+    m_qCacheKernels.insert(t_sKey, new KernelCacheEntry{inv, noise_norm, vertno, K, m_matKernelFused, m_bCombineXyz}, t_iCost);
+
     inverseSetup = true;
 }
 
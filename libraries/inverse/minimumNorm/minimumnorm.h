@@ -48,6 +48,7 @@
 #include <fs/label.h>
 
 #include <QSharedPointer>
+#include <QCache>
 
 
 //*************************************************************************************************************
@@ -129,7 +130,23 @@ public:
 
     //=========================================================================================================
     /**
-    * Perform the inverse setup: Prepares this inverse operator and assembles the kernel.
+    * Applies the float32 kernel of the last inverse setup to the data. Noise normalization is already folded
+    * into the kernel and free orientations are pooled as set up by doInverseSetup. The result is written to the
+    * caller owned matrix, which is only reallocated if its size changes, so repeated calls on equally sized
+    * blocks do not allocate.
+    *
+    * @param[in] data       The data (channels of the inverse operator x samples).
+    * @param[out] sol       The source data (n_dipoles x samples).
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool applyInverse(const MatrixXd &data, MatrixXd &sol);
+
+    //=========================================================================================================
+    /**
+    * Perform the inverse setup: Prepares this inverse operator and assembles the kernel. Setups are cached by
+    * nave, lambda, method, label and pick_normal, so switching back to a previous setup does not prepare the
+    * inverse operator again.
     *
     * @param[in] nave           Number of averages to use.
     * @param[in] pick_normal    If True, rather than pooling the orientations by taking the norm, only the
@@ -195,6 +212,19 @@ public:
     inline MatrixXd& getKernel();
 
 private:
+    //=========================================================================================================
+    /**
+    * A cached inverse setup.
+    */
+    struct KernelCacheEntry {
+        MNEInverseOperator inv;             /**< The setup inverse operator */
+        SparseMatrix<double> noise_norm;    /**< The noise normalization */
+        QList<VectorXi> vertno;             /**< The vertices numbers */
+        MatrixXd K;                         /**< Imaging kernel */
+        MatrixXf matKernelFused;            /**< Float32 imaging kernel with the noise normalization folded in */
+        bool bCombineXyz;                   /**< Whether the three orientations of each source are pooled */
+    };
+
     MNEInverseOperator m_inverseOperator;   /**< The inverse operator */
     float m_fLambda;                        /**< Regularization parameter */
     QString m_sMethod;                      /**< Selected method */
@@ -208,6 +238,11 @@ private:
     Label label;                            /**< The corresponding labels */
     MatrixXd K;                             /**< Imaging kernel */
 
+    MatrixXf m_matKernelFused;              /**< Float32 imaging kernel with the noise normalization folded in */
+    bool m_bCombineXyz;                     /**< Whether applyInverse pools the three orientations of each source */
+    MatrixXf m_matDataFloat;                /**< Preallocated float copy of the data block used by applyInverse */
+    MatrixXf m_matSolFloat;                 /**< Preallocated kernel output used by applyInverse */
+    QCache<QString, KernelCacheEntry> m_qCacheKernels;  /**< Inverse setups, keyed by nave, lambda, method, label and pick_normal. The cost is given in MB. */
 };
 
 //*************************************************************************************************************
@@ -215,38 +215,15 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
 
         int t_iMaxFound = 0;
 
-        Eigen::VectorXi t_pVecIdxElements(m_iNumGridPoints);
-
-        PowellIdxVec(t_iCurrentRow, m_iNumGridPoints, t_pVecIdxElements);
-
-        int t_iNumVecElements = m_iNumGridPoints;
+        //The per grid point quantities are shared by all Powell rows of this iteration
+        SubcorrBasis t_subcorrBasis;
+        calcSubcorrBasis(t_matProj_LeadField, t_matU_B, t_subcorrBasis);
 
         while(t_iMaxFound == 0)
         {
 
-            //Multithreading correlation calculation
-            #ifdef _OPENMP
-            #pragma omp parallel num_threads(m_iMaxNumThreads)
-            #endif
-            {
-            #ifdef _OPENMP
-            #pragma omp for
-            #endif
-                for(int i = 0; i < t_iNumVecElements; i++)
-                {
-                    int k = t_pVecIdxElements(i);
-                    //new Version: calculate matrix multiplication before
-                    //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                    MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                    int idx1 = m_ppPairIdxCombinations[k]->x1;
-                    int idx2 = m_ppPairIdxCombinations[k]->x2;
-
-                    RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                    t_vecRoh(k) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-                }
-            }
+            //Gram based correlation of all combinations of the current row
+            calcSubcorrRow(t_matProj_LeadField, t_subcorrBasis, t_iCurrentRow, t_vecRoh);//t_vecRoh holds the correlations roh_k
 
     //         if(r==0)
     //         {
@@ -289,8 +266,6 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                 t_iCurrentRow = t_iIdx2;
             else
                 t_iCurrentRow = t_iIdx1;
-
-            PowellIdxVec(t_iCurrentRow, m_iNumGridPoints, t_pVecIdxElements);
         }
 
         //subcorr benchmark
@@ -70,6 +70,9 @@ RapMusic::RapMusic()
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
+, m_bStreaming(false)
+, m_dStreamSubspaceChange(0.1)
+, m_iStreamUpdatedSamples(0)
 {
 }
 
@@ -87,6 +90,9 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
+, m_bStreaming(false)
+, m_dStreamSubspaceChange(0.1)
+, m_iStreamUpdatedSamples(0)
 {
     //Init
     init(p_pFwd, p_bSparsed, p_iN, p_dThr);
@@ -153,6 +159,8 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_ForwardSolution = p_pFwd;
 
+    resetStreaming();
+
     //##### Calc lead field combination #####
 
     std::cout << "Calculate gain matrix combinations. \n";
@@ -235,7 +243,10 @@ MNESourceEstimate RapMusic::calculateInverse(const FiffEvoked &p_fiffEvoked, boo
     if(m_iSamplesStcWindow <= 3) //if samples per stc aren't set -> use full window
     {
         QList< DipolePair<double> > t_RapDipoles;
-        calculateInverse(p_fiffEvoked.data, t_RapDipoles);
+        if(m_bStreaming)
+            calculateInverseStreaming(p_fiffEvoked.data, t_RapDipoles);
+        else
+            calculateInverse(p_fiffEvoked.data, t_RapDipoles);
 
         for(qint32 i = 0; i < t_RapDipoles.size(); ++i)
         {
@@ -271,6 +282,9 @@ MNESourceEstimate RapMusic::calculateInverse(const FiffEvoked &p_fiffEvoked, boo
         qint32 curResultSample = 0;
         qint32 stcWindowSize = m_iSamplesStcWindow - 2*t_iSamplesDiscard;
 
+        qint32 winStart = 0;
+        qint32 prevWinEnd = 0;
+
         while(!last)
         {
             QList< DipolePair<double> > t_RapDipoles;
@@ -279,10 +293,12 @@ MNESourceEstimate RapMusic::calculateInverse(const FiffEvoked &p_fiffEvoked, boo
             if(curSample + m_iSamplesStcWindow >= t_iNumSteps) //last
             {
                 last = true;
-                data = p_fiffEvoked.data.block(0, p_fiffEvoked.data.cols()-m_iSamplesStcWindow, t_iNumSensors, m_iSamplesStcWindow);
+                winStart = p_fiffEvoked.data.cols()-m_iSamplesStcWindow;
             }
             else
-                data = p_fiffEvoked.data.block(0, curSample, t_iNumSensors, m_iSamplesStcWindow);
+                winStart = curSample;
+
+            data = p_fiffEvoked.data.block(0, winStart, t_iNumSensors, m_iSamplesStcWindow);
 
 
             curSample += (m_iSamplesStcWindow - t_iSamplesOverlap);
@@ -290,7 +306,16 @@ MNESourceEstimate RapMusic::calculateInverse(const FiffEvoked &p_fiffEvoked, boo
                 curSample -= t_iSamplesDiscard; //shift on start t_iSamplesDiscard backwards
 
             //Calculate
-            calculateInverse(data, t_RapDipoles);
+            if(m_bStreaming)
+            {
+                //Only the samples after the end of the previous window are new
+                qint32 numNewSamples = (!first && winStart < prevWinEnd) ? winStart + m_iSamplesStcWindow - prevWinEnd : -1;
+                calculateInverseStreaming(data, t_RapDipoles, numNewSamples);
+            }
+            else
+                calculateInverse(data, t_RapDipoles);
+
+            prevWinEnd = winStart + m_iSamplesStcWindow;
 
             //Assign Result
             if(last)
@@ -480,28 +505,10 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
-
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
+        //Gram based correlation of all pairs, the per grid point quantities are shared by all pairs
+        SubcorrBasis t_subcorrBasis;
+        calcSubcorrBasis(t_matProj_LeadField, t_matU_B, t_subcorrBasis);
+        calcSubcorrScan(t_matProj_LeadField, t_subcorrBasis, t_vecRoh);//t_vecRoh holds the correlations roh_k
 
 
 //         if(r==0)
@@ -753,6 +760,201 @@ double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vecto
 }
 
 
+//*************************************************************************************************************
+
+double RapMusic::subcorr(const Matrix6T& p_matGram_G, const Matrix6T& p_matGram_U_B)
+{
+    //The correlations c are the singular values of U_A^T*U_B, with U_A = G*V_A*Sigma_A^-1. Hence c^2 are the
+    //eigenvalues of (V_A*Sigma_A^-1)^T * G^T*U_B*U_B^T*G * (V_A*Sigma_A^-1).
+
+    //Fast path: trace((G^T*G)^-1) < 1/epsilon^2 guarantees that all singular values of G are larger than
+    //epsilon = 10^-5 (full rank), so any whitening W with W^T*G^T*G*W = I can be used -> W = L^-T
+    Eigen::LLT<Matrix6T> t_lltGram(p_matGram_G);
+
+    if(t_lltGram.info() == Eigen::Success)
+    {
+        Matrix6T t_matL_inv = t_lltGram.matrixL().solve(Matrix6T::Identity());
+
+        if(t_matL_inv.squaredNorm() < 1.0/(0.00001*0.00001))
+        {
+            Matrix6T t_matCor = t_matL_inv*p_matGram_U_B*t_matL_inv.transpose();
+
+            Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigCor(t_matCor, Eigen::EigenvaluesOnly);
+
+            return sqrt(std::max(t_eigCor.eigenvalues()(5), 0.0));
+        }
+    }
+
+    //Rank deficient or badly conditioned G -> lt. Mosher 1998: Only Retain those Components of U_A that
+    //correspond to nonzero singular values, same epsilon as getRank
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigGram(p_matGram_G);
+    const Vector6T& t_vecLambda = t_eigGram.eigenvalues(); //sigma_A^2 in ascending order
+
+    if(t_vecLambda(5) <= 0.0)
+        return 0.0;
+
+    //Rank 1 -> only the first principal component
+    if(t_vecLambda(4) <= 0.00001*0.00001)
+    {
+        Vector6T t_vecV = t_eigGram.eigenvectors().col(5);
+        return sqrt(std::max(t_vecV.dot(p_matGram_U_B*t_vecV)/t_vecLambda(5), 0.0));
+    }
+
+    Matrix6T t_matW = Matrix6T::Zero();
+    for(int i = 5; i >= 0; --i)
+    {
+        if(i < 5 && t_vecLambda(i) <= 0.00001*0.00001)
+            break;
+
+        t_matW.col(i) = t_eigGram.eigenvectors().col(i)/sqrt(t_vecLambda(i));
+    }
+
+    Matrix6T t_matCor = t_matW.transpose()*p_matGram_U_B*t_matW;
+
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigCor(t_matCor, Eigen::EigenvaluesOnly);
+
+    return sqrt(std::max(t_eigCor.eigenvalues()(5), 0.0));
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcSubcorrBasis(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, SubcorrBasis& p_basis) const
+{
+    int t_iNumPoints = p_matProj_LeadField.cols()/3;
+
+    p_basis.matProj_U_B = p_matU_B.transpose()*p_matProj_LeadField;
+    p_basis.matGram.resize(3, 3*t_iNumPoints);
+    p_basis.matGram_U_B.resize(3, 3*t_iNumPoints);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        p_basis.matGram.block<3,3>(0,3*i).noalias() = p_matProj_LeadField.middleCols<3>(3*i).transpose()
+                                                      * p_matProj_LeadField.middleCols<3>(3*i);
+        p_basis.matGram_U_B.block<3,3>(0,3*i).noalias() = p_basis.matProj_U_B.middleCols<3>(3*i).transpose()
+                                                          * p_basis.matProj_U_B.middleCols<3>(3*i);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcSubcorrScan(const MatrixXT& p_matProj_LeadField, const SubcorrBasis& p_basis, VectorXT& p_vecRoh) const
+{
+    //Grid points per block -> the cross Gram tiles (3*block x 3*block) stay in the cache
+    const int t_iBlockSize = 32;
+
+    int t_iNumPoints = p_matProj_LeadField.cols()/3;
+    int t_iNumBlocks = (t_iNumPoints + t_iBlockSize - 1)/t_iBlockSize;
+    int t_iNumBlockCombinations = t_iNumBlocks*(t_iNumBlocks+1)/2;
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        MatrixXT t_matGramTile;
+        MatrixXT t_matGramTile_U_B;
+        Matrix6T t_matGram;
+        Matrix6T t_matGram_U_B;
+
+    #ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+        for(int b = 0; b < t_iNumBlockCombinations; ++b)
+        {
+            int t_iBlock1, t_iBlock2;
+            RapMusic::getPointPair(t_iNumBlocks, b, t_iBlock1, t_iBlock2);
+
+            int t_iStart1 = t_iBlock1*t_iBlockSize;
+            int t_iStart2 = t_iBlock2*t_iBlockSize;
+            int t_iSize1 = std::min(t_iBlockSize, t_iNumPoints - t_iStart1);
+            int t_iSize2 = std::min(t_iBlockSize, t_iNumPoints - t_iStart2);
+
+            t_matGramTile.noalias() = p_matProj_LeadField.middleCols(3*t_iStart1, 3*t_iSize1).transpose()
+                                      * p_matProj_LeadField.middleCols(3*t_iStart2, 3*t_iSize2);
+            t_matGramTile_U_B.noalias() = p_basis.matProj_U_B.middleCols(3*t_iStart1, 3*t_iSize1).transpose()
+                                          * p_basis.matProj_U_B.middleCols(3*t_iStart2, 3*t_iSize2);
+
+            for(int idx1 = t_iStart1; idx1 < t_iStart1 + t_iSize1; ++idx1)
+            {
+                t_matGram.topLeftCorner<3,3>() = p_basis.matGram.block<3,3>(0,3*idx1);
+                t_matGram_U_B.topLeftCorner<3,3>() = p_basis.matGram_U_B.block<3,3>(0,3*idx1);
+
+                for(int idx2 = std::max(idx1, t_iStart2); idx2 < t_iStart2 + t_iSize2; ++idx2)
+                {
+                    t_matGram.bottomRightCorner<3,3>() = p_basis.matGram.block<3,3>(0,3*idx2);
+                    t_matGram.topRightCorner<3,3>() = t_matGramTile.block<3,3>(3*(idx1-t_iStart1), 3*(idx2-t_iStart2));
+                    t_matGram.bottomLeftCorner<3,3>() = t_matGram.topRightCorner<3,3>().transpose();
+
+                    t_matGram_U_B.bottomRightCorner<3,3>() = p_basis.matGram_U_B.block<3,3>(0,3*idx2);
+                    t_matGram_U_B.topRightCorner<3,3>() = t_matGramTile_U_B.block<3,3>(3*(idx1-t_iStart1), 3*(idx2-t_iStart2));
+                    t_matGram_U_B.bottomLeftCorner<3,3>() = t_matGram_U_B.topRightCorner<3,3>().transpose();
+
+                    p_vecRoh(RapMusic::getPairIdx(t_iNumPoints, idx1, idx2)) = RapMusic::subcorr(t_matGram, t_matGram_U_B);
+                }
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcSubcorrRow(const MatrixXT& p_matProj_LeadField,
+                              const SubcorrBasis& p_basis,
+                              int p_iRow,
+                              VectorXT& p_vecRoh) const
+{
+    int t_iNumPoints = p_matProj_LeadField.cols()/3;
+
+    //Cross Gram matrices of the row point with all grid points (3*points x 3)
+    MatrixXT t_matGramRow = p_matProj_LeadField.transpose()*p_matProj_LeadField.middleCols<3>(3*p_iRow);
+    MatrixXT t_matGramRow_U_B = p_basis.matProj_U_B.transpose()*p_basis.matProj_U_B.middleCols<3>(3*p_iRow);
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        Matrix6T t_matGram;
+        Matrix6T t_matGram_U_B;
+
+    #ifdef _OPENMP
+    #pragma omp for
+    #endif
+        for(int i = 0; i < t_iNumPoints; ++i)
+        {
+            //Same order as in the pair combinations (smaller index first), so a pair yields the same correlation
+            //from both of its rows
+            int t_iFirst = std::min(i, p_iRow);
+            int t_iSecond = std::max(i, p_iRow);
+
+            t_matGram.topLeftCorner<3,3>() = p_basis.matGram.block<3,3>(0,3*t_iFirst);
+            t_matGram.bottomRightCorner<3,3>() = p_basis.matGram.block<3,3>(0,3*t_iSecond);
+            t_matGram_U_B.topLeftCorner<3,3>() = p_basis.matGram_U_B.block<3,3>(0,3*t_iFirst);
+            t_matGram_U_B.bottomRightCorner<3,3>() = p_basis.matGram_U_B.block<3,3>(0,3*t_iSecond);
+
+            if(i <= p_iRow)
+            {
+                t_matGram.topRightCorner<3,3>() = t_matGramRow.middleRows<3>(3*i);
+                t_matGram_U_B.topRightCorner<3,3>() = t_matGramRow_U_B.middleRows<3>(3*i);
+            }
+            else
+            {
+                t_matGram.topRightCorner<3,3>() = t_matGramRow.middleRows<3>(3*i).transpose();
+                t_matGram_U_B.topRightCorner<3,3>() = t_matGramRow_U_B.middleRows<3>(3*i).transpose();
+            }
+            t_matGram.bottomLeftCorner<3,3>() = t_matGram.topRightCorner<3,3>().transpose();
+            t_matGram_U_B.bottomLeftCorner<3,3>() = t_matGram_U_B.topRightCorner<3,3>().transpose();
+
+            p_vecRoh(RapMusic::getPairIdx(t_iNumPoints, t_iFirst, t_iSecond)) = RapMusic::subcorr(t_matGram, t_matGram_U_B);
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RapMusic::calcA_k_1(   const MatrixX6T& p_matG_k_1,
@@ -909,3 +1111,223 @@ void RapMusic::setStcAttr(int p_iSampStcWin, float p_fStcOverlap)
     m_iSamplesStcWindow = p_iSampStcWin;
     m_fStcOverlap = p_fStcOverlap;
 }
+
+
+//*************************************************************************************************************
+
+void RapMusic::setStreamingMode(bool p_bStreaming, double p_dSubspaceChange)
+{
+    m_bStreaming = p_bStreaming;
+    m_dStreamSubspaceChange = p_dSubspaceChange;
+
+    resetStreaming();
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::resetStreaming()
+{
+    m_matStreamWindow.resize(0,0);
+    m_matStreamCov.resize(0,0);
+    m_matStreamPhi_s.resize(0,0);
+    m_iStreamUpdatedSamples = 0;
+    m_qListStreamDipoles.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool RapMusic::calculateInverseStreaming(const MatrixXd& p_matMeasurement,
+                                         QList< DipolePair<double> > &p_RapDipoles,
+                                         int p_iNumNewSamples)
+{
+    p_RapDipoles.clear();
+
+    //if not initialized -> break
+    if(!m_bIsInit)
+    {
+        std::cout << "RAP MUSIC wasn't initialized!";
+        return false;
+    }
+
+    //Test if data are correct
+    if(p_matMeasurement.rows() != m_iNumChannels)
+    {
+        std::cout << "Lead Field channels do not fit to number of measurement channels!";
+        return false;
+    }
+
+    int t_iNumSamples = p_matMeasurement.cols();
+
+    //
+    // Window covariance F*F^T -> rank limited update with the new samples, recomputed once the updates
+    // sum up to a few windows to keep the round-off from accumulating
+    //
+    if(p_iNumNewSamples >= 0
+            && p_iNumNewSamples < t_iNumSamples
+            && m_matStreamWindow.cols() == t_iNumSamples
+            && m_iStreamUpdatedSamples + p_iNumNewSamples < 10*t_iNumSamples)
+    {
+        if(p_iNumNewSamples > 0)
+        {
+            m_matStreamCov.noalias() += p_matMeasurement.rightCols(p_iNumNewSamples) * p_matMeasurement.rightCols(p_iNumNewSamples).transpose();
+            m_matStreamCov.noalias() -= m_matStreamWindow.leftCols(p_iNumNewSamples) * m_matStreamWindow.leftCols(p_iNumNewSamples).transpose();
+        }
+
+        m_iStreamUpdatedSamples += p_iNumNewSamples;
+    }
+    else
+    {
+        m_matStreamCov = makeSquareMat(p_matMeasurement);
+        m_iStreamUpdatedSamples = 0;
+    }
+
+    m_matStreamWindow = p_matMeasurement;
+
+    //
+    // Signal subspace -> one orthogonal iteration step starting at the subspace of the previous window
+    //
+    bool t_bFullScan = m_qListStreamDipoles.isEmpty();
+    bool t_bRestart = m_matStreamPhi_s.cols() == 0;
+
+    if(!t_bRestart)
+    {
+        int t_iRank = m_matStreamPhi_s.cols();
+
+        Eigen::HouseholderQR<MatrixXT> t_qrCovPhi(m_matStreamCov * m_matStreamPhi_s);
+        MatrixXT t_matQ = t_qrCovPhi.householderQ() * MatrixXT::Identity(m_iNumChannels, t_iRank);
+
+        //Ritz values and vectors of the new subspace, ordered descending like the singular values
+        MatrixXT t_matCovQ = m_matStreamCov * t_matQ;
+        Eigen::SelfAdjointEigenSolver<MatrixXT> t_eigRitz(t_matQ.transpose() * t_matCovQ);
+        VectorXT t_vecRitz = t_eigRitz.eigenvalues().reverse();
+        MatrixXT t_matRitz = t_eigRitz.eigenvectors().rowwise().reverse();
+
+        MatrixXT t_matPhi_s = t_matQ * t_matRitz;
+        t_matCovQ = t_matCovQ * t_matRitz;
+
+        //Restart with a full SVD when the rank changed or the tracked subspace is no longer invariant
+        double t_dResidual = (t_matCovQ - t_matPhi_s * t_vecRitz.asDiagonal()).norm();
+
+        //Rank the same values as calcPhi_s: the eigenvalues of F*F^T for windows with more samples than channels,
+        //otherwise the singular values of F, i.e., the square roots of the Ritz values
+        VectorXT t_vecRankValues = t_iNumSamples > m_iNumChannels ? t_vecRitz : VectorXT(t_vecRitz.cwiseMax(0.0).cwiseSqrt());
+
+        if(getRank(t_vecRankValues.asDiagonal()) != t_iRank
+                || t_vecRitz(t_iRank-1) <= 0.0
+                || t_dResidual > m_dStreamSubspaceChange * t_vecRitz(t_iRank-1))
+        {
+            t_bRestart = true;
+        }
+        else
+        {
+            //Sine of the largest principal angle between the previous and the new subspace
+            Eigen::JacobiSVD<MatrixXT> t_svdAngles(m_matStreamPhi_s.transpose() * t_matPhi_s);
+            double t_dCosMin = std::min(t_svdAngles.singularValues()(t_iRank-1), 1.0);
+
+            if(sqrt(1.0 - t_dCosMin*t_dCosMin) > m_dStreamSubspaceChange)
+                t_bFullScan = true;
+
+            m_matStreamPhi_s = t_matPhi_s;
+        }
+    }
+
+    if(t_bRestart)
+    {
+        MatrixXT* t_pMatPhi_s = NULL;
+        calcPhi_s(p_matMeasurement, t_pMatPhi_s);
+        m_matStreamPhi_s = *t_pMatPhi_s;
+        delete t_pMatPhi_s;
+
+        t_bFullScan = true;
+    }
+
+    int t_iMaxSearch = m_iN < m_matStreamPhi_s.cols() ? m_iN : m_matStreamPhi_s.cols(); //The smallest of Rank and Iterations
+
+    //
+    // RAP MUSIC iterations
+    //
+    MatrixXT t_matOrthProj = MatrixXT::Identity(m_iNumChannels,m_iNumChannels);
+    MatrixXT t_matA_k_1 = MatrixXT::Zero(m_iNumChannels, t_iMaxSearch);
+    MatrixXT t_matProj_LeadField;
+
+    for(int r = 0; r < t_iMaxSearch; ++r)
+    {
+        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;
+
+        Eigen::JacobiSVD<MatrixXT> t_svdProj_Phi_S(t_matOrthProj * m_matStreamPhi_s, Eigen::ComputeThinU);
+        MatrixXT t_matU_B;
+        useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
+
+        SubcorrBasis t_subcorrBasis;
+        calcSubcorrBasis(t_matProj_LeadField, t_matU_B, t_subcorrBasis);
+
+        VectorXT t_vecRoh = VectorXT::Zero(m_iNumLeadFieldCombinations);
+        VectorXT::Index t_iMaxIdx = 0;
+        double t_val_roh_k = 0.0;
+
+        //Warm start -> Powell search starting at the corresponding source of the previous window
+        if(!t_bFullScan && r < m_qListStreamDipoles.size())
+        {
+            int t_iCurrentRow = m_qListStreamDipoles[r].m_iIdx1;
+            int t_iMaxIdx_old = -1;
+
+            while(true)
+            {
+                calcSubcorrRow(t_matProj_LeadField, t_subcorrBasis, t_iCurrentRow, t_vecRoh);
+
+                t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);
+
+                if((int)t_iMaxIdx == t_iMaxIdx_old)
+                    break;
+
+                t_iMaxIdx_old = t_iMaxIdx;
+
+                if(m_ppPairIdxCombinations[t_iMaxIdx]->x1 == t_iCurrentRow)
+                    t_iCurrentRow = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+                else
+                    t_iCurrentRow = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
+            }
+
+            //A source which got lost has to be searched for in all pairs
+            if(t_val_roh_k < m_dThreshold)
+                t_bFullScan = true;
+        }
+
+        if(t_bFullScan || r >= m_qListStreamDipoles.size())
+        {
+            calcSubcorrScan(t_matProj_LeadField, t_subcorrBasis, t_vecRoh);
+            t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);
+        }
+
+        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
+        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+
+        //Calculations with the max correlated dipole pair G_k_1
+        MatrixX6T t_matG_k_1(m_ForwardSolution.sol->data.rows(),6);
+        getGainMatrixPair(m_ForwardSolution.sol->data, t_matG_k_1, t_iIdx1, t_iIdx2);
+
+        MatrixX6T t_matProj_G_k_1 = t_matOrthProj * t_matG_k_1;
+
+        //Calculate source direction
+        Vector6T t_vec_phi_k_1(6);
+        RapMusic::subcorr(t_matProj_G_k_1, t_matU_B, t_vec_phi_k_1);
+
+        RapMusic::insertSource(t_iIdx1, t_iIdx2, t_vec_phi_k_1, t_val_roh_k, p_RapDipoles);
+
+        //Stop Searching when Correlation is smaller then the Threshold
+        if (t_val_roh_k < m_dThreshold)
+            break;
+
+        //Calculate A_k_1 = [a_theta_1..a_theta_k_1] matrix for subtraction of found source
+        RapMusic::calcA_k_1(t_matG_k_1, t_vec_phi_k_1, r, t_matA_k_1);
+
+        //Calculate new orthogonal Projector (Pi_k_1)
+        calcOrthProj(t_matA_k_1, t_matOrthProj);
+    }
+
+    m_qListStreamDipoles = p_RapDipoles;
+
+    return true;
+}
@@ -61,6 +61,9 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 #include <Eigen/LU>
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
+#include <Eigen/Eigenvalues>
 
 
 //*************************************************************************************************************
@@ -183,6 +186,44 @@ public:
     */
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
+    //=========================================================================================================
+    /**
+    * Enables or disables the streaming mode. In streaming mode the stc windows are processed with
+    * calculateInverseStreaming, which tracks the signal subspace across window hops and warm starts the dipole
+    * search from the sources of the previous window.
+    *
+    * @param[in] p_bStreaming       Whether the streaming mode is used.
+    * @param[in] p_dSubspaceChange  Sine of the largest principal angle between the signal subspaces of two
+    *                               consecutive windows above which a full scan is done (default 0.1).
+    */
+    void setStreamingMode(bool p_bStreaming, double p_dSubspaceChange = 0.1);
+
+    //=========================================================================================================
+    /**
+    * Discards the tracked signal subspace and the sources of the last window, the next streaming window starts
+    * with a full SVD and a full scan.
+    */
+    void resetStreaming();
+
+    //=========================================================================================================
+    /**
+    * Calculates the RAP MUSIC sources of the next window of a stream. The window covariance F*F^T is updated
+    * with the new samples only and the signal subspace of the previous window is refined by one step of an
+    * orthogonal iteration instead of a JacobiSVD of the window. As long as the subspace does not change
+    * significantly, the search for each source is a Powell search starting at the corresponding source of the
+    * previous window, otherwise all pairs are scanned. The covariance update needs overlapping windows, without
+    * overlap (p_iNumNewSamples = -1) the covariance is recomputed from every window.
+    *
+    * @param[in] p_matMeasurement   The current window (channels x samples).
+    * @param[out] p_RapDipoles      The found dipole pairs.
+    * @param[in] p_iNumNewSamples   Number of samples at the end of the window which were not part of the
+    *                               previous window. -1 (default) if the windows are not continuous.
+    * @return   true if successful, false otherwise.
+    */
+    bool calculateInverseStreaming(const MatrixXd& p_matMeasurement,
+                                   QList< DipolePair<double> > &p_RapDipoles,
+                                   int p_iNumNewSamples = -1);
+
 protected:
     //=========================================================================================================
     /**
@@ -228,6 +269,68 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1);
 
+    //=========================================================================================================
+    /**
+    * Computes the maximal subspace correlation of a Lead Field combination from its 6 x 6 Gram matrices
+    * instead of the m x 6 Lead Field combination itself. The singular values of G are the square roots of the
+    * eigenvalues of G^T*G, so the rank reduction is the same as in subcorr. When G^T*G is well conditioned a
+    * Cholesky whitening is used, otherwise the eigendecomposition of G^T*G.
+    *
+    * @param[in] p_matGram_G    The Gram matrix G^T*G of the projected Lead Field combination.
+    * @param[in] p_matGram_U_B  The matrix G^T*U_B*U_B^T*G of the projected Lead Field combination.
+    * @return   The maximal correlation c_1 of the subspace correlation of the current projected Lead Field
+    *           combination and the projected measurement.
+    */
+    static double subcorr(const Matrix6T& p_matGram_G, const Matrix6T& p_matGram_U_B);
+
+    //=========================================================================================================
+    /**
+    * Per grid point quantities of the projected Lead Field which are needed by the Gram based subspace
+    * correlation. They are calculated once per RAP MUSIC iteration and shared by all pairs.
+    */
+    struct SubcorrBasis
+    {
+        MatrixXT matProj_U_B;   /**< U_B^T times the projected Lead Field (rank x 3*points). */
+        MatrixXT matGram;       /**< The 3 x 3 blocks G_i^T*G_i of all grid points (3 x 3*points). */
+        MatrixXT matGram_U_B;   /**< The 3 x 3 blocks G_i^T*U_B*U_B^T*G_i of all grid points (3 x 3*points). */
+    };
+
+    //=========================================================================================================
+    /**
+    * Calculates the per grid point quantities of the projected Lead Field for the current iteration.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field (m x 3*points).
+    * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_basis               The per grid point quantities.
+    */
+    void calcSubcorrBasis(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, SubcorrBasis& p_basis) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of all Lead Field combinations. The pairs are processed in blocks of
+    * grid points, the cross Gram matrices G_i^T*G_j of a block are calculated with one matrix product and each
+    * pair then only needs the 6 x 6 Gram based subcorr.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field (m x 3*points).
+    * @param[in] p_basis                The per grid point quantities of the current iteration.
+    * @param[out] p_vecRoh              The correlations of all Lead Field combinations.
+    */
+    void calcSubcorrScan(const MatrixXT& p_matProj_LeadField, const SubcorrBasis& p_basis, VectorXT& p_vecRoh) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of all Lead Field combinations which contain the given grid point.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field (m x 3*points).
+    * @param[in] p_basis                The per grid point quantities of the current iteration.
+    * @param[in] p_iRow                 The grid point which is combined with all other grid points.
+    * @param[out] p_vecRoh              The correlations, only the combinations of p_iRow are written.
+    */
+    void calcSubcorrRow(const MatrixXT& p_matProj_LeadField,
+                        const SubcorrBasis& p_basis,
+                        int p_iRow,
+                        VectorXT& p_vecRoh) const;
+
     //=========================================================================================================
     /**
     * Calculates the accumulated manifold vectors A_{k1}
@@ -285,6 +388,17 @@ protected:
     */
     static void getPointPair(const int p_iPoints, const int p_iCurIdx, int &p_iIdx1, int &p_iIdx2);
 
+    //=========================================================================================================
+    /**
+    * Calculates the combination index of the points Idx1 <= Idx2, this is the inverse of getPointPair.
+    *
+    * @param[in] p_iPoints  The number of points n which are combined with each other.
+    * @param[in] p_iIdx1    The first index.
+    * @param[in] p_iIdx2    The second index.
+    * @return   The combination index.
+    */
+    static inline int getPairIdx(const int p_iPoints, const int p_iIdx1, const int p_iIdx2);
+
     //=========================================================================================================
     /**
     * Returns a gain matrix pair for the given indices
@@ -334,6 +448,15 @@ protected:
     int m_iSamplesStcWindow;    /**< Number of samples per localization window */
     float m_fStcOverlap;        /**< Percentage of localization window overlap */
 
+    //Streaming stuff
+    bool m_bStreaming;                  /**< Whether the stc windows are processed in streaming mode */
+    double m_dStreamSubspaceChange;     /**< Subspace change (sine of the largest principal angle) above which a full scan is done */
+    MatrixXT m_matStreamWindow;         /**< The last streaming window */
+    MatrixXT m_matStreamCov;            /**< F*F^T of the last streaming window */
+    MatrixXT m_matStreamPhi_s;          /**< The tracked signal subspace */
+    int m_iStreamUpdatedSamples;        /**< Samples added by rank limited updates since m_matStreamCov was recomputed */
+    QList< DipolePair<double> > m_qListStreamDipoles;   /**< The sources of the last streaming window */
+
     //=========================================================================================================
     /**
     * Returns the rank r of a singular value matrix based on non-zero singular values
@@ -407,6 +530,14 @@ inline int RapMusic::useFullRank(   const MatrixXT& p_Mat,
 }
 
 
+//*************************************************************************************************************
+
+inline int RapMusic::getPairIdx(const int p_iPoints, const int p_iIdx1, const int p_iIdx2)
+{
+    return p_iIdx1*p_iPoints - (p_iIdx1*(p_iIdx1-1))/2 + p_iIdx2 - p_iIdx1;
+}
+
+
 //*************************************************************************************************************
 
 inline RapMusic::MatrixXT RapMusic::makeSquareMat(const MatrixXT& p_matF)
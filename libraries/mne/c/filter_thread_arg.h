@@ -73,6 +73,13 @@
 namespace MNELIB
 {
 
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class MneSurfaceBvh;
+
 
 //=============================================================================================================
 /**
@@ -104,6 +111,7 @@ public:
     MneSourceSpaceOld* s;           /* The source space to process */
     FIFFLIB::FiffCoordTransOld* mri_head_t;  /* Coordinate transformation */
     MneSurfaceOld*   surf;          /* The inner skull surface */
+    MneSurfaceBvh*   bvh;           /* Search structure for the inner skull surface */
     float          limit;           /* Distance limit */
     FILE           *filtered;       /* Log omitted point locations here */
     int            stat;            /* How was it? */
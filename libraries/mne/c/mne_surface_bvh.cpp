@@ -0,0 +1,565 @@
+//=============================================================================================================
+/**
+* @file     mne_surface_bvh.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MneSurfaceBvh Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_surface_bvh.h"
+#include "mne_surface_old.h"
+#include "mne_triangle.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define X_61 0
+#define Y_61 1
+#define Z_61 2
+
+#define VEC_DOT_61(x,y) ((x)[X_61]*(y)[X_61] + (x)[Y_61]*(y)[Y_61] + (x)[Z_61]*(y)[Z_61])
+
+#define VEC_LEN_61(x) sqrt(VEC_DOT_61(x,x))
+
+#define VEC_DIFF_61(from,to,diff) {\
+    (diff)[X_61] = (to)[X_61] - (from)[X_61];\
+    (diff)[Y_61] = (to)[Y_61] - (from)[Y_61];\
+    (diff)[Z_61] = (to)[Z_61] - (from)[Z_61];\
+    }
+
+#define CROSS_PRODUCT_61(x,y,xy) {\
+    (xy)[X_61] =   (x)[Y_61]*(y)[Z_61]-(y)[Y_61]*(x)[Z_61];\
+    (xy)[Y_61] = -((x)[X_61]*(y)[Z_61]-(y)[X_61]*(x)[Z_61]);\
+    (xy)[Z_61] =   (x)[X_61]*(y)[Y_61]-(y)[X_61]*(x)[Y_61];\
+    }
+
+#define BVH_LEAF_SIZE   8       /* Maximum number of items in a leaf */
+#define BVH_STACK       128     /* Traversal stack size, the depth of a median split tree is log2(n/BVH_LEAF_SIZE) */
+#define BVH_FAR         2.0     /* Clusters farther than this many radii away are replaced by a dipole */
+#define BVH_INTEGER_TOL 0.1     /* Accept the approximated winding number only this close to an integer */
+#define BVH_NEAR_REL    1e-6    /* Points closer than this relative to the surface size use the exact sum */
+#define BVH_PRUNE_TOL   1e-5    /* Safety margin for pruning against rounding errors */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC METHODS
+//=============================================================================================================
+
+static double box_dist(const float *bmin, const float *bmax, const float *r)
+/*
+ * Distance from a point to an axis aligned box, zero inside
+ */
+{
+    double d,sum = 0.0;
+    int    c;
+
+    for (c = 0; c < 3; c++) {
+        if (r[c] < bmin[c])
+            d = bmin[c] - r[c];
+        else if (r[c] > bmax[c])
+            d = r[c] - bmax[c];
+        else
+            continue;
+        sum += d*d;
+    }
+    return sqrt(sum);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MneSurfaceBvh::MneSurfaceBvh(MneSurfaceOld *s)
+: m_pSurf(s)
+, m_bClosed(false)
+, m_fNearLimit(0.0f)
+{
+    QVector<float> bmin,bmax,center;
+    MneTriangle*   tri;
+    float          *r;
+    int            k,c;
+    /*
+     * Triangles
+     */
+    bmin.resize(3*s->ntri);
+    bmax.resize(3*s->ntri);
+    center.resize(3*s->ntri);
+    for (k = 0, tri = s->tris; k < s->ntri; k++, tri++) {
+        for (c = 0; c < 3; c++) {
+            bmin[3*k+c]   = std::min(tri->r1[c],std::min(tri->r2[c],tri->r3[c]));
+            bmax[3*k+c]   = std::max(tri->r1[c],std::max(tri->r2[c],tri->r3[c]));
+            center[3*k+c] = (tri->r1[c]+tri->r2[c]+tri->r3[c])/3.0f;
+        }
+    }
+    build(bmin,bmax,center,m_qVecTriNodes,m_qVecTriOrder);
+    add_cluster_moments();
+    /*
+     * Vertices
+     */
+    bmin.resize(3*s->np);
+    for (k = 0; k < s->np; k++) {
+        r = s->rr[k];
+        for (c = 0; c < 3; c++)
+            bmin[3*k+c] = r[c];
+    }
+    build(bmin,bmin,bmin,m_qVecVertNodes,m_qVecVertOrder);
+
+    m_qVecInTri.fill(FALSE,s->np);
+    for (k = 0, tri = s->tris; k < s->ntri; k++, tri++)
+        for (c = 0; c < 3; c++)
+            m_qVecInTri[tri->vert[c]] = TRUE;
+
+    m_bClosed = check_closed();
+    if (!m_qVecTriNodes.isEmpty()) {
+        const Node& root = m_qVecTriNodes[0];
+        float diag[3];
+        VEC_DIFF_61(root.bmin,root.bmax,diag);
+        m_fNearLimit = BVH_NEAR_REL*VEC_LEN_61(diag);
+    }
+}
+
+
+//*************************************************************************************************************
+
+MneSurfaceBvh::~MneSurfaceBvh()
+{
+}
+
+
+//*************************************************************************************************************
+
+double MneSurfaceBvh::winding_number(float *r) const
+{
+    int          stack[BVH_STACK];
+    int          nstack = 0;
+    double       tot_angle = 0.0;
+    double       diff[3],dist,w,w0;
+    float        r12[3],r13[3],nn[3],v[3],lim;
+    MneTriangle* tri;
+    int          k,c;
+
+    if (!m_bClosed || m_qVecTriNodes.isEmpty())
+        return MneSurfaceOrVolume::sum_solids(r,m_pSurf)/(4*M_PI);
+
+    stack[nstack++] = 0;
+    while (nstack > 0) {
+        const Node& node = m_qVecTriNodes[stack[--nstack]];
+        /*
+         * Far away clusters are approximated by a dipole
+         */
+        VEC_DIFF_61(r,node.cent,diff);
+        dist = VEC_LEN_61(diff);
+        if (dist > BVH_FAR*node.rad) {
+            tot_angle += VEC_DOT_61(node.nsum,diff)/(dist*dist*dist);
+            continue;
+        }
+        if (node.left >= 0) {
+            stack[nstack++] = node.left;
+            stack[nstack++] = node.right;
+            continue;
+        }
+        for (k = node.start; k < node.start+node.count; k++) {
+            tri = m_pSurf->tris+m_qVecTriOrder[k];
+            /*
+             * Very close to a triangle the sum is not reliably an integer
+             */
+            lim = m_fNearLimit;
+            for (c = 0; c < 3; c++)
+                if (r[c] < std::min(tri->r1[c],std::min(tri->r2[c],tri->r3[c]))-lim ||
+                        r[c] > std::max(tri->r1[c],std::max(tri->r2[c],tri->r3[c]))+lim)
+                    break;
+            if (c == 3) {
+                VEC_DIFF_61(tri->r1,tri->r2,r12);
+                VEC_DIFF_61(tri->r1,tri->r3,r13);
+                CROSS_PRODUCT_61(r12,r13,nn);
+                VEC_DIFF_61(tri->r1,r,v);
+                if (std::fabs(VEC_DOT_61(v,nn)) <= lim*VEC_LEN_61(nn))
+                    return MneSurfaceOrVolume::sum_solids(r,m_pSurf)/(4*M_PI);
+            }
+            tot_angle += MneSurfaceOrVolume::solid_angle(r,tri);
+        }
+    }
+    w  = tot_angle/(4*M_PI);
+    w0 = floor(w+0.5);
+    if (std::fabs(w-w0) > BVH_INTEGER_TOL)
+        return MneSurfaceOrVolume::sum_solids(r,m_pSurf)/(4*M_PI);
+    return w0;
+}
+
+
+//*************************************************************************************************************
+
+int MneSurfaceBvh::nearest_vertex(float *r, float maxdist, int tri_only, float *distp) const
+{
+    int   stack[BVH_STACK];
+    float sdist[BVH_STACK];
+    int   nstack = 0;
+    int   best = -1;
+    float mindist = maxdist;
+    float diff[3],dist,d1,d2;
+    int   k,p;
+
+    if (m_qVecVertNodes.isEmpty())
+        return -1;
+
+    stack[nstack] = 0;
+    sdist[nstack++] = box_dist(m_qVecVertNodes[0].bmin,m_qVecVertNodes[0].bmax,r);
+    while (nstack > 0) {
+        nstack--;
+        if (sdist[nstack]*(1.0-BVH_PRUNE_TOL) > mindist)
+            continue;
+        const Node& node = m_qVecVertNodes[stack[nstack]];
+        if (node.left >= 0) {
+            /*
+             * Visit the closer child first
+             */
+            d1 = box_dist(m_qVecVertNodes[node.left].bmin,m_qVecVertNodes[node.left].bmax,r);
+            d2 = box_dist(m_qVecVertNodes[node.right].bmin,m_qVecVertNodes[node.right].bmax,r);
+            if (d1 <= d2) {
+                stack[nstack] = node.right; sdist[nstack++] = d2;
+                stack[nstack] = node.left;  sdist[nstack++] = d1;
+            }
+            else {
+                stack[nstack] = node.left;  sdist[nstack++] = d1;
+                stack[nstack] = node.right; sdist[nstack++] = d2;
+            }
+            continue;
+        }
+        for (k = node.start; k < node.start+node.count; k++) {
+            p = m_qVecVertOrder[k];
+            if (tri_only && !m_qVecInTri[p])
+                continue;
+            VEC_DIFF_61(r,m_pSurf->rr[p],diff);
+            dist = VEC_LEN_61(diff);
+            if (dist < mindist || (best >= 0 && dist == mindist && p < best)) {
+                mindist = dist;
+                best    = p;
+            }
+        }
+    }
+    if (best >= 0 && distp)
+        *distp = mindist;
+    return best;
+}
+
+
+//*************************************************************************************************************
+
+int MneSurfaceBvh::nearest_triangle(float *r, void *proj_data, float *x, float *y, float *z) const
+{
+    int   stack[BVH_STACK];
+    float sdist[BVH_STACK];
+    int   nstack = 0;
+    int   best = -1;
+    float p,q,dist;
+    float p0,q0,dist0;
+    float d1,d2;
+    int   k,t;
+
+    p0 = q0 = 0.0;
+    dist0 = 0.0;
+    if (m_qVecTriNodes.isEmpty())
+        return -1;
+    /*
+     * The distance reported by nearest_triangle_point is at least 1/sqrt(2) times the true distance
+     * to the triangle, which in turn is at least the distance to its bounding box
+     */
+    stack[nstack] = 0;
+    sdist[nstack++] = M_SQRT1_2*box_dist(m_qVecTriNodes[0].bmin,m_qVecTriNodes[0].bmax,r);
+    while (nstack > 0) {
+        nstack--;
+        if (best >= 0 && sdist[nstack]*(1.0-BVH_PRUNE_TOL) > std::fabs(dist0))
+            continue;
+        const Node& node = m_qVecTriNodes[stack[nstack]];
+        if (node.left >= 0) {
+            d1 = M_SQRT1_2*box_dist(m_qVecTriNodes[node.left].bmin,m_qVecTriNodes[node.left].bmax,r);
+            d2 = M_SQRT1_2*box_dist(m_qVecTriNodes[node.right].bmin,m_qVecTriNodes[node.right].bmax,r);
+            if (d1 <= d2) {
+                stack[nstack] = node.right; sdist[nstack++] = d2;
+                stack[nstack] = node.left;  sdist[nstack++] = d1;
+            }
+            else {
+                stack[nstack] = node.left;  sdist[nstack++] = d1;
+                stack[nstack] = node.right; sdist[nstack++] = d2;
+            }
+            continue;
+        }
+        for (k = node.start; k < node.start+node.count; k++) {
+            t = m_qVecTriOrder[k];
+            if (MneSurfaceOrVolume::nearest_triangle_point(r,m_pSurf,proj_data,t,&p,&q,&dist)) {
+                if (best < 0 || std::fabs(dist) < std::fabs(dist0) ||
+                        (std::fabs(dist) == std::fabs(dist0) && t < best)) {
+                    dist0 = dist;
+                    best  = t;
+                    p0    = p;
+                    q0    = q;
+                }
+            }
+        }
+    }
+    *x = p0;
+    *y = q0;
+    *z = dist0;
+    return best;
+}
+
+
+//*************************************************************************************************************
+
+int MneSurfaceBvh::project_to_surface(void *proj_data, float *r, int project_it, float *distp) const
+{
+    float p0,q0,dist0;
+    int   best;
+
+    best = nearest_triangle(r,proj_data,&p0,&q0,&dist0);
+    if (best >= 0 && project_it)
+        MneSurfaceOrVolume::project_to_triangle(m_pSurf,best,p0,q0,r);
+    if (distp)
+        *distp = dist0;
+    return best;
+}
+
+
+//*************************************************************************************************************
+
+void MneSurfaceBvh::build(const QVector<float> &bmin,
+                          const QVector<float> &bmax,
+                          const QVector<float> &center,
+                          QVector<Node> &nodes,
+                          QVector<int> &order)
+{
+    int n = bmin.size()/3;
+    int k,c,axis,mid;
+    float cmin[3],cmax[3];
+    QVector<int> todo;
+
+    nodes.clear();
+    order.resize(n);
+    for (k = 0; k < n; k++)
+        order[k] = k;
+    if (n == 0)
+        return;
+
+    Node root;
+    root.start = 0;
+    root.count = n;
+    nodes.append(root);
+    todo.append(0);
+    while (!todo.isEmpty()) {
+        int   this_node = todo.takeLast();
+        Node& node = nodes[this_node];
+        /*
+         * Bounding box of the items and of their centers
+         */
+        for (c = 0; c < 3; c++) {
+            node.bmin[c] = cmin[c] = HUGE_VAL;
+            node.bmax[c] = cmax[c] = -HUGE_VAL;
+        }
+        for (k = node.start; k < node.start+node.count; k++) {
+            for (c = 0; c < 3; c++) {
+                node.bmin[c] = std::min(node.bmin[c],bmin[3*order[k]+c]);
+                node.bmax[c] = std::max(node.bmax[c],bmax[3*order[k]+c]);
+                cmin[c]      = std::min(cmin[c],center[3*order[k]+c]);
+                cmax[c]      = std::max(cmax[c],center[3*order[k]+c]);
+            }
+        }
+        node.left = node.right = -1;
+        for (c = 0; c < 3; c++)
+            node.nsum[c] = node.cent[c] = 0.0;
+        node.rad = 0.0;
+        if (node.count <= BVH_LEAF_SIZE)
+            continue;
+        /*
+         * Median split along the longest extent of the centers
+         */
+        axis = 0;
+        for (c = 1; c < 3; c++)
+            if (cmax[c]-cmin[c] > cmax[axis]-cmin[axis])
+                axis = c;
+        mid = node.start + node.count/2;
+        std::nth_element(order.begin()+node.start,order.begin()+mid,order.begin()+node.start+node.count,
+                         [&center,axis](int a, int b) { return center[3*a+axis] < center[3*b+axis]; });
+
+        Node left,right;
+        left.start  = node.start;
+        left.count  = mid - node.start;
+        right.start = mid;
+        right.count = node.start + node.count - mid;
+        node.left   = nodes.size();
+        node.right  = nodes.size()+1;
+        /*
+         * The reference to node is not valid after this
+         */
+        nodes.append(left);
+        nodes.append(right);
+        todo.append(nodes.size()-2);
+        todo.append(nodes.size()-1);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MneSurfaceBvh::add_cluster_moments()
+{
+    QVector<double> area(m_qVecTriNodes.size());
+    MneTriangle* tri;
+    float        r12[3],r13[3],nn[3];
+    double       a,diff[3],dist;
+    int          j,k,c;
+    /*
+     * Children always come after their parents, go backwards to have them ready
+     */
+    for (j = m_qVecTriNodes.size()-1; j >= 0; j--) {
+        Node& node = m_qVecTriNodes[j];
+        area[j] = 0.0;
+        if (node.left < 0) {
+            for (k = node.start; k < node.start+node.count; k++) {
+                tri = m_pSurf->tris+m_qVecTriOrder[k];
+                VEC_DIFF_61(tri->r1,tri->r2,r12);
+                VEC_DIFF_61(tri->r1,tri->r3,r13);
+                CROSS_PRODUCT_61(r12,r13,nn);
+                a = 0.5*VEC_LEN_61(nn);
+                for (c = 0; c < 3; c++) {
+                    node.nsum[c] += 0.5*nn[c];
+                    node.cent[c] += a*(tri->r1[c]+tri->r2[c]+tri->r3[c])/3.0;
+                }
+                area[j] += a;
+            }
+        }
+        else {
+            const Node& left  = m_qVecTriNodes[node.left];
+            const Node& right = m_qVecTriNodes[node.right];
+            for (c = 0; c < 3; c++) {
+                node.nsum[c] = left.nsum[c] + right.nsum[c];
+                node.cent[c] = area[node.left]*left.cent[c] + area[node.right]*right.cent[c];
+            }
+            area[j] = area[node.left] + area[node.right];
+        }
+        for (c = 0; c < 3; c++) {
+            if (area[j] > 0.0)
+                node.cent[c] = node.cent[c]/area[j];
+            else
+                node.cent[c] = 0.5*(node.bmin[c]+node.bmax[c]);
+        }
+        /*
+         * Radius of the sphere around the centroid which contains the triangles
+         */
+        node.rad = 0.0;
+        if (node.left < 0) {
+            for (k = node.start; k < node.start+node.count; k++) {
+                tri = m_pSurf->tris+m_qVecTriOrder[k];
+                VEC_DIFF_61(node.cent,tri->r1,diff);
+                node.rad = std::max(node.rad,VEC_LEN_61(diff));
+                VEC_DIFF_61(node.cent,tri->r2,diff);
+                node.rad = std::max(node.rad,VEC_LEN_61(diff));
+                VEC_DIFF_61(node.cent,tri->r3,diff);
+                node.rad = std::max(node.rad,VEC_LEN_61(diff));
+            }
+        }
+        else {
+            const Node& left  = m_qVecTriNodes[node.left];
+            const Node& right = m_qVecTriNodes[node.right];
+            VEC_DIFF_61(node.cent,left.cent,diff);
+            dist = VEC_LEN_61(diff) + left.rad;
+            VEC_DIFF_61(node.cent,right.cent,diff);
+            node.rad = std::max(dist,VEC_LEN_61(diff) + right.rad);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool MneSurfaceBvh::check_closed() const
+{
+    QVector<quint64> edges;
+    MneTriangle*     tri;
+    quint64          v1,v2;
+    int              j,k,c;
+
+    if (m_pSurf->ntri == 0)
+        return false;
+    edges.reserve(3*m_pSurf->ntri);
+    for (k = 0, tri = m_pSurf->tris; k < m_pSurf->ntri; k++, tri++) {
+        for (c = 0; c < 3; c++) {
+            v1 = tri->vert[c];
+            v2 = tri->vert[(c+1)%3];
+            if (v1 > v2)
+                std::swap(v1,v2);
+            edges.append((v1 << 32) | v2);
+        }
+    }
+    std::sort(edges.begin(),edges.end());
+    /*
+     * Every edge must be shared by exactly two triangles
+     */
+    for (k = 0; k < edges.size(); k = j) {
+        for (j = k+1; j < edges.size() && edges[j] == edges[k]; j++)
+            ;
+        if (j-k != 2)
+            return false;
+    }
+    return true;
+}
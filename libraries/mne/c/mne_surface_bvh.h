@@ -0,0 +1,223 @@
+//=============================================================================================================
+/**
+* @file     mne_surface_bvh.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MneSurfaceBvh class declaration.
+*
+*/
+
+#ifndef MNESURFACEBVH_H
+#define MNESURFACEBVH_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../mne_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class MneSurfaceOld;
+
+
+//=============================================================================================================
+/**
+* Bounding volume hierarchy over the triangles and the vertices of a surface. The queries give the same answers
+* as the linear scans of MneSurfaceOrVolume but only visit the part of the surface near the point, which makes
+* them O(log M) instead of O(M) for a surface with M triangles.
+*
+* The winding number is evaluated hierarchically: triangle clusters far from the point are replaced by their
+* area weighted normal (a dipole), the near ones are summed exactly. Points close to the surface, open surfaces
+* and results which are not clearly integer fall back to the exact solid angle sum.
+*
+* The hierarchy refers to the vertex locations and triangles of the surface, it must not outlive it and has to
+* be rebuilt if the surface is moved. All queries are const and may be used from several threads at once.
+*
+* @brief Bounding volume hierarchy for surface queries
+*/
+class MNESHARED_EXPORT MneSurfaceBvh
+{
+public:
+    typedef QSharedPointer<MneSurfaceBvh> SPtr;              /**< Shared pointer type for MneSurfaceBvh. */
+    typedef QSharedPointer<const MneSurfaceBvh> ConstSPtr;   /**< Const shared pointer type for MneSurfaceBvh. */
+
+    //=========================================================================================================
+    /**
+    * Builds the triangle and vertex hierarchies of the surface.
+    *
+    * @param[in] s      The surface, triangle data (tris) must be present.
+    */
+    MneSurfaceBvh(MneSurfaceOld* s);
+
+    //=========================================================================================================
+    /**
+    * Destroys the MneSurfaceBvh.
+    */
+    ~MneSurfaceBvh();
+
+    //=========================================================================================================
+    /**
+    * Returns the total solid angle of the surface seen from a point divided by 4*PI, i.e., the number of times
+    * the surface winds around the point. Equivalent to MneSurfaceOrVolume::sum_solids(r,s)/(4*M_PI).
+    *
+    * @param[in] r      Location of the point.
+    *
+    * @return the winding number, 1 inside and 0 outside of a closed surface.
+    */
+    double winding_number(float *r) const;
+
+    //=========================================================================================================
+    /**
+    * Finds the vertex closest to a point. Among equally close vertices the one with the lowest index is taken.
+    *
+    * @param[in] r          Location of the point.
+    * @param[in] maxdist    Only vertices closer than this are considered.
+    * @param[in] tri_only   Only consider vertices which belong to at least one triangle.
+    * @param[out] distp     The distance to the closest vertex, untouched if none was found (optional).
+    *
+    * @return the vertex number or -1 if no vertex is closer than maxdist.
+    */
+    int nearest_vertex(float *r, float maxdist, int tri_only, float *distp) const;
+
+    //=========================================================================================================
+    /**
+    * Finds the triangle closest to a point in the sense of MneSurfaceOrVolume::nearest_triangle_point.
+    * Equivalent to the search in MneSurfaceOrVolume::mne_project_to_surface.
+    *
+    * @param[in] r          Location of the point.
+    * @param[in] proj_data  Precomputed triangle data (MneProjData), only active triangles are considered (optional).
+    * @param[out] x         Coordinates of the closest point on the triangle.
+    * @param[out] y
+    * @param[out] z         Distance to the triangle.
+    *
+    * @return the triangle number or -1 if no triangle was considered.
+    */
+    int nearest_triangle(float *r, void *proj_data, float *x, float *y, float *z) const;
+
+    //=========================================================================================================
+    /**
+    * Projects a point onto the closest point on the surface, see MneSurfaceOrVolume::mne_project_to_surface.
+    *
+    * @param[in] proj_data      Precomputed triangle data (MneProjData) (optional).
+    * @param[in, out] r         Location of the point, replaced by its projection if project_it is set.
+    * @param[in] project_it     Replace r by the projected point?
+    * @param[out] distp         Distance to the closest triangle (optional).
+    *
+    * @return the closest triangle or -1 if no triangle was considered.
+    */
+    int project_to_surface(void *proj_data, float *r, int project_it, float *distp) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Node of a hierarchy. Inner nodes have two children, leaves a range of the item order.
+    */
+    struct Node {
+        float   bmin[3];        /**< Lower corner of the bounding box */
+        float   bmax[3];        /**< Upper corner of the bounding box */
+        int     left;           /**< First child, -1 for leaves */
+        int     right;          /**< Second child, -1 for leaves */
+        int     start;          /**< First item in the item order */
+        int     count;          /**< Number of items */
+        double  nsum[3];        /**< Sum of the area weighted triangle normals (triangle hierarchy only) */
+        double  cent[3];        /**< Area weighted centroid of the triangles (triangle hierarchy only) */
+        double  rad;            /**< Radius of the sphere around cent containing the triangles (triangle hierarchy only) */
+    };
+
+    //=========================================================================================================
+    /**
+    * Builds a hierarchy over items given by their bounding boxes and centers.
+    *
+    * @param[in] bmin       Lower corners of the item bounding boxes (3 x n).
+    * @param[in] bmax       Upper corners of the item bounding boxes (3 x n).
+    * @param[in] center     Item centers used for splitting (3 x n).
+    * @param[out] nodes     The nodes, root first.
+    * @param[out] order     The items in leaf order.
+    */
+    static void build(const QVector<float>& bmin,
+                      const QVector<float>& bmax,
+                      const QVector<float>& center,
+                      QVector<Node>& nodes,
+                      QVector<int>& order);
+
+    //=========================================================================================================
+    /**
+    * Computes the cluster moments of the triangle hierarchy used by the winding number.
+    */
+    void add_cluster_moments();
+
+    //=========================================================================================================
+    /**
+    * Checks whether every edge of the triangulation is shared by exactly two triangles.
+    *
+    * @return true if the surface is closed.
+    */
+    bool check_closed() const;
+
+    MneSurfaceOld*  m_pSurf;            /**< The surface */
+    QVector<Node>   m_qVecTriNodes;     /**< The triangle hierarchy */
+    QVector<int>    m_qVecTriOrder;     /**< Triangles in leaf order */
+    QVector<Node>   m_qVecVertNodes;    /**< The vertex hierarchy */
+    QVector<int>    m_qVecVertOrder;    /**< Vertices in leaf order */
+    QVector<char>   m_qVecInTri;        /**< Does the vertex belong to a triangle? */
+    bool            m_bClosed;          /**< Is the surface closed? */
+    float           m_fNearLimit;       /**< Points closer than this to a triangle use the exact solid angle sum */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+} // NAMESPACE MNELIB
+
+#endif // MNESURFACEBVH_H
@@ -45,6 +45,7 @@
 #include "mne_patch_info.h"
 //#include "fwd_bem_model.h"
 #include "mne_nearest.h"
+#include "mne_surface_bvh.h"
 #include "filter_thread_arg.h"
 #include "mne_triangle.h"
 #include "mne_msh_display_surface.h"
@@ -462,10 +463,10 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     */
 {
     MneSourceSpaceOld* s;
-    int k,p1,p2;
+    MneSurfaceBvh* bvh;
+    int k,p1;
     float r1[3];
-    float mindist,dist,diff[3];
-    int   minnode;
+    float mindist;
     int   omit,omit_outside;
     double tot_angle;
 
@@ -489,6 +490,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     if (limit > 0.0)
         printf("and at least %6.1f mm away",1000*limit);
     printf(" (will take a few...)\n");
+    bvh          = new MneSurfaceBvh(surf);
     omit         = 0;
     omit_outside = 0;
     for (k = 0; k < nspace; k++) {
@@ -501,7 +503,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
                 /*
                 * Check that the source is inside the inner skull surface
                 */
-                tot_angle = sum_solids(r1,surf)/(4*M_PI);
+                tot_angle = bvh->winding_number(r1);
                 if (std::fabs(tot_angle-1.0) > 1e-5) {
                     omit_outside++;
                     s->inuse[p1] = FALSE;
@@ -515,15 +517,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
                         * Check the distance limit
                         */
                     mindist = 1.0;
-                    minnode = 0;
-                    for (p2 = 0; p2 < surf->np; p2++) {
-                        VEC_DIFF_17(r1,surf->rr[p2],diff);
-                        dist = VEC_LEN_17(diff);
-                        if (dist < mindist) {
-                            mindist = dist;
-                            minnode = p2;
-                        }
-                    }
+                    bvh->nearest_vertex(r1,mindist,FALSE,&mindist);
                     if (mindist < limit) {
                         omit++;
                         s->inuse[p1] = FALSE;
@@ -535,6 +529,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
                 }
             }
     }
+    delete bvh;
     if (omit_outside > 0)
         printf("%d source space points omitted because they are outside the inner skull surface.\n",
                omit_outside);
@@ -670,12 +665,11 @@ void MneSurfaceOrVolume::rearrange_source_space(MneSourceSpaceOld* s)
 void *MneSurfaceOrVolume::filter_source_space(void *arg)
 {
     FilterThreadArg* a = (FilterThreadArg*)arg;
-    int    p1,p2;
+    int    p1;
     double tot_angle;
     int    omit,omit_outside;
     float  r1[3];
-    float  mindist,dist,diff[3];
-    int    minnode;
+    float  mindist;
 
     omit         = 0;
     omit_outside = 0;
@@ -688,7 +682,7 @@ void *MneSurfaceOrVolume::filter_source_space(void *arg)
             /*
            * Check that the source is inside the inner skull surface
            */
-            tot_angle = sum_solids(r1,a->surf)/(4*M_PI);
+            tot_angle = a->bvh->winding_number(r1);
             if (std::fabs(tot_angle-1.0) > 1e-5) {
                 omit_outside++;
                 a->s->inuse[p1] = FALSE;
@@ -702,15 +696,7 @@ void *MneSurfaceOrVolume::filter_source_space(void *arg)
          * Check the distance limit
          */
                 mindist = 1.0;
-                minnode = 0;
-                for (p2 = 0; p2 < a->surf->np; p2++) {
-                    VEC_DIFF_17(r1,a->surf->rr[p2],diff);
-                    dist = VEC_LEN_17(diff);
-                    if (dist < mindist) {
-                        mindist = dist;
-                        minnode = p2;
-                    }
-                }
+                a->bvh->nearest_vertex(r1,mindist,FALSE,&mindist);
                 if (mindist < a->limit) {
                     omit++;
                     a->s->inuse[p1] = FALSE;
@@ -741,6 +727,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
           */
 {
     MneSurfaceOld*    surf = NULL;
+    MneSurfaceBvh*    bvh = NULL;
     int             k;
     int             nproc = QThread::idealThreadCount();
     FilterThreadArg* a;
@@ -766,6 +753,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
     if (limit > 0.0)
         fprintf(stderr,"and at least %6.1f mm away",1000*limit);
     fprintf(stderr," (will take a few...)\n");
+    bvh = new MneSurfaceBvh(surf);
     if (nproc < 2 || nspace == 1 || !use_threads) {
         /*
         * This is the conventional calculation
@@ -775,6 +763,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
             a->s = spaces[k];
             a->mri_head_t = mri_head_t;
             a->surf = surf;
+            a->bvh = bvh;
             a->limit = limit;
             a->filtered = filtered;
             filter_source_space(a);
@@ -794,6 +783,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
             a->s = spaces[k];
             a->mri_head_t = mri_head_t;
             a->surf = surf;
+            a->bvh = bvh;
             a->limit = limit;
             a->filtered = filtered;
             args.append(a);
@@ -809,6 +799,8 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
                 delete args[k];
         }
     }
+    if(bvh)
+        delete bvh;
     if(surf)
         delete surf;
     printf("Thank you for waiting.\n\n");
@@ -103,6 +103,7 @@ SOURCES += \
     c/mne_source_space_old.cpp \
     c/mne_surface_old.cpp \
     c/mne_surface_or_volume.cpp \
+    c/mne_surface_bvh.cpp \
     c/filter_thread_arg.cpp \
     c/mne_msh_display_surface.cpp \
     c/mne_msh_display_surface_set.cpp \
@@ -155,6 +156,7 @@ HEADERS += \
     c/mne_source_space_old.h \
     c/mne_surface_old.h \
     c/mne_surface_or_volume.h \
+    c/mne_surface_bvh.h \
     c/filter_thread_arg.h \
     c/mne_msh_display_surface.h \
     c/mne_msh_display_surface_set.h \
@@ -42,6 +42,11 @@
 
 #include <utils/mnemath.h>
 
+#include <fiff/fiff_raw_mapped_reader.h>
+
+#include <algorithm>
+#include <functional>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -99,26 +104,6 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
 {
     MNEEpochDataList data;
 
-    // Select the desired events
-    qint32 count = 0;
-    qint32 p;
-    MatrixXi selected = MatrixXi::Zero(1, events.rows());
-    for (p = 0; p < events.rows(); ++p)
-    {
-        if (events(p,1) == 0 && events(p,2) == event)
-        {
-            selected(0,count) = p;
-            ++count;
-        }
-    }
-    selected.conservativeResize(1, count);
-    if (count > 0) {
-        printf("%d matching events found\n",count);
-    } else {
-        printf("No desired events found.\n");
-        return MNEEpochDataList();
-    }
-
     // If picks are empty, pick all
     RowVectorXi picksNew = picks;
     if(picks.cols() <= 0) {
@@ -128,57 +113,140 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
         }
     }
 
-    fiff_int_t event_samp, from, to;
+    // Read all epochs into one contiguous block, streaming every raw buffer once
+    MatrixXd matEpochs;
+    RowVectorXi vecSelected;
+
+    if(!readEpochTensor(raw, events, tmin, tmax, event, matEpochs, vecSelected, picksNew)) {
+        printf("No desired events found.\n");
+        return MNEEpochDataList();
+    }
+
+    printf("%d matching events found\n", static_cast<int>(vecSelected.size()));
+
+    const qint32 iNumSamples = matEpochs.cols() / vecSelected.size();
+
+    // Scan all epochs for artifacts in parallel
+    QVector<bool> vecReject = checkForArtifacts(matEpochs,
+                                                iNumSamples,
+                                                raw.info,
+                                                mapReject,
+                                                lExcludeChs);
+
     fiff_int_t dropCount = 0;
-    MatrixXd timesDummy;
-    MatrixXd times;
 
-    QScopedPointer<MNEEpochData> epoch(Q_NULLPTR);
+    for (qint32 p = 0; p < vecSelected.size(); ++p) {
+        MNEEpochData::SPtr epoch(new MNEEpochData());
+
+        epoch->epoch = matEpochs.middleCols(p*iNumSamples, iNumSamples);
+        epoch->event = event;
+        epoch->tmin = tmin;
+        epoch->tmax = tmax;
+        epoch->bReject = vecReject[p];
+
+        if (epoch->bReject) {
+            dropCount++;
+        }
+
+        data.append(epoch);
+    }
+
+    qDebug() << "MNEEpochDataList::readEpochs - Read a total of"<< data.size() <<"epochs of type" << event << "and marked"<< dropCount <<"for rejection";
+
+    return data;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEEpochDataList::readEpochTensor(const FiffRawData& raw,
+                                       const MatrixXi& events,
+                                       float tmin,
+                                       float tmax,
+                                       qint32 event,
+                                       MatrixXd& matEpochs,
+                                       RowVectorXi& vecSelected,
+                                       const RowVectorXi& picks)
+{
+    // Select the desired events, which lie completely inside the raw data
+    QVector<QPair<fiff_int_t,qint32> > qVecWindows;
+    fiff_int_t event_samp, from, to;
+    fiff_int_t iNumSamples = -1;
+    qint32 p;
+
+    for (p = 0; p < events.rows(); ++p) {
+        if (events(p,1) != 0 || events(p,2) != event) {
+            continue;
+        }
 
-    for (p = 0; p < count; ++p) {
-        // Read a data segment
-        event_samp = events(selected(p),0);
+        event_samp = events(p,0);
         from = event_samp + tmin*raw.info.sfreq;
         to   = event_samp + floor(tmax*raw.info.sfreq + 0.5);
 
-        epoch.reset(new MNEEpochData());
+        if(from < raw.first_samp || to > raw.last_samp) {
+            printf("Event at sample %d is too close to the data boundaries. Omitting.\n", event_samp);
+            continue;
+        }
 
-        if(raw.read_raw_segment(epoch->epoch, timesDummy, from, to, picksNew)) {
-            if (p == 0) {
-                times.resize(1, to-from+1);
-                for (qint32 i = 0; i < times.cols(); ++i)
-                    times(0, i) = ((float)(from-event_samp+i)) / raw.info.sfreq;
-            }
+        if(iNumSamples == -1) {
+            iNumSamples = to - from + 1;
+        } else if(to - from + 1 != iNumSamples) {
+            continue;
+        }
 
-            epoch->event = event;
-            epoch->tmin = tmin;
-            epoch->tmax = tmax;
+        qVecWindows.append(qMakePair(from, p));
+    }
 
-            epoch->bReject = checkForArtifact(epoch->epoch,
-                                              raw.info,
-                                              mapReject,
-                                              lExcludeChs);
+    if(qVecWindows.isEmpty()) {
+        return false;
+    }
 
-            if (epoch->bReject) {
-                dropCount++;
-            }
+    // Sorting by the first sample also sorts by the last sample since all windows have the same length
+    std::stable_sort(qVecWindows.begin(), qVecWindows.end(),
+                     [](const QPair<fiff_int_t,qint32>& a, const QPair<fiff_int_t,qint32>& b) { return a.first < b.first; });
 
-            //Check if data block has the same size as the previous one
-            if(!data.isEmpty()) {
-                if(epoch->epoch.size() == data.last()->epoch.size()) {
-                    data.append(MNEEpochData::SPtr(epoch.take()));//List takes ownwership of the pointer - no delete need
-                }
-            } else {
-                data.append(MNEEpochData::SPtr(epoch.take()));//List takes ownwership of the pointer - no delete need
-            }
-        } else {
+    const qint32 iNumEpochs = qVecWindows.size();
+    const qint32 iNumRows = picks.size() > 0 ? picks.size() : raw.info.nchan;
+
+    matEpochs.resize(iNumRows, static_cast<Index>(iNumEpochs) * iNumSamples);
+    vecSelected.resize(iNumEpochs);
+    for (p = 0; p < iNumEpochs; ++p) {
+        vecSelected[p] = qVecWindows[p].second;
+    }
+
+    // Stream the raw buffers in file order and scatter each one into all epochs it overlaps
+    FiffRawMappedReader reader(raw);
+    MatrixXd matBuffer, matBufferTimes;
+    qint32 iFirstActive = 0;
+
+    for(qint32 k = 0; k < raw.rawdir.size() && iFirstActive < iNumEpochs; ++k) {
+        const fiff_int_t bufFirst = raw.rawdir[k].first;
+        const fiff_int_t bufLast = raw.rawdir[k].last;
+
+        while(iFirstActive < iNumEpochs && qVecWindows[iFirstActive].first + iNumSamples - 1 < bufFirst) {
+            ++iFirstActive;
+        }
+
+        if(iFirstActive == iNumEpochs || qVecWindows[iFirstActive].first > bufLast) {
+            continue;
+        }
+
+        if(!reader.read_raw_segment(matBuffer, matBufferTimes, bufFirst, bufLast, picks)) {
             printf("Can't read the event data segments\n");
+            return false;
         }
-    }
 
-    qDebug() << "MNEEpochDataList::readEpochs - Read a total of"<< data.size() <<"epochs of type" << event << "and marked"<< dropCount <<"for rejection";
+        for(qint32 e = iFirstActive; e < iNumEpochs && qVecWindows[e].first <= bufLast; ++e) {
+            const fiff_int_t epochFirst = qVecWindows[e].first;
+            const fiff_int_t first = qMax(epochFirst, bufFirst);
+            const fiff_int_t last = qMin(epochFirst + iNumSamples - 1, bufLast);
 
-    return data;
+            matEpochs.middleCols(static_cast<Index>(e) * iNumSamples + first - epochFirst, last - first + 1)
+                    = matBuffer.middleCols(first - bufFirst, last - first + 1);
+        }
+    }
+
+    return true;
 }
 
 
@@ -286,6 +354,93 @@ bool MNEEpochDataList::checkForArtifact(const MatrixXd& data,
     bool bReject = false;
 
     //Prepare concurrent data handling
+    QList<ArtifactRejectionData> lchData = setupArtifactRejection(pFiffInfo,
+                                                                  mapReject,
+                                                                  lExcludeChs,
+                                                                  data.rows());
+
+    if(lchData.isEmpty()) {
+        qDebug() << "MNEEpochDataList::checkForArtifact - No channels found to scan for artifacts. Do not reject. Returning.";
+
+        return bReject;
+    }
+
+    for(int i = 0; i < lchData.size(); ++i) {
+        lchData[i].data = data.row(lchData.at(i).iChIdx);
+    }
+
+    //qDebug() << "MNEEpochDataList::checkForArtifact - lchData.size()" << lchData.size();
+
+    //Start the concurrent processing
+    QFuture<void> future = QtConcurrent::map(lchData, checkChThreshold);
+    future.waitForFinished();
+
+    for(int i = 0; i < lchData.size(); ++i) {
+        if(lchData.at(i).bRejected) {
+            bReject = true;
+            qDebug() << "MNEEpochDataList::checkForArtifact - Reject trial because of channel"<<lchData.at(i).sChName;
+            break;
+        }
+    }
+
+    return bReject;
+}
+
+
+//*************************************************************************************************************
+
+QVector<bool> MNEEpochDataList::checkForArtifacts(const MatrixXd& matEpochs,
+                                                  qint32 iNumSamples,
+                                                  const FiffInfo& pFiffInfo,
+                                                  const QMap<QString,double>& mapReject,
+                                                  const QStringList& lExcludeChs)
+{
+    const qint32 iNumEpochs = iNumSamples > 0 ? matEpochs.cols() / iNumSamples : 0;
+    QVector<bool> vecReject(iNumEpochs, false);
+
+    const QList<ArtifactRejectionData> lchData = setupArtifactRejection(pFiffInfo,
+                                                                        mapReject,
+                                                                        lExcludeChs,
+                                                                        matEpochs.rows());
+
+    if(lchData.isEmpty() || iNumEpochs == 0) {
+        return vecReject;
+    }
+
+    //Every epoch is scanned serially by one thread, the epochs are distributed over the thread pool
+    QVector<int> vecEpochIdx(iNumEpochs);
+    for(int e = 0; e < iNumEpochs; ++e) {
+        vecEpochIdx[e] = e;
+    }
+
+    bool* pReject = vecReject.data();
+
+    std::function<void(int&)> checkEpoch = [&](int& e) {
+        for(int i = 0; i < lchData.size(); ++i) {
+            const ArtifactRejectionData& chData = lchData.at(i);
+            auto segment = matEpochs.row(chData.iChIdx).segment(static_cast<Index>(e) * iNumSamples, iNumSamples);
+
+            if(std::fabs(segment.maxCoeff() - segment.minCoeff()) > chData.dThreshold) {
+                pReject[e] = true;
+                qDebug() << "MNEEpochDataList::checkForArtifacts - Reject trial" << e << "because of channel" << chData.sChName;
+                break;
+            }
+        }
+    };
+
+    QtConcurrent::blockingMap(vecEpochIdx, checkEpoch);
+
+    return vecReject;
+}
+
+
+//*************************************************************************************************************
+
+QList<ArtifactRejectionData> MNEEpochDataList::setupArtifactRejection(const FiffInfo& pFiffInfo,
+                                                                      const QMap<QString,double>& mapReject,
+                                                                      const QStringList& lExcludeChs,
+                                                                      int iNumRows)
+{
     QList<ArtifactRejectionData> lchData;
     QList<int> lChTypes;
 
@@ -303,17 +458,17 @@ bool MNEEpochDataList::checkForArtifact(const MatrixXd& data,
     }
 
     if(lChTypes.isEmpty()) {
-        return bReject;
+        return lchData;
     }
 
-    for(int i = 0; i < pFiffInfo.chs.size(); ++i) {
+    for(int i = 0; i < pFiffInfo.chs.size() && i < iNumRows; ++i) {
         if(lChTypes.contains(pFiffInfo.chs.at(i).kind)
            && !lExcludeChs.contains(pFiffInfo.chs.at(i).ch_name)
            && !pFiffInfo.bads.contains(pFiffInfo.chs.at(i).ch_name)
            && pFiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG
            && pFiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG2) {
             ArtifactRejectionData tempData;
-            tempData.data = data.row(i);
+            tempData.iChIdx = i;
 
             switch (pFiffInfo.chs.at(i).kind) {
             case FIFFV_MEG_CH:
@@ -338,27 +493,7 @@ bool MNEEpochDataList::checkForArtifact(const MatrixXd& data,
         }
     }
 
-    if(lchData.isEmpty()) {
-        qDebug() << "MNEEpochDataList::checkForArtifact - No channels found to scan for artifacts. Do not reject. Returning.";
-
-        return bReject;
-    }
-
-    //qDebug() << "MNEEpochDataList::checkForArtifact - lchData.size()" << lchData.size();
-
-    //Start the concurrent processing
-    QFuture<void> future = QtConcurrent::map(lchData, checkChThreshold);
-    future.waitForFinished();
-
-    for(int i = 0; i < lchData.size(); ++i) {
-        if(lchData.at(i).bRejected) {
-            bReject = true;
-            qDebug() << "MNEEpochDataList::checkForArtifact - Reject trial because of channel"<<lchData.at(i).sChName;
-            break;
-        }
-    }
-
-    return bReject;
+    return lchData;
 }
 
 
@@ -55,6 +55,7 @@
 //=============================================================================================================
 
 #include <QList>
+#include <QVector>
 #include <QSharedPointer>
 
 
@@ -71,6 +72,7 @@ struct ArtifactRejectionData {
     Eigen::RowVectorXd data;
     double dThreshold;
     QString sChName;
+    int iChIdx = -1;
 };
 
 //=============================================================================================================
@@ -121,6 +123,33 @@ public:
                                        const QStringList &lExcludeChs = QStringList(),
                                        const Eigen::RowVectorXi& picks = Eigen::RowVectorXi());
 
+    //=========================================================================================================
+    /**
+    * Read the epochs of the given event kind into one contiguous matrix. The events are sorted by sample and the
+    * raw buffers are streamed in file order, so every buffer is read and decoded exactly once no matter how many
+    * epochs it overlaps. Epoch p occupies the columns p*nsamp ... (p+1)*nsamp-1 of matEpochs. Events whose
+    * window exceeds the raw data are omitted.
+    *
+    * @param[in] raw            The raw data.
+    * @param[in] events         The events provided in samples and event kind.
+    * @param[in] tmin           The start time relative to the event in seconds.
+    * @param[in] tmax           The end time relative to the event in seconds.
+    * @param[in] event          The event kind.
+    * @param[out] matEpochs     The epochs (channels x epochs*samples).
+    * @param[out] vecSelected   The rows of events corresponding to the epochs in matEpochs.
+    * @param[in] picks          Which channels to pick. All channels if empty.
+    *
+    * @return true if at least one epoch was read, false otherwise.
+    */
+    static bool readEpochTensor(const FIFFLIB::FiffRawData& raw,
+                                const Eigen::MatrixXi& events,
+                                float tmin,
+                                float tmax,
+                                qint32 event,
+                                Eigen::MatrixXd& matEpochs,
+                                Eigen::RowVectorXi& vecSelected,
+                                const Eigen::RowVectorXi& picks = Eigen::RowVectorXi());
+
     //=========================================================================================================
     /**
     * Averages epoch list. Note that no baseline correction performed.
@@ -175,7 +204,43 @@ public:
                                  const QMap<QString,double>& mapReject,
                                  const QStringList &lExcludeChs = QStringList());
 
+    //=========================================================================================================
+    /**
+    * Checks all epochs of a contiguous epoch matrix (see readEpochTensor) for artifacts beyond a threshold value.
+    * The epochs are scanned in parallel.
+    *
+    * @param[in] matEpochs      The epochs (channels x epochs*samples).
+    * @param[in] iNumSamples    The number of samples per epoch.
+    * @param[in] pFiffInfo      The fiff info.
+    * @param[in] mapReject      The channel data types to scan for. EEG, MEG or EOG.
+    * @param[in] lExcludeChs    List of channel names to exclude.
+    *
+    * @return   Whether a threshold artifact was detected, for each epoch.
+    */
+    static QVector<bool> checkForArtifacts(const Eigen::MatrixXd& matEpochs,
+                                           qint32 iNumSamples,
+                                           const FIFFLIB::FiffInfo& pFiffInfo,
+                                           const QMap<QString,double>& mapReject,
+                                           const QStringList &lExcludeChs = QStringList());
+
     static void checkChThreshold(ArtifactRejectionData& inputData);
+
+private:
+    //=========================================================================================================
+    /**
+    * Collects the channels to scan for artifacts together with their threshold. The data is not filled in.
+    *
+    * @param[in] pFiffInfo      The fiff info.
+    * @param[in] mapReject      The channel data types to scan for. EEG, MEG or EOG.
+    * @param[in] lExcludeChs    List of channel names to exclude.
+    * @param[in] iNumRows       The number of data rows, channels beyond are ignored.
+    *
+    * @return   The channels to scan.
+    */
+    static QList<ArtifactRejectionData> setupArtifactRejection(const FIFFLIB::FiffInfo& pFiffInfo,
+                                                               const QMap<QString,double>& mapReject,
+                                                               const QStringList &lExcludeChs,
+                                                               int iNumRows);
 };
 
 } // NAMESPACE
@@ -48,6 +48,8 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <functional>
+#include <limits>
 
 
 //*************************************************************************************************************
@@ -65,6 +67,7 @@
 //=============================================================================================================
 
 #include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
 
 
 //*************************************************************************************************************
@@ -856,22 +859,17 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     // 12. Decompose the combined matrix
     //
     printf("Computing SVD of whitened and weighted lead field matrix.\n");
-    JacobiSVD<MatrixXd> svd(gain, ComputeThinU | ComputeThinV);
-    std::cout << "ToDo Sorting Necessary?" << std::endl;
-    VectorXd p_sing = svd.singularValues();
-    MatrixXd t_U = svd.matrixU();
-    MNEMath::sort<double>(p_sing, t_U);
-    FiffNamedMatrix::SDPtr p_eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( svd.matrixU().cols(),
-                                                                                        svd.matrixU().rows(),
+    VectorXd p_sing;
+    MatrixXd t_U, t_V;
+    MNEInverseOperator::decompose_gain(gain, p_sing, t_U, t_V);
+    FiffNamedMatrix::SDPtr p_eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( t_U.cols(),
+                                                                                        t_U.rows(),
                                                                                         defaultQStringList,
                                                                                         gain_info.ch_names,
                                                                                         t_U.transpose() ));
 
-    p_sing = svd.singularValues();
-    MatrixXd t_V = svd.matrixV();
-    MNEMath::sort<double>(p_sing, t_V);
-    FiffNamedMatrix::SDPtr p_eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( svd.matrixV().rows(),
-                                                                                       svd.matrixV().cols(),
+    FiffNamedMatrix::SDPtr p_eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( t_V.rows(),
+                                                                                       t_V.cols(),
                                                                                        defaultQStringList,
                                                                                        defaultQStringList,
                                                                                        t_V ));
@@ -942,6 +940,83 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
 }
 
 
+//*************************************************************************************************************
+
+void MNEInverseOperator::decompose_gain(const MatrixXd& gain, VectorXd& sing, MatrixXd& U, MatrixXd& V)
+{
+    if(gain.cols() <= gain.rows())
+    {
+        JacobiSVD<MatrixXd> svd(gain, ComputeThinU | ComputeThinV);
+        sing = svd.singularValues();
+        U = svd.matrixU();
+        V = svd.matrixV();
+        return;
+    }
+
+    //
+    // Blocks of source columns, processed in parallel
+    //
+    const qint32 nchan = gain.rows();
+    const qint32 nsrc = gain.cols();
+    const qint32 blockSize = 1024;
+
+    QList<QPair<qint32,qint32> > blocks;
+    for(qint32 i = 0; i < nsrc; i += blockSize)
+        blocks.append(QPair<qint32,qint32>(i, qMin(blockSize, nsrc - i)));
+
+    //
+    // gain*gain^T as the sum of the block products (only the lower triangle is accumulated)
+    //
+    std::function<MatrixXd (const QPair<qint32,qint32>&)> computeGram = [&gain, nchan](const QPair<qint32,qint32>& block) {
+        MatrixXd gram = MatrixXd::Zero(nchan, nchan);
+        gram.selfadjointView<Lower>().rankUpdate(gain.middleCols(block.first, block.second));
+        return gram;
+    };
+
+    std::function<void (MatrixXd&, const MatrixXd&)> sumGram = [](MatrixXd& result, const MatrixXd& gram) {
+        if(result.size() == 0)
+            result = gram;
+        else
+            result += gram;
+    };
+
+    MatrixXd GGT = QtConcurrent::blockingMappedReduced<MatrixXd>(blocks, computeGram, sumGram, QtConcurrent::UnorderedReduce);
+
+    //
+    // GGT = U*diag(sing^2)*U^T -> eigenvalues in descending order like the singular values of a SVD
+    //
+    SelfAdjointEigenSolver<MatrixXd> eig(GGT);
+
+    VectorXd lambda = eig.eigenvalues().reverse();
+    U = eig.eigenvectors().rowwise().reverse();
+    sing = lambda.cwiseMax(0.0).cwiseSqrt();
+
+    //Singular values below this tolerance are numerically zero, the eigendecomposition of GGT can't resolve them
+    double tol = std::numeric_limits<double>::epsilon() * nchan * lambda(0);
+
+    VectorXd singInv = VectorXd::Zero(nchan);
+    for(qint32 i = 0; i < nchan; ++i)
+    {
+        if(lambda(i) > tol)
+            singInv(i) = 1.0 / sing(i);
+        else
+            sing(i) = 0.0;
+    }
+
+    //
+    // V = gain^T*U*diag(sing)^-1, every block writes its own rows
+    //
+    MatrixXd UScaled = U * singInv.asDiagonal();
+    V.resize(nsrc, nchan);
+
+    std::function<void (const QPair<qint32,qint32>&)> computeV = [&gain, &UScaled, &V](const QPair<qint32,qint32>& block) {
+        V.middleRows(block.first, block.second).noalias() = gain.middleCols(block.first, block.second).transpose() * UScaled;
+    };
+
+    QtConcurrent::blockingMap(blocks, computeV);
+}
+
+
 //*************************************************************************************************************
 
 MNEInverseOperator MNEInverseOperator::prepare_inverse_operator(qint32 nave ,float lambda2, bool dSPM, bool sLORETA) const
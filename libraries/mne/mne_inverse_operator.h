@@ -299,6 +299,21 @@ public:
     */
     static MNEInverseOperator make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true);
 
+    //=========================================================================================================
+    /**
+    * Computes the thin SVD gain = U*diag(sing)*V^T of the whitened and weighted gain matrix. For gain matrices
+    * with more columns than rows the eigenvalue decomposition of the channel x channel matrix gain*gain^T is used
+    * instead of a SVD of the gain matrix itself and V is recovered blockwise as gain^T*U*diag(sing)^-1. Both
+    * steps run in parallel over blocks of source columns. Columns of V which belong to numerically zero singular
+    * values are set to zero, they do not contribute to the regularized inverse.
+    *
+    * @param[in] gain       The whitened and weighted gain matrix (channels x sources).
+    * @param[out] sing      The singular values in descending order (min(channels, sources)).
+    * @param[out] U         The left singular vectors (channels x channels, channels x sources if there are fewer sources).
+    * @param[out] V         The right singular vectors (sources x min(channels, sources)).
+    */
+    static void decompose_gain(const MatrixXd& gain, VectorXd& sing, MatrixXd& U, MatrixXd& V);
+
     //=========================================================================================================
     /**
     * mne_prepare_inverse_operator
@@ -98,6 +98,7 @@ RtAveWorker::RtAveWorker(quint32 numAverages,
 , m_bDoBaselineCorrection(false)
 , m_pairBaselineSec(qMakePair(QVariant(QString::number(iBaselineFromSecs)),QVariant(QString::number(iBaselineToSecs))))
 , m_bActivateThreshold(false)
+, m_bComputeVariance(false)
 {
     m_mapThresholds["eog"] = 300e-6;
 
@@ -138,25 +139,19 @@ void RtAveWorker::setAverageNumber(qint32 numAve)
         return;
     }
 
-    if(numAve < m_iNumAverages) {
-        int iDiff = m_iNumAverages - numAve;
+    if(numAve == m_iNumAverages) {
+        return;
+    }
 
-        //Do averaging for each trigger type
-        QMutableMapIterator<double,QList<Eigen::MatrixXd> > idx(m_mapStimAve);
+    m_iNumAverages = numAve;
 
-        while(idx.hasNext()) {
-            idx.next();
+    //Resize the rings of all trigger types, this drops the oldest epochs if the number of averages decreased
+    QMutableMapIterator<double,StimAverage> idx(m_mapStimAve);
 
-            if(idx.value().size() > iDiff) {
-                //Pop data from buffer
-                for(int i = 0; i < iDiff; ++i) {
-                    idx.value().pop_front();
-                }
-            }
-        }
+    while(idx.hasNext()) {
+        idx.next();
+        resizeAverage(idx.value());
     }
-
-    m_iNumAverages = numAve;
 }
 
 
@@ -246,6 +241,28 @@ void RtAveWorker::setBaselineTo(int toSamp, int toMSec)
 }
 
 
+//*************************************************************************************************************
+
+void RtAveWorker::setVarianceActive(bool activate)
+{
+    if(activate == m_bComputeVariance) {
+        return;
+    }
+
+    m_bComputeVariance = activate;
+
+    //Init the running mean and squared deviations from the epochs which are already part of the averages
+    if(m_bComputeVariance) {
+        QMutableMapIterator<double,StimAverage> idx(m_mapStimAve);
+
+        while(idx.hasNext()) {
+            idx.next();
+            recomputeAverage(idx.value());
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RtAveWorker::doAveraging(const MatrixXd& rawSegment)
@@ -374,6 +391,16 @@ void RtAveWorker::emitEvoked(double dTriggerType, QStringList& lResponsibleTrigg
         emit resultReady(m_stimEvokedSet, lResponsibleTriggerTypes);
     }
 
+    if(m_bComputeVariance && m_mapStimAve.contains(dTriggerType)) {
+        const StimAverage& stimAve = m_mapStimAve[dTriggerType];
+
+        if(stimAve.iCount > 1) {
+            emit varianceReady(dTriggerType, stimAve.matM2 / (stimAve.iCount - 1));
+        } else if(stimAve.iCount == 1) {
+            emit varianceReady(dTriggerType, MatrixXd::Zero(stimAve.matM2.rows(), stimAve.matM2.cols()));
+        }
+    }
+
 //    qDebug()<<"RtAveWorker::emitEvoked() - dTriggerType:" << dTriggerType;
 //    qDebug()<<"RtAveWorker::emitEvoked() - m_mapStimAve[dTriggerType].size():" << m_mapStimAve[dTriggerType].size();
 }
@@ -446,9 +473,10 @@ void RtAveWorker::mergeData(double dTriggerType)
         return;
     }
 
-    MatrixXd mergedData(m_mapDataPre[dTriggerType].rows(), m_mapDataPre[dTriggerType].cols() + m_mapDataPost[dTriggerType].cols());
+    //Reuses the memory of the last evicted epoch
+    m_matMergedData.resize(m_mapDataPre[dTriggerType].rows(), m_mapDataPre[dTriggerType].cols() + m_mapDataPost[dTriggerType].cols());
 
-    mergedData << m_mapDataPre[dTriggerType], m_mapDataPost[dTriggerType];
+    m_matMergedData << m_mapDataPre[dTriggerType], m_mapDataPost[dTriggerType];
 
     //Perform artifact threshold
     bool bArtifactDetected = false;
@@ -456,21 +484,126 @@ void RtAveWorker::mergeData(double dTriggerType)
     if(m_bActivateThreshold && m_pFiffInfo) {
         qDebug() << "RtAveWorker::mergeData - Doing artifact reduction for" << m_mapThresholds;
 
-        bArtifactDetected = MNEEpochDataList::checkForArtifact(mergedData,
+        bArtifactDetected = MNEEpochDataList::checkForArtifact(m_matMergedData,
                                                                *m_pFiffInfo,
                                                                m_mapThresholds);
     }
 
     if(!bArtifactDetected) {
         //Add cut data to average buffer
-        m_mapStimAve[dTriggerType].append(mergedData);
+        if(!m_mapStimAve.contains(dTriggerType)) {
+            StimAverage stimAve;
+            stimAve.vecEpochs.resize(m_iNumAverages);
+            stimAve.iHead = 0;
+            stimAve.iCount = 0;
+            stimAve.iEvictions = 0;
+            m_mapStimAve.insert(dTriggerType, stimAve);
+        }
 
-        //Pop data from buffer
-        int iDiff =  m_mapStimAve[dTriggerType].size() - m_iNumAverages;
-        if(iDiff > 0) {
-            for(int i = 0; i < iDiff; ++i) {
-                m_mapStimAve[dTriggerType].pop_front();
-            }
+        addEpoch(m_mapStimAve[dTriggerType], m_matMergedData);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtAveWorker::addEpoch(StimAverage& stimAve, MatrixXd& matEpoch)
+{
+    MatrixXd& matSlot = stimAve.vecEpochs[stimAve.iHead];
+
+    if(stimAve.iCount == 0 || stimAve.matSum.rows() != matEpoch.rows() || stimAve.matSum.cols() != matEpoch.cols()) {
+        //First epoch or changed epoch size, start from scratch
+        stimAve.vecEpochs[0].swap(matEpoch);
+        stimAve.iHead = 1 % stimAve.vecEpochs.size();
+        stimAve.iCount = 1;
+        recomputeAverage(stimAve);
+        return;
+    }
+
+    if(stimAve.iCount == stimAve.vecEpochs.size()) {
+        //Ring is full, replace the oldest epoch
+        stimAve.matSum += matEpoch - matSlot;
+
+        if(m_bComputeVariance) {
+            //Welford update for a window of constant size: add the new and remove the evicted epoch in one step
+            ArrayXXd arrDiff = matEpoch.array() - matSlot.array();
+            ArrayXXd arrMeanOld = stimAve.matMean.array();
+            stimAve.matMean.array() += arrDiff / stimAve.iCount;
+            stimAve.matM2.array() += arrDiff * (matEpoch.array() - stimAve.matMean.array() + matSlot.array() - arrMeanOld);
+        }
+
+        ++stimAve.iEvictions;
+    } else {
+        //Ring is still filling up
+        stimAve.matSum += matEpoch;
+        ++stimAve.iCount;
+
+        if(m_bComputeVariance) {
+            ArrayXXd arrDelta = matEpoch.array() - stimAve.matMean.array();
+            stimAve.matMean.array() += arrDelta / stimAve.iCount;
+            stimAve.matM2.array() += arrDelta * (matEpoch.array() - stimAve.matMean.array());
+        }
+    }
+
+    matSlot.swap(matEpoch);
+    stimAve.iHead = (stimAve.iHead + 1) % stimAve.vecEpochs.size();
+
+    //Recompute from the ring once per full turn to get rid of the accumulated rounding error. This costs one extra pass over the ring per m_iNumAverages epochs.
+    if(stimAve.iEvictions >= stimAve.vecEpochs.size()) {
+        recomputeAverage(stimAve);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtAveWorker::resizeAverage(StimAverage& stimAve)
+{
+    int iOldSize = stimAve.vecEpochs.size();
+    int iCount = qMin(stimAve.iCount, m_iNumAverages);
+
+    QVector<MatrixXd> vecEpochs(m_iNumAverages);
+
+    //Move the most recent epochs to the front of the new ring, oldest first
+    for(int i = 0; i < iCount; ++i) {
+        int iOldIdx = (stimAve.iHead - iCount + i + iOldSize) % iOldSize;
+        vecEpochs[i].swap(stimAve.vecEpochs[iOldIdx]);
+    }
+
+    stimAve.vecEpochs.swap(vecEpochs);
+    stimAve.iCount = iCount;
+    stimAve.iHead = iCount % m_iNumAverages;
+
+    recomputeAverage(stimAve);
+}
+
+
+//*************************************************************************************************************
+
+void RtAveWorker::recomputeAverage(StimAverage& stimAve)
+{
+    stimAve.iEvictions = 0;
+
+    if(stimAve.iCount == 0) {
+        stimAve.matSum.resize(0,0);
+        stimAve.matMean.resize(0,0);
+        stimAve.matM2.resize(0,0);
+        return;
+    }
+
+    //The filled slots are always the first iCount slots of the ring
+    stimAve.matSum = stimAve.vecEpochs.at(0);
+
+    for(int i = 1; i < stimAve.iCount; ++i) {
+        stimAve.matSum += stimAve.vecEpochs.at(i);
+    }
+
+    if(m_bComputeVariance) {
+        stimAve.matMean = stimAve.matSum / stimAve.iCount;
+        stimAve.matM2.setZero(stimAve.matSum.rows(), stimAve.matSum.cols());
+
+        for(int i = 0; i < stimAve.iCount; ++i) {
+            stimAve.matM2.array() += (stimAve.vecEpochs.at(i) - stimAve.matMean).array().square();
         }
     }
 }
@@ -480,7 +613,7 @@ void RtAveWorker::mergeData(double dTriggerType)
 
 void RtAveWorker::generateEvoked(double dTriggerType)
 {
-    if(m_mapStimAve[dTriggerType].isEmpty()) {
+    if(!m_mapStimAve.contains(dTriggerType) || m_mapStimAve[dTriggerType].iCount == 0) {
         qDebug() << "RtAveWorker::generateEvoked - m_mapStimAve is empty for type" << dTriggerType << "Returning.";
         return;
     }
@@ -512,16 +645,10 @@ void RtAveWorker::generateEvoked(double dTriggerType)
         evoked.comment = QString::number(dTriggerType);
     }
 
-    // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
+    // Generate final evoked from the running sum
+    const StimAverage& stimAve = m_mapStimAve[dTriggerType];
 
-    for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-        finalAverage += m_mapStimAve[dTriggerType].at(i);
-    }
-
-    if(!m_mapStimAve[dTriggerType].isEmpty()) {
-        finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
-    }
+    MatrixXd finalAverage = stimAve.matSum / stimAve.iCount;
 
     if(m_bDoBaselineCorrection) {
         finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
@@ -529,7 +656,7 @@ void RtAveWorker::generateEvoked(double dTriggerType)
 
     evoked.data = finalAverage;
 
-    evoked.nave = m_mapStimAve[dTriggerType].size();
+    evoked.nave = stimAve.iCount;
 
     //Add new data to evoked data set
     if(iEvokedIdx != -1) {
@@ -556,6 +683,7 @@ void RtAveWorker::reset()
 
     //Clear all maps
     m_mapStimAve.clear();
+    m_matMergedData.resize(0,0);
     m_mapDataPre.clear();
     m_mapDataPre[-1.0] = MatrixXd::Zero(m_pFiffInfo->chs.size(), m_iPreStimSamples);
     m_mapDataPost.clear();
@@ -599,6 +727,9 @@ RtAve::RtAve(quint32 numAverages,
     connect(worker, &RtAveWorker::resultReady,
             this, &RtAve::handleResults, Qt::DirectConnection);
 
+    connect(worker, &RtAveWorker::varianceReady,
+            this, &RtAve::handleVariance, Qt::DirectConnection);
+
     connect(this, &RtAve::averageNumberChanged,
             worker, &RtAveWorker::setAverageNumber);
     connect(this, &RtAve::averagePreStimChanged,
@@ -615,6 +746,8 @@ RtAve::RtAve(quint32 numAverages,
             worker, &RtAveWorker::setBaselineFrom);
     connect(this, &RtAve::averageBaselineToChanged,
             worker, &RtAveWorker::setBaselineTo);
+    connect(this, &RtAve::averageVarianceActiveChanged,
+            worker, &RtAveWorker::setVarianceActive);
     connect(this, &RtAve::averageResetRequested,
             worker, &RtAveWorker::reset);
 
@@ -648,6 +781,16 @@ void RtAve::handleResults(const FiffEvokedSet& evokedStimSet,
 }
 
 
+//*************************************************************************************************************
+
+void RtAve::handleVariance(double dTriggerType,
+                           const MatrixXd& matVariance)
+{
+    emit evokedStimVariance(dTriggerType,
+                            matVariance);
+}
+
+
 //*************************************************************************************************************
 
 void RtAve::restart(quint32 numAverages,
@@ -678,6 +821,9 @@ void RtAve::restart(quint32 numAverages,
     connect(worker, &RtAveWorker::resultReady,
             this, &RtAve::handleResults, Qt::DirectConnection);
 
+    connect(worker, &RtAveWorker::varianceReady,
+            this, &RtAve::handleVariance, Qt::DirectConnection);
+
     connect(this, &RtAve::averageNumberChanged,
             worker, &RtAveWorker::setAverageNumber);
     connect(this, &RtAve::averagePreStimChanged,
@@ -694,6 +840,8 @@ void RtAve::restart(quint32 numAverages,
             worker, &RtAveWorker::setBaselineFrom);
     connect(this, &RtAve::averageBaselineToChanged,
             worker, &RtAveWorker::setBaselineTo);
+    connect(this, &RtAve::averageVarianceActiveChanged,
+            worker, &RtAveWorker::setVarianceActive);
     connect(this, &RtAve::averageResetRequested,
             worker, &RtAveWorker::reset);
 
@@ -783,6 +931,14 @@ void RtAve::setBaselineTo(int toSamp, int toMSec)
 }
 
 
+//*************************************************************************************************************
+
+void RtAve::setVarianceActive(bool activate)
+{
+    emit averageVarianceActiveChanged(activate);
+}
+
+
 //*************************************************************************************************************
 
 void RtAve::reset()
@@ -56,6 +56,7 @@
 #include <QThread>
 #include <QSharedPointer>
 #include <QObject>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -198,6 +199,15 @@ public:
     void setBaselineTo(int toSamp,
                        int toMSec);
 
+    //=========================================================================================================
+    /**
+    * Sets the computation of the running variance on or off. The variance is computed with Welford's method
+    * over the epochs which are currently part of the average and emitted via varianceReady.
+    *
+    * @param[in] activate    activate the variance computation
+    */
+    void setVarianceActive(bool activate);
+
     //=========================================================================================================
     /**
     * Resets the averaged data stored.
@@ -243,6 +253,49 @@ protected:
     */
     inline bool controlValuesChanged();
 
+    //=========================================================================================================
+    /**
+    * The epochs of one trigger type which are part of the current average. The epochs are kept in a ring which
+    * is allocated once, the sum is updated incrementally by adding the new and subtracting the evicted epoch.
+    */
+    struct StimAverage {
+        QVector<Eigen::MatrixXd>    vecEpochs;      /**< Ring of epochs, holds m_iNumAverages epochs. */
+        Eigen::MatrixXd             matSum;         /**< Running sum of the epochs in the ring. */
+        Eigen::MatrixXd             matMean;        /**< Running mean of the epochs in the ring (Welford), only used if the variance is active. */
+        Eigen::MatrixXd             matM2;          /**< Running sum of squared deviations from the mean (Welford), only used if the variance is active. */
+        int                         iHead;          /**< Ring index the next epoch is written to. */
+        int                         iCount;         /**< Number of epochs in the ring. */
+        int                         iEvictions;     /**< Number of evicted epochs since the running values were recomputed. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Adds an epoch to the ring of the given trigger type and updates the running values. The epoch is swapped
+    * into the ring, afterwards matEpoch holds the memory of the evicted epoch (or is empty).
+    *
+    * @param[in] stimAve     the average to add the epoch to.
+    * @param[in] matEpoch    the epoch to add.
+    */
+    void addEpoch(StimAverage& stimAve,
+                  Eigen::MatrixXd& matEpoch);
+
+    //=========================================================================================================
+    /**
+    * Resizes the ring to m_iNumAverages epochs, keeping the most recent ones, and recomputes the running values.
+    *
+    * @param[in] stimAve     the average to resize.
+    */
+    void resizeAverage(StimAverage& stimAve);
+
+    //=========================================================================================================
+    /**
+    * Recomputes the running sum and, if the variance is active, mean and squared deviations from the epochs in
+    * the ring. This removes the rounding error which builds up by adding and subtracting epochs.
+    *
+    * @param[in] stimAve     the average to recompute.
+    */
+    void recomputeAverage(StimAverage& stimAve);
+
     qint32                                          m_iNumAverages;             /**< Number of averages */
 
     qint32                                          m_iPreStimSamples;          /**< Amount of samples averaged before the stimulus. */
@@ -260,6 +313,8 @@ protected:
 
     bool                                            m_bDoBaselineCorrection;    /**< Whether to perform baseline correction. */
 
+    bool                                            m_bComputeVariance;         /**< Whether to compute the running variance of the epochs. */
+
     QPair<QVariant,QVariant>                        m_pairBaselineSec;          /**< Baseline information in seconds form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
     QPair<QVariant,QVariant>                        m_pairBaselineSamp;         /**< Baseline information in samples form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
 
@@ -267,7 +322,8 @@ protected:
     FIFFLIB::FiffEvokedSet                          m_stimEvokedSet;            /**< Holds the evoked information. */
 
     QMap<QString,double>                            m_mapThresholds;            /**< Holds the current thresholds for artifact rejection. */
-    QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    QMap<double,StimAverage>                        m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages epochs per trigger type */
+    Eigen::MatrixXd                                 m_matMergedData;            /**< Pre and post stim data of the latest epoch, reuses the memory of evicted epochs. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding pre stim data. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding post stim data. */
     QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
@@ -283,6 +339,16 @@ signals:
     */
     void resultReady(const FIFFLIB::FiffEvokedSet& evokedStimSet,
                      const QStringList& lResponsibleTriggerTypes);
+
+    //=========================================================================================================
+    /**
+    * Signal which is emitted after resultReady if the variance is active.
+    *
+    * @param[in] dTriggerType   The trigger type the variance belongs to.
+    * @param[in] matVariance    The sample variance of the epochs in the average (channels x samples).
+    */
+    void varianceReady(double dTriggerType,
+                       const Eigen::MatrixXd& matVariance);
 };
 
 
@@ -434,6 +500,14 @@ public:
     void setBaselineTo(int toSamp,
                        int toMSec);
 
+    //=========================================================================================================
+    /**
+    * Sets the computation of the running variance on or off. The variance is emitted via evokedStimVariance.
+    *
+    * @param[in] activate    activate the variance computation
+    */
+    void setVarianceActive(bool activate);
+
     //=========================================================================================================
     /**
     * Reset the data processing in the real-time worker
@@ -448,11 +522,20 @@ protected:
     void handleResults(const FIFFLIB::FiffEvokedSet& evokedStimSet,
                        const QStringList& lResponsibleTriggerTypes);
 
+    //=========================================================================================================
+    /**
+    * Handles the variance results.
+    */
+    void handleVariance(double dTriggerType,
+                        const Eigen::MatrixXd& matVariance);
+
     QThread             m_workerThread;         /**< The worker thread. */
 
 signals:
     void evokedStim(const FIFFLIB::FiffEvokedSet& evokedStimSet,
                     const QStringList& lResponsibleTriggerTypes);
+    void evokedStimVariance(double dTriggerType,
+                            const Eigen::MatrixXd& matVariance);
     void operate(const Eigen::MatrixXd& matData);
     void averageNumberChanged(qint32 numAve);
     void averagePreStimChanged(qint32 samples,
@@ -466,6 +549,7 @@ signals:
                                     int fromMSec);
     void averageBaselineToChanged(int toSamp,
                                   int toMSec);
+    void averageVarianceActiveChanged(bool activate);
     void averageResetRequested();
 };
 
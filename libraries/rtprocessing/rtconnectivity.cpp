@@ -45,6 +45,7 @@
 #include <connectivity/connectivitysettings.h>
 #include <connectivity/connectivity.h>
 #include <connectivity/network/network.h>
+#include <connectivity/metrics/abstractmetric.h>
 
 
 //*************************************************************************************************************
@@ -76,6 +77,16 @@ using namespace CONNECTIVITYLIB;
 // DEFINE MEMBER METHODS RtConnectivityWorker
 //=============================================================================================================
 
+RtConnectivityWorker::RtConnectivityWorker()
+: m_iWindowBinStart(-1)
+, m_iWindowBinAmount(-1)
+, m_iNumberUpdates(0)
+{
+}
+
+
+//*************************************************************************************************************
+
 void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettings)
 {
     if(this->thread()->isInterruptionRequested()) {
@@ -111,6 +122,83 @@ void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettin
 }
 
 
+//*************************************************************************************************************
+
+void RtConnectivityWorker::doWorkSlidingWindow(const ConnectivitySettings &connectivitySettings,
+                                               int iWindowSize)
+{
+    if(this->thread()->isInterruptionRequested()) {
+        return;
+    }
+
+    if(connectivitySettings.getConnectivityMethods().isEmpty()) {
+        qDebug()<<"RtConnectivityWorker::doWorkSlidingWindow() - Network methods are empty";
+        return;
+    }
+
+    if(connectivitySettings.isEmpty() || iWindowSize < 1) {
+        return;
+    }
+
+    // Start a new window if the new trials cannot be combined with the ones in the window
+    if(!isWindowCompatible(connectivitySettings)) {
+        m_windowSettings = connectivitySettings;
+        m_windowSettings.clearAllData();
+        m_iWindowBinStart = AbstractMetric::m_iNumberBinStart;
+        m_iWindowBinAmount = AbstractMetric::m_iNumberBinAmount;
+        m_iNumberUpdates = 0;
+    }
+
+    // Only add the raw data, intermediate data of the incoming trials is not part of the window's sums
+    for(int i = 0; i < connectivitySettings.size(); ++i) {
+        m_windowSettings.append(connectivitySettings.at(i).matData);
+    }
+
+    // Subtract the trials which drop out of the window before the new trials are computed
+    if(m_windowSettings.size() > iWindowSize) {
+        m_windowSettings.removeFirst(m_windowSettings.size() - iWindowSize);
+    }
+
+    QList<Network> finalNetworks = Connectivity::calculate(m_windowSettings);
+
+    // Once per window length, sum up the stored trials again to get rid of the rounding error of the subtractions
+    if(++m_iNumberUpdates >= iWindowSize) {
+        m_windowSettings.recomputeIntermediateSumData();
+        m_iNumberUpdates = 0;
+    }
+
+    // Only pass on the setup of the window, copying its trials and intermediate sums would cost as much as the update
+    ConnectivitySettings resultSettings;
+    resultSettings.setConnectivityMethods(m_windowSettings.getConnectivityMethods());
+    resultSettings.setSamplingFrequency(m_windowSettings.getSamplingFrequency());
+    resultSettings.setFFTSize(m_windowSettings.getFFTSize());
+    resultSettings.setWindowType(m_windowSettings.getWindowType());
+    resultSettings.setNodePositions(m_windowSettings.getNodePositions());
+
+    emit resultReady(finalNetworks, resultSettings);
+}
+
+
+//*************************************************************************************************************
+
+bool RtConnectivityWorker::isWindowCompatible(const ConnectivitySettings &connectivitySettings) const
+{
+    if(m_windowSettings.isEmpty()) {
+        return false;
+    }
+
+    return m_windowSettings.getConnectivityMethods() == connectivitySettings.getConnectivityMethods()
+            && m_windowSettings.getSamplingFrequency() == connectivitySettings.getSamplingFrequency()
+            && m_windowSettings.getFFTSize() == connectivitySettings.getFFTSize()
+            && m_windowSettings.getWindowType() == connectivitySettings.getWindowType()
+            && m_windowSettings.getNodePositions().rows() == connectivitySettings.getNodePositions().rows()
+            && m_windowSettings.at(0).matData.rows() == connectivitySettings.at(0).matData.rows()
+            && m_windowSettings.at(0).matData.cols() == connectivitySettings.at(0).matData.cols()
+            && m_iWindowBinStart == AbstractMetric::m_iNumberBinStart
+            && m_iWindowBinAmount == AbstractMetric::m_iNumberBinAmount;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtConnectivity
@@ -118,20 +206,9 @@ void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettin
 
 RtConnectivity::RtConnectivity(QObject *parent)
 : QObject(parent)
+, m_iWindowSize(10)
 {
-    RtConnectivityWorker *worker = new RtConnectivityWorker;
-    worker->moveToThread(&m_workerThread);
-
-    connect(&m_workerThread, &QThread::finished,
-            worker, &QObject::deleteLater);
-
-    connect(this, &RtConnectivity::operate,
-            worker, &RtConnectivityWorker::doWork);
-
-    connect(worker, &RtConnectivityWorker::resultReady,
-            this, &RtConnectivity::newConnectivityResultAvailable);
-
-    m_workerThread.start();
+    initWorker();
 }
 
 
@@ -151,12 +228,46 @@ void RtConnectivity::append(const ConnectivitySettings& connectivitySettings)
 }
 
 
+//*************************************************************************************************************
+
+void RtConnectivity::appendTrials(const ConnectivitySettings& connectivitySettings)
+{
+    emit operateSlidingWindow(connectivitySettings, m_iWindowSize);
+}
+
+
+//*************************************************************************************************************
+
+void RtConnectivity::setWindowSize(int iNumberTrials)
+{
+    m_iWindowSize = iNumberTrials;
+}
+
+
 //*************************************************************************************************************
 
 void RtConnectivity::restart()
 {
     stop();
 
+    initWorker();
+}
+
+
+//*************************************************************************************************************
+
+void RtConnectivity::stop()
+{
+    m_workerThread.requestInterruption();
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+
+//*************************************************************************************************************
+
+void RtConnectivity::initWorker()
+{
     RtConnectivityWorker *worker = new RtConnectivityWorker;
     worker->moveToThread(&m_workerThread);
 
@@ -166,18 +277,11 @@ void RtConnectivity::restart()
     connect(this, &RtConnectivity::operate,
             worker, &RtConnectivityWorker::doWork);
 
+    connect(this, &RtConnectivity::operateSlidingWindow,
+            worker, &RtConnectivityWorker::doWorkSlidingWindow);
+
     connect(worker, &RtConnectivityWorker::resultReady,
             this, &RtConnectivity::newConnectivityResultAvailable);
 
     m_workerThread.start();
 }
-
-
-//*************************************************************************************************************
-
-void RtConnectivity::stop()
-{
-    m_workerThread.requestInterruption();
-    m_workerThread.quit();
-    m_workerThread.wait();
-}
@@ -45,6 +45,8 @@
 
 #include "rtprocessing_global.h"
 
+#include <connectivity/connectivitysettings.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -71,7 +73,6 @@ namespace FIFFLIB {
 }
 
 namespace CONNECTIVITYLIB {
-    class ConnectivitySettings;
     class Network;
 }
 
@@ -102,6 +103,12 @@ class RTPROCESINGSHARED_EXPORT RtConnectivityWorker : public QObject
     Q_OBJECT
 
 public:
+    //=========================================================================================================
+    /**
+    * Creates the real-time connectivity worker with an empty sliding window.
+    */
+    RtConnectivityWorker();
+
     //=========================================================================================================
     /**
     * Perform actual connectivity estimation.
@@ -110,6 +117,38 @@ public:
     */
     void doWork(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+    * Perform connectivity estimation over a sliding window of the last iWindowSize trials. The trials of
+    * connectivitySettings are added to the window held by the worker. The trials which drop out of the window are
+    * subtracted from the intermediate sums via their stored intermediate data, so only the spectra of the new trials
+    * are computed and the cost of an update does not depend on the window size. The window is reset if the
+    * settings do not match the ones of the trials in the window. Requires AbstractMetric::m_bStorageModeIsActive,
+    * otherwise the whole window is recomputed on every update. The settings emitted with the result hold the setup of
+    * the window only, without its trials and intermediate data.
+    *
+    * @param[in] connectivitySettings           The connectivity settings holding the new trials.
+    * @param[in] iWindowSize                    The number of trials in the sliding window.
+    */
+    void doWorkSlidingWindow(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                             int iWindowSize);
+
+protected:
+    //=========================================================================================================
+    /**
+    * Checks whether the trials of connectivitySettings can be added to the current sliding window.
+    *
+    * @param[in] connectivitySettings           The connectivity settings holding the new trials.
+    *
+    * @return true if methods, sampling frequency, FFT size, window type, frequency bins and data dimensions match.
+    */
+    bool isWindowCompatible(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings) const;
+
+    CONNECTIVITYLIB::ConnectivitySettings   m_windowSettings;       /**< The trials and intermediate data of the sliding window. */
+    int                                     m_iWindowBinStart;      /**< The first frequency bin the window's intermediate data was computed for. */
+    int                                     m_iWindowBinAmount;     /**< The number of frequency bins the window's intermediate data was computed for. */
+    int                                     m_iNumberUpdates;       /**< The number of updates since the intermediate sums were last recomputed. */
+
 signals:
     void resultReady(const  QList<CONNECTIVITYLIB::Network>& connectivityResults, const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 };
@@ -150,6 +189,23 @@ public:
     */
     void append(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+    * Slot to receive new trials for sliding window estimation. Only the new trials need to be passed, the worker
+    * keeps the last trials of the window together with their intermediate data.
+    *
+    * @param[in] connectivitySettings  The connectivity settings holding the new trials.
+    */
+    void appendTrials(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of trials in the sliding window used by appendTrials.
+    *
+    * @param[in] iNumberTrials  The number of trials.
+    */
+    void setWindowSize(int iNumberTrials);
+
     //=========================================================================================================
     /**
     * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -163,12 +219,22 @@ public:
     void stop();
 
 protected:
+    //=========================================================================================================
+    /**
+    * Creates a new worker, moves it to the worker thread and connects it.
+    */
+    void initWorker();
+
     QThread             m_workerThread;         /**< The worker thread. */
+    int                 m_iWindowSize;          /**< The number of trials in the sliding window. */
 
 signals:
     void newConnectivityResultAvailable(const QList<CONNECTIVITYLIB::Network>& connectivityResults, const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
     void operate(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
+
+    void operateSlidingWindow(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                              int iWindowSize);
 };
 
 //*************************************************************************************************************
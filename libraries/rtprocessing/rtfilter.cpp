@@ -58,20 +58,9 @@ using namespace FIFFLIB;
 //=============================================================================================================
 
 #include <QDebug>
-
-//*************************************************************************************************************
-//=============================================================================================================
-// DEFINE GLOBAL METHODS
-//=============================================================================================================
-
-void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &channelDataTime)
-{
-    for(int i = 0; i < channelDataTime.first.size(); ++i) {
-        //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
-    }
-}
-
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -97,61 +86,183 @@ MatrixXd RtFilter::filterDataBlock(const MatrixXd& matDataIn,
                                    const RowVectorXi &vecPicks,
                                    const QList<FilterData>& lFilterData)
 {
+    MatrixXd matDataOut = matDataIn;
+
+    filterDataBlockInPlace(matDataOut,
+                           iOrder,
+                           vecPicks,
+                           lFilterData);
+
+    return matDataOut;
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::filterDataBlockInPlace(Ref<MatrixXd> matData,
+                                      int iOrder,
+                                      const RowVectorXi &vecPicks,
+                                      const QList<FilterData>& lFilterData)
+{
+    const int iNumRows = matData.rows();
+    const int iNumCols = matData.cols();
+
     //Initialise the overlay matrix
-    if(m_matOverlap.cols() != iOrder || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matOverlap.resize(matDataIn.rows(), iOrder);
+    if(m_matOverlap.cols() != iOrder || m_matOverlap.rows() < iNumRows) {
+        m_matOverlap.resize(iNumRows, iOrder);
         m_matOverlap.setZero();
     }
 
-    if(m_matDelay.cols() != iOrder/2 || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matDelay.resize(matDataIn.rows(), iOrder/2);
+    if(m_matDelay.cols() != iOrder/2 || m_matOverlap.rows() < iNumRows) {
+        m_matDelay.resize(iNumRows, iOrder/2);
         m_matDelay.setZero();
     }
 
-    //Resize output matrix to match input matrix
-    MatrixXd matDataOut = matDataIn;
-
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
+    //The delay is taken from the unfiltered input, so store it before the data is overwritten
+    if(iNumCols >= iOrder/2) {
+        m_matDelay = matData.rightCols(iOrder/2);
+    } else {
+        qWarning() << "RtFilter::filterDataBlockInPlace - Half of filter length is larger than data size. Not filling m_matDelay for next step.";
+    }
 
-    //Only select channels specified in vecPicks
-    for(qint32 i = 0; i < vecPicks.cols(); ++i) {
-        timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(lFilterData,QPair<int,RowVectorXd>(vecPicks[i],matDataIn.row(vecPicks[i]))));
+    if(vecPicks.cols() == 0 || lFilterData.isEmpty()) {
+        return;
     }
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
+    const int iFftLength = lFilterData.first().m_iFFTlength;
+    const int iNumPicks = vecPicks.cols();
+
+    if(iNumCols + iOrder > iFftLength) {
+        qWarning() << "RtFilter::filterDataBlockInPlace - Data block plus filter length exceeds the fft length. Returning unfiltered data.";
+        return;
+    }
 
-        future.waitForFinished();
+    //Combine the filter list into one spectrum. Filtering with all filters one after another is the same as
+    //multiplying their spectra, so each channel only needs one forward and one inverse fft.
+    m_vecFilterSpectrum = lFilterData.first().m_dFFTCoeffA.transpose();
 
-        //Do the overlap add method and store in matDataOut
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
+    for(int i = 1; i < lFilterData.size(); ++i) {
+        if(lFilterData.at(i).m_iFFTlength != iFftLength) {
+            qWarning() << "RtFilter::filterDataBlockInPlace - All filters must share the same fft length. Returning unfiltered data.";
+            return;
+        }
 
-        for(int r = 0; r < timeData.size(); r++) {
-            //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-            RowVectorXd tempData = timeData.at(r).second.second;
+        m_vecFilterSpectrum.array() *= lFilterData.at(i).m_dFFTCoeffA.transpose().array();
+    }
 
-            //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-            tempData.head(iOrder) += m_matOverlap.row(timeData.at(r).second.first);
+    //Resize the work buffers only if the block layout changed
+    if(m_matFFTTime.rows() != iFftLength || m_matFFTTime.cols() != iNumPicks) {
+        m_matFFTTime.resize(iFftLength, iNumPicks);
+        m_matFFTFreq.resize(iFftLength/2+1, iNumPicks);
+    }
 
-            //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-            int start = 0;
-            matDataOut.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-iOrder) = tempData.head(iFilteredNumberCols-iOrder);
+    if(m_vecPickIdx.size() != iNumPicks) {
+        m_vecPickIdx.resize(iNumPicks);
 
-            //Refresh the m_matOverlap with the new calculated filtered data.
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(iOrder);
+        for(int i = 0; i < iNumPicks; ++i) {
+            m_vecPickIdx[i] = i;
         }
     }
 
-    if(matDataIn.cols() >= iOrder/2) {
-        m_matDelay = matDataIn.block(0, matDataIn.cols()-iOrder/2, matDataIn.rows(), iOrder/2);
-    } else {
-            qWarning() << "RtFilter::filterDataBlock - Half of filter length is larger than data size. Not filling m_matDelay for next step.";
+    //Gather the picked channels as zero padded columns
+    m_matFFTTime.bottomRows(iFftLength - iNumCols).setZero();
+
+    for(int i = 0; i < iNumPicks; ++i) {
+        m_matFFTTime.col(i).head(iNumCols) = matData.row(vecPicks[i]).transpose();
     }
 
-    return matDataOut;
+    //Forward fft, multiplication with the filter spectrum and inverse fft per column. The fft objects are
+    //kept per thread, so the plans are only built once for each thread and fft length.
+    std::function<void(int&)> applyFilter = [&](int& iCol) {
+        Eigen::FFT<double>& fft = FilterData::threadLocalFFT();
+
+        fft.fwd(m_matFFTFreq.col(iCol).data(), m_matFFTTime.col(iCol).data(), iFftLength);
+        m_matFFTFreq.col(iCol).array() *= m_vecFilterSpectrum.array();
+        fft.inv(m_matFFTTime.col(iCol).data(), m_matFFTFreq.col(iCol).data(), iFftLength);
+    };
+
+    QtConcurrent::blockingMap(m_vecPickIdx, applyFilter);
+
+    //Do the overlap add method and write back in place. The first iNumCols + iOrder samples of each column hold
+    //the filtered data including the filter tail.
+    const int iNumOverlap = qMin(iOrder, iNumCols);
+
+    for(int i = 0; i < iNumPicks; ++i) {
+        const int iRow = vecPicks[i];
+
+        matData.row(iRow) = m_matFFTTime.col(i).head(iNumCols).transpose();
+
+        //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
+        matData.row(iRow).head(iNumOverlap) += m_matOverlap.row(iRow).head(iNumOverlap);
+
+        //Refresh the m_matOverlap with the new calculated filter tail
+        m_matOverlap.row(iRow) = m_matFFTTime.col(i).segment(iNumCols, iOrder).transpose();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::filterDataBlockIIR(Ref<MatrixXd> matData,
+                                  const RowVectorXi &vecPicks,
+                                  const FilterData& filterData)
+{
+    const MatrixXd& matSOS = filterData.m_matSOS;
+    const int iNumPicks = vecPicks.cols();
+    const int iNumCols = matData.cols();
+
+    if(iNumPicks == 0 || iNumCols == 0) {
+        return;
+    }
+
+    if(matSOS.rows() == 0) {
+        qWarning() << "RtFilter::filterDataBlockIIR - Filter has no second order sections. Returning unfiltered data.";
+        return;
+    }
+
+    //Reset the states if the filter or the picked channels changed, the delay lines belong to the previous setup
+    if(m_matIIRStateSOS.rows() != matSOS.rows() || m_matIIRStateSOS.cols() != matSOS.cols() || m_matIIRStateSOS != matSOS
+            || m_vecIIRStatePicks.cols() != iNumPicks || m_vecIIRStatePicks != vecPicks) {
+        m_matIIRState = MatrixXd::Zero(iNumPicks, 2 * matSOS.rows());
+        m_matIIRStateSOS = matSOS;
+        m_vecIIRStatePicks = vecPicks;
+    }
+
+    if(m_matIIRWork.rows() != iNumPicks || m_matIIRWork.cols() != iNumCols) {
+        m_matIIRWork.resize(iNumPicks, iNumCols);
+    }
+
+    if(m_vecIIROut.rows() != iNumPicks) {
+        m_vecIIROut.resize(iNumPicks);
+    }
+
+    //Gather the picked channels, one column per sample
+    for(int i = 0; i < iNumPicks; ++i) {
+        m_matIIRWork.row(i) = matData.row(vecPicks[i]);
+    }
+
+    //Run the block through one section after another. Each step updates all channels at once.
+    for(int s = 0; s < matSOS.rows(); ++s) {
+        const double b0 = matSOS(s,0);
+        const double b1 = matSOS(s,1);
+        const double b2 = matSOS(s,2);
+        const double a1 = matSOS(s,4);
+        const double a2 = matSOS(s,5);
+
+        Ref<VectorXd> vecZ1 = m_matIIRState.col(2*s);
+        Ref<VectorXd> vecZ2 = m_matIIRState.col(2*s+1);
+
+        for(int t = 0; t < iNumCols; ++t) {
+            m_vecIIROut = b0 * m_matIIRWork.col(t) + vecZ1;
+            vecZ1 = b1 * m_matIIRWork.col(t) - a1 * m_vecIIROut + vecZ2;
+            vecZ2 = b2 * m_matIIRWork.col(t) - a2 * m_vecIIROut;
+            m_matIIRWork.col(t) = m_vecIIROut;
+        }
+    }
+
+    for(int i = 0; i < iNumPicks; ++i) {
+        matData.row(vecPicks[i]) = m_matIIRWork.row(i);
+    }
 }
 
 
@@ -166,10 +277,11 @@ MatrixXd RtFilter::filterData(const MatrixXd& matDataIn,
                               const RowVectorXi& vecPicks,
                               int iOrder,
                               qint32 iFftLength,
-                              FilterData::DesignMethod designMethod)
+                              FilterData::DesignMethod designMethod,
+                              bool bMinimumPhase)
 {
     // Check for size of data
-    if (matDataIn.cols()<iOrder){
+    if (designMethod != FilterData::Butterworth && matDataIn.cols()<iOrder){
         qDebug() << QString("RtFilter::filterData - Filter length bigger then data length.");
     }
 
@@ -178,22 +290,26 @@ MatrixXd RtFilter::filterData(const MatrixXd& matDataIn,
     bandwidth = bandwidth/(dSFreq/2.0);
     dTransition = dTransition/(dSFreq/2.0);
 
-    // create output matrix with size of inputmatrix and temporal input matrix with size of pick
+    // create output matrix with size of inputmatrix, the slices are filtered in place
     MatrixXd matDataOut = matDataIn;
-    MatrixXd sliceFiltered;
-    // create filter
-    FilterData filter = FilterData("rt_filter",
-                                   type,
-                                   iOrder,
-                                   dCenterfreq,
-                                   bandwidth,
-                                   dTransition,
-                                   dSFreq,
-                                   iFftLength,
-                                   designMethod);
-
-    QList<FilterData> filterList;
-    filterList << filter;
+    // get the filter, it is only designed if these parameters were not requested before
+    QList<FilterData> filterList = getCachedFilterDesign(type,
+                                                         dCenterfreq,
+                                                         bandwidth,
+                                                         dTransition,
+                                                         dSFreq,
+                                                         iOrder,
+                                                         iFftLength,
+                                                         designMethod,
+                                                         bMinimumPhase);
+
+    // IIR filters run sample by sample and do not need to be sliced
+    if(designMethod == FilterData::Butterworth) {
+        filterDataBlockIIR(matDataOut,
+                           vecPicks,
+                           filterList.first());
+        return matDataOut;
+    }
 
     // slice input data into data junks with proper length for fft
     int iSize = iFftLength-iOrder;
@@ -207,18 +323,77 @@ MatrixXd RtFilter::filterData(const MatrixXd& matDataIn,
                 //catch the last one that might be shorter then original size
                 iSize = matDataIn.cols() - (iSize * (numSlices -1));
             }
-            sliceFiltered = filterDataBlock(matDataIn.block(0,from,matDataIn.rows(),iSize),
-                                            iOrder,
-                                            vecPicks,
-                                            filterList);
-            matDataOut.block(0,from,matDataIn.rows(),iSize) = sliceFiltered;
+            filterDataBlockInPlace(matDataOut.middleCols(from,iSize),
+                                   iOrder,
+                                   vecPicks,
+                                   filterList);
             from += iSize;
         }
     } else {
-        matDataOut = filterDataBlock(matDataIn,
-                                    iOrder,
-                                    vecPicks,
-                                    filterList);
+        filterDataBlockInPlace(matDataOut,
+                               iOrder,
+                               vecPicks,
+                               filterList);
     }
     return matDataOut;
 }
+
+
+//*************************************************************************************************************
+
+QList<FilterData> RtFilter::getCachedFilterDesign(FilterData::FilterType type,
+                                                  double dCenterfreq,
+                                                  double dBandwidth,
+                                                  double dTransition,
+                                                  double dSFreq,
+                                                  int iOrder,
+                                                  qint32 iFftLength,
+                                                  FilterData::DesignMethod designMethod,
+                                                  bool bMinimumPhase)
+{
+    static QMutex s_mutex;
+    static QMap<QString, QList<FilterData> > s_mapFilterDesigns;
+
+    //Upper bound of cached designs. Filter settings rarely change, this only guards against endless sweeps.
+    const int iMaxCachedDesigns = 64;
+
+    const QString sKey = QString("%1_%2_%3_%4_%5_%6_%7_%8_%9").arg(static_cast<int>(type))
+                                                            .arg(dCenterfreq, 0, 'g', 17)
+                                                            .arg(dBandwidth, 0, 'g', 17)
+                                                            .arg(dTransition, 0, 'g', 17)
+                                                            .arg(dSFreq, 0, 'g', 17)
+                                                            .arg(iOrder)
+                                                            .arg(iFftLength)
+                                                            .arg(static_cast<int>(designMethod))
+                                                            .arg(bMinimumPhase ? 1 : 0);
+
+    QMutexLocker locker(&s_mutex);
+
+    QMap<QString, QList<FilterData> >::const_iterator it = s_mapFilterDesigns.constFind(sKey);
+    if(it != s_mapFilterDesigns.constEnd()) {
+        return it.value();
+    }
+
+    QList<FilterData> filterList;
+    filterList << FilterData("rt_filter",
+                             type,
+                             iOrder,
+                             dCenterfreq,
+                             dBandwidth,
+                             dTransition,
+                             dSFreq,
+                             iFftLength,
+                             designMethod);
+
+    if(bMinimumPhase) {
+        filterList.first().convertToMinimumPhase();
+    }
+
+    if(s_mapFilterDesigns.size() >= iMaxCachedDesigns) {
+        s_mapFilterDesigns.clear();
+    }
+
+    s_mapFilterDesigns.insert(sKey, filterList);
+
+    return filterList;
+}
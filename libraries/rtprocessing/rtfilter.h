@@ -53,6 +53,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QVector>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
 
@@ -122,6 +123,38 @@ public:
                                                const Eigen::RowVectorXi& vecPicks,
                                                const QList<UTILSLIB::FilterData> &lFilterData);
 
+    //=========================================================================================================
+    /**
+    * Filters the picked channels of a data block in place using fft overlap-add. All picked channels are
+    * transformed in one pass, multiplied with the combined spectrum of the filter list and transformed back.
+    * The filtered block is written over the input and the tail is kept in m_matOverlap for the next block.
+    * The work buffers are kept between calls, so consecutive blocks of equal size do not allocate.
+    *
+    * @param [in, out] matData The data which is to be filtered. The picked rows are replaced by the filtered data.
+    * @param [in] iOrder The maximum filterlength, sames as filter order(FIR)
+    * @param [in] vecPicks The used channel as index in RowVector
+    * @param [in] lFilterData The FilterData generated by filterobject from utilslib. All filters must share the same fft length.
+    */
+    void filterDataBlockInPlace(Eigen::Ref<Eigen::MatrixXd> matData,
+                                int iOrder,
+                                const Eigen::RowVectorXi& vecPicks,
+                                const QList<UTILSLIB::FilterData> &lFilterData);
+
+    //=========================================================================================================
+    /**
+    * Filters the picked channels of a data block in place with the second order sections of an IIR filter
+    * (transposed direct form II). The samples are processed one after another for all picked channels at once,
+    * so the inner loop runs over contiguous channel vectors. The section states are kept per channel between
+    * calls and are reset if the number of picks or sections changes. No samples are delayed by block buffering.
+    *
+    * @param [in, out] matData The data which is to be filtered. The picked rows are replaced by the filtered data.
+    * @param [in] vecPicks The used channel as index in RowVector
+    * @param [in] filterData The IIR filter, designed with FilterData::Butterworth
+    */
+    void filterDataBlockIIR(Eigen::Ref<Eigen::MatrixXd> matData,
+                            const Eigen::RowVectorXi& vecPicks,
+                            const UTILSLIB::FilterData &filterData);
+
     /**
     * Calculates the filtered version of the raw input data AND creates filter
     *
@@ -135,7 +168,8 @@ public:
     * @param [in] vecPicks - used channel as index in QVector
     * @param [in] iOrder represents the order of the filter, the higher the higher is the stopband attenuation
     * @param [in] iFftLength length of the fft (multiple integer of 2^x) - Default = 4096
-    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff; Defaul = Cosine
+    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff; Defaul = Cosine. Butterworth designs an IIR filter of order iOrder, which is applied with filterDataBlockIIR.
+    * @param [in] bMinimumPhase whether the FIR filter is converted to minimum phase, which lowers the group delay from iOrder/2 to a few samples; Default = false
     *
     * @return The filtered data in form of a matrix.
     */
@@ -149,14 +183,52 @@ public:
                                const Eigen::RowVectorXi &vecPicks = Eigen::RowVectorXi(),
                                int iOrder = 1024,
                                qint32 iFftLength = 4096,
-                               UTILSLIB::FilterData::DesignMethod designMethod = UTILSLIB::FilterData::Cosine);
+                               UTILSLIB::FilterData::DesignMethod designMethod = UTILSLIB::FilterData::Cosine,
+                               bool bMinimumPhase = false);
+
+    //=========================================================================================================
+    /**
+    * Returns the filter for the given design parameters. The designs are cached process-wide, so the filter
+    * coefficients and their FFT are only computed the first time a parameter set is requested. The returned
+    * list shares its data with the cache.
+    *
+    * @param [in] type of the filter: LPF, HPF, BPF, NOTCH (from enum FilterType)
+    * @param [in] dCenterfreq determines the center of the frequency - normed to sFreq/2 (nyquist)
+    * @param [in] dBandwidth ignored if FilterType is set to LPF,HPF. if NOTCH/BPF: bandwidth of stop-/passband - normed to sFreq/2 (nyquist)
+    * @param [in] dTransition determines the width of the filter slopes (steepness) - normed to sFreq/2 (nyquist)
+    * @param [in] dSFreq sampling frequency
+    * @param [in] iOrder represents the order of the filter
+    * @param [in] iFftLength length of the fft (multiple integer of 2^x)
+    * @param [in] designMethod specifies the design method to use. Choose between Cosine, Tschebyscheff and Butterworth
+    * @param [in] bMinimumPhase whether the FIR filter is converted to minimum phase
+    *
+    * @return A list holding the designed filter.
+    */
+    static QList<UTILSLIB::FilterData> getCachedFilterDesign(UTILSLIB::FilterData::FilterType type,
+                                                             double dCenterfreq,
+                                                             double dBandwidth,
+                                                             double dTransition,
+                                                             double dSFreq,
+                                                             int iOrder,
+                                                             qint32 iFftLength,
+                                                             UTILSLIB::FilterData::DesignMethod designMethod,
+                                                             bool bMinimumPhase = false);
 
 protected:
     Eigen::MatrixXd                 m_matOverlap;                   /**< Last overlap block */
     Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block */
 
 private:
-
+    Eigen::MatrixXd                 m_matFFTTime;                   /**< Zero padded time domain work buffer (fft length x picked channels) */
+    Eigen::MatrixXcd                m_matFFTFreq;                   /**< Half spectrum work buffer (fft length/2+1 x picked channels) */
+    Eigen::VectorXcd                m_vecFilterSpectrum;            /**< Combined spectrum of the filter list, the product of all filter spectra */
+    QVector<int>                    m_vecPickIdx;                   /**< Column indices of the work buffers, handed to QtConcurrent */
+
+    Eigen::MatrixXd                 m_matIIRState;                  /**< IIR section states (picked channels x 2*sections) */
+    Eigen::MatrixXd                 m_matIIRStateSOS;               /**< Second order sections the IIR states were computed with */
+    Eigen::RowVectorXi              m_vecIIRStatePicks;             /**< Picked channels the IIR states were computed for */
+    Eigen::MatrixXd                 m_matIIRWork;                   /**< IIR work buffer (picked channels x samples), one column holds one sample of all channels */
+    Eigen::VectorXd                 m_vecIIROut;                    /**< Output of the current IIR section for one sample of all channels */
 };
 
 //*************************************************************************************************************
@@ -53,6 +53,8 @@
 //=============================================================================================================
 
 #include <iostream>
+#define _USE_MATH_DEFINES
+#include <math.h>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -60,6 +62,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QThreadStorage>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -190,6 +193,12 @@ void FilterData::designFilter()
 
             break;
         }
+
+        case Butterworth: {
+            designButterworth();
+
+            break;
+        }
     }
 
     switch(m_Type) {
@@ -212,6 +221,53 @@ void FilterData::designFilter()
 }
 
 
+//*************************************************************************************************************
+
+void FilterData::convertToMinimumPhase()
+{
+    if(m_designMethod == Butterworth || m_dCoeffA.cols() < 2) {
+        return;
+    }
+
+    const int iNumTaps = m_dCoeffA.cols();
+
+    //Use a long fft to keep the time aliasing of the cepstrum low
+    int iNfft = 2;
+    while(iNfft < 8*iNumTaps) {
+        iNfft *= 2;
+    }
+
+    Eigen::FFT<double>& fft = FilterData::threadLocalFFT();
+
+    RowVectorXd vecTime = RowVectorXd::Zero(iNfft);
+    vecTime.head(iNumTaps) = m_dCoeffA;
+
+    RowVectorXcd vecFreq;
+    fft.fwd(vecFreq, vecTime);
+
+    //Real cepstrum of the magnitude response. The magnitude is floored to avoid log(0) in the stopband.
+    RowVectorXcd vecLogMag(vecFreq.cols());
+    for(int i = 0; i < vecFreq.cols(); ++i) {
+        vecLogMag[i] = std::log(qMax(std::abs(vecFreq[i]), 1e-10));
+    }
+
+    fft.inv(vecTime, vecLogMag);
+
+    //Fold the anti-causal part of the cepstrum onto the causal part, this moves all zeros inside the unit circle
+    vecTime.segment(1, iNfft/2-1) *= 2.0;
+    vecTime.tail(iNfft/2-1).setZero();
+
+    fft.fwd(vecFreq, vecTime);
+    vecFreq = vecFreq.array().exp();
+    fft.inv(vecTime, vecFreq);
+
+    m_dCoeffA = vecTime.head(iNumTaps);
+
+    //Now generate the fft version of the minimum phase impulse response
+    fftTransformCoeffs();
+}
+
+
 //*************************************************************************************************************
 
 void FilterData::fftTransformCoeffs()
@@ -224,9 +280,8 @@ void FilterData::fftTransformCoeffs()
     RowVectorXd t_coeffAzeroPad = RowVectorXd::Zero(m_iFFTlength);
     t_coeffAzeroPad.head(m_dCoeffA.cols()) = m_dCoeffA;
 
-    //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    //get the fft object of this thread, which keeps its plans across calls
+    Eigen::FFT<double>& fft = FilterData::threadLocalFFT();
 
     //fft-transform filter coeffs
     m_dFFTCoeffA = RowVectorXcd::Zero(m_iFFTlength);
@@ -312,9 +367,8 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
             break;
     }
 
-    //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    //get the fft object of this thread, which keeps its plans across calls
+    Eigen::FFT<double>& fft = FilterData::threadLocalFFT();
 
     //fft-transform data sequence
     RowVectorXcd t_freqData;
@@ -350,6 +404,9 @@ QString FilterData::getStringForDesignMethod(const FilterData::DesignMethod &des
     if(designMethod == FilterData::Tschebyscheff)
         designMethodString = "Tschebyscheff";
 
+    if(designMethod == FilterData::Butterworth)
+        designMethodString = "Butterworth";
+
     return designMethodString;
 }
 
@@ -391,6 +448,9 @@ FilterData::DesignMethod FilterData::getDesignMethodForString(const QString &des
     if(designMethodString == "Cosine")
         designMethod = FilterData::Cosine;
 
+    if(designMethodString == "Butterworth")
+        designMethod = FilterData::Butterworth;
+
     return designMethod;
 }
 
@@ -415,3 +475,125 @@ FilterData::FilterType FilterData::getFilterTypeForString(const QString &filterT
 
     return filterType;
 }
+
+
+//*************************************************************************************************************
+
+Eigen::FFT<double>& FilterData::threadLocalFFT()
+{
+    static QThreadStorage<Eigen::FFT<double>*> s_fftStorage;
+
+    if(!s_fftStorage.hasLocalData()) {
+        Eigen::FFT<double>* pFFT = new Eigen::FFT<double>();
+        pFFT->SetFlag(pFFT->HalfSpectrum);
+        s_fftStorage.setLocalData(pFFT);
+    }
+
+    return *s_fftStorage.localData();
+}
+
+
+//*************************************************************************************************************
+
+void FilterData::designButterworth()
+{
+    //High order IIR filters get numerically unstable, even when split into second order sections
+    int iOrder = m_iFilterOrder;
+    if(iOrder < 1 || iOrder > 16) {
+        iOrder = qBound(1, iOrder, 16);
+        qWarning() << "FilterData::designButterworth - IIR order" << m_iFilterOrder << "out of range. Using order" << iOrder;
+    }
+
+    //Frequencies are normed to nyquist, sections are designed by the bilinear transform with prewarping
+    QList<RowVectorXd> lSections;
+
+    auto appendSections = [&](double dW0, bool bHighpass) {
+        dW0 = qBound(1e-6, dW0, M_PI - 1e-6);
+        const double dCos = cos(dW0);
+        RowVectorXd vecSection(6);
+
+        for(int k = 0; k < iOrder/2; ++k) {
+            //Damping of the k-th conjugate pole pair of the Butterworth prototype
+            const double dAlpha = sin(dW0) * sin(M_PI*(2*k+1)/(2.0*iOrder));
+
+            if(bHighpass) {
+                vecSection << (1+dCos)/2, -(1+dCos), (1+dCos)/2, 1+dAlpha, -2*dCos, 1-dAlpha;
+            } else {
+                vecSection << (1-dCos)/2, 1-dCos, (1-dCos)/2, 1+dAlpha, -2*dCos, 1-dAlpha;
+            }
+
+            lSections << vecSection;
+        }
+
+        //Odd orders have one real pole, which results in a first order section
+        if(iOrder % 2) {
+            const double dK = tan(dW0/2);
+
+            if(bHighpass) {
+                vecSection << 1, -1, 0, 1+dK, dK-1, 0;
+            } else {
+                vecSection << dK, dK, 0, 1+dK, dK-1, 0;
+            }
+
+            lSections << vecSection;
+        }
+    };
+
+    switch(m_Type) {
+        case LPF:
+            appendSections(M_PI*m_dCenterFreq, false);
+            break;
+
+        case HPF:
+            appendSections(M_PI*m_dCenterFreq, true);
+            break;
+
+        case BPF:
+            appendSections(M_PI*(m_dCenterFreq - m_dBandwidth/2), true);
+            appendSections(M_PI*(m_dCenterFreq + m_dBandwidth/2), false);
+            break;
+
+        case NOTCH: {
+            //Cascade of order/2 notch sections with a quality factor of center frequency over bandwidth
+            const double dW0 = qBound(1e-6, M_PI*m_dCenterFreq, M_PI - 1e-6);
+            const double dCos = cos(dW0);
+            const double dAlpha = sin(dW0) * (m_dBandwidth > 0 && m_dCenterFreq > 0 ? m_dBandwidth/(2*m_dCenterFreq) : 0.01);
+            RowVectorXd vecSection(6);
+            vecSection << 1, -2*dCos, 1, 1+dAlpha, -2*dCos, 1-dAlpha;
+
+            for(int i = 0; i < qMax(1, iOrder/2); ++i) {
+                lSections << vecSection;
+            }
+            break;
+        }
+
+        default:
+            qWarning() << "FilterData::designButterworth - Unknown filter type. Returning.";
+            return;
+    }
+
+    //Normalize all sections to a0 = 1
+    m_matSOS.resize(lSections.size(), 6);
+    for(int i = 0; i < lSections.size(); ++i) {
+        m_matSOS.row(i) = lSections.at(i) / lSections.at(i)(3);
+    }
+
+    //Truncated impulse response, used to display the frequency response like for FIR filters
+    m_dCoeffA = RowVectorXd::Zero(qMax(1, m_iFFTlength/2));
+    m_dCoeffA(0) = 1.0;
+
+    for(int s = 0; s < m_matSOS.rows(); ++s) {
+        double dZ1 = 0.0;
+        double dZ2 = 0.0;
+
+        for(int t = 0; t < m_dCoeffA.cols(); ++t) {
+            const double dX = m_dCoeffA(t);
+            const double dY = m_matSOS(s,0) * dX + dZ1;
+            dZ1 = m_matSOS(s,1) * dX - m_matSOS(s,4) * dY + dZ2;
+            dZ2 = m_matSOS(s,2) * dX - m_matSOS(s,5) * dY;
+            m_dCoeffA(t) = dY;
+        }
+    }
+
+    fftTransformCoeffs();
+}
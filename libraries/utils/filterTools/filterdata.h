@@ -65,6 +65,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
 
 
 //*************************************************************************************************************
@@ -102,7 +103,8 @@ public:
     enum DesignMethod {
         Tschebyscheff,
         Cosine,
-        External
+        External,
+        Butterworth
     } m_designMethod;
 
     enum FilterType {
@@ -134,7 +136,7 @@ public:
     * @param [in] parkswidth determines the width of the filter slopes (steepness) - normed to sFreq/2 (nyquist)
     * @param [in] sFreq sampling frequency
     * @param [in] fftlength length of the fft (multiple integer of 2^x)
-    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff
+    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff (FIR) or Butterworth (IIR). For Butterworth the order is the IIR order.
     **/
 
     FilterData(QString unique_name,
@@ -157,6 +159,11 @@ public:
      */
     void designFilter();
 
+    /**
+     * @brief convertToMinimumPhase replaces the FIR coefficients by the minimum phase filter with the same magnitude response (homomorphic method). The group delay drops from order/2 to a few samples, which makes the filter usable for low latency real-time filtering. IIR designs are minimum phase already and are left untouched.
+     */
+    void convertToMinimumPhase();
+
     /**
     * Applies the current filter to the input data using convolution in time domain. Pro: Uses only past samples (real-time capable) Con: Might not be as ideal as acausal version (steepness etc.)
     *
@@ -201,6 +208,13 @@ public:
      */
     static FilterData::FilterType getFilterTypeForString(const QString &filerTypeString);
 
+    /**
+     * @brief threadLocalFFT returns the FFT object of the calling thread, set to half spectrum mode. Eigen::FFT
+     * keeps its plans per FFT length, reusing one object per thread avoids rebuilding them for every channel and
+     * block without sharing the plan cache between threads.
+     */
+    static Eigen::FFT<double>& threadLocalFFT();
+
     double          m_sFreq;            /**< the sampling frequency. */
     int             m_iFilterOrder;     /**< represents the order of the filter instance. */
     int             m_iFFTlength;       /**< represents the filter length. */
@@ -218,6 +232,14 @@ public:
 
     RowVectorXcd    m_dFFTCoeffA;       /**< the FFT-transformed forward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
     RowVectorXcd    m_dFFTCoeffB;       /**< the FFT-transformed backward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
+
+    MatrixXd        m_matSOS;           /**< the second order sections of IIR designs, one section per row [b0 b1 b2 a0 a1 a2] with a0 = 1 (empty if FIR filter). */
+
+private:
+    /**
+     * @brief designButterworth designs the second order sections of the Butterworth IIR filter. m_dCoeffA is set to the truncated impulse response so the frequency response can be displayed like for FIR filters.
+     */
+    void designButterworth();
 };
 
 //*************************************************************************************************************
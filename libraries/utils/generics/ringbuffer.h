@@ -0,0 +1,742 @@
+//=============================================================================================================
+/**
+* @file     ringbuffer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RingBuffer class declaration
+*
+*/
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+#include "buffer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <typeinfo>
+#include <atomic>
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE IOBUFFER
+//=============================================================================================================
+
+namespace IOBUFFER
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Lock-free ring buffer for one producer and one or more consumers. The producer and every consumer own a
+* monotonically increasing index, each on its own cache line, so producer and consumers never write to the same
+* cache line. Blocks are copied in at most two contiguous chunks. A thread only sleeps on a wait condition if the
+* buffer is full (producer) or empty (consumer), the fast path takes no lock. With more than one consumer every
+* consumer receives every element (broadcast) and the producer waits for the slowest consumer.
+*
+* @brief Lock-free single producer ring buffer with optional broadcast to several consumers
+*/
+template<typename _Tp>
+class RingBuffer : public Buffer
+{
+public:
+    typedef QSharedPointer<RingBuffer> SPtr;              /**< Shared pointer type for RingBuffer. */
+    typedef QSharedPointer<const RingBuffer> ConstSPtr;   /**< Const shared pointer type for RingBuffer. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a RingBuffer. The capacity is rounded up to the next power of two.
+    *
+    * @param [in] uiMinNumElements  minimal length of buffer.
+    * @param [in] iNumConsumers     number of consumers, each consumer receives all elements.
+    */
+    explicit RingBuffer(unsigned int uiMinNumElements, int iNumConsumers = 1);
+
+    //=========================================================================================================
+    /**
+    * Destroys the RingBuffer.
+    */
+    virtual ~RingBuffer();
+
+    //=========================================================================================================
+    /**
+    * Adds a whole array at the end of the buffer. Blocks while the buffer is full.
+    *
+    * @param [in] pArray    pointer to an Array which should be apend to the end.
+    * @param [in] size      number of elements containing the array.
+    *
+    * @return false if the producer was released by releaseFromPush before all elements were written.
+    */
+    inline bool push(const _Tp* pArray, unsigned int size);
+
+    //=========================================================================================================
+    /**
+    * Adds an element at the end of the buffer. Blocks while the buffer is full.
+    *
+    * @param [in] newElement    the element which should be apend to the end.
+    */
+    inline void push(const _Tp& newElement);
+
+    //=========================================================================================================
+    /**
+    * Reads a whole array from the buffer (first in first out). Blocks until enough elements are available.
+    * If the consumer is released by releaseFromPop or the buffer is paused, the array is filled with zeros.
+    *
+    * @param [out] pArray       pointer to an Array which receives the elements.
+    * @param [in] size          number of elements to read.
+    * @param [in] iConsumer     index of the consumer.
+    *
+    * @return false if the consumer was released or the buffer is paused, true otherwise.
+    */
+    inline bool pop(_Tp* pArray, unsigned int size, int iConsumer = 0);
+
+    //=========================================================================================================
+    /**
+    * Returns the first element (first in first out) of the first consumer.
+    *
+    * @return the first element
+    */
+    inline _Tp pop();
+
+    //=========================================================================================================
+    /**
+    * Clears the buffer. Must only be called while producer and consumers are idle or blocked.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of elements the buffer can hold.
+    *
+    * @return the capacity.
+    */
+    inline unsigned int capacity() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of elements which are ready to be read by a consumer.
+    *
+    * @param [in] iConsumer     index of the consumer.
+    *
+    * @return the number of available elements.
+    */
+    inline unsigned int available(int iConsumer = 0) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of consumers.
+    *
+    * @return the number of consumers.
+    */
+    inline int numConsumers() const;
+
+    //=========================================================================================================
+    /**
+    * Pauses the buffer. Skips any incoming data and only pops zeros.
+    */
+    inline void pause(bool);
+
+    //=========================================================================================================
+    /**
+    * Releases consumers which are blocked in (or about to block in) the pop() function because no data is available.
+    * @param [out] bool returns true if a consumer was released, otherwise false.
+    */
+    inline bool releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Releases the producer if it is blocked in (or about to block in) the push() function because the buffer is full.
+    * @param [out] bool returns true if the producer was released, otherwise false.
+    */
+    inline bool releaseFromPush();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Index owned by one thread, padded to its own cache line to avoid false sharing.
+    */
+    struct PaddedIndex {
+        std::atomic<unsigned int>   value;          /**< Number of elements written or read so far, wraps around */
+        int                         iReleases;      /**< Pending releases, guarded by m_mutex */
+        char                        pad[64 - sizeof(std::atomic<unsigned int>) - sizeof(int)];
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the read index of the slowest consumer.
+    *
+    * @return the smallest read index.
+    */
+    inline unsigned int minReadIndex() const;
+
+    //=========================================================================================================
+    /**
+    * Wakes up threads sleeping on the given condition, but only takes the lock if a thread is waiting.
+    *
+    * @param [in] condition     the condition to wake.
+    */
+    inline void wakeWaiting(QWaitCondition& condition);
+
+    _Tp*                        m_pBuffer;              /**< Holds the ring buffer.*/
+    unsigned int                m_uiCapacity;           /**< Holds the capacity, a power of two.*/
+    unsigned int                m_uiMask;               /**< Holds the index mask (capacity - 1).*/
+    int                         m_iNumConsumers;        /**< Holds the number of consumers.*/
+
+    char                        m_padFront[64];         /**< Keeps the producer index off the cache line of the members above.*/
+    PaddedIndex                 m_writeIndex;           /**< Producer index.*/
+    PaddedIndex*                m_pReadIndices;         /**< Consumer indices, one cache line each.*/
+
+    std::atomic<int>            m_iNumWaiting;          /**< Number of threads sleeping or about to sleep on a wait condition.*/
+    QMutex                      m_mutex;                /**< Only used to sleep when the buffer is full or empty.*/
+    QWaitCondition              m_condNotEmpty;         /**< Signalled when data was written.*/
+    QWaitCondition              m_condNotFull;          /**< Signalled when data was read.*/
+
+    std::atomic<bool>           m_bPause;               /**< Whether the buffer is paused.*/
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+RingBuffer<_Tp>::RingBuffer(unsigned int uiMinNumElements, int iNumConsumers)
+: Buffer(typeid(_Tp).name())
+, m_pBuffer(Q_NULLPTR)
+, m_uiCapacity(1)
+, m_iNumConsumers(qMax(1, iNumConsumers))
+, m_pReadIndices(new PaddedIndex[qMax(1, iNumConsumers)])
+, m_iNumWaiting(0)
+, m_bPause(false)
+{
+    while(m_uiCapacity < uiMinNumElements) {
+        m_uiCapacity <<= 1;
+    }
+    m_uiMask = m_uiCapacity - 1;
+    m_pBuffer = new _Tp[m_uiCapacity];
+
+    m_writeIndex.value.store(0);
+    m_writeIndex.iReleases = 0;
+
+    for(int i = 0; i < m_iNumConsumers; ++i) {
+        m_pReadIndices[i].value.store(0);
+        m_pReadIndices[i].iReleases = 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+RingBuffer<_Tp>::~RingBuffer()
+{
+    delete [] m_pReadIndices;
+    delete [] m_pBuffer;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::push(const _Tp* pArray, unsigned int size)
+{
+    if(m_bPause.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    unsigned int uiDone = 0;
+
+    while(uiDone < size) {
+        //Only the producer writes the write index
+        const unsigned int uiWrite = m_writeIndex.value.load(std::memory_order_relaxed);
+        const unsigned int uiFree = m_uiCapacity - (uiWrite - minReadIndex());
+
+        if(uiFree == 0) {
+            QMutexLocker locker(&m_mutex);
+            m_iNumWaiting.fetch_add(1);
+
+            while(m_uiCapacity == uiWrite - minReadIndex() && m_writeIndex.iReleases == 0) {
+                m_condNotFull.wait(&m_mutex);
+            }
+
+            m_iNumWaiting.fetch_sub(1);
+
+            if(m_uiCapacity == uiWrite - minReadIndex()) {
+                --m_writeIndex.iReleases;
+                return false;
+            }
+
+            continue;
+        }
+
+        //Copy in at most two contiguous chunks
+        const unsigned int uiNum = qMin(uiFree, size - uiDone);
+        const unsigned int uiStart = uiWrite & m_uiMask;
+        const unsigned int uiFirst = qMin(uiNum, m_uiCapacity - uiStart);
+
+        std::copy(pArray + uiDone, pArray + uiDone + uiFirst, m_pBuffer + uiStart);
+        std::copy(pArray + uiDone + uiFirst, pArray + uiDone + uiNum, m_pBuffer);
+
+        //Publish the elements. Sequentially consistent, so either the consumer sees the new index or we see the waiting consumer.
+        m_writeIndex.value.store(uiWrite + uiNum);
+        wakeWaiting(m_condNotEmpty);
+
+        uiDone += uiNum;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void RingBuffer<_Tp>::push(const _Tp& newElement)
+{
+    push(&newElement, 1);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::pop(_Tp* pArray, unsigned int size, int iConsumer)
+{
+    if(m_bPause.load(std::memory_order_relaxed)) {
+        std::fill(pArray, pArray + size, _Tp());
+        return false;
+    }
+
+    PaddedIndex& readIndex = m_pReadIndices[iConsumer];
+    unsigned int uiDone = 0;
+
+    while(uiDone < size) {
+        //Only this consumer writes its read index
+        const unsigned int uiRead = readIndex.value.load(std::memory_order_relaxed);
+        const unsigned int uiAvailable = m_writeIndex.value.load(std::memory_order_acquire) - uiRead;
+
+        if(uiAvailable == 0) {
+            QMutexLocker locker(&m_mutex);
+            m_iNumWaiting.fetch_add(1);
+
+            while(m_writeIndex.value.load() == uiRead && readIndex.iReleases == 0) {
+                m_condNotEmpty.wait(&m_mutex);
+            }
+
+            m_iNumWaiting.fetch_sub(1);
+
+            if(m_writeIndex.value.load() == uiRead) {
+                --readIndex.iReleases;
+                std::fill(pArray + uiDone, pArray + size, _Tp());
+                return false;
+            }
+
+            continue;
+        }
+
+        //Copy out in at most two contiguous chunks
+        const unsigned int uiNum = qMin(uiAvailable, size - uiDone);
+        const unsigned int uiStart = uiRead & m_uiMask;
+        const unsigned int uiFirst = qMin(uiNum, m_uiCapacity - uiStart);
+
+        std::copy(m_pBuffer + uiStart, m_pBuffer + uiStart + uiFirst, pArray + uiDone);
+        std::copy(m_pBuffer, m_pBuffer + (uiNum - uiFirst), pArray + uiDone + uiFirst);
+
+        //Hand the space back to the producer
+        readIndex.value.store(uiRead + uiNum);
+        wakeWaiting(m_condNotFull);
+
+        uiDone += uiNum;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline _Tp RingBuffer<_Tp>::pop()
+{
+    _Tp element = _Tp();
+    pop(&element, 1, 0);
+
+    return element;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void RingBuffer<_Tp>::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_writeIndex.value.store(0);
+
+    for(int i = 0; i < m_iNumConsumers; ++i) {
+        m_pReadIndices[i].value.store(0);
+    }
+
+    //Pending releases are kept for threads which are still blocked
+    if(m_iNumWaiting.load() == 0) {
+        m_writeIndex.iReleases = 0;
+
+        for(int i = 0; i < m_iNumConsumers; ++i) {
+            m_pReadIndices[i].iReleases = 0;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int RingBuffer<_Tp>::capacity() const
+{
+    return m_uiCapacity;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int RingBuffer<_Tp>::available(int iConsumer) const
+{
+    return m_writeIndex.value.load(std::memory_order_acquire) - m_pReadIndices[iConsumer].value.load(std::memory_order_acquire);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline int RingBuffer<_Tp>::numConsumers() const
+{
+    return m_iNumConsumers;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void RingBuffer<_Tp>::pause(bool bPause)
+{
+    m_bPause.store(bPause);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::releaseFromPop()
+{
+    QMutexLocker locker(&m_mutex);
+
+    bool bReleased = false;
+
+    //Release every consumer which has nothing to read, so the pop function returns instead of waiting
+    for(int i = 0; i < m_iNumConsumers; ++i) {
+        if(available(i) == 0 && m_pReadIndices[i].iReleases == 0) {
+            ++m_pReadIndices[i].iReleases;
+            bReleased = true;
+        }
+    }
+
+    m_condNotEmpty.wakeAll();
+
+    return bReleased;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::releaseFromPush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    //Release the producer if the buffer is full, so the push function returns instead of waiting
+    if(m_uiCapacity - (m_writeIndex.value.load() - minReadIndex()) == 0 && m_writeIndex.iReleases == 0) {
+        ++m_writeIndex.iReleases;
+        m_condNotFull.wakeAll();
+
+        return true;
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int RingBuffer<_Tp>::minReadIndex() const
+{
+    const unsigned int uiWrite = m_writeIndex.value.load(std::memory_order_relaxed);
+    unsigned int uiMaxUsed = 0;
+
+    //Compare distances to the write index, the indices themselves wrap around. The loads are sequentially
+    //consistent, so a producer going to sleep either sees the new read index or the consumer sees the waiting producer.
+    for(int i = 0; i < m_iNumConsumers; ++i) {
+        uiMaxUsed = qMax(uiMaxUsed, uiWrite - m_pReadIndices[i].value.load());
+    }
+
+    return uiWrite - uiMaxUsed;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void RingBuffer<_Tp>::wakeWaiting(QWaitCondition& condition)
+{
+    if(m_iNumWaiting.load() > 0) {
+        QMutexLocker locker(&m_mutex);
+        condition.wakeAll();
+    }
+}
+
+
+//=============================================================================================================
+/**
+* Ring buffer of equally sized matrices, a drop-in replacement of CircularMatrixBuffer. Whole matrices are
+* copied in bulk and pop can write into a preallocated matrix.
+*
+* @brief Lock-free ring buffer of matrices
+*/
+template<typename _Tp>
+class RingMatrixBuffer : public RingBuffer<_Tp>
+{
+public:
+    typedef QSharedPointer<RingMatrixBuffer> SPtr;              /**< Shared pointer type for RingMatrixBuffer. */
+    typedef QSharedPointer<const RingMatrixBuffer> ConstSPtr;   /**< Const shared pointer type for RingMatrixBuffer. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a RingMatrixBuffer.
+    *
+    * @param [in] uiMaxNumMatrices  minimal number of matrices the buffer can hold.
+    * @param [in] uiRows            Number of rows.
+    * @param [in] uiCols            Number of columns.
+    * @param [in] iNumConsumers     number of consumers, each consumer receives all matrices.
+    */
+    explicit RingMatrixBuffer(unsigned int uiMaxNumMatrices, unsigned int uiRows, unsigned int uiCols, int iNumConsumers = 1);
+
+    //=========================================================================================================
+    /**
+    * Adds a whole matrix at the end buffer.
+    *
+    * @param [in] pMatrix pointer to a Matrix which should be apend to the end.
+    */
+    inline void push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix);
+
+    //=========================================================================================================
+    /**
+    * Returns the first matrix (first in first out).
+    *
+    * @return the first matrix
+    */
+    inline Matrix<_Tp, Dynamic, Dynamic> pop();
+
+    //=========================================================================================================
+    /**
+    * Reads the first matrix (first in first out) into a preallocated matrix, which is only resized if needed.
+    *
+    * @param [out] matrix       receives the matrix.
+    * @param [in] iConsumer     index of the consumer.
+    *
+    * @return false if the consumer was released or the buffer is paused, true otherwise.
+    */
+    inline bool pop(Matrix<_Tp, Dynamic, Dynamic>& matrix, int iConsumer = 0);
+
+    //=========================================================================================================
+    /**
+    * Size of the buffer in matrices.
+    */
+    inline quint32 size() const;
+
+    //=========================================================================================================
+    /**
+    * Rows of the stored matrices of the buffer.
+    */
+    inline quint32 rows() const;
+
+    //=========================================================================================================
+    /**
+    * Cols of the stored matrices of the buffer.
+    */
+    inline quint32 cols() const;
+
+private:
+    unsigned int    m_uiMaxNumMatrices;         /**< Holds the maximal number of matrices.*/
+    unsigned int    m_uiRows;                   /**< Holds the number rows.*/
+    unsigned int    m_uiCols;                   /**< Holds the number cols.*/
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+RingMatrixBuffer<_Tp>::RingMatrixBuffer(unsigned int uiMaxNumMatrices, unsigned int uiRows, unsigned int uiCols, int iNumConsumers)
+: RingBuffer<_Tp>(uiMaxNumMatrices*uiRows*uiCols, iNumConsumers)
+, m_uiMaxNumMatrices(uiMaxNumMatrices)
+, m_uiRows(uiRows)
+, m_uiCols(uiCols)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void RingMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix)
+{
+    if(pMatrix->size() == int(m_uiRows*m_uiCols)) {
+        RingBuffer<_Tp>::push(pMatrix->data(), pMatrix->size());
+    } else {
+        printf("Error: Matrix not appended to RingMatrixBuffer - wrong dimensions\n");
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline Matrix<_Tp, Dynamic, Dynamic> RingMatrixBuffer<_Tp>::pop()
+{
+    Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols);
+    pop(matrix);
+
+    return matrix;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool RingMatrixBuffer<_Tp>::pop(Matrix<_Tp, Dynamic, Dynamic>& matrix, int iConsumer)
+{
+    if(matrix.rows() != int(m_uiRows) || matrix.cols() != int(m_uiCols)) {
+        matrix.resize(m_uiRows, m_uiCols);
+    }
+
+    return RingBuffer<_Tp>::pop(matrix.data(), m_uiRows*m_uiCols, iConsumer);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 RingMatrixBuffer<_Tp>::size() const
+{
+    return m_uiMaxNumMatrices;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 RingMatrixBuffer<_Tp>::rows() const
+{
+    return m_uiRows;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 RingMatrixBuffer<_Tp>::cols() const
+{
+    return m_uiCols;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// TYPEDEF
+//=============================================================================================================
+
+typedef RingBuffer<int>                         _int_RingBuffer;                /**< Defines RingBuffer of integer type.*/
+typedef RingBuffer<short>                       _short_RingBuffer;              /**< Defines RingBuffer of short type.*/
+typedef RingBuffer<char>                        _char_RingBuffer;               /**< Defines RingBuffer of char type.*/
+typedef RingBuffer<double>                      _double_RingBuffer;             /**< Defines RingBuffer of double type.*/
+
+typedef RingMatrixBuffer<int>                   _int_RingMatrixBuffer;          /**< Defines RingMatrixBuffer of integer type.*/
+typedef RingMatrixBuffer<float>                 _float_RingMatrixBuffer;        /**< Defines RingMatrixBuffer of float type.*/
+typedef RingMatrixBuffer<char>                  _char_RingMatrixBuffer;         /**< Defines RingMatrixBuffer of char type.*/
+typedef RingMatrixBuffer<double>                _double_RingMatrixBuffer;       /**< Defines RingMatrixBuffer of double type.*/
+
+} // NAMESPACE
+
+#endif // RINGBUFFER_H
@@ -80,6 +80,7 @@ SOURCES += \
     generics/buffer.cpp \
     generics/circularbuffer.cpp \
     generics/circularmatrixbuffer.cpp \
+    generics/ringbuffer.cpp \
     generics/observerpattern.cpp \
     spectral.cpp
 
@@ -110,6 +111,7 @@ HEADERS += \
     generics/circularbuffer_old.h \
     generics/circularmatrixbuffer.h \
     generics/circularmultichannelbuffer_old.h \
+    generics/ringbuffer.h \
     generics/commandpattern.h \
     generics/observerpattern.h \
     generics/typename_old.h \
@@ -101,7 +101,8 @@ TestDipoleFit::TestDipoleFit()
 
 void TestDipoleFit::initTestCase()
 {
-
+    // Compute everything from scratch and keep the user's cache directory clean
+    qputenv("MNE_CPP_CACHE_SIZE", "0");
 }
 
 
@@ -78,6 +78,8 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareMappedRead();
+    void compareChunkIterator();
     void cleanupTestCase();
 
 private:
@@ -319,6 +321,78 @@ void TestFiffRWR::compareInfo()
     }
 }
 
+//*************************************************************************************************************
+
+void TestFiffRWR::compareMappedRead()
+{
+    FiffRawMappedReader mappedReader(first_in_raw);
+    QVERIFY( mappedReader.isMapped() );
+
+    fiff_int_t from = first_in_raw.first_samp + 17;
+    fiff_int_t to = first_in_raw.first_samp + 2*ceil(first_in_raw.info.sfreq) + 41;
+
+    RowVectorXi sel(3);
+    sel << 0, 5, first_in_raw.info.nchan - 1;
+
+    MatrixXd data, times, mapped_data, mapped_times;
+
+    //All channels
+    QVERIFY( first_in_raw.read_raw_segment(data, times, from, to) );
+    QVERIFY( mappedReader.read_raw_segment(mapped_data, mapped_times, from, to) );
+    QVERIFY( (data - mapped_data).cwiseAbs().maxCoeff() < epsilon );
+    QVERIFY( (times - mapped_times).cwiseAbs().maxCoeff() < epsilon );
+
+    //Selection, reusing the preallocated output
+    QVERIFY( first_in_raw.read_raw_segment(data, times, from, to, sel) );
+    mapped_data.resize(sel.size(), to - from + 1);
+    const double* pPrealloc = mapped_data.data();
+    QVERIFY( mappedReader.read_raw_segment(mapped_data, mapped_times, from, to, sel) );
+    QVERIFY( mapped_data.data() == pPrealloc );
+    QVERIFY( (data - mapped_data).cwiseAbs().maxCoeff() < epsilon );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareChunkIterator()
+{
+    RowVectorXi sel(3);
+    sel << 0, 5, first_in_raw.info.nchan - 1;
+
+    //Start off the buffer boundaries and end with a partial chunk, a small memory cap keeps two slots only
+    fiff_int_t iChunkSize = first_in_raw.rawdir.first().nsamp;
+    fiff_int_t from = first_in_raw.first_samp + 17;
+    fiff_int_t to = from + 5*iChunkSize + iChunkSize/2 - 1;
+
+    MatrixXd data, times;
+    QVERIFY( first_in_raw.read_raw_segment(data, times, from, to, sel) );
+
+    FiffRawChunkIterator iterator(first_in_raw, -1, sel, from, to, 1);
+    QVERIFY( iterator.chunkSize() == iChunkSize );
+    QVERIFY( iterator.numSlots() == 2 );
+
+    MatrixXd chunk_data, chunk_times;
+    fiff_int_t first, last;
+    fiff_int_t expected_first = from;
+
+    while(iterator.next(chunk_data, chunk_times, first, last))
+    {
+        QVERIFY( first == expected_first );
+        QVERIFY( last == qMin(first + iChunkSize - 1, to) );
+        QVERIFY( chunk_data.rows() == sel.size() );
+        QVERIFY( chunk_data.cols() == last - first + 1 );
+        QVERIFY( (data.middleCols(first - from, last - first + 1) - chunk_data).cwiseAbs().maxCoeff() < epsilon );
+        QVERIFY( (times.middleCols(first - from, last - first + 1) - chunk_times).cwiseAbs().maxCoeff() < epsilon );
+
+        expected_first = last + 1;
+    }
+
+    //All samples were handed out and the final chunk was the partial one
+    QVERIFY( expected_first == to + 1 );
+    QVERIFY( chunk_data.cols() == iChunkSize/2 );
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffRWR::cleanupTestCase()
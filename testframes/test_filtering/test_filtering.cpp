@@ -85,11 +85,14 @@ private slots:
     void initTestCase();
     void compareData();
     void compareTimes();
+    void compareBlockwiseIIR();
+    void compareMinimumPhase();
     void cleanupTestCase();
 
 private:
     double epsilon;
     int order;
+    double sFreq;
 
     MatrixXd first_in_data;
     MatrixXd first_in_times;
@@ -152,7 +155,7 @@ void TestFiffRFR::initTestCase()
     // initialize filter settings
     QString filter_name = "example_cosine";
     FilterData::FilterType type = FilterData::BPF;
-    double sFreq = first_in_raw.info.sfreq;
+    sFreq = first_in_raw.info.sfreq;
     double dCenterfreq = 10;
     double dBandwidth = 10;
     double dTransition = 1;
@@ -227,6 +230,51 @@ void TestFiffRFR::compareTimes()
 
 }
 
+//*************************************************************************************************************
+
+void TestFiffRFR::compareBlockwiseIIR()
+{
+    // Filtering block by block must give the same result as filtering all at once, since the section states are kept
+    RowVectorXi picks = RowVectorXi::LinSpaced(first_in_data.rows(), 0, first_in_data.rows()-1);
+
+    RtFilter rtFilterAll;
+    MatrixXd filteredAll = rtFilterAll.filterData(first_in_data, FilterData::BPF, 10, 10, 1, sFreq, picks, 4, 4096, FilterData::Butterworth);
+
+    QList<FilterData> filterList = RtFilter::getCachedFilterDesign(FilterData::BPF, 10/(sFreq/2.0), 10/(sFreq/2.0), 1/(sFreq/2.0), sFreq, 4, 4096, FilterData::Butterworth);
+    QVERIFY(filterList.first().m_matSOS.rows() == 4);
+
+    RtFilter rtFilterBlocks;
+    MatrixXd filteredBlocks = first_in_data;
+    int blockSize = 100;
+
+    for(int from = 0; from < filteredBlocks.cols(); from += blockSize) {
+        rtFilterBlocks.filterDataBlockIIR(filteredBlocks.middleCols(from, qMin(blockSize, int(filteredBlocks.cols()) - from)), picks, filterList.first());
+    }
+
+    QVERIFY((filteredAll - filteredBlocks).cwiseAbs().maxCoeff() < epsilon);
+}
+
+//*************************************************************************************************************
+
+void TestFiffRFR::compareMinimumPhase()
+{
+    // The minimum phase version keeps the magnitude response of the linear phase filter
+    FilterData linearPhase("linear", FilterData::BPF, order, 10/(sFreq/2.0), 10/(sFreq/2.0), 1/(sFreq/2.0), sFreq, 4096, FilterData::Cosine);
+    FilterData minimumPhase = linearPhase;
+    minimumPhase.convertToMinimumPhase();
+
+    RowVectorXd magDiff = linearPhase.m_dFFTCoeffA.cwiseAbs() - minimumPhase.m_dFFTCoeffA.cwiseAbs();
+    QVERIFY(magDiff.cwiseAbs().maxCoeff() < 0.01);
+
+    // The energy of a minimum phase filter is concentrated at its beginning
+    RowVectorXd::Index peakLinear, peakMinimum;
+    linearPhase.m_dCoeffA.cwiseAbs().maxCoeff(&peakLinear);
+    minimumPhase.m_dCoeffA.cwiseAbs().maxCoeff(&peakMinimum);
+    QVERIFY(peakMinimum < peakLinear);
+}
+
+//*************************************************************************************************************
+
 void TestFiffRFR::cleanupTestCase()
 {
 }
@@ -102,7 +102,8 @@ TestMneForwardSolution::TestMneForwardSolution()
 
 void TestMneForwardSolution::initTestCase()
 {
-
+    // Compute everything from scratch and keep the user's cache directory clean
+    qputenv("MNE_CPP_CACHE_SIZE", "0");
 }
 
 
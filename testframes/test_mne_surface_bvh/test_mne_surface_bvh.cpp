@@ -0,0 +1,281 @@
+//=============================================================================================================
+/**
+* @file     test_mne_surface_bvh.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the MneSurfaceBvh queries with the linear scans of MneSurfaceOrVolume
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/c/mne_surface_bvh.h>
+#include <mne/c/mne_surface_old.h>
+#include <mne/c/mne_triangle.h>
+
+#include <fiff/fiff_file.h>
+
+#include <math.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneSurfaceBvh
+*
+* @brief The TestMneSurfaceBvh class compares the bounding volume hierarchy queries with the linear scans
+*
+*/
+class TestMneSurfaceBvh: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneSurfaceBvh();
+
+private slots:
+    void initTestCase();
+    void compareInside();
+    void compareNearestTriangle();
+    void compareNearestVertex();
+    void cleanupTestCase();
+
+private:
+    MneSurfaceOld*  m_pSurf;
+    MneSurfaceBvh*  m_pBvh;
+    MatrixX3f       m_matPoints;        /**< Grid points around the surface and points close to it */
+};
+
+
+//*************************************************************************************************************
+
+TestMneSurfaceBvh::TestMneSurfaceBvh()
+: m_pSurf(Q_NULLPTR)
+, m_pBvh(Q_NULLPTR)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::initTestCase()
+{
+    QString sBemFile = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif";
+
+    m_pSurf = MneSurfaceOrVolume::read_bem_surface(sBemFile,FIFFV_BEM_SURF_ID_BRAIN,TRUE,Q_NULLPTR);
+    QVERIFY(m_pSurf != Q_NULLPTR);
+    QVERIFY(m_pSurf->ntri == 5120);
+
+    m_pBvh = new MneSurfaceBvh(m_pSurf);
+
+    // Regular grid covering the surface with a margin of 1 cm
+    Vector3f vecMin = Vector3f::Constant(1.0f);
+    Vector3f vecMax = Vector3f::Constant(-1.0f);
+    for(int k = 0; k < m_pSurf->np; ++k) {
+        Map<Vector3f> r(m_pSurf->rr[k]);
+        vecMin = vecMin.cwiseMin(r);
+        vecMax = vecMax.cwiseMax(r);
+    }
+    vecMin.array() -= 0.01f;
+    vecMax.array() += 0.01f;
+
+    const float fStep = 0.008f;
+    QList<Vector3f> lPoints;
+    for(float x = vecMin.x(); x <= vecMax.x(); x += fStep) {
+        for(float y = vecMin.y(); y <= vecMax.y(); y += fStep) {
+            for(float z = vecMin.z(); z <= vecMax.z(); z += fStep) {
+                lPoints.append(Vector3f(x,y,z));
+            }
+        }
+    }
+
+    // Points close to the surface on both sides, where the far field approximation of the winding number is most
+    // likely to misclassify, as well as points on the edges and on the vertices
+    const float offsets[] = {1e-2f, 1e-3f, 1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-8f};
+    for(int k = 0; k < m_pSurf->ntri; k += 7) {
+        MneTriangle* tri = m_pSurf->tris + k;
+        float p = 0.05f + 0.9f*fmod(0.618034f*k,1.0f);
+        float q = (1.0f - p)*fmod(0.414214f*k,1.0f);
+        Vector3f r = Map<Vector3f>(tri->r1) + p*Map<Vector3f>(tri->r12) + q*Map<Vector3f>(tri->r13);
+        for(int j = 0; j < 7; ++j) {
+            lPoints.append(r + offsets[j]*Map<Vector3f>(tri->nn));
+            lPoints.append(r - offsets[j]*Map<Vector3f>(tri->nn));
+        }
+        lPoints.append(r);
+        lPoints.append(Map<Vector3f>(tri->r1) + 0.5f*Map<Vector3f>(tri->r12));
+    }
+    for(int k = 0; k < m_pSurf->np; k += 13) {
+        lPoints.append(Map<Vector3f>(m_pSurf->rr[k]));
+    }
+
+    m_matPoints.resize(lPoints.size(),3);
+    for(int k = 0; k < lPoints.size(); ++k) {
+        m_matPoints.row(k) = lPoints[k].transpose();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareInside()
+{
+    int nInside = 0, nOutside = 0, nMismatch = 0;
+    float r[3];
+
+    for(int k = 0; k < m_matPoints.rows(); ++k) {
+        for(int c = 0; c < 3; ++c) {
+            r[c] = m_matPoints(k,c);
+        }
+
+        bool bOutsideLinear = std::fabs(MneSurfaceOrVolume::sum_solids(r,m_pSurf)/(4*M_PI) - 1.0) > 1e-5;
+        bool bOutsideBvh = std::fabs(m_pBvh->winding_number(r) - 1.0) > 1e-5;
+
+        if(bOutsideLinear != bOutsideBvh) {
+            nMismatch++;
+        }
+        if(bOutsideLinear) {
+            nOutside++;
+        } else {
+            nInside++;
+        }
+    }
+
+    QVERIFY(nInside > 0);
+    QVERIFY(nOutside > 0);
+    QCOMPARE(nMismatch, 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareNearestTriangle()
+{
+    int nMismatch = 0;
+    float r[3];
+    float fDistLinear, fDistBvh;
+
+    for(int k = 0; k < m_matPoints.rows(); ++k) {
+        for(int c = 0; c < 3; ++c) {
+            r[c] = m_matPoints(k,c);
+        }
+
+        int iBestLinear = MneSurfaceOrVolume::mne_project_to_surface(m_pSurf,Q_NULLPTR,r,FALSE,&fDistLinear);
+        int iBestBvh = m_pBvh->project_to_surface(Q_NULLPTR,r,FALSE,&fDistBvh);
+
+        if(iBestLinear != iBestBvh || fDistLinear != fDistBvh) {
+            nMismatch++;
+        }
+    }
+
+    QCOMPARE(nMismatch, 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareNearestVertex()
+{
+    int nMismatch = 0;
+    float r[3], diff[3];
+    float fDist, fDistLinear, fDistBvh;
+
+    for(int k = 0; k < m_matPoints.rows(); ++k) {
+        for(int c = 0; c < 3; ++c) {
+            r[c] = m_matPoints(k,c);
+        }
+
+        int iBestLinear = -1;
+        fDistLinear = 1.0f;
+        for(int p = 0; p < m_pSurf->np; ++p) {
+            for(int c = 0; c < 3; ++c) {
+                diff[c] = m_pSurf->rr[p][c] - r[c];
+            }
+            fDist = sqrt(diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2]);
+            if(fDist < fDistLinear) {
+                fDistLinear = fDist;
+                iBestLinear = p;
+            }
+        }
+
+        fDistBvh = 1.0f;
+        int iBestBvh = m_pBvh->nearest_vertex(r,1.0f,FALSE,&fDistBvh);
+
+        if(iBestLinear != iBestBvh || fDistLinear != fDistBvh) {
+            nMismatch++;
+        }
+    }
+
+    QCOMPARE(nMismatch, 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::cleanupTestCase()
+{
+    delete m_pBvh;
+    delete m_pSurf;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMneSurfaceBvh)
+#include "test_mne_surface_bvh.moc"
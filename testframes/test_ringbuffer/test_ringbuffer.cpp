@@ -0,0 +1,331 @@
+//=============================================================================================================
+/**
+* @file     test_ringbuffer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     12, 2019
+*
+* @section  LICENSE
+*
+* Copyright (C) 2019, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Tests and benchmark of the lock-free RingBuffer against the semaphore based buffers.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/ringbuffer.h>
+#include <utils/generics/circularmatrixbuffer.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Dense>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtTest>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace IOBUFFER;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRingBuffer
+*
+* @brief The TestRingBuffer class provides ring buffer verification tests and a comparison with CircularMatrixBuffer
+*
+*/
+class TestRingBuffer: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRingBuffer();
+
+private slots:
+    void initTestCase();
+    void compareSingleConsumer();
+    void compareBroadcast();
+    void compareMatrices();
+    void releaseBlockedPop();
+    void benchmarkMatrixBuffers();
+    void cleanupTestCase();
+
+private:
+    void printLatency(const char* name, qint64 iTotalNs, std::vector<qint64>& vecLatencies);
+
+    int numElements;
+    int numBlocks;
+    int rows;
+    int cols;
+};
+
+//*************************************************************************************************************
+
+TestRingBuffer::TestRingBuffer()
+: numElements(1000000)
+, numBlocks(2000)
+, rows(306)
+, cols(100)
+{
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::initTestCase()
+{
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::compareSingleConsumer()
+{
+    // Push and pop blocks of different sizes, so the copies wrap around the end of the buffer
+    RingBuffer<int> buffer(1000);
+    QVERIFY(buffer.capacity() == 1024);
+
+    QFuture<void> producer = QtConcurrent::run([&]() {
+        std::vector<int> block(37);
+        int value = 0;
+        while(value < numElements) {
+            int num = std::min(37, numElements - value);
+            for(int i = 0; i < num; ++i) {
+                block[i] = value++;
+            }
+            buffer.push(block.data(), num);
+        }
+    });
+
+    std::vector<int> block(53);
+    int value = 0;
+    int errors = 0;
+    while(value < numElements) {
+        int num = std::min(53, numElements - value);
+        buffer.pop(block.data(), num);
+        for(int i = 0; i < num; ++i) {
+            if(block[i] != value++) {
+                errors++;
+            }
+        }
+    }
+
+    producer.waitForFinished();
+
+    QVERIFY(errors == 0);
+    QVERIFY(buffer.available() == 0);
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::compareBroadcast()
+{
+    // Every consumer must receive every element
+    const int numConsumers = 3;
+    RingBuffer<int> buffer(256, numConsumers);
+
+    QFuture<void> producer = QtConcurrent::run([&]() {
+        for(int value = 0; value < numElements; ++value) {
+            buffer.push(value);
+        }
+    });
+
+    // Each consumer runs on its own thread, so the consumers cannot starve each other in a thread pool
+    std::vector<int> errors(numConsumers, 0);
+    std::vector<std::thread> consumers;
+
+    for(int consumer = 0; consumer < numConsumers; ++consumer) {
+        consumers.push_back(std::thread([&, consumer]() {
+            std::vector<int> block(100);
+            int value = 0;
+            while(value < numElements) {
+                int num = std::min(100, numElements - value);
+                buffer.pop(block.data(), num, consumer);
+                for(int i = 0; i < num; ++i) {
+                    if(block[i] != value++) {
+                        errors[consumer]++;
+                    }
+                }
+            }
+        }));
+    }
+
+    for(int i = 0; i < numConsumers; ++i) {
+        consumers[i].join();
+    }
+
+    producer.waitForFinished();
+
+    for(int i = 0; i < numConsumers; ++i) {
+        QVERIFY(errors[i] == 0);
+    }
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::compareMatrices()
+{
+    RingMatrixBuffer<double> buffer(4, rows, cols);
+    MatrixXd matIn = MatrixXd::Random(rows, cols);
+    MatrixXd matOut;
+
+    for(int i = 0; i < 10; ++i) {
+        buffer.push(&matIn);
+        QVERIFY(buffer.pop(matOut));
+        QVERIFY((matIn - matOut).cwiseAbs().maxCoeff() == 0.0);
+    }
+
+    // Matrices with wrong dimensions are not appended
+    MatrixXd matWrong = MatrixXd::Random(rows, cols + 1);
+    buffer.push(&matWrong);
+    QVERIFY(buffer.available() == 0);
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::releaseBlockedPop()
+{
+    RingBuffer<double> buffer(64);
+
+    QFuture<bool> consumer = QtConcurrent::run([&]() {
+        double block[8];
+        return buffer.pop(block, 8);
+    });
+
+    // Give the consumer time to block in pop
+    QThread::msleep(50);
+
+    QVERIFY(buffer.releaseFromPop());
+    QVERIFY(consumer.result() == false);
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::benchmarkMatrixBuffers()
+{
+    // Producer and consumer hand over MEG sized blocks, latency is measured from push to pop
+    MatrixXd matBlock = MatrixXd::Random(rows, cols);
+    QElapsedTimer timer;
+    std::vector<qint64> vecPushTimes(numBlocks);
+    std::vector<qint64> vecLatencies(numBlocks);
+
+    // Semaphore based CircularMatrixBuffer
+    {
+        CircularMatrixBuffer<double> buffer(8, rows, cols);
+        timer.start();
+
+        QFuture<void> producer = QtConcurrent::run([&]() {
+            for(int i = 0; i < numBlocks; ++i) {
+                vecPushTimes[i] = timer.nsecsElapsed();
+                buffer.push(&matBlock);
+            }
+        });
+
+        for(int i = 0; i < numBlocks; ++i) {
+            MatrixXd matOut = buffer.pop();
+            vecLatencies[i] = timer.nsecsElapsed();
+        }
+
+        producer.waitForFinished();
+
+        for(int i = 0; i < numBlocks; ++i) {
+            vecLatencies[i] -= vecPushTimes[i];
+        }
+        printLatency("CircularMatrixBuffer", timer.nsecsElapsed(), vecLatencies);
+    }
+
+    // Lock-free RingMatrixBuffer
+    {
+        RingMatrixBuffer<double> buffer(8, rows, cols);
+        MatrixXd matOut(rows, cols);
+        timer.restart();
+
+        QFuture<void> producer = QtConcurrent::run([&]() {
+            for(int i = 0; i < numBlocks; ++i) {
+                vecPushTimes[i] = timer.nsecsElapsed();
+                buffer.push(&matBlock);
+            }
+        });
+
+        for(int i = 0; i < numBlocks; ++i) {
+            buffer.pop(matOut);
+            vecLatencies[i] = timer.nsecsElapsed();
+        }
+
+        producer.waitForFinished();
+
+        for(int i = 0; i < numBlocks; ++i) {
+            vecLatencies[i] -= vecPushTimes[i];
+        }
+        printLatency("RingMatrixBuffer", timer.nsecsElapsed(), vecLatencies);
+
+        QVERIFY((matOut - matBlock).cwiseAbs().maxCoeff() == 0.0);
+    }
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::printLatency(const char* name, qint64 iTotalNs, std::vector<qint64>& vecLatencies)
+{
+    std::sort(vecLatencies.begin(), vecLatencies.end());
+
+    const double dMBytes = double(numBlocks) * rows * cols * sizeof(double) / (1024.0 * 1024.0);
+
+    printf("%-22s %8.1f MB/s   latency p50 %8.1f us   p99 %8.1f us   max %8.1f us\n",
+           name,
+           dMBytes / (iTotalNs / 1e9),
+           vecLatencies[vecLatencies.size() / 2] / 1000.0,
+           vecLatencies[vecLatencies.size() * 99 / 100] / 1000.0,
+           vecLatencies.back() / 1000.0);
+}
+
+//*************************************************************************************************************
+
+void TestRingBuffer::cleanupTestCase()
+{
+}
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRingBuffer)
+#include "test_ringbuffer.moc"
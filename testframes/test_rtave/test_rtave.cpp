@@ -0,0 +1,280 @@
+//=============================================================================================================
+/**
+* @file     test_rtave.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2018
+*
+* @section  LICENSE
+*
+* Copyright (C) 2018, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Compares the incremental average of RtAveWorker with a batch average of the same epochs
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <rtprocessing/rtave.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtAve
+*
+* @brief The TestRtAve class compares the incremental average of RtAveWorker with a batch average
+*
+*/
+class TestRtAve: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtAve();
+
+private slots:
+    void initTestCase();
+    void compareAverage();
+    void compareVariance();
+    void cleanupTestCase();
+
+private:
+    void runAverage(bool bComputeVariance);
+
+    double epsilon;
+    int m_iNumChannels;
+    int m_iBlockSize;
+    int m_iPreStim;
+    int m_iPostStim;
+    int m_iNumAverages;
+    int m_iNumAveragesChanged;
+    int m_iChangeAfter;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    MatrixXd m_matData;             /**< Continuous data, row 0 is the trigger channel */
+    QList<MatrixXd> m_lEpochs;      /**< The epochs in the order their average is emitted */
+
+    QList<MatrixXd> m_lAverages;
+    QList<int> m_lNave;
+    QList<MatrixXd> m_lVariances;
+};
+
+
+//*************************************************************************************************************
+
+TestRtAve::TestRtAve()
+: epsilon(0.0000000001)
+, m_iNumChannels(6)
+, m_iBlockSize(100)
+, m_iPreStim(20)
+, m_iPostStim(30)
+, m_iNumAverages(4)
+, m_iNumAveragesChanged(3)
+, m_iChangeAfter(12)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::initTestCase()
+{
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo);
+    m_pFiffInfo->sfreq = 1000.0;
+    m_pFiffInfo->nchan = m_iNumChannels;
+
+    for(int i = 0; i < m_iNumChannels; ++i) {
+        FiffChInfo chInfo;
+        chInfo.ch_name = QString("CH %1").arg(i);
+        chInfo.kind = i == 0 ? FIFFV_STIM_CH : FIFFV_MISC_CH;
+        m_pFiffInfo->chs.append(chInfo);
+        m_pFiffInfo->ch_names.append(chInfo.ch_name);
+    }
+
+    //
+    // Random data with one trigger in two out of three blocks. Triggers late in a block complete their post
+    // stimulus data in the following block, which carries no trigger.
+    //
+    int iNumBlocks = 45;
+    m_matData = MatrixXd::Random(m_iNumChannels, iNumBlocks * m_iBlockSize);
+    m_matData.row(0).setZero();
+
+    for(int k = 0; k < iNumBlocks; ++k) {
+        int iTrigger;
+
+        if(k % 3 == 0) {
+            iTrigger = k * m_iBlockSize + 50;
+        } else if(k % 3 == 1) {
+            iTrigger = k * m_iBlockSize + 85;
+        } else {
+            continue;
+        }
+
+        m_matData(0, iTrigger) = 1.0;
+        m_lEpochs.append(m_matData.middleCols(iTrigger - m_iPreStim, m_iPreStim + m_iPostStim));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::compareAverage()
+{
+    runAverage(false);
+
+    QCOMPARE(m_lAverages.size(), m_lEpochs.size());
+
+    for(int i = 0; i < m_lEpochs.size(); ++i) {
+        //Batch average over the epochs which are part of the average
+        int iNumAverages = i < m_iChangeAfter ? m_iNumAverages : m_iNumAveragesChanged;
+        int iFirst = qMax(0, i - iNumAverages + 1);
+
+        MatrixXd matAverage = MatrixXd::Zero(m_iNumChannels, m_iPreStim + m_iPostStim);
+        for(int j = iFirst; j <= i; ++j) {
+            matAverage += m_lEpochs.at(j);
+        }
+        matAverage /= i - iFirst + 1;
+
+        QCOMPARE(m_lNave.at(i), i - iFirst + 1);
+        QVERIFY((m_lAverages.at(i) - matAverage).cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::compareVariance()
+{
+    runAverage(true);
+
+    QCOMPARE(m_lVariances.size(), m_lEpochs.size());
+
+    for(int i = 0; i < m_lEpochs.size(); ++i) {
+        int iNumAverages = i < m_iChangeAfter ? m_iNumAverages : m_iNumAveragesChanged;
+        int iFirst = qMax(0, i - iNumAverages + 1);
+        int iCount = i - iFirst + 1;
+
+        MatrixXd matMean = MatrixXd::Zero(m_iNumChannels, m_iPreStim + m_iPostStim);
+        for(int j = iFirst; j <= i; ++j) {
+            matMean += m_lEpochs.at(j);
+        }
+        matMean /= iCount;
+
+        MatrixXd matVariance = MatrixXd::Zero(m_iNumChannels, m_iPreStim + m_iPostStim);
+        for(int j = iFirst; j <= i; ++j) {
+            matVariance.array() += (m_lEpochs.at(j) - matMean).array().square();
+        }
+        if(iCount > 1) {
+            matVariance /= iCount - 1;
+        }
+
+        QVERIFY((m_lAverages.at(i) - matMean).cwiseAbs().maxCoeff() < epsilon);
+        QVERIFY((m_lVariances.at(i) - matVariance).cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtAve::runAverage(bool bComputeVariance)
+{
+    m_lAverages.clear();
+    m_lNave.clear();
+    m_lVariances.clear();
+
+    RtAveWorker worker(m_iNumAverages, m_iPreStim, m_iPostStim, 0, 0, 0, m_pFiffInfo);
+    worker.setVarianceActive(bComputeVariance);
+
+    //The worker is used directly, so the signals are delivered before doWork returns
+    connect(&worker, &RtAveWorker::resultReady, [this](const FiffEvokedSet& evokedStimSet, const QStringList& lResponsibleTriggerTypes) {
+        Q_UNUSED(lResponsibleTriggerTypes);
+
+        for(int i = 0; i < evokedStimSet.evoked.size(); ++i) {
+            if(evokedStimSet.evoked.at(i).comment == QString::number(1.0)) {
+                m_lAverages.append(evokedStimSet.evoked.at(i).data);
+                m_lNave.append(evokedStimSet.evoked.at(i).nave);
+            }
+        }
+    });
+
+    connect(&worker, &RtAveWorker::varianceReady, [this](double dTriggerType, const MatrixXd& matVariance) {
+        if(dTriggerType == 1.0) {
+            m_lVariances.append(matVariance);
+        }
+    });
+
+    for(int k = 0; k < m_matData.cols() / m_iBlockSize; ++k) {
+        if(m_lAverages.size() == m_iChangeAfter) {
+            worker.setAverageNumber(m_iNumAveragesChanged);
+        }
+
+        worker.doWork(m_matData.middleCols(k * m_iBlockSize, m_iBlockSize));
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtAve)
+#include "test_rtave.moc"
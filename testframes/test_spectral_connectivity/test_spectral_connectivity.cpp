@@ -52,6 +52,8 @@
 #include <connectivity/metrics/crosscorrelation.h>
 #include <connectivity/connectivitysettings.h>
 #include <connectivity/network/network.h>
+#include <connectivity/network/networkedge.h>
+#include <connectivity/network/networknode.h>
 
 
 //*************************************************************************************************************
@@ -60,6 +62,7 @@
 //=============================================================================================================
 
 #include <QtTest>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -104,6 +107,7 @@ private slots:
     void spectralConnectivityCoherence();
     void spectralConnectivityImagCoherence();
     void spectralConnectivityXCOR();
+    void networkEdges();
     void cleanupTestCase();
 
 private:
@@ -363,6 +367,58 @@ void TestSpectralConnectivity::spectralConnectivityXCOR()
 }
 
 
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::networkEdges()
+{
+    //*********************************************************************************************************
+    // Compute Connectivity
+    //*********************************************************************************************************
+
+    Network network = Coherence::calculate(m_connectivitySettings);
+    int iNumberNodes = network.getNodes().size();
+    QVERIFY(iNumberNodes > 1);
+
+    //*********************************************************************************************************
+    // Edges from a node to itself are discarded
+    //*********************************************************************************************************
+
+    MatrixXd matConnectivity = network.getFullConnectivityMatrix();
+    QVERIFY(matConnectivity.diagonal().isZero(0.0));
+    QCOMPARE(network.getFullEdges().size(), iNumberNodes * (iNumberNodes - 1) / 2);
+
+    for(int i = 0; i < network.getFullEdges().size(); ++i) {
+        NetworkEdge::SPtr pEdge = network.getFullEdges().at(i);
+        QVERIFY(pEdge->getStartNodeID() != pEdge->getEndNodeID());
+        QVERIFY(fabs(pEdge->getWeight() - matConnectivity(pEdge->getStartNodeID(), pEdge->getEndNodeID())) < epsilon);
+    }
+
+    for(int i = 0; i < iNumberNodes; ++i) {
+        QCOMPARE(int(network.getNodes().at(i)->getFullDegree()), iNumberNodes - 1);
+    }
+
+    //*********************************************************************************************************
+    // The edge objects are created on demand, concurrent getters must see the same edges
+    //*********************************************************************************************************
+
+    const Network networkCopy = Coherence::calculate(m_connectivitySettings);
+    std::function<int(int)> countEdges = [&networkCopy](int i) {
+        return i % 2 ? networkCopy.getFullEdges().size() : networkCopy.getNodes().size();
+    };
+
+    QList<int> lIndices;
+    for(int i = 0; i < 16; ++i) {
+        lIndices << i;
+    }
+
+    QList<int> lCounts = QtConcurrent::blockingMapped(lIndices, countEdges);
+
+    for(int i = 0; i < lCounts.size(); ++i) {
+        QCOMPARE(lCounts.at(i), i % 2 ? iNumberNodes * (iNumberNodes - 1) / 2 : iNumberNodes);
+    }
+}
+
+
 //*************************************************************************************************************
 
 QList<MatrixXd> TestSpectralConnectivity::readConnectivityData()
@@ -45,6 +45,8 @@ SUBDIRS += \
     test_fiff_cov \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \
+    test_mne_surface_bvh \
+    test_ringbuffer \
 
 !contains(MNECPP_CONFIG, minimalVersion) {
     qtHaveModule(charts) {
@@ -53,5 +55,6 @@ SUBDIRS += \
             test_geometryinfo \
             test_spectral_connectivity \
             test_filtering \
+            test_rtave \
     }
 }